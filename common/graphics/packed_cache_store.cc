@@ -0,0 +1,460 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/common/graphics/packed_cache_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint32_t kDataMagic = 0x44435046;   // "FPCD"
+constexpr uint32_t kIndexMagic = 0x49435046;  // "FPCI"
+constexpr uint32_t kFormatVersion = 1;
+
+// Below this many bytes of replaced records, compacting the data file is not
+// worth rewriting it.
+constexpr size_t kMinCompactionBytes = 64 * 1024;
+
+struct DataHeader {
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct RecordHeader {
+  uint32_t key_size;
+  uint32_t value_size;
+};
+
+struct IndexHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t entry_count;
+  uint64_t data_size;
+};
+
+static_assert(sizeof(IndexHeader) % alignof(PackedCacheStore::IndexEntry) == 0,
+              "Index entries must be aligned in the mapped index.");
+
+uint64_t HashKey(const void* bytes, size_t size) {
+  // 64-bit FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  const uint8_t* data = static_cast<const uint8_t*>(bytes);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+size_t RecordSize(const PackedCacheStore::IndexEntry& entry) {
+  return sizeof(RecordHeader) + entry.key_size + entry.value_size;
+}
+
+bool EntryLess(const PackedCacheStore::IndexEntry& a,
+               const PackedCacheStore::IndexEntry& b) {
+  return a.hash < b.hash || (a.hash == b.hash && a.offset < b.offset);
+}
+
+std::string KeyString(const SkData& key) {
+  return std::string(static_cast<const char*>(key.data()), key.size());
+}
+
+void ReleaseMapping(const void* ptr, void* context) {
+  delete static_cast<std::shared_ptr<fml::FileMapping>*>(context);
+}
+
+}  // namespace
+
+bool PackedCacheStore::IsStoreFile(const std::string& file_name) {
+  return file_name == kDataFileName || file_name == kIndexFileName;
+}
+
+PackedCacheStore::PackedCacheStore(std::shared_ptr<fml::UniqueFD> directory,
+                                   bool read_only)
+    : directory_(std::move(directory)), read_only_(read_only) {
+  MapFiles();
+}
+
+PackedCacheStore::~PackedCacheStore() = default;
+
+const PackedCacheStore::IndexEntry* PackedCacheStore::Snapshot::entries()
+    const {
+  if (!index) {
+    return nullptr;
+  }
+  return reinterpret_cast<const IndexEntry*>(index->GetMapping() +
+                                             sizeof(IndexHeader));
+}
+
+size_t PackedCacheStore::Snapshot::entry_count() const {
+  if (!index) {
+    return 0;
+  }
+  return (index->GetSize() - sizeof(IndexHeader)) / sizeof(IndexEntry);
+}
+
+const PackedCacheStore::IndexEntry* PackedCacheStore::Snapshot::Find(
+    const SkData& key,
+    uint64_t hash) const {
+  const IndexEntry* begin = entries();
+  const IndexEntry* end = begin + entry_count();
+  const IndexEntry* found = std::lower_bound(
+      begin, end, hash,
+      [](const IndexEntry& entry, uint64_t hash) { return entry.hash < hash; });
+  for (; found != end && found->hash == hash; ++found) {
+    sk_sp<SkData> found_key = KeyAt(*found);
+    if (found_key && found_key->equals(&key)) {
+      return found;
+    }
+  }
+  return nullptr;
+}
+
+sk_sp<SkData> PackedCacheStore::Snapshot::KeyAt(const IndexEntry& entry) const {
+  // The index and data file are written separately, so every entry is checked
+  // against the record it points to before it is trusted.
+  if (!data || entry.offset > data->GetSize() ||
+      RecordSize(entry) > data->GetSize() - entry.offset) {
+    return nullptr;
+  }
+  RecordHeader record;
+  memcpy(&record, data->GetMapping() + entry.offset, sizeof(record));
+  if (record.key_size != entry.key_size ||
+      record.value_size != entry.value_size) {
+    return nullptr;
+  }
+  return SkData::MakeWithCopy(
+      data->GetMapping() + entry.offset + sizeof(RecordHeader), entry.key_size);
+}
+
+sk_sp<SkData> PackedCacheStore::Snapshot::ValueAt(
+    const IndexEntry& entry) const {
+  if (!KeyAt(entry)) {
+    return nullptr;
+  }
+  const uint8_t* value = data->GetMapping() + entry.offset +
+                         sizeof(RecordHeader) + entry.key_size;
+  // Keep the mapping alive for as long as the value is referenced.
+  return SkData::MakeWithProc(value, entry.value_size, ReleaseMapping,
+                              new std::shared_ptr<fml::FileMapping>(data));
+}
+
+std::shared_ptr<const PackedCacheStore::Snapshot>
+PackedCacheStore::GetSnapshot() const {
+  std::scoped_lock lock(mutex_);
+  return snapshot_;
+}
+
+void PackedCacheStore::MapFiles() {
+  TRACE_EVENT0("flutter", "PackedCacheStore::MapFiles");
+  auto snapshot = std::make_shared<Snapshot>();
+  size_t dead_bytes = 0;
+
+  if (directory_ && directory_->is_valid()) {
+    std::shared_ptr<fml::FileMapping> data =
+        fml::FileMapping::CreateReadOnly(*directory_, kDataFileName);
+    DataHeader data_header = {};
+    if (data && data->GetSize() >= sizeof(DataHeader)) {
+      memcpy(&data_header, data->GetMapping(), sizeof(DataHeader));
+    }
+    const bool data_valid = data_header.magic == kDataMagic &&
+                            data_header.version == kFormatVersion;
+
+    std::shared_ptr<fml::FileMapping> index =
+        fml::FileMapping::CreateReadOnly(*directory_, kIndexFileName);
+    IndexHeader index_header = {};
+    if (index && index->GetSize() >= sizeof(IndexHeader)) {
+      memcpy(&index_header, index->GetMapping(), sizeof(IndexHeader));
+    }
+    // Without an index, the records in the data file cannot be found and the
+    // next flush starts the data file over.
+    if (data_valid && index_header.magic == kIndexMagic &&
+        index_header.version == kFormatVersion &&
+        index_header.entry_count ==
+            (index->GetSize() - sizeof(IndexHeader)) / sizeof(IndexEntry) &&
+        index_header.data_size >= sizeof(DataHeader) &&
+        index_header.data_size <= data->GetSize()) {
+      snapshot->data = std::move(data);
+      snapshot->index = std::move(index);
+      snapshot->data_size = index_header.data_size;
+      dead_bytes = snapshot->data_size - sizeof(DataHeader);
+      const IndexEntry* entries = snapshot->entries();
+      for (size_t i = 0; i < snapshot->entry_count(); ++i) {
+        dead_bytes -= std::min(dead_bytes, RecordSize(entries[i]));
+      }
+    }
+  }
+
+  std::scoped_lock lock(mutex_);
+  snapshot_ = std::move(snapshot);
+  dead_bytes_ = dead_bytes;
+}
+
+sk_sp<SkData> PackedCacheStore::Load(const SkData& key) const {
+  std::shared_ptr<const Snapshot> snapshot;
+  {
+    std::scoped_lock lock(mutex_);
+    auto pending = pending_.find(KeyString(key));
+    if (pending != pending_.end()) {
+      return pending->second;
+    }
+    snapshot = snapshot_;
+  }
+
+  const IndexEntry* entry =
+      snapshot->Find(key, HashKey(key.data(), key.size()));
+  return entry ? snapshot->ValueAt(*entry) : nullptr;
+}
+
+void PackedCacheStore::Store(const SkData& key, const SkData& value) {
+  if (read_only_) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  pending_[KeyString(key)] = SkData::MakeWithCopy(value.data(), value.size());
+}
+
+bool PackedCacheStore::HasPendingEntries() const {
+  std::scoped_lock lock(mutex_);
+  return !pending_.empty();
+}
+
+bool PackedCacheStore::ScheduleFlush() {
+  std::scoped_lock lock(mutex_);
+  if (read_only_ || flush_scheduled_) {
+    return false;
+  }
+  flush_scheduled_ = true;
+  return true;
+}
+
+bool PackedCacheStore::Flush() {
+  std::scoped_lock file_lock(file_mutex_);
+  return FlushLocked();
+}
+
+bool PackedCacheStore::FlushLocked() {
+  TRACE_EVENT0("flutter", "PackedCacheStore::Flush");
+  if (read_only_ || !directory_ || !directory_->is_valid()) {
+    return false;
+  }
+
+  std::map<std::string, sk_sp<SkData>> pending;
+  std::shared_ptr<const Snapshot> snapshot;
+  {
+    std::scoped_lock lock(mutex_);
+    pending = pending_;
+    snapshot = snapshot_;
+    // Entries stored from now on are not written by this flush, so the next
+    // store has to schedule another one.
+    flush_scheduled_ = false;
+  }
+  if (pending.empty()) {
+    return true;
+  }
+
+  fml::UniqueFD data_file =
+      fml::OpenFile(*directory_, kDataFileName, true,
+                    fml::FilePermission::kReadWrite);
+  if (!data_file.is_valid()) {
+    FML_LOG(WARNING) << "Could not open the packed cache data file.";
+    return false;
+  }
+
+  // Append the new records after the last one the index knows about.
+  // Anything past it is left over from an interrupted flush. It is
+  // overwritten by the new records, and the file is truncated to where they
+  // end.
+  const size_t base = snapshot->index ? snapshot->data_size : 0;
+  size_t data_size = base == 0 ? sizeof(DataHeader) : base;
+  std::vector<IndexEntry> appended;
+  appended.reserve(pending.size());
+  for (const auto& [key, value] : pending) {
+    IndexEntry entry;
+    entry.hash = HashKey(key.data(), key.size());
+    entry.offset = data_size;
+    entry.key_size = static_cast<uint32_t>(key.size());
+    entry.value_size = static_cast<uint32_t>(value->size());
+    appended.push_back(entry);
+    data_size += RecordSize(entry);
+  }
+
+  if (!fml::TruncateFile(data_file, data_size)) {
+    FML_LOG(WARNING) << "Could not resize the packed cache data file.";
+    return false;
+  }
+  {
+    fml::FileMapping writable(data_file,
+                              {fml::FileMapping::Protection::kRead,
+                               fml::FileMapping::Protection::kWrite});
+    uint8_t* destination = writable.GetMutableMapping();
+    if (!writable.IsValid() || destination == nullptr) {
+      FML_LOG(WARNING) << "Could not map the packed cache data file.";
+      return false;
+    }
+    if (base == 0) {
+      DataHeader header = {kDataMagic, kFormatVersion};
+      memcpy(destination, &header, sizeof(header));
+    }
+    auto entry = appended.begin();
+    for (const auto& [key, value] : pending) {
+      RecordHeader record = {entry->key_size, entry->value_size};
+      uint8_t* cursor = destination + entry->offset;
+      memcpy(cursor, &record, sizeof(record));
+      memcpy(cursor + sizeof(record), key.data(), key.size());
+      memcpy(cursor + sizeof(record) + key.size(), value->data(),
+             value->size());
+      ++entry;
+    }
+  }
+
+  // Carry over the entries that were not replaced by this flush.
+  std::vector<IndexEntry> entries;
+  entries.reserve(snapshot->entry_count() + appended.size());
+  const IndexEntry* existing = snapshot->entries();
+  for (size_t i = 0; i < snapshot->entry_count(); ++i) {
+    sk_sp<SkData> key = snapshot->KeyAt(existing[i]);
+    if (key && pending.count(KeyString(*key)) == 0) {
+      entries.push_back(existing[i]);
+    }
+  }
+  entries.insert(entries.end(), appended.begin(), appended.end());
+  std::sort(entries.begin(), entries.end(), EntryLess);
+
+  if (!WriteIndex(entries, data_size)) {
+    return false;
+  }
+
+  // Remapping also accounts for the records that were just replaced.
+  MapFiles();
+
+  std::scoped_lock lock(mutex_);
+  for (const auto& flushed : pending) {
+    auto found = pending_.find(flushed.first);
+    if (found != pending_.end() && found->second == flushed.second) {
+      pending_.erase(found);
+    }
+  }
+  return true;
+}
+
+bool PackedCacheStore::NeedsCompaction() const {
+  std::scoped_lock lock(mutex_);
+  if (!snapshot_->index || dead_bytes_ < kMinCompactionBytes) {
+    return false;
+  }
+  const size_t live_bytes =
+      snapshot_->data_size - sizeof(DataHeader) - dead_bytes_;
+  return dead_bytes_ >= live_bytes;
+}
+
+bool PackedCacheStore::Compact() {
+  TRACE_EVENT0("flutter", "PackedCacheStore::Compact");
+  std::scoped_lock file_lock(file_mutex_);
+  if (!FlushLocked()) {
+    return false;
+  }
+
+  std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+  std::vector<uint8_t> data(sizeof(DataHeader));
+  DataHeader header = {kDataMagic, kFormatVersion};
+  memcpy(data.data(), &header, sizeof(header));
+
+  std::vector<IndexEntry> entries;
+  entries.reserve(snapshot->entry_count());
+  const IndexEntry* existing = snapshot->entries();
+  for (size_t i = 0; i < snapshot->entry_count(); ++i) {
+    if (!snapshot->KeyAt(existing[i])) {
+      continue;
+    }
+    IndexEntry entry = existing[i];
+    const uint8_t* record = snapshot->data->GetMapping() + entry.offset;
+    entry.offset = data.size();
+    data.insert(data.end(), record, record + RecordSize(entry));
+    entries.push_back(entry);
+  }
+  std::sort(entries.begin(), entries.end(), EntryLess);
+
+  const size_t data_size = data.size();
+  if (!fml::WriteAtomically(*directory_, kDataFileName,
+                            fml::DataMapping(std::move(data)))) {
+    FML_LOG(WARNING) << "Could not write the compacted packed cache.";
+    return false;
+  }
+  // If this fails, the old index is verified against the new data file on
+  // every lookup and simply misses.
+  bool result = WriteIndex(entries, data_size);
+  MapFiles();
+  return result;
+}
+
+void PackedCacheStore::Clear() {
+  std::scoped_lock file_lock(file_mutex_);
+  {
+    std::scoped_lock lock(mutex_);
+    snapshot_ = std::make_shared<Snapshot>();
+    pending_.clear();
+    dead_bytes_ = 0;
+  }
+  if (!read_only_ && directory_ && directory_->is_valid()) {
+    fml::UnlinkFile(*directory_, kIndexFileName);
+    fml::UnlinkFile(*directory_, kDataFileName);
+  }
+}
+
+void PackedCacheStore::VisitEntries(const EntryVisitor& visitor) const {
+  std::map<std::string, sk_sp<SkData>> pending;
+  std::shared_ptr<const Snapshot> snapshot;
+  {
+    std::scoped_lock lock(mutex_);
+    pending = pending_;
+    snapshot = snapshot_;
+  }
+
+  const IndexEntry* entries = snapshot->entries();
+  for (size_t i = 0; i < snapshot->entry_count(); ++i) {
+    sk_sp<SkData> key = snapshot->KeyAt(entries[i]);
+    if (!key || pending.count(KeyString(*key)) != 0) {
+      continue;
+    }
+    visitor(std::move(key), snapshot->ValueAt(entries[i]));
+  }
+  for (const auto& [key, value] : pending) {
+    visitor(SkData::MakeWithCopy(key.data(), key.size()), value);
+  }
+}
+
+size_t PackedCacheStore::GetEntryCount() const {
+  size_t count = 0;
+  VisitEntries([&count](sk_sp<SkData>, sk_sp<SkData>) { ++count; });
+  return count;
+}
+
+bool PackedCacheStore::WriteIndex(const std::vector<IndexEntry>& entries,
+                                  size_t data_size) {
+  IndexHeader header = {kIndexMagic, kFormatVersion, entries.size(),
+                        data_size};
+  std::vector<uint8_t> index(sizeof(IndexHeader) +
+                             entries.size() * sizeof(IndexEntry));
+  memcpy(index.data(), &header, sizeof(header));
+  if (!entries.empty()) {
+    memcpy(index.data() + sizeof(header), entries.data(),
+           entries.size() * sizeof(IndexEntry));
+  }
+  if (!fml::WriteAtomically(*directory_, kIndexFileName,
+                            fml::DataMapping(std::move(index)))) {
+    FML_LOG(WARNING) << "Could not write the packed cache index.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,145 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_STORE_H_
+#define FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_STORE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+/// A key/value store backed by two files in a directory instead of one file
+/// per key.
+///
+/// Records are appended to a single data file. A separate index file holds the
+/// hashes of all live keys, sorted, along with the location of their records
+/// in the data file. Both files are memory mapped, so loading the store is two
+/// mmaps and a lookup is a binary search over the mapped index without
+/// touching the directory.
+///
+/// Records replaced by a later store of the same key stay in the data file
+/// until |Compact| rewrites it with only the live records.
+///
+/// All methods may be called from any thread. |Flush|, |Compact| and |Clear|
+/// write to disk one at a time, so concurrent calls wait for each other
+/// instead of overwriting each other's files.
+class PackedCacheStore {
+ public:
+  static constexpr char kDataFileName[] = "io.flutter.cache.pack";
+  static constexpr char kIndexFileName[] = "io.flutter.cache.pack.index";
+
+  // Whether the file is one of the files of a packed store. Used to skip them
+  // when visiting a cache directory for individually stored entries.
+  static bool IsStoreFile(const std::string& file_name);
+
+  // Maps the store in |directory|. Missing, stale or corrupt files result in
+  // an empty store.
+  PackedCacheStore(std::shared_ptr<fml::UniqueFD> directory, bool read_only);
+
+  ~PackedCacheStore();
+
+  // Returns the value stored for the key, or nullptr. The returned data
+  // references the mapped data file instead of copying it where possible.
+  sk_sp<SkData> Load(const SkData& key) const;
+
+  // Stores the value for the key. The entry is visible to |Load| right away
+  // but is only written to disk by the next |Flush|.
+  void Store(const SkData& key, const SkData& value);
+
+  // Whether there are entries that have not been flushed to disk yet.
+  bool HasPendingEntries() const;
+
+  // Called after |Store| by writers that flush asynchronously. Returns true if
+  // the caller has to schedule a |Flush|, because no flush that is yet to
+  // start is scheduled to write the entries stored so far.
+  bool ScheduleFlush();
+
+  // Appends the entries stored since the last flush to the data file and
+  // rewrites the index.
+  bool Flush();
+
+  // Whether at least half of the data file is taken up by replaced records,
+  // so that it should be compacted.
+  bool NeedsCompaction() const;
+
+  // Rewrites the data file with only the live records. Flushes first.
+  bool Compact();
+
+  // Forgets all entries and removes the files of the store.
+  void Clear();
+
+  using EntryVisitor =
+      std::function<void(sk_sp<SkData> key, sk_sp<SkData> value)>;
+
+  // Calls the visitor for every entry in the store.
+  void VisitEntries(const EntryVisitor& visitor) const;
+
+  size_t GetEntryCount() const;
+
+  struct IndexEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint32_t key_size;
+    uint32_t value_size;
+  };
+
+ private:
+  // The data file and index that are currently mapped. Snapshots are
+  // immutable and replaced as a whole, so readers only need the lock to grab
+  // a reference.
+  struct Snapshot {
+    std::shared_ptr<fml::FileMapping> data;
+    std::shared_ptr<fml::FileMapping> index;
+    // The end of the last record the index was written for. Anything in the
+    // data file past it is left over from an interrupted flush.
+    size_t data_size = 0;
+
+    const IndexEntry* entries() const;
+    size_t entry_count() const;
+    // Returns the entry for the key, or nullptr.
+    const IndexEntry* Find(const SkData& key, uint64_t hash) const;
+    sk_sp<SkData> KeyAt(const IndexEntry& entry) const;
+    sk_sp<SkData> ValueAt(const IndexEntry& entry) const;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const bool read_only_;
+
+  // Held for the duration of every write to the files of the store.
+  std::mutex file_mutex_;
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Snapshot> snapshot_;
+  // Entries stored since the last flush, by key.
+  std::map<std::string, sk_sp<SkData>> pending_;
+  // Bytes of the data file taken up by records no index entry points to.
+  size_t dead_bytes_ = 0;
+  // Whether a flush was scheduled by |ScheduleFlush| and has not taken the
+  // pending entries yet.
+  bool flush_scheduled_ = false;
+
+  std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+  void MapFiles();
+
+  // Does the work of |Flush|. |file_mutex_| must be held.
+  bool FlushLocked();
+
+  bool WriteIndex(const std::vector<IndexEntry>& entries, size_t data_size);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedCacheStore);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_COMMON_GRAPHICS_PACKED_CACHE_STORE_H_
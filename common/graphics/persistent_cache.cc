@@ -9,6 +9,7 @@
 #include <string>
 #include <string_view>
 
+#include "flutter/common/graphics/packed_cache_store.h"
 #include "flutter/fml/base32.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
@@ -48,6 +49,12 @@ std::string PersistentCache::SkKeyToFilePath(const SkData& data) {
 
 bool PersistentCache::gIsReadOnly = false;
 
+bool PersistentCache::gUsePackedStore = false;
+
+bool PersistentCache::gCacheText = false;
+
+bool PersistentCache::gCacheGlyphProfile = false;
+
 std::atomic<bool> PersistentCache::cache_sksl_ = false;
 std::atomic<bool> PersistentCache::strategy_set_ = false;
 
@@ -86,7 +93,18 @@ bool PersistentCache::Purge() {
 
   std::promise<bool> removed;
   GetWorkerTaskRunner()->PostTask([&removed,
-                                   cache_directory = cache_directory_]() {
+                                   cache_directory = cache_directory_,
+                                   packed_store = packed_store_,
+                                   sksl_packed_store = sksl_packed_store_,
+                                   text_store = text_store_,
+                                   glyph_profile_store =
+                                       glyph_profile_store_]() {
+    for (const auto& store : {packed_store, sksl_packed_store, text_store,
+                              glyph_profile_store}) {
+      if (store) {
+        store->Clear();
+      }
+    }
     if (cache_directory->is_valid()) {
       // Only remove files but not directories.
       FML_LOG(INFO) << "Purge persistent cache.";
@@ -132,7 +150,7 @@ static void FreeOldCacheDirectory(const fml::UniqueFD& cache_base_dir) {
 static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     const std::string& global_cache_base_path,
     bool read_only,
-    bool cache_sksl) {
+    const char* subdirectory) {
   fml::UniqueFD cache_base_dir;
   if (global_cache_base_path.length()) {
     cache_base_dir = fml::OpenDirectory(global_cache_base_path.c_str(), false,
@@ -145,8 +163,8 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     FreeOldCacheDirectory(cache_base_dir);
     std::vector<std::string> components = {
         kEngineComponent, GetFlutterEngineVersion(), "skia", GetSkiaVersion()};
-    if (cache_sksl) {
-      components.push_back(PersistentCache::kSkSLSubdirName);
+    if (subdirectory) {
+      components.push_back(subdirectory);
     }
     return std::make_shared<fml::UniqueFD>(
         CreateDirectory(cache_base_dir, components,
@@ -156,6 +174,33 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     return std::make_shared<fml::UniqueFD>();
   }
 }
+
+static std::shared_ptr<PackedCacheStore> MakePackedStore(
+    const std::shared_ptr<fml::UniqueFD>& cache_directory,
+    bool read_only) {
+  if (!PersistentCache::gUsePackedStore || !cache_directory->is_valid()) {
+    return nullptr;
+  }
+  return std::make_shared<PackedCacheStore>(cache_directory, read_only);
+}
+
+// Makes a packed store in a subdirectory of its own, for entries that are
+// not Skia's.
+static std::shared_ptr<PackedCacheStore> MakeSubdirectoryStore(
+    bool enabled,
+    const std::string& global_cache_base_path,
+    bool read_only,
+    const char* subdirectory) {
+  if (!enabled) {
+    return nullptr;
+  }
+  auto directory =
+      MakeCacheDirectory(global_cache_base_path, read_only, subdirectory);
+  if (!directory->is_valid()) {
+    return nullptr;
+  }
+  return std::make_shared<PackedCacheStore>(std::move(directory), read_only);
+}
 }  // namespace
 
 sk_sp<SkData> ParseBase32(const std::string& input) {
@@ -196,6 +241,9 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   std::vector<PersistentCache::SkSLCache> result;
   fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
                                        const std::string& filename) {
+    if (PackedCacheStore::IsStoreFile(filename)) {
+      return true;
+    }
     sk_sp<SkData> key = ParseBase32(filename);
     sk_sp<SkData> data = LoadFile(directory, filename);
     if (key != nullptr && data != nullptr) {
@@ -210,12 +258,23 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   // However, we'd like to continue visit the asset dir even if this persistent
   // cache is invalid.
   if (IsValid()) {
-    // In case `rewinddir` doesn't work reliably, load SkSLs from a freshly
-    // opened directory (https://github.com/flutter/flutter/issues/65258).
-    fml::UniqueFD fresh_dir =
-        fml::OpenDirectoryReadOnly(*cache_directory_, kSkSLSubdirName);
-    if (fresh_dir.is_valid()) {
-      fml::VisitFiles(fresh_dir, visitor);
+    if (sksl_packed_store_) {
+      // All SkSLs are stored in the packed store, so the directory is not
+      // scanned for individually stored ones.
+      sksl_packed_store_->VisitEntries(
+          [&result](sk_sp<SkData> key, sk_sp<SkData> value) {
+            if (value != nullptr) {
+              result.push_back({std::move(key), std::move(value)});
+            }
+          });
+    } else {
+      // In case `rewinddir` doesn't work reliably, load SkSLs from a freshly
+      // opened directory (https://github.com/flutter/flutter/issues/65258).
+      fml::UniqueFD fresh_dir =
+          fml::OpenDirectoryReadOnly(*cache_directory_, kSkSLSubdirName);
+      if (fresh_dir.is_valid()) {
+        fml::VisitFiles(fresh_dir, visitor);
+      }
     }
   }
 
@@ -251,9 +310,20 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
 
 PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
-      cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
+      cache_directory_(
+          MakeCacheDirectory(cache_base_path_, read_only, nullptr)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, kSkSLSubdirName)),
+      packed_store_(MakePackedStore(cache_directory_, read_only)),
+      sksl_packed_store_(MakePackedStore(sksl_cache_directory_, read_only)),
+      text_store_(MakeSubdirectoryStore(gCacheText,
+                                        cache_base_path_,
+                                        read_only,
+                                        kTextSubdirName)),
+      glyph_profile_store_(MakeSubdirectoryStore(gCacheGlyphProfile,
+                                                 cache_base_path_,
+                                                 read_only,
+                                                 kGlyphProfileSubdirName)) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -285,6 +355,15 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   if (!IsValid()) {
     return nullptr;
   }
+  if (packed_store_) {
+    // Shaders are only stored in the packed store, so a miss does not open
+    // any file.
+    auto result = packed_store_->Load(key);
+    if (result != nullptr) {
+      TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
+    }
+    return result;
+  }
   auto file_name = SkKeyToFilePath(key);
   if (file_name.size() == 0) {
     return nullptr;
@@ -324,6 +403,39 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
   }
 }
 
+static void PackedCacheStoreEntry(fml::RefPtr<fml::TaskRunner> worker,
+                                  std::shared_ptr<PackedCacheStore> store,
+                                  const SkData& key,
+                                  const SkData& value) {
+  // Storing only copies the entry into memory, so it is done right away and
+  // the entry can be loaded before it is written to disk.
+  store->Store(key, value);
+
+  auto flush = [store]() {
+    if (store->Flush() && store->NeedsCompaction()) {
+      store->Compact();
+    }
+  };
+
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    flush();
+    return;
+  }
+
+  // Entries stored in a burst are written to disk together by a single flush
+  // that runs after all of them.
+  if (store->ScheduleFlush()) {
+    worker->PostTask([flush]() {
+      TRACE_EVENT0("flutter", "PersistentCacheStore");
+      flush();
+    });
+  }
+}
+
 // |GrContextOptions::PersistentCache|
 void PersistentCache::store(const SkData& key, const SkData& data) {
   stored_new_shaders_ = true;
@@ -342,6 +454,14 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
+  if (auto packed_store = cache_sksl_ ? sksl_packed_store_ : packed_store_) {
+    if (data.size() != 0) {
+      PackedCacheStoreEntry(GetWorkerTaskRunner(), std::move(packed_store),
+                            key, data);
+    }
+    return;
+  }
+
   auto mapping = std::make_unique<fml::DataMapping>(
       std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
 
@@ -354,6 +474,44 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
                        std::move(file_name), std::move(mapping));
 }
 
+sk_sp<SkData> PersistentCache::LoadText(const SkData& key) const {
+  if (!text_store_) {
+    return nullptr;
+  }
+  return text_store_->Load(key);
+}
+
+void PersistentCache::StoreText(const SkData& key, const SkData& value) {
+  if (is_read_only_ || !text_store_ || value.size() == 0) {
+    return;
+  }
+  PackedCacheStoreEntry(GetWorkerTaskRunner(), text_store_, key, value);
+}
+
+std::vector<PersistentCache::GlyphProfileEntry>
+PersistentCache::LoadGlyphProfile() const {
+  TRACE_EVENT0("flutter", "PersistentCache::LoadGlyphProfile");
+  std::vector<GlyphProfileEntry> result;
+  if (glyph_profile_store_) {
+    glyph_profile_store_->VisitEntries(
+        [&result](sk_sp<SkData> font, sk_sp<SkData> glyphs) {
+          if (glyphs != nullptr) {
+            result.push_back({std::move(font), std::move(glyphs)});
+          }
+        });
+  }
+  return result;
+}
+
+void PersistentCache::StoreGlyphProfile(const SkData& font,
+                                        const SkData& glyphs) {
+  if (is_read_only_ || !glyph_profile_store_ || glyphs.size() == 0) {
+    return;
+  }
+  PackedCacheStoreEntry(GetWorkerTaskRunner(), glyph_profile_store_, font,
+                        glyphs);
+}
+
 void PersistentCache::DumpSkp(const SkData& data) {
   if (is_read_only_ || !IsValid()) {
     FML_LOG(ERROR) << "Could not dump SKP from read-only or invalid persistent "
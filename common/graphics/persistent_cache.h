@@ -21,6 +21,8 @@ namespace testing {
 class ShellTest;
 }
 
+class PackedCacheStore;
+
 /// A cache of SkData that gets stored to disk.
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
@@ -34,6 +36,23 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // packages.
   static bool gIsReadOnly;
 
+  // Mutable static switch that can be set before GetCacheForProcess. If true,
+  // new entries are written to a single packed, indexed and memory mapped
+  // store per cache directory instead of one file per entry. Neither loads nor
+  // |LoadSkSLs| touch the files of individually stored entries then, so
+  // entries stored before the switch was turned on are not read.
+  static bool gUsePackedStore;
+
+  // Mutable static switch that can be set before GetCacheForProcess. If true,
+  // the cache also keeps the results of text shaping and font fallback in a
+  // packed store of its own, see |LoadText| and |StoreText|.
+  static bool gCacheText;
+
+  // Mutable static switch that can be set before GetCacheForProcess. If true,
+  // the cache also keeps a profile of the glyphs drawn by text in a packed
+  // store of its own, see |LoadGlyphProfile| and |StoreGlyphProfile|.
+  static bool gCacheGlyphProfile;
+
   static PersistentCache* GetCacheForProcess();
   static void ResetCacheForProcess();
 
@@ -69,6 +88,24 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // |GrContextOptions::PersistentCache|
   sk_sp<SkData> load(const SkData& key) override;
 
+  // Returns the text layout data stored for the key, or nullptr. Always
+  // returns nullptr unless |gCacheText| was set when the cache was created.
+  sk_sp<SkData> LoadText(const SkData& key) const;
+
+  // Stores text layout data for the key. The entry can be loaded right away
+  // and is written to disk on a worker.
+  void StoreText(const SkData& key, const SkData& value);
+
+  using GlyphProfileEntry = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
+
+  // Returns all the entries of the glyph profile. Always returns no entries
+  // unless |gCacheGlyphProfile| was set when the cache was created.
+  std::vector<GlyphProfileEntry> LoadGlyphProfile() const;
+
+  // Stores the glyphs drawn in a font, replacing those stored before for the
+  // same font. The entry is written to disk on a worker.
+  void StoreGlyphProfile(const SkData& font, const SkData& glyphs);
+
   using SkSLCache = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
 
   /// Load all the SkSL shader caches in the right directory.
@@ -86,6 +123,8 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   static void MarkStrategySet() { strategy_set_ = true; }
 
   static constexpr char kSkSLSubdirName[] = "sksl";
+  static constexpr char kTextSubdirName[] = "text";
+  static constexpr char kGlyphProfileSubdirName[] = "glyphs";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
 
  private:
@@ -109,6 +148,13 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  // Only set if |gUsePackedStore| was true when the cache was created.
+  const std::shared_ptr<PackedCacheStore> packed_store_;
+  const std::shared_ptr<PackedCacheStore> sksl_packed_store_;
+  // Only set if |gCacheText| was true when the cache was created.
+  const std::shared_ptr<PackedCacheStore> text_store_;
+  // Only set if |gCacheGlyphProfile| was true when the cache was created.
+  const std::shared_ptr<PackedCacheStore> glyph_profile_store_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
 
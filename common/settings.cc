@@ -42,6 +42,10 @@ std::string Settings::ToString() const {
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
   stream << "purge_persistent_cache: " << purge_persistent_cache << std::endl;
+  stream << "packed_persistent_cache: " << packed_persistent_cache
+         << std::endl;
+  stream << "persistent_text_cache: " << persistent_text_cache << std::endl;
+  stream << "glyph_cache_profile: " << glyph_cache_profile << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
   stream << "disable_dart_asserts: " << disable_dart_asserts << std::endl;
@@ -62,6 +66,18 @@ std::string Settings::ToString() const {
   stream << "frame_rasterized_callback set: " << !!frame_rasterized_callback
          << std::endl;
   stream << "old_gen_heap_size: " << old_gen_heap_size << std::endl;
+  stream << "raster_cache_max_size_mb: " << raster_cache_max_size_mb
+         << std::endl;
+  stream << "raster_cache_eviction_grace_frames: "
+         << raster_cache_eviction_grace_frames << std::endl;
+  stream << "enable_concurrent_layer_painting: "
+         << enable_concurrent_layer_painting << std::endl;
+  stream << "enable_async_raster_cache: " << enable_async_raster_cache
+         << std::endl;
+  stream << "animated_image_look_ahead_frames: "
+         << animated_image_look_ahead_frames << std::endl;
+  stream << "animated_image_max_resident_size_mb: "
+         << animated_image_max_resident_size_mb << std::endl;
   return stream.str();
 }
 
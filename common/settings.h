@@ -110,6 +110,15 @@ struct Settings {
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
   bool purge_persistent_cache = false;
+  // Store the persistent cache in a single packed and indexed file per cache
+  // directory instead of one file per entry.
+  bool packed_persistent_cache = false;
+  // Keep the results of text shaping and font fallback in the persistent
+  // cache so that later runs of the app can reuse them.
+  bool persistent_text_cache = false;
+  // Record the glyphs drawn by text into a profile in the persistent cache,
+  // and rasterize the glyphs of the profile in the background at startup.
+  bool glyph_cache_profile = false;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool disable_dart_asserts = false;
@@ -158,6 +167,10 @@ struct Settings {
   // Selects the SkParagraph implementation of the text layout engine.
   bool enable_skparagraph = false;
 
+  // Records pictures into display lists owned by the engine instead of
+  // |SkPicture|s.
+  bool enable_display_list = false;
+
   // All shells in the process share the same VM. The last shell to shutdown
   // should typically shut down the VM as well. However, applications depend on
   // the behavior of "warming-up" the VM by creating a shell that does not do
@@ -246,6 +259,33 @@ struct Settings {
   /// https://github.com/dart-lang/sdk/blob/ca64509108b3e7219c50d6c52877c85ab6a35ff2/runtime/vm/flag_list.h#L150
   int64_t old_gen_heap_size = -1;
 
+  /// Max size of the images held by the raster cache in MB, or 0 to bound the
+  /// raster cache only by the entries used each frame.
+  size_t raster_cache_max_size_mb = 0;
+
+  /// The number of consecutive frames an unused raster cache entry is kept
+  /// before it is evicted.
+  size_t raster_cache_eviction_grace_frames = 0;
+
+  /// Whether independent layer subtrees are recorded concurrently on a
+  /// dedicated pool of worker threads during Paint instead of serially on the
+  /// raster thread.
+  bool enable_concurrent_layer_painting = false;
+
+  /// Whether pictures that become eligible for the raster cache are
+  /// rasterized on the engine's worker threads instead of during the frame in
+  /// which they become eligible.
+  bool enable_async_raster_cache = false;
+
+  /// The number of frames of animated images decoded ahead of time on the
+  /// engine's worker threads, or 0 to decode each frame when it is requested.
+  size_t animated_image_look_ahead_frames = 0;
+
+  /// Max size in MB of all the frames of an animated image for them to be
+  /// kept after the animation first plays through, or 0 to decode the frames
+  /// again on every loop.
+  size_t animated_image_max_resident_size_mb = 0;
+
   /// A timestamp representing when the engine started. The value is based
   /// on the clock used by the Dart timeline APIs. This timestamp is used
   /// to log a timeline event that tracks the latency of engine startup.
@@ -14,6 +14,15 @@ CompositorContext::CompositorContext(fml::Milliseconds frame_budget)
 
 CompositorContext::~CompositorContext() = default;
 
+void CompositorContext::EnableConcurrentPaint(size_t worker_count) {
+  if (worker_count == 0) {
+    return;
+  }
+  concurrent_paint_loop_ = fml::ConcurrentMessageLoop::Create(worker_count);
+  concurrent_paint_task_runner_ = concurrent_paint_loop_->GetTaskRunner();
+  concurrent_paint_worker_count_ = concurrent_paint_loop_->GetWorkerCount();
+}
+
 void CompositorContext::BeginFrame(ScopedFrame& frame,
                                    bool enable_instrumentation) {
   if (enable_instrumentation) {
@@ -12,6 +12,7 @@
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -114,6 +115,21 @@ class CompositorContext {
 
   RasterCache& raster_cache() { return raster_cache_; }
 
+  // Starts a worker pool of |worker_count| threads on which independent layer
+  // subtrees are recorded concurrently during Paint. The pool is not shared
+  // with other engine work, so the raster thread never waits behind image
+  // decodes for it. Without a pool, which is the default, all layers are
+  // painted on the raster thread.
+  void EnableConcurrentPaint(size_t worker_count);
+
+  fml::ConcurrentTaskRunner* concurrent_paint_task_runner() const {
+    return concurrent_paint_task_runner_.get();
+  }
+
+  size_t concurrent_paint_worker_count() const {
+    return concurrent_paint_worker_count_;
+  }
+
   TextureRegistry& texture_registry() { return texture_registry_; }
 
   const Counter& frame_count() const { return frame_count_; }
@@ -124,6 +140,9 @@ class CompositorContext {
 
  private:
   RasterCache raster_cache_;
+  std::shared_ptr<fml::ConcurrentMessageLoop> concurrent_paint_loop_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_paint_task_runner_;
+  size_t concurrent_paint_worker_count_ = 0;
   TextureRegistry texture_registry_;
   Counter frame_count_;
   Stopwatch raster_time_;
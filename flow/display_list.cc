@@ -0,0 +1,1320 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+
+namespace flutter {
+
+namespace {
+
+// The ops are stored back to back, each one followed by the arrays it
+// references. The buffer is grown with realloc, so ops may only hold members
+// that can be moved in memory without running their constructors: plain
+// values and Skia's reference counted pointers, paints and paths.
+constexpr size_t kOpAlignment = 8;
+
+constexpr size_t AlignOpSize(size_t size) {
+  return (size + kOpAlignment - 1) & ~(kOpAlignment - 1);
+}
+
+struct DLOp {
+  DisplayListOpType type;
+  uint32_t size;
+};
+
+// The state shared by the ops of one |DisplayList::RenderTo|.
+struct DispatchContext {
+  // The matrix |SetMatrixOp| is relative to.
+  SkM44 initial_matrix;
+};
+
+// A nested display list, which unlike the other referenced objects is
+// compared by content.
+struct NestedDisplayList {
+  sk_sp<DisplayList> display_list;
+
+  bool operator==(const NestedDisplayList& other) const {
+    return display_list == other.display_list ||
+           display_list->Equals(*other.display_list);
+  }
+};
+
+// Combines the values of an op into a 64-bit FNV-1a hash.
+class Hasher {
+ public:
+  uint64_t value() const { return hash_; }
+
+  void Add(uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      hash_ = (hash_ ^ ((value >> (i * 8)) & 0xff)) * 1099511628211u;
+    }
+  }
+
+  void AddBytes(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211u;
+    }
+  }
+
+  template <typename T>
+  std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>> Hash(T value) {
+    Add(static_cast<uint64_t>(value));
+  }
+
+  void Hash(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Add(bits);
+  }
+
+  void Hash(const SkPoint& point) {
+    Hash(point.fX);
+    Hash(point.fY);
+  }
+
+  void Hash(const SkRect& rect) {
+    Hash(rect.fLeft);
+    Hash(rect.fTop);
+    Hash(rect.fRight);
+    Hash(rect.fBottom);
+  }
+
+  void Hash(const SkIRect& rect) {
+    Hash(rect.fLeft);
+    Hash(rect.fTop);
+    Hash(rect.fRight);
+    Hash(rect.fBottom);
+  }
+
+  void Hash(const SkRRect& rrect) {
+    Hash(rrect.rect());
+    for (int corner = 0; corner < 4; corner++) {
+      Hash(rrect.radii(static_cast<SkRRect::Corner>(corner)));
+    }
+  }
+
+  void Hash(const SkM44& matrix) {
+    SkScalar values[16];
+    matrix.getColMajor(values);
+    for (SkScalar value : values) {
+      Hash(value);
+    }
+  }
+
+  void Hash(const SkMatrix& matrix) {
+    SkScalar values[9];
+    matrix.get9(values);
+    for (SkScalar value : values) {
+      Hash(value);
+    }
+  }
+
+  // Paths and regions are compared in full by |Equals|; their bounds and
+  // sizes are enough to tell most of the differing ones apart.
+  void Hash(const SkPath& path) {
+    Hash(path.getBounds());
+    Hash(path.countPoints());
+    Hash(path.countVerbs());
+    Hash(path.getFillType());
+  }
+
+  void Hash(const SkRegion& region) { Hash(region.getBounds()); }
+
+  // Hashes every field SkPaint::operator== compares.
+  void Hash(const SkPaint& paint) {
+    const SkColor4f color = paint.getColor4f();
+    Hash(color.fR);
+    Hash(color.fG);
+    Hash(color.fB);
+    Hash(color.fA);
+    Hash(paint.getBlendMode());
+    Hash(paint.isAntiAlias());
+    Hash(paint.isDither());
+    Hash(paint.getStyle());
+    Hash(paint.getStrokeWidth());
+    Hash(paint.getStrokeMiter());
+    Hash(paint.getStrokeCap());
+    Hash(paint.getStrokeJoin());
+    Hash(paint.getShader());
+    Hash(paint.getColorFilter());
+    Hash(paint.getImageFilter());
+    Hash(paint.getMaskFilter());
+    Hash(paint.getPathEffect());
+  }
+
+  void Hash(const SkSamplingOptions& sampling) {
+    Hash(sampling.useCubic);
+    Hash(sampling.cubic.B);
+    Hash(sampling.cubic.C);
+    Hash(sampling.filter);
+    Hash(sampling.mipmap);
+  }
+
+  void Hash(const NestedDisplayList& nested) {
+    Add(nested.display_list->content_hash());
+  }
+
+  template <typename T>
+  void Hash(const T* pointer) {
+    Add(reinterpret_cast<uintptr_t>(pointer));
+  }
+
+  template <typename T>
+  void Hash(const sk_sp<T>& pointer) {
+    Hash(pointer.get());
+  }
+
+  template <typename... Fields>
+  void Hash(const std::tuple<Fields...>& fields) {
+    std::apply([&](const auto&... field) { (Hash(field), ...); }, fields);
+  }
+
+ private:
+  uint64_t hash_ = 14695981039346656037u;
+};
+
+// Each op provides its |kType|, the |Fields| that take part in equality and
+// hashing, and |Dispatch| to play it back. Arrays stored after an op are
+// compared and hashed as raw bytes.
+
+struct SaveOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kSave;
+
+  auto Fields() const { return std::tie(); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->save();
+  }
+};
+
+struct SaveLayerOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kSaveLayer;
+
+  SaveLayerOp(const SkRect* bounds,
+              const SkPaint* paint,
+              const SkImageFilter* backdrop,
+              SkCanvas::SaveLayerFlags flags)
+      : has_bounds(bounds != nullptr),
+        bounds(bounds ? *bounds : SkRect::MakeEmpty()),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()),
+        backdrop(sk_ref_sp(backdrop)),
+        flags(flags) {}
+
+  const bool has_bounds;
+  const SkRect bounds;
+  const bool has_paint;
+  const SkPaint paint;
+  const sk_sp<SkImageFilter> backdrop;
+  const SkCanvas::SaveLayerFlags flags;
+
+  auto Fields() const {
+    return std::tie(has_bounds, bounds, has_paint, paint, backdrop, flags);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->saveLayer(SkCanvas::SaveLayerRec(has_bounds ? &bounds : nullptr,
+                                             has_paint ? &paint : nullptr,
+                                             backdrop.get(), flags));
+  }
+};
+
+struct RestoreOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kRestore;
+
+  auto Fields() const { return std::tie(); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->restore();
+  }
+};
+
+struct TranslateOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kTranslate;
+
+  TranslateOp(SkScalar tx, SkScalar ty) : tx(tx), ty(ty) {}
+
+  const SkScalar tx;
+  const SkScalar ty;
+
+  auto Fields() const { return std::tie(tx, ty); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->translate(tx, ty);
+  }
+};
+
+struct ScaleOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kScale;
+
+  ScaleOp(SkScalar sx, SkScalar sy) : sx(sx), sy(sy) {}
+
+  const SkScalar sx;
+  const SkScalar sy;
+
+  auto Fields() const { return std::tie(sx, sy); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->scale(sx, sy);
+  }
+};
+
+struct ConcatOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kConcat;
+
+  explicit ConcatOp(const SkM44& matrix) : matrix(matrix) {}
+
+  const SkM44 matrix;
+
+  auto Fields() const { return std::tie(matrix); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->concat(matrix);
+  }
+};
+
+struct SetMatrixOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kSetMatrix;
+
+  explicit SetMatrixOp(const SkM44& matrix) : matrix(matrix) {}
+
+  const SkM44 matrix;
+
+  auto Fields() const { return std::tie(matrix); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext& context) const {
+    canvas->setMatrix(SkM44(context.initial_matrix, matrix));
+  }
+};
+
+struct ClipRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kClipRect;
+
+  ClipRectOp(const SkRect& rect, SkClipOp clip_op, bool is_aa)
+      : rect(rect), clip_op(clip_op), is_aa(is_aa) {}
+
+  const SkRect rect;
+  const SkClipOp clip_op;
+  const bool is_aa;
+
+  auto Fields() const { return std::tie(rect, clip_op, is_aa); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->clipRect(rect, clip_op, is_aa);
+  }
+};
+
+struct ClipRRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kClipRRect;
+
+  ClipRRectOp(const SkRRect& rrect, SkClipOp clip_op, bool is_aa)
+      : rrect(rrect), clip_op(clip_op), is_aa(is_aa) {}
+
+  const SkRRect rrect;
+  const SkClipOp clip_op;
+  const bool is_aa;
+
+  auto Fields() const { return std::tie(rrect, clip_op, is_aa); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->clipRRect(rrect, clip_op, is_aa);
+  }
+};
+
+struct ClipPathOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kClipPath;
+
+  ClipPathOp(const SkPath& path, SkClipOp clip_op, bool is_aa)
+      : path(path), clip_op(clip_op), is_aa(is_aa) {}
+
+  const SkPath path;
+  const SkClipOp clip_op;
+  const bool is_aa;
+
+  auto Fields() const { return std::tie(path, clip_op, is_aa); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->clipPath(path, clip_op, is_aa);
+  }
+};
+
+struct DrawPaintOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPaint;
+
+  explicit DrawPaintOp(const SkPaint& paint) : paint(paint) {}
+
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawPaint(paint);
+  }
+};
+
+struct DrawRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawRect;
+
+  DrawRectOp(const SkRect& rect, const SkPaint& paint)
+      : rect(rect), paint(paint) {}
+
+  const SkRect rect;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(rect, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawRect(rect, paint);
+  }
+};
+
+struct DrawOvalOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawOval;
+
+  DrawOvalOp(const SkRect& bounds, const SkPaint& paint)
+      : bounds(bounds), paint(paint) {}
+
+  const SkRect bounds;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(bounds, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawOval(bounds, paint);
+  }
+};
+
+struct DrawRRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawRRect;
+
+  DrawRRectOp(const SkRRect& rrect, const SkPaint& paint)
+      : rrect(rrect), paint(paint) {}
+
+  const SkRRect rrect;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(rrect, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawRRect(rrect, paint);
+  }
+};
+
+struct DrawDRRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawDRRect;
+
+  DrawDRRectOp(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint)
+      : outer(outer), inner(inner), paint(paint) {}
+
+  const SkRRect outer;
+  const SkRRect inner;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(outer, inner, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawDRRect(outer, inner, paint);
+  }
+};
+
+struct DrawArcOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawArc;
+
+  DrawArcOp(const SkRect& bounds,
+            SkScalar start,
+            SkScalar sweep,
+            bool use_center,
+            const SkPaint& paint)
+      : bounds(bounds),
+        start(start),
+        sweep(sweep),
+        use_center(use_center),
+        paint(paint) {}
+
+  const SkRect bounds;
+  const SkScalar start;
+  const SkScalar sweep;
+  const bool use_center;
+  const SkPaint paint;
+
+  auto Fields() const {
+    return std::tie(bounds, start, sweep, use_center, paint);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawArc(bounds, start, sweep, use_center, paint);
+  }
+};
+
+struct DrawPathOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPath;
+
+  DrawPathOp(const SkPath& path, const SkPaint& paint)
+      : path(path), paint(paint) {}
+
+  const SkPath path;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(path, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawPath(path, paint);
+  }
+};
+
+struct DrawRegionOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawRegion;
+
+  DrawRegionOp(const SkRegion& region, const SkPaint& paint)
+      : region(region), paint(paint) {}
+
+  const SkRegion region;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(region, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawRegion(region, paint);
+  }
+};
+
+// Followed by |count| SkPoints.
+struct DrawPointsOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPoints;
+
+  DrawPointsOp(SkCanvas::PointMode mode, uint32_t count, const SkPaint& paint)
+      : mode(mode), count(count), paint(paint) {}
+
+  const SkCanvas::PointMode mode;
+  const uint32_t count;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(mode, count, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    const SkPoint* points = reinterpret_cast<const SkPoint*>(this + 1);
+    canvas->drawPoints(mode, count, points, paint);
+  }
+};
+
+struct DrawVerticesOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawVertices;
+
+  DrawVerticesOp(sk_sp<SkVertices> vertices,
+                 SkBlendMode mode,
+                 const SkPaint& paint)
+      : vertices(std::move(vertices)), mode(mode), paint(paint) {}
+
+  const sk_sp<SkVertices> vertices;
+  const SkBlendMode mode;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(vertices, mode, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawVertices(vertices, mode, paint);
+  }
+};
+
+struct DrawImageOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImage;
+
+  DrawImageOp(sk_sp<SkImage> image,
+              const SkPoint& point,
+              const SkSamplingOptions& sampling,
+              const SkPaint* paint)
+      : image(std::move(image)),
+        point(point),
+        sampling(sampling),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()) {}
+
+  const sk_sp<SkImage> image;
+  const SkPoint point;
+  const SkSamplingOptions sampling;
+  const bool has_paint;
+  const SkPaint paint;
+
+  auto Fields() const {
+    return std::tie(image, point, sampling, has_paint, paint);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawImage(image.get(), point.fX, point.fY, sampling,
+                      has_paint ? &paint : nullptr);
+  }
+};
+
+struct DrawImageRectOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImageRect;
+
+  DrawImageRectOp(sk_sp<SkImage> image,
+                  const SkRect& src,
+                  const SkRect& dst,
+                  const SkSamplingOptions& sampling,
+                  const SkPaint* paint,
+                  SkCanvas::SrcRectConstraint constraint)
+      : image(std::move(image)),
+        src(src),
+        dst(dst),
+        sampling(sampling),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()),
+        constraint(constraint) {}
+
+  const sk_sp<SkImage> image;
+  const SkRect src;
+  const SkRect dst;
+  const SkSamplingOptions sampling;
+  const bool has_paint;
+  const SkPaint paint;
+  const SkCanvas::SrcRectConstraint constraint;
+
+  auto Fields() const {
+    return std::tie(image, src, dst, sampling, has_paint, paint, constraint);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawImageRect(image.get(), src, dst, sampling,
+                          has_paint ? &paint : nullptr, constraint);
+  }
+};
+
+// Followed by |x_count| x divs, |y_count| y divs, |cell_count| colors if
+// |has_colors| and |cell_count| rect types if |has_rect_types|.
+struct DrawImageLatticeOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImageLattice;
+
+  DrawImageLatticeOp(sk_sp<SkImage> image,
+                     const SkCanvas::Lattice& lattice,
+                     const SkRect& dst,
+                     SkFilterMode filter,
+                     const SkPaint* paint)
+      : image(std::move(image)),
+        x_count(lattice.fXCount),
+        y_count(lattice.fYCount),
+        cell_count(lattice.fRectTypes || lattice.fColors
+                       ? (lattice.fXCount + 1) * (lattice.fYCount + 1)
+                       : 0),
+        has_rect_types(lattice.fRectTypes != nullptr),
+        has_colors(lattice.fColors != nullptr),
+        has_bounds(lattice.fBounds != nullptr),
+        bounds(lattice.fBounds ? *lattice.fBounds : SkIRect::MakeEmpty()),
+        dst(dst),
+        filter(filter),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()) {}
+
+  const sk_sp<SkImage> image;
+  const int x_count;
+  const int y_count;
+  const int cell_count;
+  const bool has_rect_types;
+  const bool has_colors;
+  const bool has_bounds;
+  const SkIRect bounds;
+  const SkRect dst;
+  const SkFilterMode filter;
+  const bool has_paint;
+  const SkPaint paint;
+
+  auto Fields() const {
+    return std::tie(image, x_count, y_count, cell_count, has_rect_types,
+                    has_colors, has_bounds, bounds, dst, filter, has_paint,
+                    paint);
+  }
+
+  static size_t ArrayBytes(const SkCanvas::Lattice& lattice) {
+    const size_t cells = (lattice.fXCount + 1) * (lattice.fYCount + 1);
+    return (lattice.fXCount + lattice.fYCount) * sizeof(int) +
+           (lattice.fColors ? cells * sizeof(SkColor) : 0) +
+           (lattice.fRectTypes ? cells * sizeof(SkCanvas::Lattice::RectType)
+                               : 0);
+  }
+
+  static void CopyArrays(const SkCanvas::Lattice& lattice, void* storage) {
+    const int cells = (lattice.fXCount + 1) * (lattice.fYCount + 1);
+    uint8_t* bytes = static_cast<uint8_t*>(storage);
+    bytes = Copy(bytes, lattice.fXDivs, lattice.fXCount);
+    bytes = Copy(bytes, lattice.fYDivs, lattice.fYCount);
+    if (lattice.fColors) {
+      bytes = Copy(bytes, lattice.fColors, cells);
+    }
+    if (lattice.fRectTypes) {
+      Copy(bytes, lattice.fRectTypes, cells);
+    }
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    const int* x_divs = reinterpret_cast<const int*>(this + 1);
+    const int* y_divs = x_divs + x_count;
+    const SkColor* colors = reinterpret_cast<const SkColor*>(y_divs + y_count);
+    const SkCanvas::Lattice::RectType* rect_types =
+        reinterpret_cast<const SkCanvas::Lattice::RectType*>(
+            colors + (has_colors ? cell_count : 0));
+
+    SkCanvas::Lattice lattice;
+    lattice.fXDivs = x_divs;
+    lattice.fYDivs = y_divs;
+    lattice.fRectTypes = has_rect_types ? rect_types : nullptr;
+    lattice.fXCount = x_count;
+    lattice.fYCount = y_count;
+    lattice.fBounds = has_bounds ? &bounds : nullptr;
+    lattice.fColors = has_colors ? colors : nullptr;
+    canvas->drawImageLattice(image.get(), lattice, dst, filter,
+                             has_paint ? &paint : nullptr);
+  }
+
+ private:
+  template <typename T>
+  static uint8_t* Copy(uint8_t* destination, const T* source, int count) {
+    std::memcpy(destination, source, count * sizeof(T));
+    return destination + count * sizeof(T);
+  }
+};
+
+// Followed by |count| SkRSXforms, |count| SkRects and |count| SkColors if
+// |has_colors|.
+struct DrawAtlasOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawAtlas;
+
+  DrawAtlasOp(sk_sp<SkImage> atlas,
+              int count,
+              bool has_colors,
+              SkBlendMode mode,
+              const SkSamplingOptions& sampling,
+              const SkRect* cull_rect,
+              const SkPaint* paint)
+      : atlas(std::move(atlas)),
+        count(count),
+        has_colors(has_colors),
+        mode(mode),
+        sampling(sampling),
+        has_cull_rect(cull_rect != nullptr),
+        cull_rect(cull_rect ? *cull_rect : SkRect::MakeEmpty()),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()) {}
+
+  const sk_sp<SkImage> atlas;
+  const int count;
+  const bool has_colors;
+  const SkBlendMode mode;
+  const SkSamplingOptions sampling;
+  const bool has_cull_rect;
+  const SkRect cull_rect;
+  const bool has_paint;
+  const SkPaint paint;
+
+  auto Fields() const {
+    return std::tie(atlas, count, has_colors, mode, sampling, has_cull_rect,
+                    cull_rect, has_paint, paint);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    const SkRSXform* xforms = reinterpret_cast<const SkRSXform*>(this + 1);
+    const SkRect* tex = reinterpret_cast<const SkRect*>(xforms + count);
+    const SkColor* colors = reinterpret_cast<const SkColor*>(tex + count);
+    canvas->drawAtlas(atlas.get(), xforms, tex, has_colors ? colors : nullptr,
+                      count, mode, sampling,
+                      has_cull_rect ? &cull_rect : nullptr,
+                      has_paint ? &paint : nullptr);
+  }
+};
+
+struct DrawPictureOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPicture;
+
+  DrawPictureOp(sk_sp<SkPicture> picture,
+                const SkMatrix* matrix,
+                const SkPaint* paint)
+      : picture(std::move(picture)),
+        has_matrix(matrix != nullptr),
+        matrix(matrix ? *matrix : SkMatrix::I()),
+        has_paint(paint != nullptr),
+        paint(paint ? *paint : SkPaint()) {}
+
+  const sk_sp<SkPicture> picture;
+  const bool has_matrix;
+  const SkMatrix matrix;
+  const bool has_paint;
+  const SkPaint paint;
+
+  auto Fields() const {
+    return std::tie(picture, has_matrix, matrix, has_paint, paint);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawPicture(picture, has_matrix ? &matrix : nullptr,
+                        has_paint ? &paint : nullptr);
+  }
+};
+
+struct DrawDisplayListOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawDisplayList;
+
+  explicit DrawDisplayListOp(sk_sp<DisplayList> display_list)
+      : nested{std::move(display_list)} {}
+
+  const NestedDisplayList nested;
+
+  auto Fields() const { return std::tie(nested); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    nested.display_list->RenderTo(canvas);
+  }
+};
+
+struct DrawTextBlobOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawTextBlob;
+
+  DrawTextBlobOp(sk_sp<SkTextBlob> blob,
+                 SkScalar x,
+                 SkScalar y,
+                 const SkPaint& paint)
+      : blob(std::move(blob)), x(x), y(y), paint(paint) {}
+
+  const sk_sp<SkTextBlob> blob;
+  const SkScalar x;
+  const SkScalar y;
+  const SkPaint paint;
+
+  auto Fields() const { return std::tie(blob, x, y, paint); }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    canvas->drawTextBlob(blob, x, y, paint);
+  }
+};
+
+struct DrawShadowOp final : DLOp {
+  static constexpr auto kType = DisplayListOpType::kDrawShadow;
+
+  DrawShadowOp(const SkPath& path,
+               SkColor color,
+               SkScalar elevation,
+               bool transparent_occluder,
+               SkScalar dpr)
+      : path(path),
+        color(color),
+        elevation(elevation),
+        transparent_occluder(transparent_occluder),
+        dpr(dpr) {}
+
+  const SkPath path;
+  const SkColor color;
+  const SkScalar elevation;
+  const bool transparent_occluder;
+  const SkScalar dpr;
+
+  auto Fields() const {
+    return std::tie(path, color, elevation, transparent_occluder, dpr);
+  }
+
+  void Dispatch(SkCanvas* canvas, const DispatchContext&) const {
+    PhysicalShapeLayer::DrawShadow(canvas, path, color, elevation,
+                                   transparent_occluder, dpr);
+  }
+};
+
+void DisposeOps(uint8_t* storage, size_t byte_count) {
+  uint8_t* end = storage + byte_count;
+  for (uint8_t* ptr = storage; ptr < end;) {
+    DLOp* op = reinterpret_cast<DLOp*>(ptr);
+    ptr += op->size;
+    switch (op->type) {
+#define DL_OP_DISPOSE(name)                  \
+  case DisplayListOpType::k##name:           \
+    static_cast<name##Op*>(op)->~name##Op(); \
+    break;
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_DISPOSE)
+#undef DL_OP_DISPOSE
+    }
+  }
+}
+
+template <typename T>
+bool OpEquals(const T* a, const T* b) {
+  if (a->size != b->size || a->Fields() != b->Fields()) {
+    return false;
+  }
+  return std::memcmp(a + 1, b + 1, a->size - sizeof(T)) == 0;
+}
+
+template <typename T>
+void HashOp(Hasher& hasher, const T* op) {
+  hasher.Hash(op->type);
+  hasher.Hash(op->Fields());
+  hasher.AddBytes(op + 1, op->size - sizeof(T));
+}
+
+uint64_t HashOps(const uint8_t* storage, size_t byte_count) {
+  Hasher hasher;
+  const uint8_t* end = storage + byte_count;
+  for (const uint8_t* ptr = storage; ptr < end;) {
+    const DLOp* op = reinterpret_cast<const DLOp*>(ptr);
+    ptr += op->size;
+    switch (op->type) {
+#define DL_OP_HASH(name)                              \
+  case DisplayListOpType::k##name:                    \
+    HashOp(hasher, static_cast<const name##Op*>(op)); \
+    break;
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_HASH)
+#undef DL_OP_HASH
+    }
+  }
+  return hasher.value();
+}
+
+uint32_t NextUniqueID() {
+  static std::atomic<uint32_t> next_id{1};
+  uint32_t id;
+  do {
+    id = next_id.fetch_add(1, std::memory_order_relaxed);
+  } while (id == 0);
+  return id;
+}
+
+}  // namespace
+
+DisplayList::DisplayList(uint8_t* storage,
+                         size_t byte_count,
+                         int op_count,
+                         const SkRect& cull_rect,
+                         const SkRect& bounds)
+    : storage_(storage),
+      byte_count_(byte_count),
+      op_count_(op_count),
+      cull_rect_(cull_rect),
+      bounds_(bounds),
+      unique_id_(NextUniqueID()) {
+  content_hash_ = HashOps(storage_, byte_count_);
+}
+
+DisplayList::~DisplayList() {
+  DisposeOps(storage_, byte_count_);
+  std::free(storage_);
+}
+
+void DisplayList::RenderTo(SkCanvas* canvas) const {
+  SkAutoCanvasRestore save(canvas, true);
+  DispatchContext context = {canvas->getLocalToDevice()};
+  const uint8_t* end = storage_ + byte_count_;
+  for (const uint8_t* ptr = storage_; ptr < end;) {
+    const DLOp* op = reinterpret_cast<const DLOp*>(ptr);
+    ptr += op->size;
+    switch (op->type) {
+#define DL_OP_DISPATCH(name)                                     \
+  case DisplayListOpType::k##name:                               \
+    static_cast<const name##Op*>(op)->Dispatch(canvas, context); \
+    break;
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_DISPATCH)
+#undef DL_OP_DISPATCH
+    }
+  }
+}
+
+sk_sp<SkPicture> DisplayList::ToSkPicture() const {
+  SkPictureRecorder recorder;
+  RenderTo(recorder.beginRecording(cull_rect_));
+  return recorder.finishRecordingAsPicture();
+}
+
+bool DisplayList::Equals(const DisplayList& other) const {
+  if (this == &other) {
+    return true;
+  }
+  if (op_count_ != other.op_count_ || byte_count_ != other.byte_count_ ||
+      content_hash_ != other.content_hash_ || bounds_ != other.bounds_) {
+    return false;
+  }
+  const uint8_t* end = storage_ + byte_count_;
+  const uint8_t* other_ptr = other.storage_;
+  for (const uint8_t* ptr = storage_; ptr < end;) {
+    const DLOp* op = reinterpret_cast<const DLOp*>(ptr);
+    const DLOp* other_op = reinterpret_cast<const DLOp*>(other_ptr);
+    if (op->type != other_op->type) {
+      return false;
+    }
+    switch (op->type) {
+#define DL_OP_EQUALS(name)                                   \
+  case DisplayListOpType::k##name:                           \
+    if (!OpEquals(static_cast<const name##Op*>(op),          \
+                  static_cast<const name##Op*>(other_op))) { \
+      return false;                                          \
+    }                                                        \
+    break;
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_EQUALS)
+#undef DL_OP_EQUALS
+    }
+    ptr += op->size;
+    other_ptr += other_op->size;
+  }
+  return true;
+}
+
+DisplayListBuilder::DisplayListBuilder(const SkRect& cull_rect)
+    : cull_rect_(cull_rect) {
+  layer_stack_.push_back({SkM44(), cull_rect});
+}
+
+DisplayListBuilder::~DisplayListBuilder() {
+  if (storage_) {
+    DisposeOps(storage_, used_);
+    std::free(storage_);
+  }
+}
+
+template <typename T, typename... Args>
+void* DisplayListBuilder::Push(size_t extra_bytes, Args&&... args) {
+  static_assert(alignof(T) <= kOpAlignment);
+  const size_t size = AlignOpSize(sizeof(T) + extra_bytes);
+  FML_DCHECK(size < (1u << 24));
+  if (used_ + size > allocated_) {
+    allocated_ = std::max(used_ + size, allocated_ * 2);
+    allocated_ = std::max<size_t>(allocated_, 4096);
+    storage_ = static_cast<uint8_t*>(std::realloc(storage_, allocated_));
+    FML_CHECK(storage_);
+  }
+  uint8_t* ptr = storage_ + used_;
+  // Zeroing the block keeps the padding after the arrays of an op stable for
+  // comparisons and hashing.
+  std::memset(ptr, 0, size);
+  T* op = new (ptr) T{std::forward<Args>(args)...};
+  op->type = T::kType;
+  op->size = static_cast<uint32_t>(size);
+  used_ += size;
+  op_count_++;
+  return op + 1;
+}
+
+void DisplayListBuilder::save() {
+  Push<SaveOp>(0);
+  layer_stack_.push_back(current());
+  current().is_unbounded_layer = false;
+}
+
+void DisplayListBuilder::saveLayer(const SkRect* bounds,
+                                   const SkPaint* paint,
+                                   const SkImageFilter* backdrop,
+                                   SkCanvas::SaveLayerFlags flags) {
+  Push<SaveLayerOp>(0, bounds, paint, backdrop, flags);
+  layer_stack_.push_back(current());
+  // Filters may draw outside of what is drawn into the layer, so their
+  // layers are accounted for as filling their clip when restored.
+  current().is_unbounded_layer =
+      backdrop != nullptr ||
+      (paint && (paint->getImageFilter() || paint->getColorFilter()));
+  if (backdrop) {
+    AccumulateUnbounded();
+  }
+}
+
+void DisplayListBuilder::restore() {
+  if (layer_stack_.size() <= 1) {
+    return;
+  }
+  Push<RestoreOp>(0);
+  const bool was_unbounded_layer = current().is_unbounded_layer;
+  layer_stack_.pop_back();
+  if (was_unbounded_layer) {
+    AccumulateUnbounded();
+  }
+}
+
+void DisplayListBuilder::translate(SkScalar tx, SkScalar ty) {
+  Push<TranslateOp>(0, tx, ty);
+  current().matrix.preTranslate(tx, ty);
+}
+
+void DisplayListBuilder::scale(SkScalar sx, SkScalar sy) {
+  Push<ScaleOp>(0, sx, sy);
+  current().matrix.preScale(sx, sy);
+}
+
+void DisplayListBuilder::concat(const SkM44& matrix) {
+  Push<ConcatOp>(0, matrix);
+  current().matrix.preConcat(matrix);
+}
+
+void DisplayListBuilder::setMatrix(const SkM44& matrix) {
+  Push<SetMatrixOp>(0, matrix);
+  current().matrix = matrix;
+}
+
+void DisplayListBuilder::IntersectClip(const SkRect& local_bounds,
+                                       SkClipOp clip_op) {
+  if (clip_op != SkClipOp::kIntersect) {
+    return;
+  }
+  SkRect& clip_bounds = current().clip_bounds;
+  if (!clip_bounds.intersect(current().matrix.asM33().mapRect(local_bounds))) {
+    clip_bounds.setEmpty();
+  }
+}
+
+void DisplayListBuilder::clipRect(const SkRect& rect,
+                                  SkClipOp clip_op,
+                                  bool is_aa) {
+  Push<ClipRectOp>(0, rect, clip_op, is_aa);
+  IntersectClip(rect, clip_op);
+}
+
+void DisplayListBuilder::clipRRect(const SkRRect& rrect,
+                                   SkClipOp clip_op,
+                                   bool is_aa) {
+  Push<ClipRRectOp>(0, rrect, clip_op, is_aa);
+  IntersectClip(rrect.getBounds(), clip_op);
+}
+
+void DisplayListBuilder::clipPath(const SkPath& path,
+                                  SkClipOp clip_op,
+                                  bool is_aa) {
+  Push<ClipPathOp>(0, path, clip_op, is_aa);
+  if (!path.isInverseFillType()) {
+    IntersectClip(path.getBounds(), clip_op);
+  }
+}
+
+void DisplayListBuilder::drawPaint(const SkPaint& paint) {
+  Push<DrawPaintOp>(0, paint);
+  AccumulateUnbounded();
+}
+
+void DisplayListBuilder::drawRect(const SkRect& rect, const SkPaint& paint) {
+  Push<DrawRectOp>(0, rect, paint);
+  AccumulateBounds(rect.makeSorted(), &paint);
+}
+
+void DisplayListBuilder::drawOval(const SkRect& bounds, const SkPaint& paint) {
+  Push<DrawOvalOp>(0, bounds, paint);
+  AccumulateBounds(bounds.makeSorted(), &paint);
+}
+
+void DisplayListBuilder::drawRRect(const SkRRect& rrect,
+                                   const SkPaint& paint) {
+  Push<DrawRRectOp>(0, rrect, paint);
+  AccumulateBounds(rrect.getBounds(), &paint);
+}
+
+void DisplayListBuilder::drawDRRect(const SkRRect& outer,
+                                    const SkRRect& inner,
+                                    const SkPaint& paint) {
+  Push<DrawDRRectOp>(0, outer, inner, paint);
+  AccumulateBounds(outer.getBounds(), &paint);
+}
+
+void DisplayListBuilder::drawArc(const SkRect& bounds,
+                                 SkScalar start,
+                                 SkScalar sweep,
+                                 bool use_center,
+                                 const SkPaint& paint) {
+  Push<DrawArcOp>(0, bounds, start, sweep, use_center, paint);
+  AccumulateBounds(bounds.makeSorted(), &paint);
+}
+
+void DisplayListBuilder::drawPath(const SkPath& path, const SkPaint& paint) {
+  Push<DrawPathOp>(0, path, paint);
+  if (path.isInverseFillType()) {
+    AccumulateUnbounded();
+  } else {
+    AccumulateBounds(path.getBounds(), &paint);
+  }
+}
+
+void DisplayListBuilder::drawRegion(const SkRegion& region,
+                                    const SkPaint& paint) {
+  Push<DrawRegionOp>(0, region, paint);
+  AccumulateBounds(SkRect::Make(region.getBounds()), &paint);
+}
+
+void DisplayListBuilder::drawPoints(SkCanvas::PointMode mode,
+                                    size_t count,
+                                    const SkPoint points[],
+                                    const SkPaint& paint) {
+  if (count == 0) {
+    return;
+  }
+  void* data = Push<DrawPointsOp>(count * sizeof(SkPoint), mode,
+                                  static_cast<uint32_t>(count), paint);
+  std::memcpy(data, points, count * sizeof(SkPoint));
+
+  SkRect bounds;
+  bounds.setBounds(points, static_cast<int>(count));
+  if (!paint.canComputeFastBounds()) {
+    AccumulateUnbounded();
+    return;
+  }
+  // Points are always stroked, regardless of the style of the paint.
+  SkRect storage;
+  AccumulateBounds(paint.computeFastStrokeBounds(bounds, &storage), nullptr);
+}
+
+void DisplayListBuilder::drawVertices(sk_sp<SkVertices> vertices,
+                                      SkBlendMode mode,
+                                      const SkPaint& paint) {
+  const SkRect bounds = vertices->bounds();
+  Push<DrawVerticesOp>(0, std::move(vertices), mode, paint);
+  AccumulateBounds(bounds, &paint);
+}
+
+void DisplayListBuilder::drawImage(sk_sp<SkImage> image,
+                                   const SkPoint& point,
+                                   const SkSamplingOptions& sampling,
+                                   const SkPaint* paint) {
+  const SkRect bounds =
+      SkRect::MakeXYWH(point.fX, point.fY, image->width(), image->height());
+  Push<DrawImageOp>(0, std::move(image), point, sampling, paint);
+  AccumulateBounds(bounds, paint);
+}
+
+void DisplayListBuilder::drawImageRect(sk_sp<SkImage> image,
+                                       const SkRect& src,
+                                       const SkRect& dst,
+                                       const SkSamplingOptions& sampling,
+                                       const SkPaint* paint,
+                                       SkCanvas::SrcRectConstraint constraint) {
+  Push<DrawImageRectOp>(0, std::move(image), src, dst, sampling, paint,
+                        constraint);
+  AccumulateBounds(dst.makeSorted(), paint);
+}
+
+void DisplayListBuilder::drawImageLattice(sk_sp<SkImage> image,
+                                          const SkCanvas::Lattice& lattice,
+                                          const SkRect& dst,
+                                          SkFilterMode filter,
+                                          const SkPaint* paint) {
+  void* data = Push<DrawImageLatticeOp>(DrawImageLatticeOp::ArrayBytes(lattice),
+                                        std::move(image), lattice, dst, filter,
+                                        paint);
+  DrawImageLatticeOp::CopyArrays(lattice, data);
+  AccumulateBounds(dst.makeSorted(), paint);
+}
+
+void DisplayListBuilder::drawAtlas(sk_sp<SkImage> atlas,
+                                   const SkRSXform xform[],
+                                   const SkRect tex[],
+                                   const SkColor colors[],
+                                   int count,
+                                   SkBlendMode mode,
+                                   const SkSamplingOptions& sampling,
+                                   const SkRect* cull_rect,
+                                   const SkPaint* paint) {
+  if (count <= 0) {
+    return;
+  }
+  const size_t array_bytes =
+      count * (sizeof(SkRSXform) + sizeof(SkRect) +
+               (colors ? sizeof(SkColor) : 0));
+  uint8_t* data = static_cast<uint8_t*>(
+      Push<DrawAtlasOp>(array_bytes, std::move(atlas), count,
+                        colors != nullptr, mode, sampling, cull_rect, paint));
+  std::memcpy(data, xform, count * sizeof(SkRSXform));
+  data += count * sizeof(SkRSXform);
+  std::memcpy(data, tex, count * sizeof(SkRect));
+  data += count * sizeof(SkRect);
+  if (colors) {
+    std::memcpy(data, colors, count * sizeof(SkColor));
+  }
+
+  if (cull_rect) {
+    AccumulateBounds(*cull_rect, paint);
+    return;
+  }
+  SkRect bounds = SkRect::MakeEmpty();
+  for (int i = 0; i < count; i++) {
+    SkPoint quad[4];
+    xform[i].toQuad(tex[i].width(), tex[i].height(), quad);
+    SkRect quad_bounds;
+    quad_bounds.setBounds(quad, 4);
+    bounds.join(quad_bounds);
+  }
+  AccumulateBounds(bounds, paint);
+}
+
+void DisplayListBuilder::drawPicture(sk_sp<SkPicture> picture,
+                                     const SkMatrix* matrix,
+                                     const SkPaint* paint) {
+  SkRect bounds = picture->cullRect();
+  if (matrix) {
+    bounds = matrix->mapRect(bounds);
+  }
+  Push<DrawPictureOp>(0, std::move(picture), matrix, paint);
+  AccumulateBounds(bounds, paint);
+}
+
+void DisplayListBuilder::drawDisplayList(sk_sp<DisplayList> display_list) {
+  const SkRect bounds = display_list->bounds();
+  Push<DrawDisplayListOp>(0, std::move(display_list));
+  AccumulateBounds(bounds, nullptr);
+}
+
+void DisplayListBuilder::drawTextBlob(sk_sp<SkTextBlob> blob,
+                                      SkScalar x,
+                                      SkScalar y,
+                                      const SkPaint& paint) {
+  const SkRect bounds = blob->bounds().makeOffset(x, y);
+  Push<DrawTextBlobOp>(0, std::move(blob), x, y, paint);
+  AccumulateBounds(bounds, &paint);
+}
+
+void DisplayListBuilder::drawShadow(const SkPath& path,
+                                    SkColor color,
+                                    SkScalar elevation,
+                                    bool transparent_occluder,
+                                    SkScalar dpr) {
+  Push<DrawShadowOp>(0, path, color, elevation, transparent_occluder, dpr);
+  AccumulateBounds(PhysicalShapeLayer::ComputeShadowBounds(path.getBounds(),
+                                                           elevation, dpr),
+                   nullptr);
+}
+
+void DisplayListBuilder::AccumulateBounds(const SkRect& local_bounds,
+                                          const SkPaint* paint) {
+  SkRect bounds = local_bounds;
+  if (paint) {
+    if (!paint->canComputeFastBounds()) {
+      AccumulateUnbounded();
+      return;
+    }
+    SkRect storage;
+    bounds = paint->computeFastBounds(local_bounds, &storage);
+  }
+  bounds = current().matrix.asM33().mapRect(bounds);
+  if (bounds.intersect(current().clip_bounds)) {
+    bounds_.join(bounds);
+  }
+}
+
+void DisplayListBuilder::AccumulateUnbounded() {
+  bounds_.join(current().clip_bounds);
+}
+
+sk_sp<DisplayList> DisplayListBuilder::Build() {
+  while (layer_stack_.size() > 1) {
+    restore();
+  }
+  sk_sp<DisplayList> display_list(
+      new DisplayList(storage_, used_, op_count_, cull_rect_, bounds_));
+  storage_ = nullptr;
+  used_ = 0;
+  allocated_ = 0;
+  op_count_ = 0;
+  bounds_.setEmpty();
+  return display_list;
+}
+
+}  // namespace flutter
@@ -0,0 +1,266 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkM44.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/core/SkRegion.h"
+#include "third_party/skia/include/core/SkSamplingOptions.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+#include "third_party/skia/include/core/SkVertices.h"
+
+// The operations a |DisplayList| can hold. Each entry corresponds to a
+// |DisplayListBuilder| method of the same (lower camel case) name.
+#define FOR_EACH_DISPLAY_LIST_OP(V) \
+  V(Save)                           \
+  V(SaveLayer)                      \
+  V(Restore)                        \
+  V(Translate)                      \
+  V(Scale)                          \
+  V(Concat)                         \
+  V(SetMatrix)                      \
+  V(ClipRect)                       \
+  V(ClipRRect)                      \
+  V(ClipPath)                       \
+  V(DrawPaint)                      \
+  V(DrawRect)                       \
+  V(DrawOval)                       \
+  V(DrawRRect)                      \
+  V(DrawDRRect)                     \
+  V(DrawArc)                        \
+  V(DrawPath)                       \
+  V(DrawRegion)                     \
+  V(DrawPoints)                     \
+  V(DrawVertices)                   \
+  V(DrawImage)                      \
+  V(DrawImageRect)                  \
+  V(DrawImageLattice)               \
+  V(DrawAtlas)                      \
+  V(DrawPicture)                    \
+  V(DrawDisplayList)                \
+  V(DrawTextBlob)                   \
+  V(DrawShadow)
+
+namespace flutter {
+
+#define DL_OP_TO_ENUM_VALUE(name) k##name,
+enum class DisplayListOpType : uint8_t {
+  FOR_EACH_DISPLAY_LIST_OP(DL_OP_TO_ENUM_VALUE)
+};
+#undef DL_OP_TO_ENUM_VALUE
+
+/// An immutable list of drawing operations recorded by a
+/// |DisplayListBuilder|.
+///
+/// Unlike an |SkPicture|, all operations live in a single contiguous block of
+/// memory that is handed over from the builder without being copied or
+/// serialized, and the engine can inspect them. This makes two display lists
+/// cheap to compare for equality, which lets the diff and the raster cache
+/// recognize content that was recorded again without changing.
+///
+/// Display lists are created on the UI thread and are safe to use from any
+/// thread once built.
+class DisplayList : public SkRefCnt {
+ public:
+  ~DisplayList() override;
+
+  /// Plays the operations back into the canvas. Operations that set the
+  /// matrix do so relative to the matrix of the canvas at the time of the
+  /// call, and the state of the canvas is restored when done, like
+  /// |SkCanvas::drawPicture| does.
+  void RenderTo(SkCanvas* canvas) const;
+
+  /// Records the operations into an |SkPicture|, for the consumers that need
+  /// one (e.g. |Picture.toImage|).
+  sk_sp<SkPicture> ToSkPicture() const;
+
+  /// Whether both lists hold the same operations with the same arguments.
+  /// Images, text blobs, vertices and pictures are compared by identity,
+  /// nested display lists by content.
+  bool Equals(const DisplayList& other) const;
+
+  int op_count() const { return op_count_; }
+
+  /// The bytes used by the operations, including the list itself.
+  size_t bytes() const { return sizeof(DisplayList) + byte_count_; }
+
+  /// The bounds the display list was recorded with.
+  const SkRect& cull_rect() const { return cull_rect_; }
+
+  /// Conservative bounds of what the operations draw, clipped to
+  /// |cull_rect|.
+  const SkRect& bounds() const { return bounds_; }
+
+  /// An identifier that is unique to this instance, like
+  /// |SkPicture::uniqueID|.
+  uint32_t unique_id() const { return unique_id_; }
+
+  /// A hash of the operations. Lists that are |Equals| have the same hash.
+  uint64_t content_hash() const { return content_hash_; }
+
+ private:
+  DisplayList(uint8_t* storage,
+              size_t byte_count,
+              int op_count,
+              const SkRect& cull_rect,
+              const SkRect& bounds);
+
+  uint8_t* storage_;
+  const size_t byte_count_;
+  const int op_count_;
+  const SkRect cull_rect_;
+  const SkRect bounds_;
+  const uint32_t unique_id_;
+  uint64_t content_hash_ = 0;
+
+  friend class DisplayListBuilder;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayList);
+};
+
+/// Records drawing operations into a |DisplayList|.
+///
+/// The methods mirror the |SkCanvas| methods of the same names. Operations
+/// are appended to a single growing buffer instead of being allocated one by
+/// one, and the conservative bounds of the drawing are tracked while
+/// recording so that they are known without replaying the list.
+class DisplayListBuilder {
+ public:
+  explicit DisplayListBuilder(const SkRect& cull_rect);
+
+  ~DisplayListBuilder();
+
+  void save();
+  void saveLayer(const SkRect* bounds,
+                 const SkPaint* paint,
+                 const SkImageFilter* backdrop = nullptr,
+                 SkCanvas::SaveLayerFlags flags = 0);
+  void restore();
+  int getSaveCount() const { return static_cast<int>(layer_stack_.size()); }
+
+  void translate(SkScalar tx, SkScalar ty);
+  void scale(SkScalar sx, SkScalar sy);
+  void concat(const SkM44& matrix);
+  void setMatrix(const SkM44& matrix);
+
+  void clipRect(const SkRect& rect, SkClipOp clip_op, bool is_aa);
+  void clipRRect(const SkRRect& rrect, SkClipOp clip_op, bool is_aa);
+  void clipPath(const SkPath& path, SkClipOp clip_op, bool is_aa);
+
+  void drawPaint(const SkPaint& paint);
+  void drawRect(const SkRect& rect, const SkPaint& paint);
+  void drawOval(const SkRect& bounds, const SkPaint& paint);
+  void drawRRect(const SkRRect& rrect, const SkPaint& paint);
+  void drawDRRect(const SkRRect& outer,
+                  const SkRRect& inner,
+                  const SkPaint& paint);
+  void drawArc(const SkRect& bounds,
+               SkScalar start,
+               SkScalar sweep,
+               bool use_center,
+               const SkPaint& paint);
+  void drawPath(const SkPath& path, const SkPaint& paint);
+  void drawRegion(const SkRegion& region, const SkPaint& paint);
+  void drawPoints(SkCanvas::PointMode mode,
+                  size_t count,
+                  const SkPoint points[],
+                  const SkPaint& paint);
+  void drawVertices(sk_sp<SkVertices> vertices,
+                    SkBlendMode mode,
+                    const SkPaint& paint);
+  void drawImage(sk_sp<SkImage> image,
+                 const SkPoint& point,
+                 const SkSamplingOptions& sampling,
+                 const SkPaint* paint);
+  void drawImageRect(sk_sp<SkImage> image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkSamplingOptions& sampling,
+                     const SkPaint* paint,
+                     SkCanvas::SrcRectConstraint constraint);
+  void drawImageLattice(sk_sp<SkImage> image,
+                        const SkCanvas::Lattice& lattice,
+                        const SkRect& dst,
+                        SkFilterMode filter,
+                        const SkPaint* paint);
+  void drawAtlas(sk_sp<SkImage> atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkSamplingOptions& sampling,
+                 const SkRect* cull_rect,
+                 const SkPaint* paint);
+  void drawPicture(sk_sp<SkPicture> picture,
+                   const SkMatrix* matrix,
+                   const SkPaint* paint);
+  void drawDisplayList(sk_sp<DisplayList> display_list);
+  void drawTextBlob(sk_sp<SkTextBlob> blob,
+                    SkScalar x,
+                    SkScalar y,
+                    const SkPaint& paint);
+  // See |PhysicalShapeLayer::DrawShadow|.
+  void drawShadow(const SkPath& path,
+                  SkColor color,
+                  SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar dpr);
+
+  /// Restores any unbalanced saves and hands the recorded operations over to
+  /// a new display list. The builder is empty afterwards.
+  sk_sp<DisplayList> Build();
+
+ private:
+  struct LayerState {
+    SkM44 matrix;
+    // The bounds of the clip in the coordinates of the display list.
+    SkRect clip_bounds;
+    // Whether this save is a layer whose contents may be filtered beyond
+    // the bounds of what is drawn into it.
+    bool is_unbounded_layer = false;
+  };
+
+  const SkRect cull_rect_;
+  uint8_t* storage_ = nullptr;
+  size_t used_ = 0;
+  size_t allocated_ = 0;
+  int op_count_ = 0;
+  std::vector<LayerState> layer_stack_;
+  SkRect bounds_ = SkRect::MakeEmpty();
+
+  // Appends an operation of type |T| followed by |extra_bytes| of storage for
+  // its arrays, and returns a pointer to that storage.
+  template <typename T, typename... Args>
+  void* Push(size_t extra_bytes, Args&&... args);
+
+  LayerState& current() { return layer_stack_.back(); }
+
+  void IntersectClip(const SkRect& local_bounds, SkClipOp clip_op);
+
+  // Adds what is drawn within |local_bounds| with |paint| to the bounds of
+  // the display list.
+  void AccumulateBounds(const SkRect& local_bounds, const SkPaint* paint);
+  // Like |AccumulateBounds| for drawing that is not limited by anything but
+  // the clip.
+  void AccumulateUnbounded();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListBuilder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_H_
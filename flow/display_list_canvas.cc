@@ -0,0 +1,188 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_canvas.h"
+
+namespace flutter {
+
+DisplayListCanvasRecorder::DisplayListCanvasRecorder(const SkRect& bounds)
+    : SkNoDrawCanvas(bounds.roundOut()), builder_(bounds) {}
+
+DisplayListCanvasRecorder::~DisplayListCanvasRecorder() = default;
+
+void DisplayListCanvasRecorder::willSave() {
+  builder_.save();
+}
+
+SkCanvas::SaveLayerStrategy DisplayListCanvasRecorder::getSaveLayerStrategy(
+    const SaveLayerRec& rec) {
+  builder_.saveLayer(rec.fBounds, rec.fPaint, rec.fBackdrop,
+                     rec.fSaveLayerFlags);
+  return kNoLayer_SaveLayerStrategy;
+}
+
+void DisplayListCanvasRecorder::willRestore() {
+  builder_.restore();
+}
+
+void DisplayListCanvasRecorder::didConcat44(const SkM44& matrix) {
+  builder_.concat(matrix);
+}
+
+void DisplayListCanvasRecorder::didSetM44(const SkM44& matrix) {
+  builder_.setMatrix(matrix);
+}
+
+void DisplayListCanvasRecorder::didScale(SkScalar sx, SkScalar sy) {
+  builder_.scale(sx, sy);
+}
+
+void DisplayListCanvasRecorder::didTranslate(SkScalar tx, SkScalar ty) {
+  builder_.translate(tx, ty);
+}
+
+void DisplayListCanvasRecorder::onClipRect(const SkRect& rect,
+                                           SkClipOp clip_op,
+                                           ClipEdgeStyle style) {
+  builder_.clipRect(rect, clip_op, style == kSoft_ClipEdgeStyle);
+  SkNoDrawCanvas::onClipRect(rect, clip_op, style);
+}
+
+void DisplayListCanvasRecorder::onClipRRect(const SkRRect& rrect,
+                                            SkClipOp clip_op,
+                                            ClipEdgeStyle style) {
+  builder_.clipRRect(rrect, clip_op, style == kSoft_ClipEdgeStyle);
+  SkNoDrawCanvas::onClipRRect(rrect, clip_op, style);
+}
+
+void DisplayListCanvasRecorder::onClipPath(const SkPath& path,
+                                           SkClipOp clip_op,
+                                           ClipEdgeStyle style) {
+  builder_.clipPath(path, clip_op, style == kSoft_ClipEdgeStyle);
+  SkNoDrawCanvas::onClipPath(path, clip_op, style);
+}
+
+void DisplayListCanvasRecorder::onClipRegion(const SkRegion& region,
+                                             SkClipOp clip_op) {
+  // Regions are in device space, so they are recorded as a path clip with the
+  // matrix reset.
+  SkPath path;
+  region.getBoundaryPath(&path);
+  const SkM44 matrix = getLocalToDevice();
+  builder_.setMatrix(SkM44());
+  builder_.clipPath(path, clip_op, false);
+  builder_.setMatrix(matrix);
+  SkNoDrawCanvas::onClipRegion(region, clip_op);
+}
+
+void DisplayListCanvasRecorder::onDrawPaint(const SkPaint& paint) {
+  builder_.drawPaint(paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRect(const SkRect& rect,
+                                           const SkPaint& paint) {
+  builder_.drawRect(rect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRRect(const SkRRect& rrect,
+                                            const SkPaint& paint) {
+  builder_.drawRRect(rrect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawDRRect(const SkRRect& outer,
+                                             const SkRRect& inner,
+                                             const SkPaint& paint) {
+  builder_.drawDRRect(outer, inner, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawOval(const SkRect& bounds,
+                                           const SkPaint& paint) {
+  builder_.drawOval(bounds, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawArc(const SkRect& bounds,
+                                          SkScalar start,
+                                          SkScalar sweep,
+                                          bool use_center,
+                                          const SkPaint& paint) {
+  builder_.drawArc(bounds, start, sweep, use_center, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawPath(const SkPath& path,
+                                           const SkPaint& paint) {
+  builder_.drawPath(path, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRegion(const SkRegion& region,
+                                             const SkPaint& paint) {
+  builder_.drawRegion(region, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawPoints(PointMode mode,
+                                             size_t count,
+                                             const SkPoint points[],
+                                             const SkPaint& paint) {
+  builder_.drawPoints(mode, count, points, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawVerticesObject(const SkVertices* vertices,
+                                                     SkBlendMode mode,
+                                                     const SkPaint& paint) {
+  builder_.drawVertices(sk_ref_sp(vertices), mode, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawImage2(const SkImage* image,
+                                             SkScalar x,
+                                             SkScalar y,
+                                             const SkSamplingOptions& sampling,
+                                             const SkPaint* paint) {
+  builder_.drawImage(sk_ref_sp(image), SkPoint::Make(x, y), sampling, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawImageRect2(
+    const SkImage* image,
+    const SkRect& src,
+    const SkRect& dst,
+    const SkSamplingOptions& sampling,
+    const SkPaint* paint,
+    SrcRectConstraint constraint) {
+  builder_.drawImageRect(sk_ref_sp(image), src, dst, sampling, paint,
+                         constraint);
+}
+
+void DisplayListCanvasRecorder::onDrawImageLattice2(const SkImage* image,
+                                                    const Lattice& lattice,
+                                                    const SkRect& dst,
+                                                    SkFilterMode filter,
+                                                    const SkPaint* paint) {
+  builder_.drawImageLattice(sk_ref_sp(image), lattice, dst, filter, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawAtlas2(const SkImage* atlas,
+                                             const SkRSXform xform[],
+                                             const SkRect tex[],
+                                             const SkColor colors[],
+                                             int count,
+                                             SkBlendMode mode,
+                                             const SkSamplingOptions& sampling,
+                                             const SkRect* cull_rect,
+                                             const SkPaint* paint) {
+  builder_.drawAtlas(sk_ref_sp(atlas), xform, tex, colors, count, mode,
+                     sampling, cull_rect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawPicture(const SkPicture* picture,
+                                              const SkMatrix* matrix,
+                                              const SkPaint* paint) {
+  builder_.drawPicture(sk_ref_sp(picture), matrix, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawTextBlob(const SkTextBlob* blob,
+                                               SkScalar x,
+                                               SkScalar y,
+                                               const SkPaint& paint) {
+  builder_.drawTextBlob(sk_ref_sp(blob), x, y, paint);
+}
+
+}  // namespace flutter
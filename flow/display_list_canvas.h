@@ -0,0 +1,144 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
+
+#include "flutter/flow/display_list.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+/// An |SkCanvas| that records everything drawn into it into a
+/// |DisplayListBuilder|, for code that can only draw into an |SkCanvas|
+/// (e.g. text layout).
+///
+/// The canvas keeps track of its matrix and clip like any other canvas, but
+/// does not rasterize anything. Annotations, drawables, patches and edge
+/// anti-aliased quads and image sets are not used by the framework and are
+/// not recorded.
+class DisplayListCanvasRecorder : public SkNoDrawCanvas {
+ public:
+  explicit DisplayListCanvasRecorder(const SkRect& bounds);
+
+  ~DisplayListCanvasRecorder() override;
+
+  /// The builder the canvas records into. Operations that have no |SkCanvas|
+  /// counterpart (e.g. |DisplayListBuilder::drawShadow|) may be added to it
+  /// directly.
+  DisplayListBuilder* builder() { return &builder_; }
+
+  sk_sp<DisplayList> Build() { return builder_.Build(); }
+
+ protected:
+  // |SkCanvas|
+  void willSave() override;
+  // |SkCanvas|
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override;
+  // |SkCanvas|
+  void willRestore() override;
+  // |SkCanvas|
+  void didConcat44(const SkM44& matrix) override;
+  // |SkCanvas|
+  void didSetM44(const SkM44& matrix) override;
+  // |SkCanvas|
+  void didScale(SkScalar sx, SkScalar sy) override;
+  // |SkCanvas|
+  void didTranslate(SkScalar tx, SkScalar ty) override;
+
+  // |SkCanvas|
+  void onClipRect(const SkRect& rect,
+                  SkClipOp clip_op,
+                  ClipEdgeStyle style) override;
+  // |SkCanvas|
+  void onClipRRect(const SkRRect& rrect,
+                   SkClipOp clip_op,
+                   ClipEdgeStyle style) override;
+  // |SkCanvas|
+  void onClipPath(const SkPath& path,
+                  SkClipOp clip_op,
+                  ClipEdgeStyle style) override;
+  // |SkCanvas|
+  void onClipRegion(const SkRegion& region, SkClipOp clip_op) override;
+
+  // |SkCanvas|
+  void onDrawPaint(const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawRect(const SkRect& rect, const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawRRect(const SkRRect& rrect, const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawDRRect(const SkRRect& outer,
+                    const SkRRect& inner,
+                    const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawOval(const SkRect& bounds, const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawArc(const SkRect& bounds,
+                 SkScalar start,
+                 SkScalar sweep,
+                 bool use_center,
+                 const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawPath(const SkPath& path, const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawRegion(const SkRegion& region, const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawPoints(PointMode mode,
+                    size_t count,
+                    const SkPoint points[],
+                    const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawVerticesObject(const SkVertices* vertices,
+                            SkBlendMode mode,
+                            const SkPaint& paint) override;
+  // |SkCanvas|
+  void onDrawImage2(const SkImage* image,
+                    SkScalar x,
+                    SkScalar y,
+                    const SkSamplingOptions& sampling,
+                    const SkPaint* paint) override;
+  // |SkCanvas|
+  void onDrawImageRect2(const SkImage* image,
+                        const SkRect& src,
+                        const SkRect& dst,
+                        const SkSamplingOptions& sampling,
+                        const SkPaint* paint,
+                        SrcRectConstraint constraint) override;
+  // |SkCanvas|
+  void onDrawImageLattice2(const SkImage* image,
+                           const Lattice& lattice,
+                           const SkRect& dst,
+                           SkFilterMode filter,
+                           const SkPaint* paint) override;
+  // |SkCanvas|
+  void onDrawAtlas2(const SkImage* atlas,
+                    const SkRSXform xform[],
+                    const SkRect tex[],
+                    const SkColor colors[],
+                    int count,
+                    SkBlendMode mode,
+                    const SkSamplingOptions& sampling,
+                    const SkRect* cull_rect,
+                    const SkPaint* paint) override;
+  // |SkCanvas|
+  void onDrawPicture(const SkPicture* picture,
+                     const SkMatrix* matrix,
+                     const SkPaint* paint) override;
+  // |SkCanvas|
+  void onDrawTextBlob(const SkTextBlob* blob,
+                      SkScalar x,
+                      SkScalar y,
+                      const SkPaint& paint) override;
+
+ private:
+  DisplayListBuilder builder_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListCanvasRecorder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
@@ -0,0 +1,218 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list.h"
+
+#include "flutter/flow/display_list_canvas.h"
+#include "flutter/testing/mock_canvas.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flutter {
+namespace testing {
+
+static sk_sp<DisplayList> RecordRects(int count, SkColor color) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.save();
+  builder.translate(5, 5);
+  for (int i = 0; i < count; i++) {
+    builder.drawRect(SkRect::MakeXYWH(i, i, 10, 10),
+                     SkPaint(SkColor4f::FromColor(color)));
+  }
+  builder.restore();
+  return builder.Build();
+}
+
+TEST(DisplayList, EmptyDisplayList) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  auto display_list = builder.Build();
+  EXPECT_EQ(display_list->op_count(), 0);
+  EXPECT_EQ(display_list->cull_rect(), SkRect::MakeWH(100, 100));
+  EXPECT_TRUE(display_list->bounds().isEmpty());
+}
+
+TEST(DisplayList, EqualContentIsEqual) {
+  auto display_list1 = RecordRects(20, SK_ColorRED);
+  auto display_list2 = RecordRects(20, SK_ColorRED);
+
+  EXPECT_NE(display_list1->unique_id(), display_list2->unique_id());
+  EXPECT_EQ(display_list1->op_count(), 23);
+  EXPECT_EQ(display_list1->content_hash(), display_list2->content_hash());
+  EXPECT_TRUE(display_list1->Equals(*display_list2));
+  EXPECT_TRUE(display_list2->Equals(*display_list1));
+}
+
+TEST(DisplayList, DifferentContentIsNotEqual) {
+  auto display_list = RecordRects(20, SK_ColorRED);
+
+  EXPECT_FALSE(display_list->Equals(*RecordRects(20, SK_ColorBLUE)));
+  EXPECT_FALSE(display_list->Equals(*RecordRects(19, SK_ColorRED)));
+  EXPECT_NE(display_list->content_hash(),
+            RecordRects(20, SK_ColorBLUE)->content_hash());
+}
+
+TEST(DisplayList, PaintsDifferingInAnyFieldHashDifferently) {
+  auto record = [](const SkPaint& paint) {
+    DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+    builder.drawRect(SkRect::MakeWH(10, 10), paint);
+    return builder.Build();
+  };
+  const SkPaint paint(SkColor4f::FromColor(SK_ColorRED));
+  auto display_list = record(paint);
+
+  SkPaint blend_mode = paint;
+  blend_mode.setBlendMode(SkBlendMode::kSrc);
+  SkPaint color = paint;
+  color.setColor4f({1.0f, 0.0f, 0.0f, 0.999f});
+  SkPaint stroke = paint;
+  stroke.setStyle(SkPaint::kStroke_Style);
+  SkPaint anti_alias = paint;
+  anti_alias.setAntiAlias(true);
+  for (const SkPaint& other : {blend_mode, color, stroke, anti_alias}) {
+    auto other_display_list = record(other);
+    EXPECT_FALSE(display_list->Equals(*other_display_list));
+    EXPECT_NE(display_list->content_hash(), other_display_list->content_hash());
+  }
+}
+
+TEST(DisplayList, ArraysAreCompared) {
+  const SkPoint points1[] = {{0, 0}, {10, 10}, {20, 0}};
+  const SkPoint points2[] = {{0, 0}, {10, 10}, {20, 5}};
+  auto record = [](const SkPoint* points) {
+    DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+    builder.drawPoints(SkCanvas::kPolygon_PointMode, 3, points, SkPaint());
+    return builder.Build();
+  };
+
+  EXPECT_TRUE(record(points1)->Equals(*record(points1)));
+  EXPECT_FALSE(record(points1)->Equals(*record(points2)));
+}
+
+TEST(DisplayList, NestedDisplayListsAreComparedByContent) {
+  auto record = [](sk_sp<DisplayList> nested) {
+    DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+    builder.drawDisplayList(std::move(nested));
+    return builder.Build();
+  };
+
+  EXPECT_TRUE(record(RecordRects(3, SK_ColorRED))
+                  ->Equals(*record(RecordRects(3, SK_ColorRED))));
+  EXPECT_FALSE(record(RecordRects(3, SK_ColorRED))
+                   ->Equals(*record(RecordRects(3, SK_ColorBLUE))));
+}
+
+TEST(DisplayList, BoundsAreTransformedAndClipped) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.save();
+  builder.translate(10, 20);
+  builder.clipRect(SkRect::MakeWH(30, 30), SkClipOp::kIntersect, false);
+  builder.drawRect(SkRect::MakeXYWH(20, 0, 40, 10), SkPaint());
+  builder.restore();
+  builder.drawRect(SkRect::MakeXYWH(90, 90, 20, 20), SkPaint());
+  auto display_list = builder.Build();
+
+  // The first rect is clipped to x < 40, the second one to the cull rect.
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(30, 20, 100, 100));
+}
+
+TEST(DisplayList, StrokeWidthIsPartOfTheBounds) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  SkPaint paint;
+  paint.setStyle(SkPaint::kStroke_Style);
+  paint.setStrokeWidth(4);
+  // Miter joins would inflate the bounds by the miter limit.
+  paint.setStrokeJoin(SkPaint::kRound_Join);
+  builder.drawRect(SkRect::MakeLTRB(10, 10, 20, 20), paint);
+  auto display_list = builder.Build();
+
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(8, 8, 22, 22));
+}
+
+TEST(DisplayList, UnboundedOpsFillTheClip) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.clipRect(SkRect::MakeLTRB(10, 10, 50, 50), SkClipOp::kIntersect,
+                   false);
+  builder.drawPaint(SkPaint());
+  auto display_list = builder.Build();
+
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(10, 10, 50, 50));
+}
+
+TEST(DisplayList, UnbalancedSavesAreRestored) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.save();
+  builder.save();
+  EXPECT_EQ(builder.getSaveCount(), 3);
+  auto display_list = builder.Build();
+
+  EXPECT_EQ(display_list->op_count(), 4);
+}
+
+TEST(DisplayList, RenderToDispatchesOps) {
+  const SkRect rect = SkRect::MakeLTRB(5, 5, 15, 15);
+  const SkPaint paint(SkColors::kRed);
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.drawRect(rect, paint);
+  auto display_list = builder.Build();
+
+  MockCanvas canvas;
+  display_list->RenderTo(&canvas);
+
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::DrawRectData{rect, paint}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(canvas.draw_calls(), expected_draw_calls);
+}
+
+TEST(DisplayList, SetMatrixIsRelativeToTheCanvas) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.setMatrix(SkM44::Scale(2, 2));
+  auto display_list = builder.Build();
+
+  MockCanvas canvas;
+  canvas.translate(10, 10);
+  display_list->RenderTo(&canvas);
+
+  EXPECT_EQ(canvas.draw_calls()[2],
+            (MockCanvas::DrawCall{
+                1, MockCanvas::SetMatrixData{SkM44(SkM44::Translate(10, 10),
+                                                   SkM44::Scale(2, 2))}}));
+}
+
+TEST(DisplayList, CanvasRecorderRecordsCanvasCalls) {
+  DisplayListCanvasRecorder recorder(SkRect::MakeWH(100, 100));
+  recorder.save();
+  recorder.translate(10, 10);
+  recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+  recorder.drawLine(0, 0, 20, 0, SkPaint());
+  recorder.restore();
+  EXPECT_EQ(recorder.builder()->getSaveCount(), 1);
+  auto display_list = recorder.Build();
+
+  // save, translate, drawRect, drawPoints, restore.
+  EXPECT_EQ(display_list->op_count(), 5);
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(9, 9, 31, 20));
+
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.save();
+  builder.translate(10, 10);
+  builder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+  const SkPoint line[] = {{0, 0}, {20, 0}};
+  builder.drawPoints(SkCanvas::kLines_PointMode, 2, line, SkPaint());
+  builder.restore();
+  EXPECT_TRUE(display_list->Equals(*builder.Build()));
+}
+
+TEST(DisplayList, ToSkPicture) {
+  auto display_list = RecordRects(10, SK_ColorRED);
+  auto picture = display_list->ToSkPicture();
+
+  ASSERT_TRUE(picture);
+  EXPECT_EQ(picture->cullRect(), display_list->cull_rect());
+  EXPECT_GE(picture->approximateOpCount(), 10);
+}
+
+}  // namespace testing
+}  // namespace flutter
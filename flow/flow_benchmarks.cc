@@ -0,0 +1,325 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/backdrop_filter_layer.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/clip_rrect_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/raster_cache.h"
+#include "flutter/flow/rtree.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+namespace flutter {
+namespace benchmarking {
+namespace {
+
+const SkISize kFrameSize = SkISize::Make(1080, 1920);
+
+// The number of rects drawn by every picture in the synthesized trees.
+constexpr int kRectsPerPicture = 8;
+
+sk_sp<SkPicture> CreatePicture(const SkRect& bounds, int rect_count) {
+  RTreeFactory rtree_factory;
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(bounds, &rtree_factory);
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  const SkScalar step = bounds.height() / rect_count;
+  for (int i = 0; i < rect_count; i++) {
+    paint.setColor(SkColorSetARGB(0xFF, 30 * i, 255 - 30 * i, 128));
+    const SkRect rect = SkRect::MakeXYWH(bounds.left() + step * (i % 4),
+                                         bounds.top() + step * i,
+                                         bounds.width() / 2, step);
+    canvas->drawRect(rect, paint);
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+// Synthesizes layer trees in which every level is a clip, opacity, transform
+// or rounded clip layer that splits its bounds between |fan_out| children,
+// with pictures at the leaves.
+//
+// The pictures are created with the first tree and shared by all trees built
+// afterwards, like the pictures of retained widgets are shared by the
+// successive frames of an app.
+class LayerTreeSynthesizer {
+ public:
+  LayerTreeSynthesizer(int depth, int fan_out, bool with_backdrop_filter)
+      : depth_(depth),
+        fan_out_(fan_out),
+        with_backdrop_filter_(with_backdrop_filter) {}
+
+  // Builds a tree. If |replace_previous| is true, every layer of the tree is
+  // linked to the layer at its place in the previously built tree, the way
+  // the SceneBuilder links the layers of a frame to those of the frame it
+  // updates, so that diffing the two trees finds them unchanged.
+  std::unique_ptr<LayerTree> Build(bool replace_previous = false) {
+    FML_CHECK(!replace_previous || !layers_.empty());
+    next_picture_ = 0;
+    next_container_ = 0;
+    replace_previous_ = replace_previous;
+    previous_layers_.swap(layers_);
+    layers_.clear();
+    auto root = std::make_shared<ContainerLayer>();
+    Link(root);
+    root->Add(BuildSubtree(SkRect::Make(kFrameSize), depth_));
+    auto layer_tree = std::make_unique<LayerTree>(kFrameSize, 1.0f);
+    layer_tree->set_root_layer(std::move(root));
+    return layer_tree;
+  }
+
+  size_t picture_count() const { return pictures_.size(); }
+
+ private:
+  const int depth_;
+  const int fan_out_;
+  const bool with_backdrop_filter_;
+  std::vector<sk_sp<SkPicture>> pictures_;
+  size_t next_picture_ = 0;
+  int next_container_ = 0;
+  bool replace_previous_ = false;
+  // The layers of the last and of the previously built tree, in the order
+  // they were created.
+  std::vector<std::shared_ptr<Layer>> layers_;
+  std::vector<std::shared_ptr<Layer>> previous_layers_;
+
+  void Link(const std::shared_ptr<Layer>& layer) {
+    if (replace_previous_) {
+      layer->AssignOldLayer(previous_layers_[layers_.size()].get());
+    }
+    layers_.push_back(layer);
+  }
+
+  std::shared_ptr<Layer> BuildSubtree(const SkRect& bounds, int depth) {
+    if (depth == 0) {
+      if (next_picture_ == pictures_.size()) {
+        pictures_.push_back(CreatePicture(
+            SkRect::MakeWH(bounds.width(), bounds.height()), kRectsPerPicture));
+      }
+      auto picture_layer = std::make_shared<PictureLayer>(
+          bounds.topLeft(),
+          SkiaGPUObject<SkPicture>(pictures_[next_picture_++], nullptr), false,
+          false);
+      Link(picture_layer);
+      return picture_layer;
+    }
+
+    std::shared_ptr<ContainerLayer> container;
+    switch (next_container_++ % 4) {
+      case 0:
+        container = std::make_shared<ClipRectLayer>(bounds, Clip::hardEdge);
+        break;
+      case 1:
+        container = std::make_shared<OpacityLayer>(0xC0, SkPoint::Make(0, 0));
+        break;
+      case 2:
+        container = std::make_shared<TransformLayer>(SkMatrix::Translate(1, 1));
+        break;
+      case 3:
+        container = std::make_shared<ClipRRectLayer>(
+            SkRRect::MakeRectXY(bounds, 8, 8), Clip::antiAlias);
+        break;
+    }
+    Link(container);
+
+    // Split horizontally and vertically on alternate levels.
+    const bool horizontal = depth % 2 == 0;
+    const SkScalar step =
+        (horizontal ? bounds.width() : bounds.height()) / fan_out_;
+    for (int i = 0; i < fan_out_; i++) {
+      const SkRect child_bounds =
+          horizontal
+              ? SkRect::MakeXYWH(bounds.left() + step * i, bounds.top(), step,
+                                 bounds.height())
+              : SkRect::MakeXYWH(bounds.left(), bounds.top() + step * i,
+                                 bounds.width(), step);
+      container->Add(BuildSubtree(child_bounds, depth - 1));
+    }
+
+    if (with_backdrop_filter_ && depth == depth_) {
+      auto backdrop_filter = std::make_shared<BackdropFilterLayer>(
+          SkImageFilters::Blur(4, 4, SkTileMode::kClamp, nullptr));
+      Link(backdrop_filter);
+      backdrop_filter->Add(container);
+      return backdrop_filter;
+    }
+    return container;
+  }
+};
+
+// Renders the frames of the benchmarks into a software surface.
+class FrameHarness {
+ public:
+  FrameHarness()
+      : surface_(SkSurface::MakeRasterN32Premul(kFrameSize.width(),
+                                                kFrameSize.height())) {
+    FML_CHECK(surface_);
+  }
+
+  std::unique_ptr<CompositorContext::ScopedFrame> AcquireFrame() {
+    return compositor_context_.AcquireFrame(nullptr, surface_->getCanvas(),
+                                            nullptr, SkMatrix::I(), false,
+                                            true, nullptr);
+  }
+
+ private:
+  sk_sp<SkSurface> surface_;
+  CompositorContext compositor_context_;
+};
+
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+Damage DiffLayerTrees(LayerTree& layer_tree, const LayerTree* old_layer_tree) {
+  const PaintRegionMap empty_paint_region_map;
+  DiffContext context(kFrameSize, layer_tree.device_pixel_ratio(),
+                      layer_tree.paint_region_map(),
+                      old_layer_tree ? old_layer_tree->paint_region_map()
+                                     : empty_paint_region_map);
+  context.PushCullRect(SkRect::Make(kFrameSize));
+  layer_tree.root_layer()->Diff(
+      &context, old_layer_tree ? old_layer_tree->root_layer() : nullptr);
+  return context.ComputeDamage(SkIRect::MakeEmpty());
+}
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
+}  // namespace
+
+static void BM_LayerTreePreroll(benchmark::State& state) {
+  LayerTreeSynthesizer synthesizer(state.range(0), state.range(1), false);
+  auto layer_tree = synthesizer.Build();
+  FrameHarness harness;
+
+  while (state.KeepRunning()) {
+    auto frame = harness.AcquireFrame();
+    layer_tree->Preroll(*frame, true);
+  }
+  state.counters["Pictures"] = synthesizer.picture_count();
+}
+
+static void BM_LayerTreePaint(benchmark::State& state) {
+  LayerTreeSynthesizer synthesizer(state.range(0), state.range(1),
+                                   state.range(2) != 0);
+  auto layer_tree = synthesizer.Build();
+  FrameHarness harness;
+  layer_tree->Preroll(*harness.AcquireFrame(), true);
+
+  while (state.KeepRunning()) {
+    auto frame = harness.AcquireFrame();
+    layer_tree->Paint(*frame, true);
+  }
+  state.counters["Pictures"] = synthesizer.picture_count();
+}
+
+// Preroll and Paint of a tree whose pictures are drawn from the raster
+// cache, which is populated before the measurement starts.
+static void BM_LayerTreePrerollAndPaintWithRasterCache(
+    benchmark::State& state) {
+  LayerTreeSynthesizer synthesizer(state.range(0), state.range(1), false);
+  auto layer_tree = synthesizer.Build();
+  FrameHarness harness;
+  // Pictures are cached on their third frame, a few of them per frame.
+  const size_t warm_up_frames =
+      3 + synthesizer.picture_count() /
+              RasterCache::kDefaultPictureCacheLimitPerFrame;
+  for (size_t i = 0; i < warm_up_frames; i++) {
+    auto frame = harness.AcquireFrame();
+    layer_tree->Preroll(*frame);
+    layer_tree->Paint(*frame);
+  }
+
+  while (state.KeepRunning()) {
+    auto frame = harness.AcquireFrame();
+    layer_tree->Preroll(*frame);
+    layer_tree->Paint(*frame);
+  }
+  state.counters["Pictures"] = synthesizer.picture_count();
+}
+
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+// Diffs a rebuilt tree whose layers replace those of the previous one and
+// share its pictures, the common case of a frame in which nothing changed.
+static void BM_DiffContextUnchangedTree(benchmark::State& state) {
+  LayerTreeSynthesizer synthesizer(state.range(0), state.range(1), false);
+  auto old_layer_tree = synthesizer.Build();
+  DiffLayerTrees(*old_layer_tree, nullptr);
+  auto layer_tree = synthesizer.Build(true);
+  FML_CHECK(DiffLayerTrees(*layer_tree, old_layer_tree.get())
+                .frame_damage.isEmpty());
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(DiffLayerTrees(*layer_tree, old_layer_tree.get()));
+  }
+  state.counters["Pictures"] = synthesizer.picture_count();
+}
+
+// Diffs a tree against nothing, as for the first frame.
+static void BM_DiffContextNewTree(benchmark::State& state) {
+  LayerTreeSynthesizer synthesizer(state.range(0), state.range(1), false);
+  auto layer_tree = synthesizer.Build();
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(DiffLayerTrees(*layer_tree, nullptr));
+  }
+  state.counters["Pictures"] = synthesizer.picture_count();
+}
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
+static void BM_RTreeSearchNonOverlappingDrawnRects(benchmark::State& state) {
+  const SkRect bounds = SkRect::Make(kFrameSize);
+  RTreeFactory rtree_factory;
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(bounds, &rtree_factory);
+  const int rect_count = state.range(0);
+  for (int i = 0; i < rect_count; i++) {
+    // A grid of overlapping rects.
+    const SkScalar x = (i % 32) * bounds.width() / 32;
+    const SkScalar y = (i / 32 % 64) * bounds.height() / 64;
+    canvas->drawRect(SkRect::MakeXYWH(x, y, 50, 40), SkPaint());
+  }
+  sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+  sk_sp<RTree> rtree = rtree_factory.getInstance();
+  const SkRect query =
+      SkRect::MakeXYWH(bounds.width() / 4, bounds.height() / 4,
+                       bounds.width() / 2, bounds.height() / 2);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(rtree->searchNonOverlappingDrawnRects(query));
+  }
+}
+
+// Arguments are the depth and the fan out of the synthesized trees: deep and
+// narrow, balanced, and shallow and wide.
+#define LAYER_TREE_SHAPES \
+  Args({8, 2})->Args({4, 4})->Args({2, 24})->Unit(benchmark::kMicrosecond)
+
+BENCHMARK(BM_LayerTreePreroll)->LAYER_TREE_SHAPES;
+// The third argument adds a backdrop filter at the root.
+BENCHMARK(BM_LayerTreePaint)
+    ->Args({8, 2, 0})
+    ->Args({4, 4, 0})
+    ->Args({2, 24, 0})
+    ->Args({4, 4, 1})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LayerTreePrerollAndPaintWithRasterCache)->LAYER_TREE_SHAPES;
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+BENCHMARK(BM_DiffContextUnchangedTree)->LAYER_TREE_SHAPES;
+BENCHMARK(BM_DiffContextNewTree)->LAYER_TREE_SHAPES;
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+BENCHMARK(BM_RTreeSearchNonOverlappingDrawnRects)
+    ->Range(64, 2048)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace benchmarking
+}  // namespace flutter
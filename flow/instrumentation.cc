@@ -5,6 +5,7 @@
 #include "flutter/flow/instrumentation.h"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "third_party/skia/include/core/SkPath.h"
@@ -320,4 +321,89 @@ int64_t CounterValues::GetMinValue() const {
   return min;
 }
 
+// The index of the most significant bit set in |value|, which must be
+// positive.
+static int MostSignificantBit(uint64_t value) {
+  int bit = 0;
+  while (value >>= 1) {
+    bit++;
+  }
+  return bit;
+}
+
+Histogram::Histogram(int64_t max_value, int precision_bits)
+    : max_value_(std::max<int64_t>(max_value, 1)),
+      precision_bits_(std::clamp(precision_bits, 1, 16)) {
+  counts_.resize(BucketIndex(max_value_) + 1, 0);
+}
+
+Histogram::~Histogram() = default;
+
+// Values below 2^precision_bits each have a bucket of their own. Above that,
+// a value whose most significant bit is b is counted in one of the
+// 2^precision_bits buckets of width 2^(b - precision_bits) that cover
+// [2^b, 2^(b + 1)), so a bucket is never wider than 2^-precision_bits of the
+// values in it.
+size_t Histogram::BucketIndex(int64_t value) const {
+  const uint64_t linear_buckets = uint64_t{1} << precision_bits_;
+  if (static_cast<uint64_t>(value) < linear_buckets) {
+    return static_cast<size_t>(value);
+  }
+  const int shift = MostSignificantBit(value) - precision_bits_;
+  const uint64_t sub_bucket = static_cast<uint64_t>(value) >> shift;
+  return static_cast<size_t>(shift * linear_buckets + sub_bucket);
+}
+
+int64_t Histogram::BucketMaxValue(size_t index) const {
+  const uint64_t linear_buckets = uint64_t{1} << precision_bits_;
+  if (index < linear_buckets) {
+    return static_cast<int64_t>(index);
+  }
+  const int shift = static_cast<int>((index - linear_buckets) / linear_buckets);
+  const uint64_t sub_bucket = linear_buckets + index % linear_buckets;
+  return static_cast<int64_t>(((sub_bucket + 1) << shift) - 1);
+}
+
+void Histogram::Record(int64_t value) {
+  value = std::clamp<int64_t>(value, 0, max_value_);
+  counts_[BucketIndex(value)]++;
+  if (count_ == 0 || value < min_) {
+    min_ = value;
+  }
+  if (count_ == 0 || value > max_) {
+    max_ = value;
+  }
+  count_++;
+  sum_ += value;
+}
+
+void Histogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0;
+}
+
+double Histogram::Mean() const {
+  return count_ > 0 ? sum_ / count_ : 0;
+}
+
+int64_t Histogram::ValueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+  const int64_t rank =
+      std::max<int64_t>(1, static_cast<int64_t>(std::ceil(fraction * count_)));
+  int64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); i++) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::clamp(BucketMaxValue(i), min_, max_);
+    }
+  }
+  return max_;
+}
+
 }  // namespace flutter
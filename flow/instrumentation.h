@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_INSTRUMENTATION_H_
 #define FLUTTER_FLOW_INSTRUMENTATION_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "flutter/fml/macros.h"
@@ -96,6 +97,56 @@ class CounterValues {
   FML_DISALLOW_COPY_AND_ASSIGN(CounterValues);
 };
 
+/// A histogram of non-negative integer values that uses a fixed amount of
+/// memory no matter how many values are recorded, in the style of
+/// HdrHistogram.
+///
+/// Small values are counted exactly. Larger values share buckets whose width
+/// doubles with every power of two, so that any value read back (e.g. a
+/// percentile) is within a fixed relative error of the values recorded.
+class Histogram {
+ public:
+  /// Creates a histogram for values up to |max_value|. Larger values are
+  /// recorded as |max_value|. Every power of two is split into
+  /// 2^|precision_bits| buckets, for a relative error of at most
+  /// 2^-|precision_bits| (about 3% by default).
+  explicit Histogram(int64_t max_value, int precision_bits = 5);
+
+  ~Histogram();
+
+  /// Records |value|, which is clamped to [0, max_value].
+  void Record(int64_t value);
+
+  /// Forgets all recorded values.
+  void Reset();
+
+  int64_t count() const { return count_; }
+
+  /// The smallest and largest values recorded, or 0 if there are none.
+  int64_t min() const { return count_ > 0 ? min_ : 0; }
+  int64_t max() const { return count_ > 0 ? max_ : 0; }
+
+  double Mean() const;
+
+  /// The value that |percentile| percent of the recorded values are less
+  /// than or equal to, within the precision of the histogram. Returns 0 if
+  /// no values were recorded.
+  int64_t ValueAtPercentile(double percentile) const;
+
+ private:
+  size_t BucketIndex(int64_t value) const;
+  // The largest value counted in the bucket at |index|.
+  int64_t BucketMaxValue(size_t index) const;
+
+  const int64_t max_value_;
+  const int precision_bits_;
+  std::vector<int64_t> counts_;
+  int64_t count_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  double sum_ = 0;
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_INSTRUMENTATION_H_
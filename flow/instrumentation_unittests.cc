@@ -0,0 +1,85 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/instrumentation.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(HistogramTest, EmptyHistogram) {
+  Histogram histogram(1000);
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.Mean(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 0);
+}
+
+TEST(HistogramTest, SmallValuesAreExact) {
+  Histogram histogram(1000);
+  for (int i = 1; i <= 20; i++) {
+    histogram.Record(i);
+  }
+  EXPECT_EQ(histogram.count(), 20);
+  EXPECT_EQ(histogram.min(), 1);
+  EXPECT_EQ(histogram.max(), 20);
+  EXPECT_DOUBLE_EQ(histogram.Mean(), 10.5);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 10);
+  EXPECT_EQ(histogram.ValueAtPercentile(95), 19);
+  EXPECT_EQ(histogram.ValueAtPercentile(100), 20);
+  EXPECT_EQ(histogram.ValueAtPercentile(0), 1);
+}
+
+TEST(HistogramTest, LargeValuesAreWithinPrecision) {
+  Histogram histogram(100000000, 5);
+  for (int64_t value = 1; value <= 1000000; value++) {
+    histogram.Record(value);
+  }
+  for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    const double expected = percentile * 10000;
+    const double actual = histogram.ValueAtPercentile(percentile);
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected * (1 + 1.0 / 32)) << percentile;
+  }
+  EXPECT_EQ(histogram.ValueAtPercentile(100), 1000000);
+}
+
+TEST(HistogramTest, ValuesJustAbovePowersOfTwoAreWithinPrecision) {
+  const int64_t max_value = int64_t{1} << 40;
+  for (int bit = 5; bit < 40; bit++) {
+    const int64_t value = (int64_t{1} << bit) + 1;
+    Histogram histogram(max_value, 5);
+    histogram.Record(value);
+    // A larger value keeps the percentile from being clamped to |value|.
+    histogram.Record(max_value);
+    const int64_t actual = histogram.ValueAtPercentile(50);
+    EXPECT_GE(actual, value) << value;
+    EXPECT_LE(actual, value + value / 32) << value;
+  }
+}
+
+TEST(HistogramTest, ValuesAreClamped) {
+  Histogram histogram(100);
+  histogram.Record(-5);
+  histogram.Record(1000);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 100);
+  EXPECT_EQ(histogram.ValueAtPercentile(100), 100);
+}
+
+TEST(HistogramTest, Reset) {
+  Histogram histogram(100);
+  histogram.Record(42);
+  histogram.Reset();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 0);
+  histogram.Record(7);
+  EXPECT_EQ(histogram.min(), 7);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 7);
+}
+
+}  // namespace testing
+}  // namespace flutter
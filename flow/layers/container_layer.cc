@@ -5,6 +5,10 @@
 #include "flutter/flow/layers/container_layer.h"
 
 #include <optional>
+#include <string>
+
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
 
 namespace flutter {
 
@@ -139,15 +143,36 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
   // always be false.
   FML_DCHECK(!context->has_platform_view);
   bool child_has_platform_view = false;
-  bool child_has_texture_layer = false;
-  for (auto& layer : layers_) {
-    // Reset context->has_platform_view to false so that layers aren't treated
-    // as if they have a platform view based on one being previously found in a
-    // sibling tree.
+  bool child_has_texture_layer = context->has_texture_layer;
+  // The union of the paint bounds of the children that contain textures.
+  SkRect texture_bounds = SkRect::MakeEmpty();
+  child_paints_concurrently_.assign(layers_.size(), false);
+  for (size_t i = 0; i < layers_.size(); i++) {
+    auto& layer = layers_[i];
+    // Reset context->has_platform_view and context->has_texture_layer to false
+    // so that layers aren't treated as if they have a platform view or texture
+    // layer based on one being previously found in a sibling tree.
     context->has_platform_view = false;
+    context->has_texture_layer = false;
+    const bool sibling_needs_readback = context->surface_needs_readback;
+    context->surface_needs_readback = false;
 
     layer->Preroll(context, child_matrix);
 
+    // A subtree can only be recorded away from the raster thread if it neither
+    // splits the canvas, nor needs the GrDirectContext to paint, nor reads back
+    // from the surface it is painted into. Subtrees drawn over a texture stay
+    // on the raster thread with it, the others do not depend on it.
+    if (context->has_texture_layer) {
+      texture_bounds.join(layer->paint_bounds());
+    }
+    child_paints_concurrently_[i] =
+        !context->has_platform_view && !context->has_texture_layer &&
+        !context->surface_needs_readback && !layer->needs_system_composite() &&
+        !SkRect::Intersects(texture_bounds, layer->paint_bounds());
+    context->surface_needs_readback =
+        sibling_needs_readback || context->surface_needs_readback;
+
     if (layer->needs_system_composite()) {
       set_needs_system_composite(true);
     }
@@ -180,6 +205,10 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
 
   // Intentionally not tracing here as there should be no self-time
   // and the trace event on this common function has a small overhead.
+  if (context.concurrent_task_runner && PaintChildrenConcurrently(context)) {
+    return;
+  }
+
   for (auto& layer : layers_) {
     if (layer->needs_painting(context)) {
       layer->Paint(context);
@@ -187,6 +216,118 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   }
 }
 
+bool ContainerLayer::PaintChildrenConcurrently(PaintContext& context) const {
+  if (layers_.size() < kMinChildrenForConcurrentPaint ||
+      child_paints_concurrently_.size() != layers_.size()) {
+    return false;
+  }
+
+  size_t concurrent_children = 0;
+  for (bool concurrent : child_paints_concurrently_) {
+    concurrent_children += concurrent ? 1 : 0;
+  }
+  if (concurrent_children < kMinChildrenForConcurrentPaint) {
+    return false;
+  }
+
+  // Split the children into spans of consecutive layers that are either all
+  // recorded on one thread or all painted directly. The raster thread records
+  // one of the spans itself while it waits for the workers.
+  struct Span {
+    size_t begin;
+    size_t end;
+    bool concurrent;
+    sk_sp<SkPicture> picture;
+  };
+  const size_t thread_count = context.concurrent_worker_count + 1;
+  const size_t span_size =
+      (concurrent_children + thread_count - 1) / thread_count;
+  std::vector<Span> spans;
+  size_t concurrent_spans = 0;
+  for (size_t i = 0; i < layers_.size(); i++) {
+    const bool concurrent = child_paints_concurrently_[i];
+    if (!spans.empty() && spans.back().concurrent == concurrent &&
+        (!concurrent || spans.back().end - spans.back().begin < span_size)) {
+      spans.back().end = i + 1;
+      continue;
+    }
+    spans.push_back({i, i + 1, concurrent, nullptr});
+    concurrent_spans += concurrent ? 1 : 0;
+  }
+  if (concurrent_spans < 2) {
+    return false;
+  }
+
+  // Each span is recorded with the device clip and matrix of the canvas it is
+  // drawn into so that culling, pixel snapping and raster cache lookups behave
+  // exactly as if the span had been painted directly.
+  const SkRect record_bounds =
+      SkRect::Make(context.leaf_nodes_canvas->getDeviceClipBounds());
+  const SkMatrix record_matrix = context.leaf_nodes_canvas->getTotalMatrix();
+  auto record_span = [this, &context, &record_bounds,
+                      &record_matrix](Span& span) {
+    TRACE_EVENT0("flutter", "ContainerLayer::RecordSpan");
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(record_bounds);
+    canvas->setMatrix(record_matrix);
+    PaintContext span_context = context;
+    span_context.internal_nodes_canvas = canvas;
+    span_context.leaf_nodes_canvas = canvas;
+    span_context.gr_context = nullptr;
+    span_context.view_embedder = nullptr;
+    span_context.concurrent_task_runner = nullptr;
+    span_context.concurrent_worker_count = 0;
+    for (size_t i = span.begin; i < span.end; i++) {
+      if (layers_[i]->needs_painting(span_context)) {
+        layers_[i]->Paint(span_context);
+      }
+    }
+    span.picture = recorder.finishRecordingAsPicture();
+  };
+
+  {
+    auto trace_spans = std::to_string(concurrent_spans);
+    TRACE_EVENT1("flutter", "ContainerLayer::PaintChildrenConcurrently",
+                 "spans", trace_spans.c_str());
+    fml::CountDownLatch latch(concurrent_spans - 1);
+    Span* local_span = nullptr;
+    for (Span& span : spans) {
+      if (!span.concurrent) {
+        continue;
+      }
+      if (!local_span) {
+        local_span = &span;
+        continue;
+      }
+      // The raster thread blocks on these, so they go ahead of background
+      // work like image decodes.
+      context.concurrent_task_runner->PostTaskWithPriority(
+          [&record_span, &span, &latch]() {
+            record_span(span);
+            latch.CountDown();
+          },
+          fml::ConcurrentTaskPriority::kHigh);
+    }
+    record_span(*local_span);
+    latch.Wait();
+  }
+
+  for (const Span& span : spans) {
+    if (span.concurrent) {
+      SkAutoCanvasRestore save(context.leaf_nodes_canvas, true);
+      context.leaf_nodes_canvas->resetMatrix();
+      context.leaf_nodes_canvas->drawPicture(span.picture);
+      continue;
+    }
+    for (size_t i = span.begin; i < span.end; i++) {
+      if (layers_[i]->needs_painting(context)) {
+        layers_[i]->Paint(context);
+      }
+    }
+  }
+  return true;
+}
+
 void ContainerLayer::TryToPrepareRasterCache(PrerollContext* context,
                                              Layer* layer,
                                              const SkMatrix& matrix) {
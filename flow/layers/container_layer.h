@@ -64,8 +64,25 @@ class ContainerLayer : public Layer {
                                       const SkMatrix& matrix);
 
  private:
+  // The minimum number of children a container must have before its
+  // independent children are recorded concurrently. Below this the cost of
+  // recording and stitching separate pictures outweighs the gain.
+  static constexpr size_t kMinChildrenForConcurrentPaint = 4;
+
+  // Records runs of children that were found to be independent during Preroll
+  // into separate pictures on the concurrent worker pool, then draws them and
+  // the remaining children in order.
+  //
+  // Returns false without painting anything if there are not enough
+  // independent children to split the work.
+  bool PaintChildrenConcurrently(PaintContext& context) const;
+
   std::vector<std::shared_ptr<Layer>> layers_;
 
+  // Whether the child at the same index in |layers_| may be recorded on a
+  // thread other than the raster thread, as determined by the last Preroll.
+  std::vector<bool> child_paints_concurrently_;
+
   FML_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
 
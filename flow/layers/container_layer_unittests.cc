@@ -6,9 +6,13 @@
 
 #include "flutter/flow/testing/diff_context_test.h"
 #include "flutter/flow/testing/layer_test.h"
+#include "flutter/flow/layers/texture_layer.h"
 #include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/mock_texture.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/testing/mock_canvas.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
 namespace testing {
@@ -269,6 +273,90 @@ TEST_F(ContainerLayerTest, MergedMultipleChildren) {
                                                child_path2, child_paint2}}}));
 }
 
+TEST_F(ContainerLayerTest, ConcurrentPaintMatchesSerialPaint) {
+  const SkColor colors[] = {SK_ColorRED,  SK_ColorGREEN,   SK_ColorBLUE,
+                            SK_ColorCYAN, SK_ColorMAGENTA, SK_ColorYELLOW,
+                            SK_ColorGRAY, SK_ColorBLACK};
+  auto layer = std::make_shared<ContainerLayer>();
+  for (size_t i = 0; i < std::size(colors); i++) {
+    SkPath child_path;
+    child_path.addRect(SkRect::MakeXYWH(5.5f * i, 3.0f * i, 20.0f, 20.0f));
+    // The layer in the middle reads back from the surface, so it has to be
+    // painted on the calling thread between the concurrently recorded spans.
+    const bool reads_surface = i == 4;
+    SkPaint child_paint;
+    child_paint.setColor(colors[i]);
+    layer->Add(std::make_shared<MockLayer>(child_path, child_paint, false,
+                                           false, reads_surface));
+  }
+  SkMatrix initial_transform = SkMatrix::Translate(2.5f, 1.5f);
+  layer->Preroll(preroll_context(), initial_transform);
+
+  auto paint = [&](fml::ConcurrentTaskRunner* task_runner,
+                   size_t worker_count) {
+    sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(64, 64);
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->setMatrix(initial_transform);
+    Layer::PaintContext context = paint_context();
+    context.internal_nodes_canvas = canvas;
+    context.leaf_nodes_canvas = canvas;
+    context.concurrent_task_runner = task_runner;
+    context.concurrent_worker_count = worker_count;
+    layer->Paint(context);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    EXPECT_TRUE(surface->readPixels(bitmap, 0, 0));
+    return bitmap;
+  };
+
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  SkBitmap serial = paint(nullptr, 0);
+  SkBitmap concurrent = paint(task_runner.get(), loop->GetWorkerCount());
+  ASSERT_EQ(serial.computeByteSize(), concurrent.computeByteSize());
+  EXPECT_EQ(memcmp(serial.getPixels(), concurrent.getPixels(),
+                   serial.computeByteSize()),
+            0);
+}
+
+TEST_F(ContainerLayerTest, ConcurrentPaintOnlyKeepsLayersOverTexturesSerial) {
+  const int64_t texture_id = 0;
+  preroll_context()->texture_registry.RegisterTexture(
+      std::make_shared<MockTexture>(texture_id));
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(std::make_shared<TextureLayer>(
+      SkPoint::Make(0.0f, 0.0f), SkSize::Make(20.0f, 20.0f), texture_id, false,
+      SkSamplingOptions()));
+  // The first sibling overlaps the texture, the others are well clear of it.
+  for (size_t i = 0; i < 5; i++) {
+    SkPath child_path;
+    child_path.addRect(SkRect::MakeXYWH(i == 0 ? 10.0f : 100.0f + 30.0f * i,
+                                        10.0f, 20.0f, 20.0f));
+    layer->Add(std::make_shared<MockLayer>(child_path));
+  }
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_TRUE(preroll_context()->has_texture_layer);
+
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  Layer::PaintContext context = paint_context();
+  context.concurrent_task_runner = task_runner.get();
+  context.concurrent_worker_count = loop->GetWorkerCount();
+  layer->Paint(context);
+
+  // The overlapping sibling is painted directly, the four clear of the
+  // texture are recorded into two pictures.
+  size_t paths = 0;
+  size_t pictures = 0;
+  for (const auto& call : mock_canvas().draw_calls()) {
+    paths += std::holds_alternative<MockCanvas::DrawPathData>(call.data);
+    pictures += std::holds_alternative<MockCanvas::DrawPictureData>(call.data);
+  }
+  EXPECT_EQ(paths, 1u);
+  EXPECT_EQ(pictures, 2u);
+}
+
 #ifdef FLUTTER_ENABLE_DIFF_CONTEXT
 
 using ContainerLayerDiffTest = DiffContextTest;
@@ -0,0 +1,177 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/flow/layers/display_list_layer.h"
+
+#include "flutter/flow/testing/diff_context_test.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "flutter/fml/macros.h"
+#include "flutter/testing/mock_canvas.h"
+
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+#include "flutter/flow/raster_cache.h"
+#endif
+
+namespace flutter {
+namespace testing {
+
+using DisplayListLayerTest = SkiaGPUObjectLayerTest;
+
+#ifndef NDEBUG
+TEST_F(DisplayListLayerTest, PaintBeforePrerollInvalidDisplayListDies) {
+  const SkPoint layer_offset = SkPoint::Make(0.0f, 0.0f);
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject<DisplayList>(), false, false);
+
+  EXPECT_DEATH_IF_SUPPORTED(layer->Paint(paint_context()),
+                            "display_list_\\.get\\(\\)");
+}
+
+TEST_F(DisplayListLayerTest, PaintingEmptyLayerDies) {
+  const SkPoint layer_offset = SkPoint::Make(0.0f, 0.0f);
+  DisplayListBuilder builder(SkRect::MakeLTRB(5.0f, 6.0f, 20.5f, 21.5f));
+  auto display_list = builder.Build();
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject(display_list, unref_queue()), false, false);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(layer->paint_bounds(), SkRect::MakeEmpty());
+  EXPECT_FALSE(layer->needs_painting(paint_context()));
+
+  EXPECT_DEATH_IF_SUPPORTED(layer->Paint(paint_context()),
+                            "needs_painting\\(context\\)");
+}
+#endif
+
+TEST_F(DisplayListLayerTest, SimpleDisplayList) {
+  const SkPoint layer_offset = SkPoint::Make(1.5f, -0.5f);
+  const SkMatrix layer_offset_matrix =
+      SkMatrix::Translate(layer_offset.fX, layer_offset.fY);
+  const SkRect cull_rect = SkRect::MakeLTRB(0.0f, 0.0f, 50.0f, 50.0f);
+  const SkRect draw_rect = SkRect::MakeLTRB(5.0f, 6.0f, 20.5f, 21.5f);
+  const SkPaint paint(SkColors::kRed);
+  DisplayListBuilder builder(cull_rect);
+  builder.drawRect(draw_rect, paint);
+  auto display_list = builder.Build();
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject(display_list, unref_queue()), false, false);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  // The paint bounds are those of what is drawn, not the cull rect.
+  EXPECT_EQ(layer->paint_bounds(),
+            draw_rect.makeOffset(layer_offset.fX, layer_offset.fY));
+  EXPECT_EQ(layer->display_list(), display_list.get());
+  EXPECT_TRUE(layer->needs_painting(paint_context()));
+
+  layer->Paint(paint_context());
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{
+           1, MockCanvas::ConcatMatrixData{SkM44(layer_offset_matrix)}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           1, MockCanvas::SetMatrixData{SkM44(
+                  RasterCache::GetIntegralTransCTM(layer_offset_matrix))}},
+#endif
+       MockCanvas::DrawCall{1, MockCanvas::SaveData{2}},
+       MockCanvas::DrawCall{2, MockCanvas::DrawRectData{draw_rect, paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+
+using DisplayListLayerDiffTest = DiffContextTest;
+
+TEST_F(DisplayListLayerDiffTest, SimpleDisplayList) {
+  auto display_list = CreateDisplayList(SkRect::MakeLTRB(10, 10, 60, 60), 1);
+
+  MockLayerTree tree1;
+  tree1.root()->Add(CreateDisplayListLayer(display_list));
+
+  auto damage = DiffLayerTree(tree1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(10, 10, 60, 60));
+
+  MockLayerTree tree2;
+  tree2.root()->Add(CreateDisplayListLayer(display_list));
+
+  damage = DiffLayerTree(tree2, tree1);
+  EXPECT_TRUE(damage.frame_damage.isEmpty());
+
+  MockLayerTree tree3;
+  damage = DiffLayerTree(tree3, tree2);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(10, 10, 60, 60));
+}
+
+TEST_F(DisplayListLayerDiffTest, DisplayListCompare) {
+  MockLayerTree tree1;
+  auto display_list1 = CreateDisplayList(SkRect::MakeLTRB(10, 10, 60, 60), 1);
+  tree1.root()->Add(CreateDisplayListLayer(display_list1));
+
+  auto damage = DiffLayerTree(tree1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(10, 10, 60, 60));
+
+  MockLayerTree tree2;
+  auto display_list2 = CreateDisplayList(SkRect::MakeLTRB(10, 10, 60, 60), 1);
+  tree2.root()->Add(CreateDisplayListLayer(display_list2));
+
+  damage = DiffLayerTree(tree2, tree1);
+  EXPECT_TRUE(damage.frame_damage.isEmpty());
+
+  MockLayerTree tree3;
+  auto display_list3 = CreateDisplayList(SkRect::MakeLTRB(10, 10, 60, 60), 1);
+  // add offset
+  tree3.root()->Add(
+      CreateDisplayListLayer(display_list3, SkPoint::Make(10, 10)));
+
+  damage = DiffLayerTree(tree3, tree2);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(10, 10, 70, 70));
+
+  MockLayerTree tree4;
+  // different color
+  auto display_list4 = CreateDisplayList(SkRect::MakeLTRB(10, 10, 60, 60), 2);
+  tree4.root()->Add(
+      CreateDisplayListLayer(display_list4, SkPoint::Make(10, 10)));
+
+  damage = DiffLayerTree(tree4, tree3);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(20, 20, 70, 70));
+}
+
+TEST_F(DisplayListLayerDiffTest, ComplexDisplayListsAreCompared) {
+  // Pictures with more than a few ops are too complex to compare, display
+  // lists of any size are compared op by op.
+  auto create_display_list = [](SkColor last_color) {
+    DisplayListBuilder builder(SkRect::MakeLTRB(0, 0, 100, 100));
+    for (int i = 0; i < 50; i++) {
+      builder.drawRect(SkRect::MakeXYWH(i, i, 10, 10),
+                       SkPaint(SkColor4f::FromColor(
+                           i == 49 ? last_color : SK_ColorBLUE)));
+    }
+    return builder.Build();
+  };
+
+  MockLayerTree tree1;
+  tree1.root()->Add(CreateDisplayListLayer(create_display_list(SK_ColorRED)));
+  auto damage = DiffLayerTree(tree1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 59, 59));
+
+  MockLayerTree tree2;
+  tree2.root()->Add(CreateDisplayListLayer(create_display_list(SK_ColorRED)));
+  damage = DiffLayerTree(tree2, tree1);
+  EXPECT_TRUE(damage.frame_damage.isEmpty());
+
+  MockLayerTree tree3;
+  tree3.root()->Add(
+      CreateDisplayListLayer(create_display_list(SK_ColorGREEN)));
+  damage = DiffLayerTree(tree3, tree2);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 59, 59));
+}
+
+#endif
+
+}  // namespace testing
+}  // namespace flutter
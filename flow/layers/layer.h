@@ -15,6 +15,7 @@
 #include "flutter/flow/raster_cache.h"
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/compiler_specific.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/trace_event.h"
@@ -74,6 +75,7 @@ struct PrerollContext {
   bool has_texture_layer = false;
 };
 
+class DisplayListLayer;
 class PictureLayer;
 class PerformanceOverlayLayer;
 class TextureLayer;
@@ -161,6 +163,12 @@ class Layer {
     const RasterCache* raster_cache;
     const bool checkerboard_offscreen_layers;
     const float frame_device_pixel_ratio;
+
+    // The worker pool on which independent subtrees may be recorded
+    // concurrently, or null to paint every layer on the calling thread.
+    // See |ContainerLayer::PaintChildren|.
+    fml::ConcurrentTaskRunner* concurrent_task_runner = nullptr;
+    size_t concurrent_worker_count = 0;
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
@@ -246,6 +254,9 @@ class Layer {
 #ifdef FLUTTER_ENABLE_DIFF_CONTEXT
 
   virtual const PictureLayer* as_picture_layer() const { return nullptr; }
+  virtual const DisplayListLayer* as_display_list_layer() const {
+    return nullptr;
+  }
   virtual const TextureLayer* as_texture_layer() const { return nullptr; }
   virtual const PerformanceOverlayLayer* as_performance_overlay_layer() const {
     return nullptr;
@@ -112,6 +112,10 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
       ignore_raster_cache ? nullptr : &frame.context().raster_cache(),
       checkerboard_offscreen_layers_,
       device_pixel_ratio_};
+  context.concurrent_task_runner =
+      frame.context().concurrent_paint_task_runner();
+  context.concurrent_worker_count =
+      frame.context().concurrent_paint_worker_count();
 
   if (root_layer_->needs_painting(context)) {
     root_layer_->Paint(context);
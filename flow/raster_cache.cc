@@ -4,6 +4,7 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "flutter/common/constants.h"
@@ -12,10 +13,13 @@
 #include "flutter/fml/logging.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColorFilter.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkSurface.h"
 #include "third_party/skia/include/gpu/GrDirectContext.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+#include "third_party/skia/include/utils/SkPaintFilterCanvas.h"
 
 namespace flutter {
 
@@ -88,6 +92,183 @@ static bool IsPictureWorthRasterizing(SkPicture* picture,
   return picture->approximateOpCount() > 5;
 }
 
+static bool IsDisplayListWorthRasterizing(DisplayList* display_list,
+                                          bool will_change,
+                                          bool is_complex) {
+  if (will_change || display_list == nullptr) {
+    return false;
+  }
+
+  const SkRect bounds = display_list->bounds();
+  if (bounds.isEmpty() || !bounds.isFinite()) {
+    return false;
+  }
+
+  if (is_complex) {
+    return true;
+  }
+
+  // Same heuristic as for pictures, see |IsPictureWorthRasterizing|.
+  return display_list->op_count() > 5;
+}
+
+// Walks the draws made to it to find whether they can be rasterized into a
+// software surface on a thread other than the raster thread. Draws of texture
+// backed images cannot, as they would read the textures with a context that
+// belongs to the raster thread (or draw nothing at all). Shaders other than
+// colors, gradients and raster images may hide such images, so they are
+// assumed to need the raster thread too. The same goes for image filters,
+// mask filters and color filters other than blend modes and matrices, none of
+// which can be inspected for the images they draw.
+class OffThreadRasterizationChecker : public SkPaintFilterCanvas {
+ public:
+  explicit OffThreadRasterizationChecker(SkCanvas* canvas)
+      : SkPaintFilterCanvas(canvas) {}
+
+  bool can_rasterize_off_thread() const { return can_rasterize_off_thread_; }
+
+ protected:
+  // |SkPaintFilterCanvas|
+  bool onFilter(SkPaint& paint) const override {
+    CheckPaint(paint);
+    return true;
+  }
+
+  // |SkCanvas|
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    // Layer paints and backdrops are not passed to |onFilter|.
+    if (rec.fPaint) {
+      CheckPaint(*rec.fPaint);
+    }
+    if (rec.fBackdrop) {
+      can_rasterize_off_thread_ = false;
+    }
+    return SkPaintFilterCanvas::getSaveLayerStrategy(rec);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawImage2(const SkImage* image,
+                    SkScalar left,
+                    SkScalar top,
+                    const SkSamplingOptions& sampling,
+                    const SkPaint* paint) override {
+    CheckImage(image);
+    SkPaintFilterCanvas::onDrawImage2(image, left, top, sampling, paint);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawImageRect2(const SkImage* image,
+                        const SkRect& src,
+                        const SkRect& dst,
+                        const SkSamplingOptions& sampling,
+                        const SkPaint* paint,
+                        SrcRectConstraint constraint) override {
+    CheckImage(image);
+    SkPaintFilterCanvas::onDrawImageRect2(image, src, dst, sampling, paint,
+                                          constraint);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawImageLattice2(const SkImage* image,
+                           const Lattice& lattice,
+                           const SkRect& dst,
+                           SkFilterMode filter,
+                           const SkPaint* paint) override {
+    CheckImage(image);
+    SkPaintFilterCanvas::onDrawImageLattice2(image, lattice, dst, filter,
+                                             paint);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawAtlas2(const SkImage* atlas,
+                    const SkRSXform xform[],
+                    const SkRect src[],
+                    const SkColor colors[],
+                    int count,
+                    SkBlendMode mode,
+                    const SkSamplingOptions& sampling,
+                    const SkRect* cull,
+                    const SkPaint* paint) override {
+    CheckImage(atlas);
+    SkPaintFilterCanvas::onDrawAtlas2(atlas, xform, src, colors, count, mode,
+                                      sampling, cull, paint);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawEdgeAAImageSet2(const ImageSetEntry set[],
+                             int count,
+                             const SkPoint dst_clips[],
+                             const SkMatrix pre_view_matrices[],
+                             const SkSamplingOptions& sampling,
+                             const SkPaint* paint,
+                             SrcRectConstraint constraint) override {
+    for (int i = 0; i < count; i++) {
+      CheckImage(set[i].fImage.get());
+    }
+    SkPaintFilterCanvas::onDrawEdgeAAImageSet2(
+        set, count, dst_clips, pre_view_matrices, sampling, paint, constraint);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawPicture(const SkPicture* picture,
+                     const SkMatrix* matrix,
+                     const SkPaint* paint) override {
+    if (paint) {
+      CheckPaint(*paint);
+    }
+    // Play nested pictures back into this canvas rather than handing them to
+    // the wrapped canvas, so that their draws are checked too.
+    picture->playback(this);
+  }
+
+  // |SkPaintFilterCanvas|
+  void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+    // Drawables may draw anything when they are drawn.
+    can_rasterize_off_thread_ = false;
+  }
+
+ private:
+  mutable bool can_rasterize_off_thread_ = true;
+
+  void CheckImage(const SkImage* image) const {
+    if (image && image->isTextureBacked()) {
+      can_rasterize_off_thread_ = false;
+    }
+  }
+
+  void CheckPaint(const SkPaint& paint) const {
+    CheckShader(paint.getShader());
+    CheckColorFilter(paint.getColorFilter());
+    if (paint.getImageFilter() || paint.getMaskFilter()) {
+      can_rasterize_off_thread_ = false;
+    }
+  }
+
+  void CheckColorFilter(const SkColorFilter* color_filter) const {
+    if (color_filter == nullptr) {
+      return;
+    }
+    float matrix[20];
+    if (!color_filter->asAColorMode(nullptr, nullptr) &&
+        !color_filter->asAColorMatrix(matrix)) {
+      can_rasterize_off_thread_ = false;
+    }
+  }
+
+  void CheckShader(const SkShader* shader) const {
+    if (shader == nullptr) {
+      return;
+    }
+    if (SkImage* image = shader->isAImage(nullptr, nullptr)) {
+      CheckImage(image);
+      return;
+    }
+    if (shader->asAGradient(nullptr) == SkShader::kNone_GradientType) {
+      can_rasterize_off_thread_ = false;
+    }
+  }
+};
+
 /// @note Procedure doesn't copy all closures.
 static std::unique_ptr<RasterCacheResult> Rasterize(
     GrDirectContext* context,
@@ -121,8 +302,11 @@ static std::unique_ptr<RasterCacheResult> Rasterize(
     DrawCheckerboard(canvas, logical_rect);
   }
 
-  return std::make_unique<RasterCacheResult>(surface->makeImageSnapshot(),
-                                             logical_rect);
+  sk_sp<SkImage> image = surface->makeImageSnapshot();
+  if (!image) {
+    return nullptr;
+  }
+  return std::make_unique<RasterCacheResult>(std::move(image), logical_rect);
 }
 
 std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
@@ -136,6 +320,17 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
                    [=](SkCanvas* canvas) { canvas->drawPicture(picture); });
 }
 
+std::unique_ptr<RasterCacheResult> RasterCache::RasterizeDisplayList(
+    DisplayList* display_list,
+    GrDirectContext* context,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    bool checkerboard) const {
+  return Rasterize(
+      context, ctm, dst_color_space, checkerboard, display_list->bounds(),
+      [=](SkCanvas* canvas) { display_list->RenderTo(canvas); });
+}
+
 void RasterCache::Prepare(PrerollContext* context,
                           Layer* layer,
                           const SkMatrix& ctm) {
@@ -143,8 +338,10 @@ void RasterCache::Prepare(PrerollContext* context,
   Entry& entry = layer_cache_[cache_key];
   entry.access_count++;
   entry.used_this_frame = true;
-  if (!entry.image) {
-    entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
+  if (!entry.image && CanAdmit(entry)) {
+    Populate(entry, [&] {
+      return RasterizeLayer(context, layer, ctm, checkerboard_images_);
+    });
   }
 }
 
@@ -216,8 +413,88 @@ bool RasterCache::Prepare(GrDirectContext* context,
   }
 
   if (!entry.image) {
-    entry.image = RasterizePicture(picture, context, transformation_matrix,
-                                   dst_color_space, checkerboard_images_);
+    if (!CanAdmit(entry)) {
+      // The entry was evicted to stay within the byte budget and there is
+      // still no room for it.
+      return false;
+    }
+    auto draw_picture = [picture = sk_ref_sp(picture)](SkCanvas* canvas) {
+      canvas->drawPicture(picture);
+    };
+    if (ShouldPopulateAsync(entry, picture->cullRect(), draw_picture)) {
+      return PopulateAsync(entry, picture->cullRect(), std::move(draw_picture),
+                           transformation_matrix, dst_color_space);
+    }
+    Populate(entry, [&] {
+      return RasterizePicture(picture, context, transformation_matrix,
+                              dst_color_space, checkerboard_images_);
+    });
+    picture_cached_this_frame_++;
+  }
+  return true;
+}
+
+bool RasterCache::Prepare(GrDirectContext* context,
+                          DisplayList* display_list,
+                          const SkMatrix& transformation_matrix,
+                          SkColorSpace* dst_color_space,
+                          bool is_complex,
+                          bool will_change) {
+  // Disabling caching when access_threshold is zero is historic behavior.
+  if (access_threshold_ == 0) {
+    return false;
+  }
+  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+    return false;
+  }
+  if (!IsDisplayListWorthRasterizing(display_list, will_change, is_complex)) {
+    return false;
+  }
+
+  const MatrixDecomposition matrix(transformation_matrix);
+  if (!matrix.IsValid()) {
+    return false;
+  }
+
+  DisplayListRasterCacheKey cache_key(display_list->content_hash(),
+                                      transformation_matrix);
+
+  // Creates an entry, if not present prior.
+  Entry& entry = display_list_cache_[cache_key];
+  if (entry.display_list && !entry.display_list->Equals(*display_list)) {
+    // A different display list with the same hash. The latest one takes over
+    // the entry.
+    ResetEntry(entry);
+    entry.access_count = 0;
+    entry.display_list = nullptr;
+    entry.rasterize_on_raster_thread = false;
+  }
+  if (!entry.display_list) {
+    entry.display_list = sk_ref_sp(display_list);
+  }
+  if (entry.access_count < access_threshold_) {
+    // Frame threshold has not yet been reached.
+    return false;
+  }
+
+  if (!entry.image) {
+    if (!CanAdmit(entry)) {
+      return false;
+    }
+    auto render_display_list =
+        [display_list = sk_ref_sp(display_list)](SkCanvas* canvas) {
+          display_list->RenderTo(canvas);
+        };
+    if (ShouldPopulateAsync(entry, display_list->bounds(),
+                            render_display_list)) {
+      return PopulateAsync(entry, display_list->bounds(),
+                           std::move(render_display_list),
+                           transformation_matrix, dst_color_space);
+    }
+    Populate(entry, [&] {
+      return RasterizeDisplayList(display_list, context, transformation_matrix,
+                                  dst_color_space, checkerboard_images_);
+    });
     picture_cached_this_frame_++;
   }
   return true;
@@ -227,18 +504,49 @@ bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
   auto it = picture_cache_.find(cache_key);
   if (it == picture_cache_.end()) {
+    frame_misses_++;
+    return false;
+  }
+
+  Entry& entry = it->second;
+  entry.access_count++;
+  entry.used_this_frame = true;
+
+  if (entry.image) {
+    entry.image->draw(canvas, nullptr);
+    frame_hits_++;
+    return true;
+  }
+
+  frame_misses_++;
+  return false;
+}
+
+bool RasterCache::Draw(const DisplayList& display_list,
+                       SkCanvas& canvas) const {
+  DisplayListRasterCacheKey cache_key(display_list.content_hash(),
+                                      canvas.getTotalMatrix());
+  auto it = display_list_cache_.find(cache_key);
+  if (it == display_list_cache_.end()) {
+    frame_misses_++;
     return false;
   }
 
   Entry& entry = it->second;
+  if (!entry.display_list || !entry.display_list->Equals(display_list)) {
+    frame_misses_++;
+    return false;
+  }
   entry.access_count++;
   entry.used_this_frame = true;
 
   if (entry.image) {
     entry.image->draw(canvas, nullptr);
+    frame_hits_++;
     return true;
   }
 
+  frame_misses_++;
   return false;
 }
 
@@ -248,6 +556,7 @@ bool RasterCache::Draw(const Layer* layer,
   LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix());
   auto it = layer_cache_.find(cache_key);
   if (it == layer_cache_.end()) {
+    frame_misses_++;
     return false;
   }
 
@@ -257,26 +566,185 @@ bool RasterCache::Draw(const Layer* layer,
 
   if (entry.image) {
     entry.image->draw(canvas, paint);
+    frame_hits_++;
     return true;
   }
 
+  frame_misses_++;
   return false;
 }
 
+bool RasterCache::PopulateAsync(Entry& entry,
+                                const SkRect& logical_rect,
+                                std::function<void(SkCanvas*)> draw_function,
+                                const SkMatrix& ctm,
+                                SkColorSpace* dst_color_space) {
+  if (!entry.pending_image.valid()) {
+    auto promise = std::make_shared<std::promise<AsyncRasterization>>();
+    entry.pending_image = promise->get_future();
+    // The task must not reference the cache, which may be destroyed or
+    // cleared before the task runs.
+    async_rasterization_task_runner_->PostTask(
+        [promise, logical_rect, draw_function = std::move(draw_function), ctm,
+         dst_color_space = sk_ref_sp(dst_color_space),
+         checkerboard = checkerboard_images_]() {
+          const fml::TimePoint start = fml::TimePoint::Now();
+          AsyncRasterization result;
+          result.image = Rasterize(nullptr, ctm, dst_color_space.get(),
+                                   checkerboard, logical_rect, draw_function);
+          result.rasterize_time = fml::TimePoint::Now() - start;
+          promise->set_value(std::move(result));
+        });
+    picture_cached_this_frame_++;
+    return false;
+  }
+
+  if (entry.pending_image.wait_for(std::chrono::seconds(0)) !=
+      std::future_status::ready) {
+    // Keep drawing the picture uncached until the rasterization is done.
+    return false;
+  }
+
+  AsyncRasterization result = entry.pending_image.get();
+  if (!result.image) {
+    // Never cache a failed rasterization. The next |Prepare| rasterizes the
+    // entry on the raster thread instead.
+    entry.rasterize_on_raster_thread = true;
+    return false;
+  }
+  entry.image = std::move(result.image);
+  entry.rasterize_time = result.rasterize_time;
+  entry.image_bytes = entry.image->image_bytes();
+  cache_bytes_ += entry.image_bytes;
+  return true;
+}
+
+bool RasterCache::ShouldPopulateAsync(
+    Entry& entry,
+    const SkRect& logical_rect,
+    const std::function<void(SkCanvas*)>& draw_function) const {
+  if (!async_rasterization_task_runner_ || entry.rasterize_on_raster_thread) {
+    return false;
+  }
+  if (entry.pending_image.valid()) {
+    return true;
+  }
+  TRACE_EVENT0("flutter", "RasterCache::ShouldPopulateAsync");
+  const SkIRect bounds = logical_rect.roundOut();
+  SkNoDrawCanvas no_draw_canvas(bounds.width(), bounds.height());
+  OffThreadRasterizationChecker checker(&no_draw_canvas);
+  draw_function(&checker);
+  entry.rasterize_on_raster_thread = !checker.can_rasterize_off_thread();
+  return !entry.rasterize_on_raster_thread;
+}
+
+void RasterCache::ResetEntry(Entry& entry) {
+  if (entry.image) {
+    cache_bytes_ -= entry.image_bytes;
+    entry.image.reset();
+  }
+  entry.image_bytes = 0;
+  entry.rasterize_time = fml::TimeDelta::Zero();
+  // Dropping the future does not wait for the task, whose result is then
+  // discarded.
+  entry.pending_image = {};
+}
+
+double RasterCache::EvictionScore(const Entry& entry) {
+  // Entries that were too cheap to time still save a little; weigh them as if
+  // they took a microsecond so that larger ones are evicted first.
+  const double saved_micros =
+      std::max(entry.rasterize_time.ToMicrosecondsF(), 1.0);
+  return saved_micros / std::max<size_t>(entry.image_bytes, 1);
+}
+
+bool RasterCache::CanAdmit(const Entry& entry) const {
+  if (max_cache_bytes_ == 0) {
+    return true;
+  }
+  // A new entry's size is unknown until it has been rasterized. Admit it while
+  // there is room left and let |EvictToByteBudget| settle which entries stay.
+  // An entry that has been evicted before must fit as a whole so that it does
+  // not evict others only to be evicted again in the next frame.
+  if (entry.image_bytes == 0) {
+    return cache_bytes_ < max_cache_bytes_;
+  }
+  return cache_bytes_ + entry.image_bytes <= max_cache_bytes_;
+}
+
+void RasterCache::EvictToByteBudget() {
+  if (max_cache_bytes_ == 0 || cache_bytes_ <= max_cache_bytes_) {
+    return;
+  }
+
+  std::vector<Entry*> resident;
+  for (auto& item : picture_cache_) {
+    if (item.second.image) {
+      resident.push_back(&item.second);
+    }
+  }
+  for (auto& item : layer_cache_) {
+    if (item.second.image) {
+      resident.push_back(&item.second);
+    }
+  }
+  for (auto& item : display_list_cache_) {
+    if (item.second.image) {
+      resident.push_back(&item.second);
+    }
+  }
+
+  std::sort(resident.begin(), resident.end(),
+            [](const Entry* a, const Entry* b) {
+              if ((a->unused_frames > 0) != (b->unused_frames > 0)) {
+                return a->unused_frames > 0;
+              }
+              return EvictionScore(*a) < EvictionScore(*b);
+            });
+
+  for (Entry* entry : resident) {
+    if (cache_bytes_ <= max_cache_bytes_) {
+      break;
+    }
+    cache_bytes_ -= entry->image_bytes;
+    entry->image.reset();
+  }
+}
+
 void RasterCache::SweepAfterFrame() {
   SweepOneCacheAfterFrame(picture_cache_);
   SweepOneCacheAfterFrame(layer_cache_);
+  SweepOneCacheAfterFrame(display_list_cache_);
+  EvictToByteBudget();
   picture_cached_this_frame_ = 0;
+  last_frame_hits_ = frame_hits_.exchange(0);
+  last_frame_misses_ = frame_misses_.exchange(0);
   TraceStatsToTimeline();
 }
 
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  display_list_cache_.clear();
+  cache_bytes_ = 0;
+}
+
+void RasterCache::SetMaxCacheBytes(size_t max_bytes) {
+  max_cache_bytes_ = max_bytes;
+}
+
+void RasterCache::SetEvictionGraceFrames(size_t frames) {
+  eviction_grace_frames_ = frames;
+}
+
+void RasterCache::SetAsyncRasterizationTaskRunner(
+    std::shared_ptr<fml::BasicTaskRunner> task_runner) {
+  async_rasterization_task_runner_ = std::move(task_runner);
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
-  return layer_cache_.size() + picture_cache_.size();
+  return layer_cache_.size() + picture_cache_.size() +
+         display_list_cache_.size();
 }
 
 size_t RasterCache::GetLayerCachedEntriesCount() const {
@@ -284,7 +752,7 @@ size_t RasterCache::GetLayerCachedEntriesCount() const {
 }
 
 size_t RasterCache::GetPictureCachedEntriesCount() const {
-  return picture_cache_.size();
+  return picture_cache_.size() + display_list_cache_.size();
 }
 
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
@@ -304,7 +772,8 @@ void RasterCache::TraceStatsToTimeline() const {
   FML_TRACE_COUNTER("flutter", "RasterCache", reinterpret_cast<int64_t>(this),
                     "LayerCount", layer_cache_.size(), "LayerMBytes",
                     EstimateLayerCacheByteSize() / kMegaByteSizeInBytes,
-                    "PictureCount", picture_cache_.size(), "PictureMBytes",
+                    "PictureCount", GetPictureCachedEntriesCount(),
+                    "PictureMBytes",
                     EstimatePictureCacheByteSize() / kMegaByteSizeInBytes);
 
 #endif  // !FLUTTER_RELEASE
@@ -327,6 +796,11 @@ size_t RasterCache::EstimatePictureCacheByteSize() const {
       picture_cache_bytes += item.second.image->image_bytes();
     }
   }
+  for (const auto& item : display_list_cache_) {
+    if (item.second.image) {
+      picture_cache_bytes += item.second.image->image_bytes();
+    }
+  }
   return picture_cache_bytes;
 }
 
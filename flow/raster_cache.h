@@ -5,12 +5,19 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
+#include "flutter/flow/display_list.h"
 #include "flutter/flow/raster_cache_key.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_point.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -47,6 +54,10 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // The default byte budget for all raster cache entries. A budget of zero
+  // means the cache is only bounded by the number of entries used per frame.
+  static constexpr size_t kDefaultMaxCacheBytes = 0;
+
   explicit RasterCache(
       size_t access_threshold = 3,
       size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
@@ -75,6 +86,28 @@ class RasterCache {
       SkColorSpace* dst_color_space,
       bool checkerboard) const;
 
+  /**
+   * @brief Rasterize a display list and produce a RasterCacheResult
+   * to be stored in the cache.
+   *
+   * @param display_list the DisplayList to be cached.
+   * @param context the GrDirectContext used for rendering.
+   * @param ctm the transformation matrix used for rendering.
+   * @param dst_color_space the destination color space that the cached
+   *        rendering will be drawn into
+   * @param checkerboard a flag indicating whether or not a checkerboard
+   *        pattern should be rendered into the cached image for debug
+   *        analysis
+   * @return a RasterCacheResult that can draw the rendered display list into
+   *         the destination using a simple image blit
+   */
+  virtual std::unique_ptr<RasterCacheResult> RasterizeDisplayList(
+      DisplayList* display_list,
+      GrDirectContext* context,
+      const SkMatrix& ctm,
+      SkColorSpace* dst_color_space,
+      bool checkerboard) const;
+
   /**
    * @brief Rasterize an engine Layer and produce a RasterCacheResult
    * to be stored in the cache.
@@ -139,6 +172,16 @@ class RasterCache {
                bool is_complex,
                bool will_change);
 
+  // Like the |SkPicture| variant, except that display lists are keyed on
+  // their content instead of their identity, so that a display list that is
+  // recorded again without changes hits the entry of its predecessor.
+  bool Prepare(GrDirectContext* context,
+               DisplayList* display_list,
+               const SkMatrix& transformation_matrix,
+               SkColorSpace* dst_color_space,
+               bool is_complex,
+               bool will_change);
+
   void Prepare(PrerollContext* context, Layer* layer, const SkMatrix& ctm);
 
   // Find the raster cache for the picture and draw it to the canvas.
@@ -146,6 +189,12 @@ class RasterCache {
   // Return true if it's found and drawn.
   bool Draw(const SkPicture& picture, SkCanvas& canvas) const;
 
+  // Find the raster cache for the display list, or an equal one, and draw it
+  // to the canvas.
+  //
+  // Return true if it's found and drawn.
+  bool Draw(const DisplayList& display_list, SkCanvas& canvas) const;
+
   // Find the raster cache for the layer and draw it to the canvas.
   //
   // Additional paint can be given to change how the raster cache is drawn
@@ -166,11 +215,67 @@ class RasterCache {
 
   size_t GetLayerCachedEntriesCount() const;
 
+  // The number of picture and display list entries.
   size_t GetPictureCachedEntriesCount() const;
 
+  // The number of |Draw| calls in the last frame that drew a cached image,
+  // and the number of those that did not. Updated by |SweepAfterFrame|.
+  size_t GetLastFrameHitCount() const { return last_frame_hits_; }
+  size_t GetLastFrameMissCount() const { return last_frame_misses_; }
+
   /**
-   * @brief Estimate how much memory is used by picture raster cache entries in
-   * bytes.
+   * @brief Set the maximum number of bytes that the images of all cache
+   * entries may occupy.
+   *
+   * When the budget is exceeded, |SweepAfterFrame| evicts the entries that
+   * save the least raster time per byte until the cache fits again. Entries
+   * evicted this way are only re-admitted once there is room for them. A
+   * budget of zero disables byte-based eviction.
+   *
+   * @param max_bytes the byte budget for picture and layer entries combined.
+   */
+  void SetMaxCacheBytes(size_t max_bytes);
+
+  size_t GetMaxCacheBytes() const { return max_cache_bytes_; }
+
+  /**
+   * @brief Set the number of consecutive frames an entry may go unused before
+   * |SweepAfterFrame| removes it.
+   *
+   * The default of zero evicts an entry at the end of the first frame in which
+   * it was not drawn. A few frames of grace avoid re-rasterizing content that
+   * disappears only briefly (e.g. during a page transition).
+   */
+  void SetEvictionGraceFrames(size_t frames);
+
+  size_t GetEvictionGraceFrames() const { return eviction_grace_frames_; }
+
+  /**
+   * @brief Rasterize pictures that become eligible for caching on the given
+   * task runner instead of synchronously during Preroll.
+   *
+   * Pictures are rasterized into a software surface on the task runner and
+   * are drawn uncached until a later |Prepare| finds the result ready and
+   * swaps it into the cache. This trades a few frames of uncached drawing for
+   * never spending a frame's raster time on populating the cache. Layers are
+   * still rasterized synchronously since they can only be painted while
+   * their layer tree is alive on the raster thread, and so are pictures that
+   * draw texture backed images, which can only be read with the raster
+   * thread's context, and pictures whose async rasterization failed.
+   *
+   * @param task_runner the runner to rasterize pictures on, or null to
+   *        rasterize synchronously (the default).
+   */
+  void SetAsyncRasterizationTaskRunner(
+      std::shared_ptr<fml::BasicTaskRunner> task_runner);
+
+  bool IsAsyncRasterizationEnabled() const {
+    return async_rasterization_task_runner_ != nullptr;
+  }
+
+  /**
+   * @brief Estimate how much memory is used by picture and display list raster
+   * cache entries in bytes.
    *
    * Only SkImage's memory usage is counted as other objects are often much
    * smaller compared to SkImage. SkImageInfo::computeMinByteSize is used to
@@ -189,34 +294,121 @@ class RasterCache {
   size_t EstimateLayerCacheByteSize() const;
 
  private:
+  struct AsyncRasterization {
+    std::unique_ptr<RasterCacheResult> image;
+    fml::TimeDelta rasterize_time;
+  };
+
+  // |Draw| may be called concurrently for subtrees that are recorded on
+  // worker threads (see |ContainerLayer::PaintChildren|), so the bookkeeping
+  // it updates is atomic.
   struct Entry {
-    bool used_this_frame = false;
-    size_t access_count = 0;
+    std::atomic<bool> used_this_frame{false};
+    std::atomic<size_t> access_count{0};
+    // The number of consecutive frames at the end of which this entry had not
+    // been used.
+    size_t unused_frames = 0;
+    // How long it took to rasterize |image|. This is the estimate of the
+    // raster time saved in every frame that draws the entry from the cache.
+    fml::TimeDelta rasterize_time;
+    // The size of |image| in bytes. This is retained after the image is
+    // evicted to stay within the byte budget, so that the entry is only
+    // re-admitted once it fits.
+    size_t image_bytes = 0;
     std::unique_ptr<RasterCacheResult> image;
+    // The result of a rasterization that is in flight on the async
+    // rasterization task runner, if any.
+    std::future<AsyncRasterization> pending_image;
+    // Set once the content is known to need the raster thread's context,
+    // because it draws texture backed images or because rasterizing it on
+    // the async rasterization task runner failed.
+    bool rasterize_on_raster_thread = false;
+    // For display list entries, the display list the image was rasterized
+    // from. Entries are keyed on a hash of the content, which is checked
+    // against this on every lookup.
+    sk_sp<DisplayList> display_list;
   };
 
+  // The raster time saved per byte of cache memory by keeping |entry|.
+  static double EvictionScore(const Entry& entry);
+
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
+  void SweepOneCacheAfterFrame(Cache& cache) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
+      if (entry.used_this_frame) {
+        entry.unused_frames = 0;
+      } else if (++entry.unused_frames > eviction_grace_frames_) {
         dead.push_back(it);
       }
       entry.used_this_frame = false;
     }
 
     for (auto it : dead) {
+      if (it->second.image) {
+        cache_bytes_ -= it->second.image_bytes;
+      }
       cache.erase(it);
     }
   }
 
+  // Returns whether a new image for |entry| may be rasterized given the byte
+  // budget.
+  bool CanAdmit(const Entry& entry) const;
+
+  // Rasterizes |entry| with |rasterize| and accounts for its cost and size.
+  template <class Rasterizer>
+  void Populate(Entry& entry, const Rasterizer& rasterize) {
+    const fml::TimePoint start = fml::TimePoint::Now();
+    entry.image = rasterize();
+    entry.rasterize_time = fml::TimePoint::Now() - start;
+    entry.image_bytes = entry.image ? entry.image->image_bytes() : 0;
+    cache_bytes_ += entry.image_bytes;
+  }
+
+  // Starts rasterizing |draw_function| for |entry| on the async rasterization
+  // task runner, or swaps in the result once it is ready. |draw_function|
+  // must keep what it draws alive.
+  //
+  // Returns true if |entry| has an image after the call.
+  bool PopulateAsync(Entry& entry,
+                     const SkRect& logical_rect,
+                     std::function<void(SkCanvas*)> draw_function,
+                     const SkMatrix& ctm,
+                     SkColorSpace* dst_color_space);
+
+  // Returns whether |entry| is rasterized on the async rasterization task
+  // runner. The first time it is asked for an entry, this walks the draws of
+  // |draw_function| to check that rasterizing them into a software surface on
+  // another thread does not need the raster thread's GrDirectContext.
+  bool ShouldPopulateAsync(
+      Entry& entry,
+      const SkRect& logical_rect,
+      const std::function<void(SkCanvas*)>& draw_function) const;
+
+  // Drops the image of |entry|, including one that is still being rasterized.
+  void ResetEntry(Entry& entry);
+
+  // Evicts the images with the lowest |EvictionScore| until the cache fits in
+  // |max_cache_bytes_|. Entries not used in the last frame go first.
+  void EvictToByteBudget();
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
   size_t picture_cached_this_frame_ = 0;
+  size_t max_cache_bytes_ = kDefaultMaxCacheBytes;
+  size_t eviction_grace_frames_ = 0;
+  size_t cache_bytes_ = 0;
+  std::shared_ptr<fml::BasicTaskRunner> async_rasterization_task_runner_;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
+  mutable DisplayListRasterCacheKey::Map<Entry> display_list_cache_;
+  mutable std::atomic<size_t> frame_hits_{0};
+  mutable std::atomic<size_t> frame_misses_{0};
+  size_t last_frame_hits_ = 0;
+  size_t last_frame_misses_ = 0;
   bool checkerboard_images_;
 
   void TraceStatsToTimeline() const;
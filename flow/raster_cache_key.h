@@ -57,6 +57,9 @@ class Layer;
 // The ID is the uint64_t layer unique_id
 using LayerRasterCacheKey = RasterCacheKey<uint64_t>;
 
+// The ID is the uint64_t display list content_hash
+using DisplayListRasterCacheKey = RasterCacheKey<uint64_t>;
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_RASTER_CACHE_KEY_H_
@@ -9,11 +9,32 @@
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
 
 namespace flutter {
 namespace testing {
 namespace {
 
+// Holds on to posted tasks until the test runs them.
+class DeferredTaskRunner : public fml::BasicTaskRunner {
+ public:
+  void PostTask(const fml::closure& task) override { tasks_.push_back(task); }
+
+  size_t RunPendingTasks() {
+    std::vector<fml::closure> tasks;
+    std::swap(tasks, tasks_);
+    for (const auto& task : tasks) {
+      task();
+    }
+    return tasks.size();
+  }
+
+ private:
+  std::vector<fml::closure> tasks_;
+};
+
 sk_sp<SkPicture> GetSamplePicture() {
   SkPictureRecorder recorder;
   recorder.beginRecording(SkRect::MakeWH(150, 100));
@@ -65,6 +86,30 @@ TEST(RasterCache, ThresholdIsRespected) {
   ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, CountsHitsAndMissesOfTheLastFrame) {
+  flutter::RasterCache cache(1);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  EXPECT_EQ(cache.GetLastFrameHitCount(), 0u);
+  EXPECT_EQ(cache.GetLastFrameMissCount(), 1u);
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  EXPECT_EQ(cache.GetLastFrameHitCount(), 2u);
+  EXPECT_EQ(cache.GetLastFrameMissCount(), 0u);
+}
+
 TEST(RasterCache, AccessThresholdOfZeroDisablesCaching) {
   size_t threshold = 0;
   flutter::RasterCache cache(threshold);
@@ -132,6 +177,186 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, EvictionGraceFramesAreRespected) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetEvictionGraceFrames(2);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // 1st frame without access.
+  cache.SweepAfterFrame();  // 2nd frame without access.
+
+  // Still within the grace period. Drawing resets it.
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // 3rd frame without access.
+
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, ByteBudgetIsRespected) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  ASSERT_NE(picture1->uniqueID(), picture2->uniqueID());
+
+  // Room for one 150x100 N32 image, but not for two.
+  const size_t picture_bytes = 150 * 100 * 4;
+  cache.SetMaxCacheBytes(picture_bytes + picture_bytes / 2);
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  // Both are admitted while there is room left in the budget.
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2 * picture_bytes);
+
+  // The sweep evicts one of them to get back within the budget.
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), picture_bytes);
+
+  // The evicted entry is not re-admitted since it does not fit.
+  bool prepared1 =
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false);
+  bool prepared2 =
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false);
+  ASSERT_NE(prepared1, prepared2);
+  ASSERT_EQ(cache.Draw(*picture1, dummy_canvas), prepared1);
+  ASSERT_EQ(cache.Draw(*picture2, dummy_canvas), prepared2);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), picture_bytes);
+}
+
+TEST(RasterCache, AsyncRasterizationSwapsInWhenReady) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto task_runner = std::make_shared<DeferredTaskRunner>();
+  cache.SetAsyncRasterizationTaskRunner(task_runner);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(task_runner->RunPendingTasks(), 0u);
+
+  cache.SweepAfterFrame();
+
+  // The picture is eligible now, but is rasterized on the task runner.
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  // Not rasterized yet, so it is still drawn uncached and not posted again.
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(task_runner->RunPendingTasks(), 1u);
+
+  cache.SweepAfterFrame();
+
+  // The next frame swaps the result in.
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 150u * 100u * 4u);
+}
+
+TEST(RasterCache, PicturesWithTexturesAreRasterizedOnTheRasterThread) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto task_runner = std::make_shared<DeferredTaskRunner>();
+  cache.SetAsyncRasterizationTaskRunner(task_runner);
+
+  auto gr_context = GrDirectContext::MakeMock(nullptr);
+  ASSERT_TRUE(gr_context);
+  auto raster_surface = SkSurface::MakeRasterN32Premul(10, 10);
+  raster_surface->getCanvas()->clear(SK_ColorRED);
+  auto texture_image =
+      raster_surface->makeImageSnapshot()->makeTextureImage(gr_context.get());
+  ASSERT_TRUE(texture_image);
+  ASSERT_TRUE(texture_image->isTextureBacked());
+
+  // The pictures draw the texture directly, through a shader and through an
+  // image filter.
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(150, 100));
+  recorder.getRecordingCanvas()->drawImage(texture_image, 0, 0);
+  auto image_picture = recorder.finishRecordingAsPicture();
+  recorder.beginRecording(SkRect::MakeWH(150, 100));
+  SkPaint paint;
+  paint.setShader(texture_image->makeShader(SkSamplingOptions()));
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeWH(150, 100), paint);
+  auto shader_picture = recorder.finishRecordingAsPicture();
+  recorder.beginRecording(SkRect::MakeWH(150, 100));
+  SkPaint filter_paint;
+  filter_paint.setImageFilter(SkImageFilters::Image(texture_image));
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeWH(150, 100),
+                                          filter_paint);
+  auto filter_picture = recorder.finishRecordingAsPicture();
+
+  SkMatrix matrix = SkMatrix::I();
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  for (const auto& picture : {image_picture, shader_picture, filter_picture}) {
+    ASSERT_FALSE(cache.Prepare(gr_context.get(), picture.get(), matrix,
+                               srgb.get(), true, false));
+    cache.SweepAfterFrame();
+
+    // Eligible now, and rasterized right away with the raster thread's
+    // context instead of on the task runner.
+    ASSERT_TRUE(cache.Prepare(gr_context.get(), picture.get(), matrix,
+                              srgb.get(), true, false));
+    ASSERT_EQ(task_runner->RunPendingTasks(), 0u);
+    SkCanvas dummy_canvas;
+    ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+    cache.SweepAfterFrame();
+  }
+}
+
 // Construct a cache result whose device target rectangle rounds out to be one
 // pixel wider than the cached image.  Verify that it can be drawn without
 // triggering any assertions.
@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_SURFACE_FRAME_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -42,10 +43,46 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  // Information about the underlying framebuffer that is provided by the
+  // surface when the frame is acquired.
+  struct FramebufferInfo {
+    // Whether the surface can present only the damaged portion of the frame.
+    // When false, the whole frame is repainted and presented.
+    bool supports_partial_repaint = false;
+
+    // The area of the framebuffer that is stale relative to the most recently
+    // presented frame, in frame coordinates. An empty rect means that the
+    // framebuffer holds the last presented frame. std::nullopt means the
+    // content of the framebuffer is unknown and must be repainted in full.
+    std::optional<SkIRect> existing_damage;
+  };
+
+  void set_framebuffer_info(const FramebufferInfo& info) {
+    framebuffer_info_ = info;
+  }
+  const FramebufferInfo& framebuffer_info() const { return framebuffer_info_; }
+
+  // Information the rasterizer provides to the surface on submit.
+  struct SubmitInfo {
+    // The area that changed since the last presented frame, in surface
+    // coordinates. std::nullopt means the whole frame changed.
+    std::optional<SkIRect> frame_damage;
+
+    // The area of the framebuffer that was painted to this frame, in surface
+    // coordinates. This is the frame damage joined with the existing damage of
+    // the framebuffer. std::nullopt means the whole framebuffer was painted.
+    std::optional<SkIRect> buffer_damage;
+  };
+
+  void set_submit_info(const SubmitInfo& info) { submit_info_ = info; }
+  const SubmitInfo& submit_info() const { return submit_info_; }
+
  private:
   bool submitted_ = false;
   sk_sp<SkSurface> surface_;
   bool supports_readback_;
+  FramebufferInfo framebuffer_info_;
+  SubmitInfo submit_info_;
   SubmitCallback submit_callback_;
   std::unique_ptr<GLContextResult> context_result_;
 
@@ -38,6 +38,20 @@ std::shared_ptr<PictureLayer> DiffContextTest::CreatePictureLayer(
       offset, SkiaGPUObject(picture, unref_queue()), false, false);
 }
 
+sk_sp<DisplayList> DiffContextTest::CreateDisplayList(const SkRect& bounds,
+                                                     uint32_t color) {
+  DisplayListBuilder builder(bounds);
+  builder.drawRect(bounds, SkPaint(SkColor4f::FromBytes_RGBA(color)));
+  return builder.Build();
+}
+
+std::shared_ptr<DisplayListLayer> DiffContextTest::CreateDisplayListLayer(
+    sk_sp<DisplayList> display_list,
+    const SkPoint& offset) {
+  return std::make_shared<DisplayListLayer>(
+      offset, SkiaGPUObject(display_list, unref_queue()), false, false);
+}
+
 std::shared_ptr<ContainerLayer> DiffContextTest::CreateContainerLayer(
     std::initializer_list<std::shared_ptr<Layer>> layers) {
   auto res = std::make_shared<ContainerLayer>();
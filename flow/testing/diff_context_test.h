@@ -1,4 +1,5 @@
 #include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
 #include "flutter/flow/layers/picture_layer.h"
 #include "flutter/flow/testing/skia_gpu_object_layer_test.h"
 #include "third_party/skia/include/core/SkPicture.h"
@@ -44,6 +45,13 @@ class DiffContextTest : public ThreadTest {
       sk_sp<SkPicture> picture,
       const SkPoint& offset = SkPoint::Make(0, 0));
 
+  // Like |CreatePicture|, but recorded into a display list.
+  sk_sp<DisplayList> CreateDisplayList(const SkRect& bounds, uint32_t color);
+
+  std::shared_ptr<DisplayListLayer> CreateDisplayListLayer(
+      sk_sp<DisplayList> display_list,
+      const SkPoint& offset = SkPoint::Make(0, 0));
+
   std::shared_ptr<ContainerLayer> CreateContainerLayer(
       std::initializer_list<std::shared_ptr<Layer>> layers);
 
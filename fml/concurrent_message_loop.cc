@@ -17,19 +17,35 @@ std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
       new ConcurrentMessageLoop(worker_count)};
 }
 
+namespace {
+
+// How often each worker reports its utilization to the timeline.
+constexpr fml::TimeDelta kUtilizationReportInterval =
+    fml::TimeDelta::FromMilliseconds(100);
+
+// The loop and index of the worker running on the current thread, if any.
+struct CurrentWorker {
+  const ConcurrentMessageLoop* loop = nullptr;
+  size_t index = 0;
+};
+
+thread_local CurrentWorker tCurrentWorker;
+
+}  // namespace
+
 ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  for (size_t i = 0; i < worker_count_; ++i) {
+    worker_queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      WorkerMain(i);
     });
   }
-
-  for (const auto& worker : workers_) {
-    worker_thread_ids_.emplace_back(worker.get_id());
-  }
 }
 
 ConcurrentMessageLoop::~ConcurrentMessageLoop() {
@@ -47,63 +63,167 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(const fml::closure& task,
+                                     ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
   // Don't just drop tasks on the floor in case of shutdown.
   if (shutdown_) {
     FML_DLOG(WARNING)
         << "Tried to post a task to shutdown concurrent message "
            "loop. The task will be executed on the callers thread.";
-    lock.unlock();
     task();
     return;
   }
 
-  tasks_.push(task);
+  // Tasks posted by a worker are likely to be related to what it is running
+  // now, so they go to its own queue. Other workers steal them if it stays
+  // busy.
+  const size_t worker_index =
+      tCurrentWorker.loop == this
+          ? tCurrentWorker.index
+          : next_worker_queue_.fetch_add(1, std::memory_order_relaxed) %
+                worker_count_;
+  auto& worker_queue = *worker_queues_[worker_index];
+  {
+    std::scoped_lock lock(worker_queue.mutex);
+    worker_queue.tasks[static_cast<size_t>(priority)].push_back(task);
+    worker_queue.task_counts[static_cast<size_t>(priority)]++;
+  }
+  pending_task_count_++;
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+  // The loop may have been terminated since shutdown was checked above.
+  // Workers read the shutdown flag before they look for tasks one last time,
+  // so either they see this task or it sees the flag. In the latter case the
+  // remaining tasks are run here instead of being dropped.
+  if (shutdown_) {
+    bool stolen = false;
+    while (fml::closure queued_task = TakeTask(worker_index, &stolen)) {
+      queued_task();
+    }
+    return;
+  }
 
-  tasks_condition_.notify_one();
+  // Idle workers count themselves as idle before checking for pending tasks,
+  // so either they see this task or the task sees them.
+  if (idle_worker_count_ > 0) {
+    WakeUpIdleWorker();
+  }
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
-  while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
-    });
-
-    // Shutdown cannot be read with the task mutex unlocked.
-    bool shutdown_now = shutdown_;
-    fml::closure task;
-    std::vector<fml::closure> thread_tasks;
+void ConcurrentMessageLoop::WakeUpIdleWorker() {
+  {
+    // Idle workers hold this mutex from the time they check for tasks until
+    // they wait on the condition variable. Acquiring it makes sure that the
+    // notification is not sent in between.
+    std::scoped_lock lock(idle_mutex_);
+  }
+  idle_condition_.notify_one();
+}
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+fml::closure ConcurrentMessageLoop::TakeTask(size_t worker_index,
+                                             bool* stolen) {
+  *stolen = false;
+  if (pending_task_count_ == 0) {
+    return nullptr;
+  }
+  // The worker's own queue is the only one it takes a lock on while it has
+  // work, so busy workers do not contend with each other.
+  auto& own_queue = *worker_queues_[worker_index];
+  for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+    if (fml::closure task = PopTask(own_queue, priority)) {
+      return task;
+    }
+  }
+  for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+    for (size_t offset = 1; offset < worker_count_; ++offset) {
+      auto& worker_queue =
+          *worker_queues_[(worker_index + offset) % worker_count_];
+      if (fml::closure task = PopTask(worker_queue, priority)) {
+        *stolen = true;
+        return task;
+      }
     }
+  }
+  return nullptr;
+}
 
-    if (HasThreadTasksLocked()) {
-      thread_tasks = GetThreadTasksLocked();
-      FML_DCHECK(!HasThreadTasksLocked());
+fml::closure ConcurrentMessageLoop::PopTask(WorkerQueue& worker_queue,
+                                            size_t priority) {
+  if (worker_queue.task_counts[priority] == 0) {
+    return nullptr;
+  }
+  std::scoped_lock lock(worker_queue.mutex);
+  auto& tasks = worker_queue.tasks[priority];
+  if (tasks.empty()) {
+    return nullptr;
+  }
+  fml::closure task = std::move(tasks.front());
+  tasks.pop_front();
+  worker_queue.task_counts[priority]--;
+  pending_task_count_--;
+  return task;
+}
+
+std::vector<fml::closure> ConcurrentMessageLoop::TakeThreadTasks(
+    size_t worker_index) {
+  auto& worker_queue = *worker_queues_[worker_index];
+  std::vector<fml::closure> thread_tasks;
+  std::scoped_lock lock(worker_queue.mutex);
+  std::swap(thread_tasks, worker_queue.thread_tasks);
+  return thread_tasks;
+}
+
+void ConcurrentMessageLoop::WaitForTasks(size_t worker_index) {
+  auto& worker_queue = *worker_queues_[worker_index];
+  std::unique_lock lock(idle_mutex_);
+  idle_worker_count_++;
+  idle_condition_.wait(lock, [&]() {
+    if (shutdown_ || pending_task_count_ > 0) {
+      return true;
     }
+    std::scoped_lock worker_lock(worker_queue.mutex);
+    return !worker_queue.thread_tasks.empty();
+  });
+  idle_worker_count_--;
+}
 
-    // Don't hold onto the mutex while tasks are being executed as they could
-    // themselves try to post more tasks to the message loop.
-    lock.unlock();
+void ConcurrentMessageLoop::WorkerMain(size_t worker_index) {
+  tCurrentWorker.loop = this;
+  tCurrentWorker.index = worker_index;
+  auto& worker_queue = *worker_queues_[worker_index];
+  worker_queue.report_start = fml::TimePoint::Now();
+
+  while (true) {
+    // Shutdown is read before taking tasks so that the ones posted before
+    // shutdown are still run. Tasks posted while the loop is terminated are
+    // either taken here or run by the thread that posted them.
+    const bool shutdown_now = shutdown_;
+
+    bool stolen = false;
+    fml::closure task = TakeTask(worker_index, &stolen);
+    if (stolen) {
+      worker_queue.tasks_stolen++;
+    }
+    std::vector<fml::closure> thread_tasks = TakeThreadTasks(worker_index);
+
+    if (!task && thread_tasks.empty()) {
+      if (shutdown_now) {
+        break;
+      }
+      WaitForTasks(worker_index);
+      continue;
+    }
 
     TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
+    const auto start = fml::TimePoint::Now();
+
     // Execute the primary task we woke up for.
     if (task) {
       task();
+      worker_queue.tasks_run++;
     }
 
     // Execute any thread tasks.
@@ -111,16 +231,36 @@ void ConcurrentMessageLoop::WorkerMain() {
       thread_task();
     }
 
-    if (shutdown_now) {
-      break;
-    }
+    worker_queue.busy_time =
+        worker_queue.busy_time + (fml::TimePoint::Now() - start);
+    ReportUtilization(worker_queue, worker_index);
   }
 }
 
+void ConcurrentMessageLoop::ReportUtilization(WorkerQueue& worker_queue,
+                                              size_t worker_index) {
+  const auto now = fml::TimePoint::Now();
+  const auto elapsed = now - worker_queue.report_start;
+  if (elapsed < kUtilizationReportInterval) {
+    return;
+  }
+  FML_TRACE_COUNTER("flutter", "ConcurrentWorkerUtilization",
+                    reinterpret_cast<int64_t>(&worker_queue), "Worker",
+                    worker_index + 1, "BusyPercent",
+                    worker_queue.busy_time.ToMicroseconds() * 100 /
+                        elapsed.ToMicroseconds(),
+                    "TasksRun", worker_queue.tasks_run, "TasksStolen",
+                    worker_queue.tasks_stolen);
+  worker_queue.report_start = now;
+  worker_queue.busy_time = fml::TimeDelta::Zero();
+  worker_queue.tasks_run = 0;
+  worker_queue.tasks_stolen = 0;
+}
+
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
+  std::scoped_lock lock(idle_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  idle_condition_.notify_all();
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,24 +268,12 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  for (auto& worker_queue : worker_queues_) {
+    std::scoped_lock lock(worker_queue->mutex);
+    worker_queue->thread_tasks.emplace_back(task);
   }
-  tasks_condition_.notify_all();
-}
-
-bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
-  return thread_tasks_.count(std::this_thread::get_id()) > 0;
-}
-
-std::vector<fml::closure> ConcurrentMessageLoop::GetThreadTasksLocked() {
-  auto found = thread_tasks_.find(std::this_thread::get_id());
-  FML_DCHECK(found != thread_tasks_.end());
-  std::vector<fml::closure> pending_tasks;
-  std::swap(pending_tasks, found->second);
-  thread_tasks_.erase(found);
-  return pending_tasks;
+  std::scoped_lock lock(idle_mutex_);
+  idle_condition_.notify_all();
 }
 
 ConcurrentTaskRunner::ConcurrentTaskRunner(
@@ -159,8 +287,18 @@ void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
     return;
   }
 
+  PostTaskWithPriority(task, ConcurrentTaskPriority::kNormal);
+}
+
+void ConcurrentTaskRunner::PostTaskWithPriority(
+    const fml::closure& task,
+    ConcurrentTaskPriority priority) {
+  if (!task) {
+    return;
+  }
+
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(task, priority);
     return;
   }
 
@@ -5,19 +5,37 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <map>
-#include <queue>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
 
 namespace fml {
 
 class ConcurrentTaskRunner;
 
+// Workers of a concurrent message loop pick up the tasks of a higher priority
+// in their own queue before any task of a lower priority that has not been
+// started yet. Once their own queue is empty, they steal the highest priority
+// tasks of the other workers.
+enum class ConcurrentTaskPriority {
+  // Work something is waiting on right now, like recording a layer subtree
+  // for the frame being rasterized.
+  kHigh,
+  kNormal,
+  // Work nothing is waiting on, like prefetching.
+  kLow,
+};
+
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
@@ -37,24 +55,64 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  static constexpr size_t kPriorityCount = 3;
+
+  // The tasks queued on a single worker. Each worker runs the tasks in its own
+  // queue first and steals tasks from the other workers once it runs out, so
+  // workers only contend when one of them is out of work.
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<fml::closure> tasks[kPriorityCount];
+    std::vector<fml::closure> thread_tasks;
+    // The number of tasks in each of |tasks|, so that workers looking for
+    // tasks can skip empty queues without locking them.
+    std::atomic<size_t> task_counts[kPriorityCount] = {};
+
+    // Utilization since the last report to the timeline. Only accessed by the
+    // worker thread.
+    fml::TimePoint report_start;
+    fml::TimeDelta busy_time;
+    size_t tasks_run = 0;
+    size_t tasks_stolen = 0;
+  };
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
-  std::vector<std::thread::id> worker_thread_ids_;
-  std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  // The queue tasks posted from outside the workers go to next.
+  std::atomic<size_t> next_worker_queue_ = 0;
+  // The number of tasks in all worker queues.
+  std::atomic<size_t> pending_task_count_ = 0;
+  std::atomic<size_t> idle_worker_count_ = 0;
+  // Idle workers wait on |idle_condition_|. Only threads posting tasks while
+  // some worker is idle need |idle_mutex_|.
+  std::mutex idle_mutex_;
+  std::condition_variable idle_condition_;
+  std::atomic_bool shutdown_ = false;
 
   ConcurrentMessageLoop(size_t worker_count);
 
-  void WorkerMain();
+  void WorkerMain(size_t worker_index);
+
+  void PostTask(const fml::closure& task, ConcurrentTaskPriority priority);
 
-  void PostTask(const fml::closure& task);
+  // Returns the highest priority task queued on the given worker or, if there
+  // is none, the highest priority task queued on any other worker. Returns
+  // nullptr if there are no tasks. |stolen| is set when the task was taken
+  // from another worker.
+  fml::closure TakeTask(size_t worker_index, bool* stolen);
 
-  bool HasThreadTasksLocked() const;
+  // Returns the oldest task of the priority in the queue, or nullptr.
+  fml::closure PopTask(WorkerQueue& worker_queue, size_t priority);
 
-  std::vector<fml::closure> GetThreadTasksLocked();
+  std::vector<fml::closure> TakeThreadTasks(size_t worker_index);
+
+  // Blocks until there may be tasks to run or the loop is terminated.
+  void WaitForTasks(size_t worker_index);
+
+  void WakeUpIdleWorker();
+
+  void ReportUtilization(WorkerQueue& worker_queue, size_t worker_index);
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
@@ -65,8 +123,12 @@ class ConcurrentTaskRunner : public BasicTaskRunner {
 
   virtual ~ConcurrentTaskRunner();
 
+  // |BasicTaskRunner|
   void PostTask(const fml::closure& task) override;
 
+  void PostTaskWithPriority(const fml::closure& task,
+                            ConcurrentTaskPriority priority);
+
  private:
   friend ConcurrentMessageLoop;
 
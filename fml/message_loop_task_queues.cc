@@ -6,6 +6,7 @@
 
 #include "flutter/fml/message_loop_task_queues.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "flutter/fml/make_copyable.h"
@@ -19,10 +20,27 @@ const size_t TaskQueueId::kUnmerged = ULONG_MAX;
 
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::instance_;
 
+namespace {
+
+// Whether the queue has tasks in its timer heap or waiting to be moved there.
+bool HasTasks(TaskQueueEntry& entry) {
+  std::scoped_lock lock(entry.delayed_tasks_mutex, entry.submission_mutex);
+  return !entry.delayed_tasks.empty() || !entry.incoming_tasks.empty();
+}
+
+size_t CountTasks(TaskQueueEntry& entry) {
+  std::scoped_lock lock(entry.delayed_tasks_mutex, entry.submission_mutex);
+  return entry.delayed_tasks.size() + entry.incoming_tasks.size();
+}
+
+}  // namespace
+
 TaskQueueEntry::TaskQueueEntry()
     : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
   wakeable = NULL;
   task_observers = TaskObservers();
+  earliest_incoming_time = fml::TimePoint::Max();
+  wake_time = fml::TimePoint::Max();
   delayed_tasks = DelayedTaskQueue();
 }
 
@@ -35,7 +53,7 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
   ++task_queue_id_counter_;
   queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
@@ -43,12 +61,14 @@ TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : queue_meta_mutex_(fml::SharedMutex::Create()),
+      task_queue_id_counter_(0),
+      order_(0) {}
 
 MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
@@ -59,79 +79,150 @@ void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entry->delayed_tasks = {};
+  std::vector<TaskQueueEntry*> entries = {queue_entry.get()};
   if (subsumed != _kUnmerged) {
-    queue_entries_.at(subsumed)->delayed_tasks = {};
+    entries.push_back(queue_entries_.at(subsumed).get());
+  }
+  for (auto* entry : entries) {
+    std::scoped_lock tasks_lock(entry->delayed_tasks_mutex,
+                                entry->submission_mutex);
+    entry->delayed_tasks = {};
+    entry->incoming_tasks.clear();
+    entry->earliest_incoming_time = fml::TimePoint::Max();
   }
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
                                          const fml::closure& task,
                                          fml::TimePoint target_time) {
-  std::lock_guard guard(queue_mutex_);
-  size_t order = order_++;
+  fml::SharedLock lock(*queue_meta_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
-  queue_entry->delayed_tasks.push({order, task, target_time});
-  TaskQueueId loop_to_wake = queue_id;
-  if (queue_entry->subsumed_by != _kUnmerged) {
-    loop_to_wake = queue_entry->subsumed_by;
+  const TaskQueueId owner = queue_entry->subsumed_by;
+  {
+    std::scoped_lock submission_lock(queue_entry->submission_mutex);
+    queue_entry->incoming_tasks.emplace_back(order_++, task, target_time);
+    queue_entry->earliest_incoming_time =
+        std::min(queue_entry->earliest_incoming_time, target_time);
+    if (owner == _kUnmerged) {
+      WakeUpLocked(*queue_entry, target_time);
+      return;
+    }
   }
-  WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
+  // The owner runs the tasks of this queue while they are merged. It only
+  // takes its own submission mutex to look at the incoming tasks of this
+  // queue after it has drained them, so waking it up after the task is
+  // visible cannot leave it asleep past |target_time|.
+  const auto& owner_entry = queue_entries_.at(owner);
+  std::scoped_lock owner_submission_lock(owner_entry->submission_mutex);
+  WakeUpLocked(*owner_entry, target_time);
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_meta_mutex_);
   return HasPendingTasksUnlocked(queue_id);
 }
 
 fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
                                                      fml::TimePoint from_time) {
-  std::lock_guard guard(queue_mutex_);
-  if (!HasPendingTasksUnlocked(queue_id)) {
+  fml::SharedLock lock(*queue_meta_mutex_);
+  const auto& entry = queue_entries_.at(queue_id);
+  if (entry->subsumed_by != _kUnmerged) {
     return nullptr;
   }
-  TaskQueueId top_queue = _kUnmerged;
-  const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
+  TaskQueueEntry* subsumed_entry = GetSubsumedEntryUnlocked(*entry);
+
+  std::unique_lock owner_tasks_lock(entry->delayed_tasks_mutex);
+  std::unique_lock<std::mutex> subsumed_tasks_lock;
+  DrainIncomingTasksLocked(*entry);
+  bool has_tasks = !entry->delayed_tasks.empty();
+  if (subsumed_entry) {
+    subsumed_tasks_lock =
+        std::unique_lock<std::mutex>(subsumed_entry->delayed_tasks_mutex);
+    DrainIncomingTasksLocked(*subsumed_entry);
+    has_tasks = has_tasks || !subsumed_entry->delayed_tasks.empty();
+  }
 
-  if (!HasPendingTasksUnlocked(queue_id)) {
-    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
-  } else {
-    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
+  TaskQueueId top_queue = _kUnmerged;
+  const DelayedTask* top =
+      has_tasks ? &PeekNextTaskLocked(queue_id, top_queue) : nullptr;
+
+  {
+    // Tasks registered after the heaps were drained have either woken the
+    // loop up already or will do so once they get this lock.
+    std::scoped_lock submission_lock(entry->submission_mutex);
+    fml::TimePoint earliest_incoming = entry->earliest_incoming_time;
+    if (subsumed_entry) {
+      std::scoped_lock subsumed_submission_lock(
+          subsumed_entry->submission_mutex);
+      earliest_incoming = std::min(earliest_incoming,
+                                   subsumed_entry->earliest_incoming_time);
+    }
+    if (!top) {
+      entry->wake_time = earliest_incoming;
+      return nullptr;
+    }
+    entry->wake_time = std::min(top->GetTargetTime(), earliest_incoming);
+    if (entry->wakeable) {
+      entry->wakeable->WakeUp(entry->wake_time);
+    }
   }
 
-  if (top.GetTargetTime() > from_time) {
+  if (top->GetTargetTime() > from_time) {
     return nullptr;
   }
-  fml::closure invocation = top.GetTask();
+  fml::closure invocation = top->GetTask();
   queue_entries_.at(top_queue)->delayed_tasks.pop();
   return invocation;
 }
 
-void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
-                                           fml::TimePoint time) const {
-  if (queue_entries_.at(queue_id)->wakeable) {
-    queue_entries_.at(queue_id)->wakeable->WakeUp(time);
+void MessageLoopTaskQueues::WakeUpLocked(TaskQueueEntry& entry,
+                                         fml::TimePoint time) {
+  entry.wake_time = std::min(entry.wake_time, time);
+  if (entry.wakeable) {
+    entry.wakeable->WakeUp(entry.wake_time);
   }
 }
 
+void MessageLoopTaskQueues::DrainIncomingTasksLocked(TaskQueueEntry& entry) {
+  std::vector<DelayedTask> incoming_tasks;
+  {
+    std::scoped_lock submission_lock(entry.submission_mutex);
+    if (entry.incoming_tasks.empty()) {
+      return;
+    }
+    incoming_tasks.swap(entry.incoming_tasks);
+    entry.earliest_incoming_time = fml::TimePoint::Max();
+  }
+  for (auto& task : incoming_tasks) {
+    entry.delayed_tasks.push(std::move(task));
+  }
+}
+
+TaskQueueEntry* MessageLoopTaskQueues::GetSubsumedEntryUnlocked(
+    const TaskQueueEntry& owner) const {
+  if (owner.owner_of == _kUnmerged) {
+    return nullptr;
+  }
+  return queue_entries_.at(owner.owner_of).get();
+}
+
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_meta_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   if (queue_entry->subsumed_by != _kUnmerged) {
     return 0;
   }
 
   size_t total_tasks = 0;
-  total_tasks += queue_entry->delayed_tasks.size();
+  total_tasks += CountTasks(*queue_entry);
 
-  TaskQueueId subsumed = queue_entry->owner_of;
-  if (subsumed != _kUnmerged) {
-    const auto& subsumed_entry = queue_entries_.at(subsumed);
-    total_tasks += subsumed_entry->delayed_tasks.size();
+  TaskQueueEntry* subsumed_entry = GetSubsumedEntryUnlocked(*queue_entry);
+  if (subsumed_entry) {
+    total_tasks += CountTasks(*subsumed_entry);
   }
   return total_tasks;
 }
@@ -139,20 +230,20 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
   queue_entries_.at(queue_id)->task_observers[key] = callback;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   queue_entries_.at(queue_id)->task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_meta_mutex_);
   std::vector<fml::closure> observers;
 
   if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
@@ -175,7 +266,7 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
       << "Wakeable can only be set once.";
   queue_entries_.at(queue_id)->wakeable = wakeable;
@@ -185,7 +276,7 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   auto& owner_entry = queue_entries_.at(owner);
   auto& subsumed_entry = queue_entries_.at(subsumed);
 
@@ -207,14 +298,14 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   subsumed_entry->subsumed_by = owner;
 
   if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
+    ResetWakeUpUnlocked(owner);
   }
 
   return true;
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_meta_mutex_);
   const auto& owner_entry = queue_entries_.at(owner);
   const TaskQueueId subsumed = owner_entry->owner_of;
   if (subsumed == _kUnmerged) {
@@ -225,11 +316,11 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
   owner_entry->owner_of = _kUnmerged;
 
   if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
+    ResetWakeUpUnlocked(owner);
   }
 
   if (HasPendingTasksUnlocked(subsumed)) {
-    WakeUpUnlocked(subsumed, GetNextWakeTimeUnlocked(subsumed));
+    ResetWakeUpUnlocked(subsumed);
   }
 
   return true;
@@ -237,14 +328,14 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_meta_mutex_);
   return owner != _kUnmerged && subsumed != _kUnmerged &&
          subsumed == queue_entries_.at(owner)->owner_of;
 }
 
 TaskQueueId MessageLoopTaskQueues::GetSubsumedTaskQueueId(
     TaskQueueId owner) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_meta_mutex_);
   return queue_entries_.at(owner)->owner_of;
 }
 
@@ -258,32 +349,49 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     return false;
   }
 
-  if (!entry->delayed_tasks.empty()) {
+  if (HasTasks(*entry)) {
     return true;
   }
 
-  const TaskQueueId subsumed = entry->owner_of;
-  if (subsumed == _kUnmerged) {
+  TaskQueueEntry* subsumed_entry = GetSubsumedEntryUnlocked(*entry);
+  if (!subsumed_entry) {
     // this is not an owner and queue is empty.
     return false;
   } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+    return HasTasks(*subsumed_entry);
   }
 }
 
-fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
-    TaskQueueId queue_id) const {
+void MessageLoopTaskQueues::ResetWakeUpUnlocked(TaskQueueId queue_id) {
+  const auto& entry = queue_entries_.at(queue_id);
+  TaskQueueEntry* subsumed_entry = GetSubsumedEntryUnlocked(*entry);
+
+  std::scoped_lock owner_tasks_lock(entry->delayed_tasks_mutex);
+  DrainIncomingTasksLocked(*entry);
+  std::unique_lock<std::mutex> subsumed_tasks_lock;
+  if (subsumed_entry) {
+    subsumed_tasks_lock =
+        std::unique_lock<std::mutex>(subsumed_entry->delayed_tasks_mutex);
+    DrainIncomingTasksLocked(*subsumed_entry);
+  }
+
   TaskQueueId tmp = _kUnmerged;
-  return PeekNextTaskUnlocked(queue_id, tmp).GetTargetTime();
+  const fml::TimePoint next_wake_time =
+      PeekNextTaskLocked(queue_id, tmp).GetTargetTime();
+  std::scoped_lock submission_lock(entry->submission_mutex);
+  entry->wake_time = next_wake_time;
+  if (entry->wakeable) {
+    entry->wakeable->WakeUp(next_wake_time);
+  }
 }
 
-const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
+const DelayedTask& MessageLoopTaskQueues::PeekNextTaskLocked(
     TaskQueueId owner,
     TaskQueueId& top_queue_id) const {
-  FML_DCHECK(HasPendingTasksUnlocked(owner));
   const auto& entry = queue_entries_.at(owner);
   const TaskQueueId subsumed = entry->owner_of;
   if (subsumed == _kUnmerged) {
+    FML_DCHECK(!entry->delayed_tasks.empty());
     top_queue_id = owner;
     return entry->delayed_tasks.top();
   }
@@ -294,9 +402,10 @@ const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
   // we are owning another task queue
   const bool subsumed_has_task = !subsumed_tasks.empty();
   const bool owner_has_task = !owner_tasks.empty();
+  FML_DCHECK(owner_has_task || subsumed_has_task);
   if (owner_has_task && subsumed_has_task) {
-    const auto owner_task = owner_tasks.top();
-    const auto subsumed_task = subsumed_tasks.top();
+    const auto& owner_task = owner_tasks.top();
+    const auto& subsumed_task = subsumed_tasks.top();
     if (owner_task > subsumed_task) {
       top_queue_id = subsumed;
     } else {
@@ -6,6 +6,7 @@
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -39,6 +40,21 @@ class TaskQueueEntry {
   using TaskObservers = std::map<intptr_t, fml::closure>;
   Wakeable* wakeable;
   TaskObservers task_observers;
+
+  // Tasks registered since the thread running this queue last looked at it.
+  // Each queue has its own |submission_mutex|, so threads posting to different
+  // queues never contend with each other.
+  std::mutex submission_mutex;
+  std::vector<DelayedTask> incoming_tasks;
+  fml::TimePoint earliest_incoming_time;
+  // The time the wakeable of this queue was last asked to wake up at. Guarded
+  // by |submission_mutex|.
+  fml::TimePoint wake_time;
+
+  // The timer heap. Incoming tasks are only moved into it and popped from it
+  // by the thread running the queue. Other threads only take
+  // |delayed_tasks_mutex| to count or discard tasks.
+  std::mutex delayed_tasks_mutex;
   DelayedTaskQueue delayed_tasks;
 
   // Note: Both of these can be _kUnmerged, which indicates that
@@ -133,19 +149,35 @@ class MessageLoopTaskQueues
 
   ~MessageLoopTaskQueues();
 
-  void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
+  // Asks the wakeable of the queue to wake up at |time| or at the time it was
+  // already going to wake up at, whichever is earlier. Requires the
+  // |submission_mutex| of the entry.
+  static void WakeUpLocked(TaskQueueEntry& entry, fml::TimePoint time);
+
+  // Moves the incoming tasks of the queue into its timer heap. Requires the
+  // |delayed_tasks_mutex| of the entry.
+  static void DrainIncomingTasksLocked(TaskQueueEntry& entry);
+
+  // Returns the entry subsumed by the owner, or nullptr.
+  TaskQueueEntry* GetSubsumedEntryUnlocked(const TaskQueueEntry& owner) const;
 
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
-  const DelayedTask& PeekNextTaskUnlocked(TaskQueueId owner,
-                                          TaskQueueId& top_queue_id) const;
+  // Requires the |delayed_tasks_mutex| of the owner and of the queue it owns,
+  // if any, with their incoming tasks drained.
+  const DelayedTask& PeekNextTaskLocked(TaskQueueId owner,
+                                        TaskQueueId& top_queue_id) const;
 
-  fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
+  // Recomputes the wake up time of a queue from all of its tasks and those of
+  // the queue it owns. Requires an exclusive lock on |queue_meta_mutex_|.
+  void ResetWakeUpUnlocked(TaskQueueId queue_id);
 
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
+  // Guards the set of queues and how they are merged. Registering and running
+  // tasks only takes a shared lock; the per-queue mutexes guard the tasks.
+  std::unique_ptr<fml::SharedMutex> queue_meta_mutex_;
   std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
 
   size_t task_queue_id_counter_;
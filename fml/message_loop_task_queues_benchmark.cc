@@ -66,5 +66,95 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Posts tasks from |state.range(0)| threads to a fixed set of queues while a
+// thread per queue runs them, the way the platform, UI, raster and IO threads
+// and the worker pool post to each other. With |merge_queues|, the first queue
+// owns the second one and runs its tasks too, as with merged platform and
+// raster threads.
+static void RegisterTasksFromMultipleThreads(benchmark::State& state,
+                                             bool merge_queues) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  const int num_posting_threads = state.range(0);
+  const int num_task_queues = 4;
+  const int num_tasks_per_thread = 1000;
+  const int num_tasks_per_queue =
+      num_posting_threads * num_tasks_per_thread / num_task_queues;
+  const fml::TimePoint past = fml::TimePoint::Now();
+
+  std::vector<TaskQueueId> queue_ids;
+  for (int i = 0; i < num_task_queues; i++) {
+    queue_ids.push_back(task_queue->CreateTaskQueue());
+  }
+  if (merge_queues) {
+    task_queue->Merge(queue_ids[0], queue_ids[1]);
+  }
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_task_queues; i++) {
+      if (merge_queues && i == 1) {
+        continue;
+      }
+      const int num_tasks =
+          (merge_queues && i == 0) ? 2 * num_tasks_per_queue
+                                   : num_tasks_per_queue;
+      threads.emplace_back([queue_id = queue_ids[i], num_tasks, &task_queue]() {
+        int num_invocations = 0;
+        while (num_invocations < num_tasks) {
+          fml::closure invocation =
+              task_queue->GetNextTaskToRun(queue_id, fml::TimePoint::Now());
+          if (invocation) {
+            num_invocations++;
+          }
+        }
+      });
+    }
+
+    for (int i = 0; i < num_posting_threads; i++) {
+      threads.emplace_back([thread_index = i, &queue_ids, &task_queue, past]() {
+        for (int j = 0; j < num_tasks_per_thread; j++) {
+          task_queue->RegisterTask(
+              queue_ids[(thread_index + j) % num_task_queues], [] {}, past);
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_posting_threads *
+                          num_tasks_per_thread);
+
+  for (int i = 0; i < num_task_queues; i++) {
+    if (merge_queues && i == 1) {
+      continue;
+    }
+    task_queue->Dispose(queue_ids[i]);
+  }
+}
+
+static void BM_RegisterTasksFromMultipleThreads(
+    benchmark::State& state) {  // NOLINT
+  RegisterTasksFromMultipleThreads(state, false);
+}
+
+static void BM_RegisterTasksFromMultipleThreadsToMergedQueues(
+    benchmark::State& state) {  // NOLINT
+  RegisterTasksFromMultipleThreads(state, true);
+}
+
+BENCHMARK(BM_RegisterTasksFromMultipleThreads)
+    ->RangeMultiplier(2)
+    ->Range(4, 16)
+    ->UseRealTime();
+BENCHMARK(BM_RegisterTasksFromMultipleThreadsToMergedQueues)
+    ->RangeMultiplier(2)
+    ->Range(4, 16)
+    ->UseRealTime();
+
 }  // namespace benchmarking
 }  // namespace fml
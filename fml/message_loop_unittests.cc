@@ -316,3 +316,95 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsHigherPriorityTasksFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent worker_blocked, unblock_worker;
+  task_runner->PostTask([&]() {
+    worker_blocked.Signal();
+    unblock_worker.Wait();
+  });
+  worker_blocked.Wait();
+
+  std::vector<std::string> order;
+  fml::CountDownLatch latch(3);
+  auto record = [&](std::string name) {
+    return [&order, &latch, name]() {
+      order.push_back(name);
+      latch.CountDown();
+    };
+  };
+  task_runner->PostTaskWithPriority(record("low"),
+                                    fml::ConcurrentTaskPriority::kLow);
+  task_runner->PostTask(record("normal"));
+  task_runner->PostTaskWithPriority(record("high"),
+                                    fml::ConcurrentTaskPriority::kHigh);
+  unblock_worker.Signal();
+  latch.Wait();
+
+  ASSERT_EQ(order, (std::vector<std::string>{"high", "normal", "low"}));
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopWorkersStealQueuedTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2u);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent stolen_task_ran, done;
+  std::thread::id posting_thread, stolen_thread;
+  bool timed_out = false;
+  task_runner->PostTask([&]() {
+    posting_thread = std::this_thread::get_id();
+    // Tasks posted by a worker go to its own queue. This worker stays busy
+    // until the task has run, so another worker has to steal it.
+    task_runner->PostTask([&]() {
+      stolen_thread = std::this_thread::get_id();
+      stolen_task_ran.Signal();
+    });
+    timed_out =
+        stolen_task_ran.WaitWithTimeout(fml::TimeDelta::FromSeconds(5));
+    done.Signal();
+  });
+  done.Wait();
+  ASSERT_FALSE(timed_out);
+  ASSERT_NE(posting_thread, stolen_thread);
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksQueuedBeforeTermination) {
+  bool queued_task_ran = false;
+  bool late_task_ran = false;
+  {
+    auto loop = fml::ConcurrentMessageLoop::Create(1u);
+    auto task_runner = loop->GetTaskRunner();
+    fml::AutoResetWaitableEvent worker_blocked, unblock_worker;
+    task_runner->PostTask([&]() {
+      worker_blocked.Signal();
+      unblock_worker.Wait();
+    });
+    worker_blocked.Wait();
+
+    task_runner->PostTask([&]() { queued_task_ran = true; });
+    loop->Terminate();
+    // Tasks posted after termination run on the thread that posts them.
+    task_runner->PostTask([&]() { late_task_ran = true; });
+    ASSERT_TRUE(late_task_ran);
+    unblock_worker.Signal();
+  }
+  ASSERT_TRUE(queued_task_ran);
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPostedToAllWorkersOnEach) {
+  const size_t kWorkerCount = 4;
+  auto loop = fml::ConcurrentMessageLoop::Create(kWorkerCount);
+  fml::CountDownLatch latch(kWorkerCount);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    {
+      std::scoped_lock lock(thread_ids_mutex);
+      thread_ids.insert(std::this_thread::get_id());
+    }
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), kWorkerCount);
+}
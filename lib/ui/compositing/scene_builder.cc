@@ -10,6 +10,7 @@
 #include "flutter/flow/layers/clip_rrect_layer.h"
 #include "flutter/flow/layers/color_filter_layer.h"
 #include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
 #include "flutter/flow/layers/image_filter_layer.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/layers/layer_tree.h"
@@ -274,6 +275,13 @@ void SceneBuilder::addPicture(double dx,
                               double dy,
                               Picture* picture,
                               int hints) {
+  if (auto display_list = picture->display_list()) {
+    AddLayer(std::make_unique<flutter::DisplayListLayer>(
+        SkPoint::Make(dx, dy),
+        UIDartState::CreateGPUObject(std::move(display_list)), !!(hints & 1),
+        !!(hints & 2)));
+    return;
+  }
   auto layer = std::make_unique<flutter::PictureLayer>(
       SkPoint::Make(dx, dy), UIDartState::CreateGPUObject(picture->picture()),
       !!(hints & 1), !!(hints & 2));
@@ -11,6 +11,9 @@
 #include "third_party/skia/include/gpu/GrDirectContext.h"
 
 namespace flutter {
+
+class ImageUploadBatcher;
+
 // Interface for methods that manage access to the resource GrDirectContext and
 // Skia unref queue.  Meant to be implemented by the owner of the resource
 // GrDirectContext, i.e. the shell's IOManager.
@@ -25,6 +28,10 @@ class IOManager {
   virtual fml::RefPtr<flutter::SkiaUnrefQueue> GetSkiaUnrefQueue() const = 0;
 
   virtual std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch() = 0;
+
+  // Uploads decoded images to the resource context in batches. Must only be
+  // used on the IO task runner.
+  virtual fml::RefPtr<ImageUploadBatcher> GetImageUploadBatcher() const = 0;
 };
 
 }  // namespace flutter
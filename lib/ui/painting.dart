@@ -5281,6 +5281,57 @@ class ImageDescriptor extends NativeFieldWrapperClass2 {
     return codec;
   }
   void _instantiateCodec(Codec outCodec, int targetWidth, int targetHeight) native 'ImageDescriptor_instantiateCodec';
+
+  /// Decodes the part of the image inside `region` to an [Image].
+  ///
+  /// The region is in pixels of the image, is rounded out to whole pixels and
+  /// must be inside the image. The resulting image is `targetWidth` by
+  /// `targetHeight` pixels. If only one of them is specified, the other is
+  /// scaled according to the aspect ratio of the region; if neither is, the
+  /// image is the size of the region.
+  ///
+  /// For codecs that support it, only the parts of the encoded data covering
+  /// the region are decoded, at the lowest resolution that is still at least
+  /// as large as the target. This allows tiles of very large images, such as
+  /// maps or scanned documents, to be shown with memory proportional to what
+  /// is on screen. Decoded tiles are cached by the engine.
+  Future<Image> decodeRegion(Rect region, {int? targetWidth, int? targetHeight}) {
+    final int left = region.left.floor();
+    final int top = region.top.floor();
+    final int right = region.right.ceil();
+    final int bottom = region.bottom.ceil();
+    final int regionWidth = right - left;
+    final int regionHeight = bottom - top;
+    if (regionWidth <= 0 || regionHeight <= 0)
+      throw Exception('Invalid region.');
+
+    if (targetWidth != null && targetWidth <= 0) {
+      targetWidth = null;
+    }
+    if (targetHeight != null && targetHeight <= 0) {
+      targetHeight = null;
+    }
+
+    if (targetWidth == null && targetHeight == null) {
+      targetWidth = regionWidth;
+      targetHeight = regionHeight;
+    } else if (targetWidth == null && targetHeight != null) {
+      targetWidth = math.max(1, (targetHeight * regionWidth / regionHeight).round());
+    } else if (targetHeight == null && targetWidth != null) {
+      targetHeight = math.max(1, (targetWidth * regionHeight / regionWidth).round());
+    }
+
+    return _futurize(
+      (_Callback<Image?> callback) => _decodeRegion((_Image? image) {
+        if (image == null) {
+          callback(null);
+        } else {
+          callback(Image._(image));
+        }
+      }, left, top, right, bottom, targetWidth!, targetHeight!),
+    );
+  }
+  String? _decodeRegion(_Callback<_Image?> callback, int left, int top, int right, int bottom, int targetWidth, int targetHeight) native 'ImageDescriptor_decodeRegion';
 }
 
 /// Generic callback signature, used by [_futurize].
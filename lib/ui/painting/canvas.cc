@@ -82,13 +82,16 @@ fml::RefPtr<Canvas> Canvas::Create(PictureRecorder* recorder,
         ToDart("Canvas constructor called with non-genuine PictureRecorder."));
     return nullptr;
   }
+  SkCanvas* recording_canvas =
+      recorder->BeginRecording(SkRect::MakeLTRB(left, top, right, bottom));
   fml::RefPtr<Canvas> canvas = fml::MakeRefCounted<Canvas>(
-      recorder->BeginRecording(SkRect::MakeLTRB(left, top, right, bottom)));
+      recording_canvas, recorder->display_list_builder());
   recorder->set_canvas(canvas);
   return canvas;
 }
 
-Canvas::Canvas(SkCanvas* canvas) : canvas_(canvas) {}
+Canvas::Canvas(SkCanvas* canvas, DisplayListBuilder* display_list_builder)
+    : canvas_(canvas), display_list_builder_(display_list_builder) {}
 
 Canvas::~Canvas() {}
 
@@ -396,6 +399,14 @@ void Canvas::drawPicture(Picture* picture) {
         ToDart("Canvas.drawPicture called with non-genuine Picture."));
     return;
   }
+  if (auto display_list = picture->display_list()) {
+    if (display_list_builder_) {
+      display_list_builder_->drawDisplayList(std::move(display_list));
+    } else {
+      canvas_->drawPicture(display_list->ToSkPicture());
+    }
+    return;
+  }
   canvas_->drawPicture(picture->picture().get());
 }
 
@@ -472,6 +483,9 @@ void Canvas::drawShadow(const CanvasPath* path,
                         SkColor color,
                         double elevation,
                         bool transparentOccluder) {
+  if (!canvas_) {
+    return;
+  }
   if (!path) {
     Dart_ThrowException(
         ToDart("Canvas.drawShader called with non-genuine Path."));
@@ -482,12 +496,19 @@ void Canvas::drawShadow(const CanvasPath* path,
                      ->get_window(0)
                      ->viewport_metrics()
                      .device_pixel_ratio;
+  if (display_list_builder_) {
+    // Shadows have no |SkCanvas| call the recording canvas could capture.
+    display_list_builder_->drawShadow(path->path(), color, elevation,
+                                      transparentOccluder, dpr);
+    return;
+  }
   flutter::PhysicalShapeLayer::DrawShadow(canvas_, path->path(), color,
                                           elevation, transparentOccluder, dpr);
 }
 
 void Canvas::Invalidate() {
   canvas_ = nullptr;
+  display_list_builder_ = nullptr;
   if (dart_wrapper()) {
     ClearDartWrapper();
   }
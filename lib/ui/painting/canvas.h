@@ -174,12 +174,17 @@ class Canvas : public RefCountedDartWrappable<Canvas> {
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
 
  private:
-  explicit Canvas(SkCanvas* canvas);
+  explicit Canvas(SkCanvas* canvas,
+                  DisplayListBuilder* display_list_builder = nullptr);
 
   // The SkCanvas is supplied by a call to SkPictureRecorder::beginRecording,
   // which does not transfer ownership.  For this reason, we hold a raw
   // pointer and manually set to null in Clear.
   SkCanvas* canvas_;
+
+  // The builder behind |canvas_| when the recorder records a display list.
+  // Owned by the recorder like |canvas_|.
+  DisplayListBuilder* display_list_builder_;
 };
 
 }  // namespace flutter
@@ -7,6 +7,8 @@
 #include <algorithm>
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/lib/ui/painting/image_decoder_cache.h"
+#include "flutter/lib/ui/painting/image_upload_batcher.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 
 namespace flutter {
@@ -150,6 +152,19 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
       return ResizeRasterImage(std::move(decoded_image), resized_dimensions,
                                flow);
     }
+  } else if (!resized_dimensions.isEmpty()) {
+    // Otherwise, codecs that decode a row at a time (PNG, GIF, BMP...) can
+    // skip rows and columns, as long as the image stays at least as large as
+    // the target.
+    const int sample_size =
+        std::min(source_dimensions.width() / resized_dimensions.width(),
+                 source_dimensions.height() / resized_dimensions.height());
+    if (sample_size > 1) {
+      if (auto sampled_image = descriptor->sampled_image(sample_size)) {
+        return ResizeRasterImage(std::move(sampled_image), resized_dimensions,
+                                 flow);
+      }
+    }
   }
 
   auto image = descriptor->image();
@@ -160,66 +175,77 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
   return ResizeRasterImage(std::move(image), resized_dimensions, flow);
 }
 
-static SkiaGPUObject<SkImage> UploadRasterImage(
-    sk_sp<SkImage> image,
-    fml::WeakPtr<IOManager> io_manager,
-    const fml::tracing::TraceFlow& flow) {
+sk_sp<SkImage> ImageRegionFromData(ImageDescriptor* descriptor,
+                                   const SkIRect& region,
+                                   uint32_t target_width,
+                                   uint32_t target_height,
+                                   const fml::tracing::TraceFlow& flow) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   flow.Step(__FUNCTION__);
 
-  // Should not already be a texture image because that is the entire point of
-  // the this method.
-  FML_DCHECK(!image->isTextureBacked());
+  if (region.isEmpty() ||
+      !SkIRect::MakeSize(descriptor->image_info().dimensions())
+           .contains(region)) {
+    FML_LOG(ERROR) << "Region is not inside the image.";
+    return nullptr;
+  }
 
-  if (!io_manager->GetResourceContext() || !io_manager->GetSkiaUnrefQueue()) {
-    FML_LOG(ERROR)
-        << "Could not acquire context of release queue for texture upload.";
-    return {};
+  const SkISize resized_dimensions =
+      target_width && target_height
+          ? SkISize::Make(target_width, target_height)
+          : region.size();
+
+  sk_sp<SkImage> image;
+  if (descriptor->is_compressed()) {
+    // Skip as many pixels as possible while keeping the region at least as
+    // large as the target.
+    const int sample_size =
+        std::max(std::min(region.width() / resized_dimensions.width(),
+                          region.height() / resized_dimensions.height()),
+                 1);
+    image = descriptor->region_image(region, sample_size);
+    if (!image) {
+      // The codec cannot decode regions, so decode everything.
+      image = descriptor->image();
+      image = image ? image->makeSubset(region) : nullptr;
+    }
+  } else {
+    image = SkImage::MakeRasterData(descriptor->image_info(),
+                                    descriptor->data(),
+                                    descriptor->row_bytes());
+    image = image ? image->makeSubset(region) : nullptr;
   }
 
-  SkPixmap pixmap;
-  if (!image->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Could not peek pixels of image for texture upload.";
-    return {};
+  if (!image) {
+    return nullptr;
   }
 
-  SkiaGPUObject<SkImage> result;
-  io_manager->GetIsGpuDisabledSyncSwitch()->Execute(
-      fml::SyncSwitch::Handlers()
-          .SetIfTrue([&result, &pixmap, &image] {
-            SkSafeRef(image.get());
-            sk_sp<SkImage> texture_image = SkImage::MakeFromRaster(
-                pixmap,
-                [](const void* pixels, SkImage::ReleaseContext context) {
-                  SkSafeUnref(static_cast<SkImage*>(context));
-                },
-                image.get());
-            result = {std::move(texture_image), nullptr};
-          })
-          .SetIfFalse([&result, context = io_manager->GetResourceContext(),
-                       &pixmap, queue = io_manager->GetSkiaUnrefQueue()] {
-            TRACE_EVENT0("flutter", "MakeCrossContextImageFromPixmap");
-            sk_sp<SkImage> texture_image = SkImage::MakeCrossContextFromPixmap(
-                context.get(),  // context
-                pixmap,         // pixmap
-                true,           // buildMips,
-                true            // limitToMaxTextureSize
-            );
-            if (!texture_image) {
-              FML_LOG(ERROR) << "Could not make x-context image.";
-              result = {};
-            } else {
-              result = {std::move(texture_image), queue};
-            }
-          }));
-
-  return result;
+  return ResizeRasterImage(std::move(image), resized_dimensions, flow);
 }
 
-void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
+void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
                           uint32_t target_width,
                           uint32_t target_height,
                           const ImageResult& callback) {
+  DecodeImage(std::move(descriptor), std::nullopt, target_width,
+              target_height, callback);
+}
+
+void ImageDecoder::DecodeRegion(fml::RefPtr<ImageDescriptor> descriptor,
+                                const SkIRect& region,
+                                uint32_t target_width,
+                                uint32_t target_height,
+                                const ImageResult& callback) {
+  DecodeImage(std::move(descriptor), region, target_width, target_height,
+              callback);
+}
+
+void ImageDecoder::DecodeImage(
+    fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
+    std::optional<SkIRect> region,
+    uint32_t target_width,
+    uint32_t target_height,
+    const ImageResult& callback) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   fml::tracing::TraceFlow flow(__FUNCTION__);
 
@@ -268,22 +294,39 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
                          io_manager = io_manager_,                //
                          io_runner = runners_.GetIOTaskRunner(),  //
                          result,                                  //
+                         region = region,                         //
                          target_width = target_width,             //
                          target_height = target_height,           //
                          flow = std::move(flow)                   //
   ]() mutable {
-        // Step 1: Decompress the image.
+        // Step 1: Decompress the image or the region of it, unless the same
+        // data was decoded to the same size before.
         // On Worker.
 
-        auto decompressed = raw_descriptor->is_compressed()
-                                ? ImageFromCompressedData(raw_descriptor,  //
-                                                          target_width,    //
-                                                          target_height,   //
-                                                          flow)
-                                : ImageFromDecompressedData(raw_descriptor,  //
-                                                            target_width,    //
-                                                            target_height,   //
-                                                            flow);
+        ImageDecoderCache& cache = ImageDecoderCache::GetInstance();
+        ImageDecoderCache::Key key(*raw_descriptor, target_width,
+                                   target_height, region);
+        sk_sp<SkImage> decompressed = cache.GetImage(key);
+        if (!decompressed) {
+          if (region) {
+            decompressed = ImageRegionFromData(raw_descriptor,  //
+                                               *region,         //
+                                               target_width,    //
+                                               target_height,   //
+                                               flow);
+          } else if (raw_descriptor->is_compressed()) {
+            decompressed = ImageFromCompressedData(raw_descriptor,  //
+                                                   target_width,    //
+                                                   target_height,   //
+                                                   flow);
+          } else {
+            decompressed = ImageFromDecompressedData(raw_descriptor,  //
+                                                     target_width,    //
+                                                     target_height,   //
+                                                     flow);
+          }
+          cache.PutImage(key, decompressed);
+        }
 
         if (!decompressed) {
           FML_LOG(ERROR) << "Could not decompress image.";
@@ -291,10 +334,13 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
           return;
         }
 
-        // Step 2: Update the image to the GPU.
+        // Step 2: Update the image to the GPU, unless it was uploaded with
+        // the same resource context before. Uploads are batched with the
+        // other images decoded at about the same time.
         // On IO Thread.
 
-        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, key,
+                                               result,
                                                flow =
                                                    std::move(flow)]() mutable {
           if (!io_manager) {
@@ -306,23 +352,45 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
           // If the IO manager does not have a resource context, the caller
           // might not have set one or a software backend could be in use.
           // Either way, just return the image as-is.
-          if (!io_manager->GetResourceContext()) {
+          auto context = io_manager->GetResourceContext();
+          if (!context) {
             result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
                    std::move(flow));
             return;
           }
 
-          auto uploaded =
-              UploadRasterImage(std::move(decompressed), io_manager, flow);
-
-          if (!uploaded.get()) {
-            FML_LOG(ERROR) << "Could not upload image to the GPU.";
-            result({}, std::move(flow));
+          // Textures that are already uploaded do not wait for a batch.
+          ImageDecoderCache& cache = ImageDecoderCache::GetInstance();
+          auto cached = cache.GetTexture(key, context.get());
+          if (cached.get()) {
+            result(std::move(cached), std::move(flow));
             return;
           }
 
-          // Finally, all done.
-          result(std::move(uploaded), std::move(flow));
+          auto on_upload = fml::MakeCopyable(
+              [io_manager, key, context, result,
+               flow = std::move(flow)](sk_sp<SkImage> uploaded,
+                                       bool cross_context) mutable {
+                if (!uploaded || !io_manager) {
+                  FML_LOG(ERROR) << "Could not upload image to the GPU.";
+                  result({}, std::move(flow));
+                  return;
+                }
+                auto queue = io_manager->GetSkiaUnrefQueue();
+
+                // Images that were not uploaded, for example because the GPU
+                // was disabled, are not kept as textures.
+                if (cross_context && context) {
+                  ImageDecoderCache::GetInstance().PutTexture(
+                      key, context.get(), uploaded, queue);
+                }
+
+                // Finally, all done.
+                result({std::move(uploaded), std::move(queue)},
+                       std::move(flow));
+              });
+          io_manager->GetImageUploadBatcher()->Upload(std::move(decompressed),
+                                                      std::move(on_upload));
         }));
       }));
 }
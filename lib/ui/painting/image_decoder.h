@@ -19,6 +19,7 @@
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -50,6 +51,17 @@ class ImageDecoder {
               uint32_t target_height,
               const ImageResult& result);
 
+  // Like |Decode|, but only decodes the pixels of the descriptor inside
+  // |region| and scales them to the target size. Codecs that support it only
+  // decode the parts of the data covering the region, at the lowest
+  // resolution still at least as large as the target, so tiles of very large
+  // images cost memory proportional to the tile.
+  void DecodeRegion(fml::RefPtr<ImageDescriptor> descriptor,
+                    const SkIRect& region,
+                    uint32_t target_width,
+                    uint32_t target_height,
+                    const ImageResult& result);
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
@@ -58,6 +70,12 @@ class ImageDecoder {
   fml::WeakPtr<IOManager> io_manager_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
+  void DecodeImage(fml::RefPtr<ImageDescriptor> descriptor,
+                   std::optional<SkIRect> region,
+                   uint32_t target_width,
+                   uint32_t target_height,
+                   const ImageResult& result);
+
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
@@ -66,6 +84,12 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
                                        uint32_t target_height,
                                        const fml::tracing::TraceFlow& flow);
 
+sk_sp<SkImage> ImageRegionFromData(ImageDescriptor* descriptor,
+                                   const SkIRect& region,
+                                   uint32_t target_width,
+                                   uint32_t target_height,
+                                   const fml::tracing::TraceFlow& flow);
+
 }  // namespace flutter
 
 #endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_H_
@@ -0,0 +1,216 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_decoder_cache.h"
+
+#include <iterator>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+ImageDecoderCache::Key::Key(const ImageDescriptor& descriptor,
+                            uint32_t target_width,
+                            uint32_t target_height,
+                            std::optional<SkIRect> region)
+    : data_(descriptor.data()),
+      info_(descriptor.image_info()),
+      row_bytes_(descriptor.row_bytes()),
+      target_width_(target_width),
+      target_height_(target_height),
+      region_(region.value_or(SkIRect::MakeEmpty())) {
+  hash_ = fml::HashCombine(descriptor.data_hash(), data_size(),
+                           info_.width(), info_.height(),
+                           static_cast<int>(info_.colorType()),
+                           static_cast<int>(info_.alphaType()), row_bytes_,
+                           target_width_, target_height_, region_.left(),
+                           region_.top(), region_.right(), region_.bottom());
+}
+
+bool ImageDecoderCache::Key::operator==(const Key& other) const {
+  if (hash_ != other.hash_ || info_ != other.info_ ||
+      row_bytes_ != other.row_bytes_ || target_width_ != other.target_width_ ||
+      target_height_ != other.target_height_ || region_ != other.region_) {
+    return false;
+  }
+  if (data_ == other.data_) {
+    return true;
+  }
+  return data_ && other.data_ && data_->equals(other.data_.get());
+}
+
+ImageDecoderCache::ImageDecoderCache() = default;
+
+ImageDecoderCache::~ImageDecoderCache() = default;
+
+ImageDecoderCache& ImageDecoderCache::GetInstance() {
+  static ImageDecoderCache* instance = new ImageDecoderCache();
+  return *instance;
+}
+
+size_t ImageDecoderCache::IndexHash(const Key& key,
+                                    const GrDirectContext* context) {
+  return fml::HashCombine(key.hash(), context);
+}
+
+ImageDecoderCache::Entries::iterator ImageDecoderCache::FindLocked(
+    const Key& key,
+    const GrDirectContext* context) {
+  auto range = index_.equal_range(IndexHash(key, context));
+  for (auto found = range.first; found != range.second; ++found) {
+    Entries::iterator entry = found->second;
+    if (entry->context == context && entry->key == key) {
+      // Mark the entry as the most recently used.
+      entries_.splice(entries_.begin(), entries_, entry);
+      return entry;
+    }
+  }
+  return entries_.end();
+}
+
+sk_sp<SkImage> ImageDecoderCache::GetImage(const Key& key) {
+  std::scoped_lock lock(mutex_);
+  auto entry = FindLocked(key, nullptr);
+  return entry == entries_.end() ? nullptr : entry->image;
+}
+
+void ImageDecoderCache::PutImage(const Key& key, sk_sp<SkImage> image) {
+  if (!image || image->isTextureBacked()) {
+    return;
+  }
+  const size_t bytes = image->imageInfo().computeMinByteSize();
+  Entries evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    PutLocked({key, nullptr, std::move(image), nullptr, bytes}, &evicted);
+  }
+  Release(std::move(evicted));
+}
+
+SkiaGPUObject<SkImage> ImageDecoderCache::GetTexture(
+    const Key& key,
+    const GrDirectContext* context) {
+  if (!context) {
+    return {};
+  }
+  std::scoped_lock lock(mutex_);
+  auto entry = FindLocked(key, context);
+  if (entry == entries_.end()) {
+    return {};
+  }
+  return {entry->image, entry->queue};
+}
+
+void ImageDecoderCache::PutTexture(const Key& key,
+                                   const GrDirectContext* context,
+                                   sk_sp<SkImage> texture,
+                                   fml::RefPtr<SkiaUnrefQueue> queue) {
+  if (!context || !texture || !queue) {
+    return;
+  }
+  // The texture of a lazily backed image is not counted by |textureSize|.
+  const size_t bytes = texture->imageInfo().computeMinByteSize();
+  Entries evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    PutLocked({key, context, std::move(texture), std::move(queue), bytes},
+              &evicted);
+  }
+  Release(std::move(evicted));
+}
+
+void ImageDecoderCache::PutLocked(Entry entry, Entries* evicted) {
+  if (entry.bytes > max_bytes_) {
+    evicted->push_back(std::move(entry));
+    return;
+  }
+  auto existing = FindLocked(entry.key, entry.context);
+  if (existing != entries_.end()) {
+    EraseLocked(existing, evicted);
+  }
+  while (!entries_.empty() && current_bytes_ + entry.bytes > max_bytes_) {
+    EraseLocked(std::prev(entries_.end()), evicted);
+  }
+  const size_t index_hash = IndexHash(entry.key, entry.context);
+  current_bytes_ += entry.bytes;
+  entries_.push_front(std::move(entry));
+  index_.emplace(index_hash, entries_.begin());
+}
+
+void ImageDecoderCache::EraseLocked(Entries::iterator entry,
+                                    Entries* evicted) {
+  auto range = index_.equal_range(IndexHash(entry->key, entry->context));
+  for (auto found = range.first; found != range.second; ++found) {
+    if (found->second == entry) {
+      index_.erase(found);
+      break;
+    }
+  }
+  current_bytes_ -= entry->bytes;
+  evicted->splice(evicted->end(), entries_, entry);
+}
+
+void ImageDecoderCache::PurgeContext(const GrDirectContext* context) {
+  if (!context) {
+    return;
+  }
+  Entries evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    for (auto entry = entries_.begin(); entry != entries_.end();) {
+      auto next = std::next(entry);
+      if (entry->context == context) {
+        EraseLocked(entry, &evicted);
+      }
+      entry = next;
+    }
+  }
+  Release(std::move(evicted));
+}
+
+void ImageDecoderCache::Purge() {
+  TRACE_EVENT0("flutter", "ImageDecoderCache::Purge");
+  Entries evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    index_.clear();
+    current_bytes_ = 0;
+    evicted.swap(entries_);
+  }
+  Release(std::move(evicted));
+}
+
+void ImageDecoderCache::SetMaxBytes(size_t max_bytes) {
+  Entries evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    max_bytes_ = max_bytes;
+    while (!entries_.empty() && current_bytes_ > max_bytes_) {
+      EraseLocked(std::prev(entries_.end()), &evicted);
+    }
+  }
+  Release(std::move(evicted));
+}
+
+size_t ImageDecoderCache::GetMaxBytes() {
+  std::scoped_lock lock(mutex_);
+  return max_bytes_;
+}
+
+size_t ImageDecoderCache::GetCurrentBytes() {
+  std::scoped_lock lock(mutex_);
+  return current_bytes_;
+}
+
+void ImageDecoderCache::Release(Entries entries) {
+  for (Entry& entry : entries) {
+    // Textures have to be collected on the thread of their context.
+    if (entry.queue) {
+      entry.queue->Unref(entry.image.release());
+    }
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,147 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/painting/image_descriptor.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
+
+namespace flutter {
+
+// A process wide cache of the images made by the image decoders of all
+// engines, so that the same encoded bytes decoded again at the same size (for
+// example an avatar scrolled back into view) cost neither a decode nor a
+// texture upload.
+//
+// Images are keyed by the contents of their encoded data, the region of the
+// image decoded, the size it is decoded to and the pixel format of the
+// descriptor. Decoded raster images are shared by all engines. Textures are
+// only handed back to decoders that upload with the resource context that
+// made them, and are released on the unref queue they were uploaded with.
+// Entries are evicted least recently used first once the decoded images exceed
+// the byte budget. The encoded data is shared with the descriptors it was
+// decoded from and with the other regions of the same image, so it is not
+// counted. Otherwise an image whose encoded data exceeds the budget, such as a
+// very large image decoded in tiles, could never be cached.
+//
+// All methods may be called on any thread.
+class ImageDecoderCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+
+  class Key {
+   public:
+    Key(const ImageDescriptor& descriptor,
+        uint32_t target_width,
+        uint32_t target_height,
+        std::optional<SkIRect> region = std::nullopt);
+
+    Key(const Key&) = default;
+
+    Key& operator=(const Key&) = default;
+
+    bool operator==(const Key& other) const;
+
+    size_t hash() const { return hash_; }
+
+    size_t data_size() const { return data_ ? data_->size() : 0; }
+
+   private:
+    // Kept to compare the bytes of keys with the same hash.
+    sk_sp<SkData> data_;
+    SkImageInfo info_;
+    int row_bytes_;
+    uint32_t target_width_;
+    uint32_t target_height_;
+    // Empty for the whole image.
+    SkIRect region_;
+    size_t hash_;
+  };
+
+  static ImageDecoderCache& GetInstance();
+
+  // Returns the raster image decoded for |key|, or nullptr.
+  sk_sp<SkImage> GetImage(const Key& key);
+
+  void PutImage(const Key& key, sk_sp<SkImage> image);
+
+  // Returns the texture uploaded for |key| with |context|, or an empty object.
+  SkiaGPUObject<SkImage> GetTexture(const Key& key,
+                                    const GrDirectContext* context);
+
+  // Keeps |texture|, an image that was uploaded with |context| for use by
+  // other contexts. Such images are usually lazily backed by their texture
+  // rather than texture backed, so the caller has to know that the image was
+  // uploaded.
+  void PutTexture(const Key& key,
+                  const GrDirectContext* context,
+                  sk_sp<SkImage> texture,
+                  fml::RefPtr<SkiaUnrefQueue> queue);
+
+  // Forgets the textures made with |context|. Must be called before the
+  // context or the unref queue of its textures goes away.
+  void PurgeContext(const GrDirectContext* context);
+
+  // Forgets all images, for example on low memory warnings.
+  void Purge();
+
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t GetMaxBytes();
+
+  size_t GetCurrentBytes();
+
+ private:
+  struct Entry {
+    Key key;
+    // The context of a texture, or nullptr for a raster image.
+    const GrDirectContext* context;
+    sk_sp<SkImage> image;
+    fml::RefPtr<SkiaUnrefQueue> queue;
+    size_t bytes;
+  };
+
+  using Entries = std::list<Entry>;
+
+  std::mutex mutex_;
+  size_t max_bytes_ = kDefaultMaxBytes;
+  size_t current_bytes_ = 0;
+  // Most recently used first.
+  Entries entries_;
+  std::unordered_multimap<size_t, Entries::iterator> index_;
+
+  ImageDecoderCache();
+
+  ~ImageDecoderCache();
+
+  static size_t IndexHash(const Key& key, const GrDirectContext* context);
+
+  Entries::iterator FindLocked(const Key& key, const GrDirectContext* context);
+
+  void PutLocked(Entry entry, Entries* evicted);
+
+  void EraseLocked(Entries::iterator entry, Entries* evicted);
+
+  // Releases the images of |entries| outside of the lock.
+  static void Release(Entries entries);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoderCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_DECODER_CACHE_H_
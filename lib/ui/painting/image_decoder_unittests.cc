@@ -4,9 +4,14 @@
 
 #include "flutter/lib/ui/painting/image_decoder.h"
 
+#include <optional>
+#include <vector>
+
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/lib/ui/painting/image_decoder_cache.h"
+#include "flutter/lib/ui/painting/image_upload_batcher.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
@@ -17,6 +22,7 @@
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
 #include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace flutter {
 namespace testing {
@@ -42,9 +48,12 @@ class TestIOManager final : public IOManager {
         << "The IO manager must be initialized its primary task runner. The "
            "test harness may not be set up correctly/safely.";
     weak_prototype_ = weak_factory_.GetWeakPtr();
+    upload_batcher_ = fml::MakeRefCounted<ImageUploadBatcher>(
+        task_runner, weak_prototype_, fml::TimeDelta::Zero(), 0);
   }
 
   ~TestIOManager() override {
+    ImageDecoderCache::GetInstance().PurgeContext(gl_context_.get());
     fml::AutoResetWaitableEvent latch;
     fml::TaskRunner::RunNowOrPostTask(runner_,
                                       [&latch, queue = unref_queue_]() {
@@ -76,6 +85,11 @@ class TestIOManager final : public IOManager {
     return is_gpu_disabled_sync_switch_;
   }
 
+  // |IOManager|
+  fml::RefPtr<ImageUploadBatcher> GetImageUploadBatcher() const override {
+    return upload_batcher_;
+  }
+
   bool did_access_is_gpu_disabled_sync_switch_ = false;
 
  private:
@@ -87,6 +101,7 @@ class TestIOManager final : public IOManager {
   fml::WeakPtr<TestIOManager> weak_prototype_;
   fml::RefPtr<fml::TaskRunner> runner_;
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
+  fml::RefPtr<ImageUploadBatcher> upload_batcher_;
   fml::WeakPtrFactory<TestIOManager> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(TestIOManager);
@@ -523,6 +538,234 @@ TEST_F(ImageDecoderFixtureTest, CanResizeWithoutDecode) {
   latch.Wait();
 }
 
+TEST_F(ImageDecoderFixtureTest, RepeatedDecodesShareTheUploadedTexture) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<TestIOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+    latch.Signal();
+  });
+  latch.Wait();
+
+  runners.GetUITaskRunner()->PostTask([&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    latch.Signal();
+  });
+  latch.Wait();
+
+  // Each decode reads the fixture into a new buffer, so only the contents of
+  // the data are the same.
+  auto decode = [&](uint32_t target_width,
+                    uint32_t target_height) -> sk_sp<SkImage> {
+    sk_sp<SkImage> decoded;
+    runners.GetUITaskRunner()->PostTask([&]() {
+      auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+      ASSERT_TRUE(data);
+      std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+      ASSERT_TRUE(codec);
+      auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                             std::move(codec));
+
+      ImageDecoder::ImageResult callback = [&](SkiaGPUObject<SkImage> image) {
+        decoded = image.get();
+        latch.Signal();
+      };
+      image_decoder->Decode(descriptor, target_width, target_height, callback);
+    });
+    latch.Wait();
+    return decoded;
+  };
+
+  ImageDecoderCache::GetInstance().Purge();
+  sk_sp<SkImage> first = decode(100, 100);
+  ASSERT_TRUE(first);
+  // Images uploaded for use by other contexts are lazily backed by the
+  // texture.
+  EXPECT_TRUE(first->isLazyGenerated());
+  // Both the raster image and the texture are kept.
+  EXPECT_GE(ImageDecoderCache::GetInstance().GetCurrentBytes(),
+            2 * first->imageInfo().computeMinByteSize());
+
+  io_manager->did_access_is_gpu_disabled_sync_switch_ = false;
+  EXPECT_EQ(decode(100, 100), first);
+  // The texture was not uploaded again.
+  EXPECT_FALSE(io_manager->did_access_is_gpu_disabled_sync_switch_);
+
+  sk_sp<SkImage> resized = decode(50, 50);
+  ASSERT_TRUE(resized);
+  EXPECT_NE(resized, first);
+  EXPECT_EQ(resized->dimensions(), SkISize::Make(50, 50));
+
+  // Textures are not kept after their context goes away.
+  first.reset();
+  resized.reset();
+  const size_t bytes_with_textures =
+      ImageDecoderCache::GetInstance().GetCurrentBytes();
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+  EXPECT_LT(ImageDecoderCache::GetInstance().GetCurrentBytes(),
+            bytes_with_textures);
+
+  runners.GetUITaskRunner()->PostTask([&]() {
+    image_decoder.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+  ImageDecoderCache::GetInstance().Purge();
+}
+
+TEST(ImageDecoderCacheTest, EvictsLeastRecentlyUsedImages) {
+  ImageDecoderCache& cache = ImageDecoderCache::GetInstance();
+  cache.Purge();
+  const size_t max_bytes = cache.GetMaxBytes();
+
+  const SkImageInfo info = SkImageInfo::MakeN32Premul(4, 4);
+  auto make_descriptor = [&](uint8_t value) {
+    std::vector<uint8_t> pixels(info.computeMinByteSize(), value);
+    return fml::MakeRefCounted<ImageDescriptor>(
+        SkData::MakeWithCopy(pixels.data(), pixels.size()), info,
+        std::nullopt);
+  };
+  auto make_image = [&](const fml::RefPtr<ImageDescriptor>& descriptor) {
+    return SkImage::MakeRasterData(info, descriptor->data(),
+                                   descriptor->row_bytes());
+  };
+
+  auto a = make_descriptor(1);
+  auto b = make_descriptor(2);
+  auto c = make_descriptor(3);
+  ImageDecoderCache::Key key_a(*a, 0, 0);
+  ImageDecoderCache::Key key_b(*b, 0, 0);
+  ImageDecoderCache::Key key_c(*c, 0, 0);
+
+  // Room for two images. Their encoded data is not counted.
+  cache.SetMaxBytes(info.computeMinByteSize() * 2);
+  cache.PutImage(key_a, make_image(a));
+  cache.PutImage(key_b, make_image(b));
+  EXPECT_EQ(cache.GetCurrentBytes(), info.computeMinByteSize() * 2);
+
+  // Equal data in another buffer finds the same image.
+  sk_sp<SkImage> image_a = cache.GetImage(
+      ImageDecoderCache::Key(*make_descriptor(1), 0, 0));
+  ASSERT_TRUE(image_a);
+  EXPECT_FALSE(cache.GetImage(ImageDecoderCache::Key(*a, 2, 2)));
+  EXPECT_FALSE(cache.GetImage(
+      ImageDecoderCache::Key(*a, 0, 0, SkIRect::MakeWH(2, 2))));
+
+  // |a| was used more recently than |b|.
+  cache.PutImage(key_c, make_image(c));
+  EXPECT_EQ(cache.GetImage(key_a), image_a);
+  EXPECT_FALSE(cache.GetImage(key_b));
+  EXPECT_TRUE(cache.GetImage(key_c));
+
+  cache.SetMaxBytes(info.computeMinByteSize());
+  EXPECT_TRUE(cache.GetImage(key_c));
+  EXPECT_FALSE(cache.GetImage(key_a));
+
+  cache.Purge();
+  EXPECT_EQ(cache.GetCurrentBytes(), 0u);
+  EXPECT_FALSE(cache.GetImage(key_c));
+  cache.SetMaxBytes(max_bytes);
+}
+
+TEST(ImageDecoderCacheTest, CachesRegionsOfImagesLargerThanTheBudget) {
+  ImageDecoderCache& cache = ImageDecoderCache::GetInstance();
+  cache.Purge();
+  const size_t max_bytes = cache.GetMaxBytes();
+
+  // The data of the image alone is larger than the budget.
+  const SkImageInfo info = SkImageInfo::MakeN32Premul(256, 256);
+  std::vector<uint8_t> pixels(info.computeMinByteSize(), 1);
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+      SkData::MakeWithCopy(pixels.data(), pixels.size()), info, std::nullopt);
+  const SkImageInfo tile_info = SkImageInfo::MakeN32Premul(16, 16);
+  cache.SetMaxBytes(tile_info.computeMinByteSize() * 4);
+  ASSERT_GT(descriptor->data()->size(), cache.GetMaxBytes());
+
+  auto make_tile = [&]() {
+    SkBitmap bitmap;
+    bitmap.allocPixels(tile_info);
+    bitmap.eraseColor(SK_ColorRED);
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
+  };
+  std::vector<ImageDecoderCache::Key> keys;
+  for (int i = 0; i < 4; i++) {
+    keys.emplace_back(*descriptor, 16, 16,
+                      SkIRect::MakeXYWH(i * 16, 0, 16, 16));
+    cache.PutImage(keys.back(), make_tile());
+  }
+
+  // All the tiles fit. The data they share does not count against the budget.
+  EXPECT_EQ(cache.GetCurrentBytes(), tile_info.computeMinByteSize() * 4);
+  for (const ImageDecoderCache::Key& key : keys) {
+    EXPECT_TRUE(cache.GetImage(key));
+  }
+
+  cache.Purge();
+  cache.SetMaxBytes(max_bytes);
+}
+
+TEST_F(ImageDecoderFixtureTest, UploadBatcherRunsUploadsTogether) {
+  auto io_runner = CreateNewThread("io");
+  fml::AutoResetWaitableEvent latch;
+  io_runner->PostTask([&]() {
+    TestIOManager io_manager(io_runner);
+    // A window that no batch lasts until, so batches are only run by
+    // draining them or by filling them. Three of the images fill a batch.
+    const size_t image_bytes = 4 * 4 * 4;
+    auto batcher = fml::MakeRefCounted<ImageUploadBatcher>(
+        io_runner, io_manager.GetWeakIOManager(),
+        fml::TimeDelta::FromSeconds(60), 3 * image_bytes);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(4, 4);
+    bitmap.eraseColor(SK_ColorRED);
+    bitmap.setImmutable();
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+
+    std::vector<sk_sp<SkImage>> uploaded;
+    auto on_upload = [&uploaded](sk_sp<SkImage> image, bool cross_context) {
+      EXPECT_TRUE(cross_context);
+      uploaded.push_back(std::move(image));
+    };
+    batcher->Upload(image, on_upload);
+    batcher->Upload(image, on_upload);
+    EXPECT_TRUE(uploaded.empty());
+    batcher->Drain();
+    ASSERT_EQ(uploaded.size(), 2u);
+    EXPECT_TRUE(uploaded[0]);
+    EXPECT_TRUE(uploaded[1]);
+    EXPECT_TRUE(io_manager.did_access_is_gpu_disabled_sync_switch_);
+
+    // The upload that fills the batch runs it without waiting for the window.
+    batcher->Upload(image, on_upload);
+    batcher->Upload(image, on_upload);
+    EXPECT_EQ(uploaded.size(), 2u);
+    batcher->Upload(image, on_upload);
+    ASSERT_EQ(uploaded.size(), 5u);
+    EXPECT_TRUE(uploaded[4]);
+
+    uploaded.clear();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
 // Verifies https://skia-review.googlesource.com/c/skia/+/259161 is present in
 // Flutter.
 TEST(ImageDecoderTest,
@@ -591,6 +834,82 @@ TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   assert_image(decode(300, 100));
 }
 
+TEST(ImageDecoderTest, VerifySampledDecodingOfCodecsThatCannotScale) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  auto codec = SkCodec::MakeFromData(data);
+  ASSERT_TRUE(codec);
+  auto descriptor =
+      fml::MakeRefCounted<ImageDescriptor>(data, std::move(codec));
+  ASSERT_EQ(descriptor->get_scaled_dimensions(0.25), SkISize::Make(300, 100));
+
+  auto sampled = descriptor->sampled_image(3);
+  ASSERT_TRUE(sampled);
+  ASSERT_EQ(sampled->dimensions(), SkISize::Make(100, 33));
+  ASSERT_FALSE(descriptor->sampled_image(1));
+
+  ASSERT_EQ(ImageFromCompressedData(descriptor.get(), 100, 30,
+                                    fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(100, 30));
+
+  // Sampling does not apply the EXIF orientation.
+  auto jpeg_data = OpenFixtureAsSkData("Horizontal.jpg");
+  auto jpeg_codec = SkCodec::MakeFromData(jpeg_data);
+  ASSERT_TRUE(jpeg_codec);
+  auto jpeg_descriptor = fml::MakeRefCounted<ImageDescriptor>(
+      std::move(jpeg_data), std::move(jpeg_codec));
+  ASSERT_FALSE(jpeg_descriptor->sampled_image(2));
+}
+
+TEST(ImageDecoderTest, VerifyRegionDecoding) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  auto codec = SkCodec::MakeFromData(data);
+  ASSERT_TRUE(codec);
+  auto descriptor =
+      fml::MakeRefCounted<ImageDescriptor>(data, std::move(codec));
+
+  auto sampled =
+      descriptor->region_image(SkIRect::MakeLTRB(100, 0, 200, 100), 2);
+  ASSERT_TRUE(sampled);
+  ASSERT_EQ(sampled->dimensions(), SkISize::Make(50, 50));
+  ASSERT_FALSE(
+      descriptor->region_image(SkIRect::MakeLTRB(250, 0, 350, 100), 1));
+
+  // The region matches the same pixels of the whole image.
+  auto whole = descriptor->image();
+  ASSERT_TRUE(whole);
+  const SkIRect region = SkIRect::MakeLTRB(10, 20, 30, 40);
+  auto decoded = descriptor->region_image(region, 1);
+  ASSERT_TRUE(decoded);
+  auto expected = whole->makeSubset(region);
+  ASSERT_TRUE(decoded->encodeToData(SkEncodedImageFormat::kPNG, 100)
+                  ->equals(expected->encodeToData(SkEncodedImageFormat::kPNG,
+                                                  100)
+                               .get()));
+
+  ASSERT_EQ(ImageRegionFromData(descriptor.get(),
+                                SkIRect::MakeLTRB(10, 10, 110, 60), 50, 25,
+                                fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(50, 25));
+  ASSERT_FALSE(ImageRegionFromData(descriptor.get(),
+                                   SkIRect::MakeLTRB(0, 0, 400, 100), 0, 0,
+                                   fml::tracing::TraceFlow("")));
+
+  // Images with an EXIF orientation are decoded whole and then cropped.
+  auto jpeg_data = OpenFixtureAsSkData("Horizontal.jpg");
+  auto jpeg_codec = SkCodec::MakeFromData(jpeg_data);
+  ASSERT_TRUE(jpeg_codec);
+  auto jpeg_descriptor = fml::MakeRefCounted<ImageDescriptor>(
+      std::move(jpeg_data), std::move(jpeg_codec));
+  ASSERT_FALSE(jpeg_descriptor->region_image(SkIRect::MakeWH(300, 100), 1));
+  ASSERT_EQ(ImageRegionFromData(jpeg_descriptor.get(),
+                                SkIRect::MakeLTRB(300, 100, 600, 200), 0, 0,
+                                fml::tracing::TraceFlow(""))
+                ->dimensions(),
+            SkISize::Make(300, 100));
+}
+
 TEST_F(ImageDecoderFixtureTest,
        MultiFrameCodecCanBeCollectedBeforeIOTasksFinish) {
   // This test verifies that the MultiFrameCodec safely shares state between
@@ -684,5 +1003,87 @@ TEST_F(ImageDecoderFixtureTest,
   latch.Wait();
 }
 
+class MultiFrameCodecTest : public ::testing::Test {
+ protected:
+  using State = MultiFrameCodec::State;
+
+  static std::unique_ptr<State> CreateState(size_t look_ahead_count,
+                                            size_t max_resident_bytes) {
+    auto generator = std::shared_ptr<SkCodecImageGenerator>(
+        static_cast<SkCodecImageGenerator*>(
+            SkCodecImageGenerator::MakeFromEncodedCodec(
+                OpenFixtureAsSkData("hello_loop_2.gif"))
+                .release()));
+    if (!generator) {
+      return nullptr;
+    }
+    return std::make_unique<State>(std::move(generator), look_ahead_count,
+                                   max_resident_bytes);
+  }
+
+  static size_t AheadFrameCount(State* state) {
+    std::scoped_lock lock(state->mutex_);
+    return state->aheadFrames_.size();
+  }
+
+  static bool IsResident(State* state) {
+    std::scoped_lock lock(state->mutex_);
+    return state->resident_;
+  }
+};
+
+TEST_F(MultiFrameCodecTest, DecodesFramesAheadIntoABoundedRing) {
+  auto state = CreateState(2, 0);
+  ASSERT_TRUE(state);
+  ASSERT_GT(state->frameCount_, 2);
+
+  ASSERT_TRUE(state->StartDecodeAhead());
+  // Only one decode ahead task is posted at a time.
+  ASSERT_FALSE(state->StartDecodeAhead());
+  state->DecodeAhead();
+  ASSERT_EQ(AheadFrameCount(state.get()), 2u);
+  ASSERT_FALSE(state->StartDecodeAhead());
+
+  // Frames keep being decoded, ahead or on request, across loops.
+  for (int i = 0; i < state->frameCount_ * 2; i++) {
+    auto frame = state->TakeNextFrame();
+    ASSERT_TRUE(frame.image);
+    ASSERT_FALSE(frame.image->isTextureBacked());
+    if (i % 2 == 0 && state->StartDecodeAhead()) {
+      state->DecodeAhead();
+    }
+  }
+  ASSERT_FALSE(IsResident(state.get()));
+}
+
+TEST_F(MultiFrameCodecTest, KeepsFramesOfAnimationsWithinTheBudget) {
+  auto state = CreateState(0, 64 * 1024 * 1024);
+  ASSERT_TRUE(state);
+  ASSERT_FALSE(state->StartDecodeAhead());
+
+  std::vector<sk_sp<SkImage>> first_loop;
+  for (int i = 0; i < state->frameCount_; i++) {
+    auto frame = state->TakeNextFrame();
+    ASSERT_TRUE(frame.image);
+    first_loop.push_back(frame.image);
+  }
+  ASSERT_TRUE(IsResident(state.get()));
+
+  // Later loops return the frames of the first one.
+  for (int i = 0; i < state->frameCount_; i++) {
+    ASSERT_EQ(state->TakeNextFrame().image, first_loop[i]);
+  }
+}
+
+TEST_F(MultiFrameCodecTest, DecodesFramesAgainOverTheBudget) {
+  auto state = CreateState(0, 1);
+  ASSERT_TRUE(state);
+
+  for (int i = 0; i < state->frameCount_ * 2; i++) {
+    ASSERT_TRUE(state->TakeNextFrame().image);
+  }
+  ASSERT_FALSE(IsResident(state.get()));
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -4,15 +4,22 @@
 
 #include "flutter/lib/ui/painting/image_descriptor.h"
 
+#include <algorithm>
+#include <string_view>
+
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/codec.h"
+#include "flutter/lib/ui/painting/image.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/lib/ui/painting/single_frame_codec.h"
 #include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/skia/include/codec/SkAndroidCodec.h"
 #include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/dart_persistent_value.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 
 #ifdef OS_MACOSX
@@ -35,6 +42,7 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, ImageDescriptor);
 #define FOR_EACH_BINDING(V)            \
   V(ImageDescriptor, initRaw)          \
   V(ImageDescriptor, instantiateCodec) \
+  V(ImageDescriptor, decodeRegion)     \
   V(ImageDescriptor, width)            \
   V(ImageDescriptor, height)           \
   V(ImageDescriptor, bytesPerPixel)
@@ -168,6 +176,72 @@ void ImageDescriptor::instantiateCodec(Dart_Handle codec_handle,
   ui_codec->AssociateWithDartWrapper(codec_handle);
 }
 
+Dart_Handle ImageDescriptor::decodeRegion(Dart_Handle callback_handle,
+                                          int left,
+                                          int top,
+                                          int right,
+                                          int bottom,
+                                          int target_width,
+                                          int target_height) {
+  if (!Dart_IsClosure(callback_handle)) {
+    return tonic::ToDart("Callback must be a function");
+  }
+
+  const SkIRect region = SkIRect::MakeLTRB(left, top, right, bottom);
+  if (region.isEmpty() ||
+      !SkIRect::MakeSize(image_info_.dimensions()).contains(region)) {
+    return tonic::ToDart("Region must be inside the image");
+  }
+  if (target_width <= 0 || target_height <= 0) {
+    return tonic::ToDart("Invalid target dimensions");
+  }
+
+  auto dart_state = UIDartState::Current();
+  auto decoder = dart_state->GetImageDecoder();
+  if (!decoder) {
+    return tonic::ToDart("Image decoder not available.");
+  }
+
+  auto callback =
+      std::make_unique<tonic::DartPersistentValue>(dart_state, callback_handle);
+  decoder->DecodeRegion(
+      fml::Ref(this), region, target_width, target_height,
+      fml::MakeCopyable([callback = std::move(callback)](
+                            SkiaGPUObject<SkImage> image) mutable {
+        auto state = callback->dart_state().lock();
+        if (!state) {
+          // The isolate was terminated before the region was decoded.
+          return;
+        }
+        tonic::DartState::Scope scope(state.get());
+
+        if (image.get()) {
+          auto canvas_image = fml::MakeRefCounted<CanvasImage>();
+          canvas_image->set_image(std::move(image));
+          tonic::DartInvoke(callback->value(), {tonic::ToDart(canvas_image)});
+        } else {
+          tonic::DartInvoke(callback->value(), {Dart_Null()});
+        }
+
+        // The callback is associated with the Dart isolate and must be
+        // deleted on the UI thread.
+        callback.reset();
+      }));
+  return Dart_Null();
+}
+
+size_t ImageDescriptor::data_hash() const {
+  std::call_once(data_hash_once_, [this]() {
+    TRACE_EVENT0("flutter", "ImageDescriptor::data_hash");
+    data_hash_ =
+        buffer_ ? std::hash<std::string_view>{}(std::string_view(
+                      static_cast<const char*>(buffer_->data()),
+                      buffer_->size()))
+                : 0;
+  });
+  return data_hash_;
+}
+
 sk_sp<SkImage> ImageDescriptor::image() const {
   SkBitmap bitmap;
   if (!bitmap.tryAllocPixels(image_info_)) {
@@ -185,6 +259,79 @@ sk_sp<SkImage> ImageDescriptor::image() const {
   return SkImage::MakeFromBitmap(bitmap);
 }
 
+sk_sp<SkImage> ImageDescriptor::sampled_image(int sample_size) const {
+  if (sample_size <= 1) {
+    return nullptr;
+  }
+  return region_image(SkIRect::MakeSize(image_info_.dimensions()),
+                      sample_size);
+}
+
+sk_sp<SkImage> ImageDescriptor::region_image(const SkIRect& region,
+                                             int sample_size) const {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  const SkIRect bounds = SkIRect::MakeSize(image_info_.dimensions());
+  if (!generator_ || sample_size < 1 || region.isEmpty() ||
+      !bounds.contains(region)) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(buffer_);
+  // Sampled pixels are not transformed based on the EXIF orientation, so the
+  // region is only known in encoded coordinates for unrotated images.
+  if (!codec || codec->codec()->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    return nullptr;
+  }
+
+  // Codecs may only decode subsets aligned to their blocks, which contain the
+  // requested region.
+  SkIRect subset = region;
+  const bool decode_subset = region != bounds;
+  if (decode_subset && !codec->getSupportedSubset(&subset)) {
+    return nullptr;
+  }
+
+  const auto sampled_info = image_info_.makeDimensions(
+      decode_subset ? codec->getSampledSubsetDimensions(sample_size, subset)
+                    : codec->getSampledDimensions(sample_size));
+  SkBitmap bitmap;
+  if (sampled_info.isEmpty() || !bitmap.tryAllocPixels(sampled_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << sampled_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  SkAndroidCodec::AndroidOptions options;
+  options.fSampleSize = sample_size;
+  options.fSubset = decode_subset ? &subset : nullptr;
+  // The same results as SkCodecImageGenerator treats as decoded.
+  switch (codec->getAndroidPixels(sampled_info, bitmap.getPixels(),
+                                  bitmap.rowBytes(), &options)) {
+    case SkCodec::kSuccess:
+    case SkCodec::kIncompleteInput:
+    case SkCodec::kErrorInInput:
+      break;
+    default:
+      return nullptr;
+  }
+  bitmap.setImmutable();
+  auto image = SkImage::MakeFromBitmap(bitmap);
+  if (!image || subset == region) {
+    return image;
+  }
+
+  // Crop the pixels the codec decoded around the region.
+  const SkIRect sampled_region =
+      SkIRect::MakeXYWH((region.left() - subset.left()) / sample_size,
+                        (region.top() - subset.top()) / sample_size,
+                        std::max(region.width() / sample_size, 1),
+                        std::max(region.height() / sample_size, 1));
+  if (!SkIRect::MakeSize(image->dimensions()).contains(sampled_region)) {
+    return nullptr;
+  }
+  return image->makeSubset(sampled_region);
+}
+
 bool ImageDescriptor::get_pixels(const SkPixmap& pixmap) const {
   if (generator_) {
     return generator_->getPixels(pixmap.info(), pixmap.writable_addr(),
@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 #include "flutter/fml/macros.h"
@@ -56,6 +57,17 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   /// Associates a flutter::Codec object with the dart.ui Codec handle.
   void instantiateCodec(Dart_Handle codec, int target_width, int target_height);
 
+  /// Asynchronously decodes the pixels inside the region from |left|, |top|
+  /// to |right|, |bottom| to an image of |target_width| by |target_height|
+  /// and passes it, or null on failure, to |callback|.
+  Dart_Handle decodeRegion(Dart_Handle callback,
+                           int left,
+                           int top,
+                           int right,
+                           int bottom,
+                           int target_width,
+                           int target_height);
+
   /// The width of this image, EXIF oriented if applicable.
   int width() const { return image_info_.width(); }
 
@@ -82,8 +94,26 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   /// The underlying buffer for this image.
   sk_sp<SkData> data() const { return buffer_; }
 
+  /// A hash of the contents of the underlying buffer. It is computed on first
+  /// use, so that decoding many regions of a large image hashes it only once.
+  /// May be called on any thread.
+  size_t data_hash() const;
+
   sk_sp<SkImage> image() const;
 
+  /// Decodes this image keeping one in every |sample_size| pixels in each
+  /// direction, for codecs that cannot scale while decoding. Returns nullptr
+  /// if the codec cannot sample the image or the image has an EXIF
+  /// orientation.
+  sk_sp<SkImage> sampled_image(int sample_size) const;
+
+  /// Decodes the pixels of this image inside |region|, keeping one in every
+  /// |sample_size| pixels in each direction. Only the parts of the encoded
+  /// data covering the region are decoded when the codec supports it.
+  /// Returns nullptr if the codec cannot decode regions, the region is not
+  /// inside the image or the image has an EXIF orientation.
+  sk_sp<SkImage> region_image(const SkIRect& region, int sample_size) const;
+
   /// Whether this descriptor represents compressed (encoded) data or not.
   bool is_compressed() const { return generator_ || platform_image_generator_; }
 
@@ -128,6 +158,8 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   std::unique_ptr<SkImageGenerator> platform_image_generator_;
   const SkImageInfo image_info_;
   std::optional<size_t> row_bytes_;
+  mutable std::once_flag data_hash_once_;
+  mutable size_t data_hash_ = 0;
 
   const SkImageInfo CreateImageInfo() const;
 
@@ -0,0 +1,105 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_upload_batcher.h"
+
+#include <utility>
+
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/io_manager.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
+
+namespace flutter {
+
+ImageUploadBatcher::ImageUploadBatcher(
+    fml::RefPtr<fml::TaskRunner> task_runner,
+    fml::WeakPtr<IOManager> io_manager,
+    fml::TimeDelta window,
+    size_t max_batch_bytes)
+    : task_runner_(std::move(task_runner)),
+      io_manager_(std::move(io_manager)),
+      window_(window),
+      max_batch_bytes_(max_batch_bytes),
+      batch_bytes_(0),
+      drain_pending_(false) {}
+
+ImageUploadBatcher::~ImageUploadBatcher() = default;
+
+void ImageUploadBatcher::Upload(sk_sp<SkImage> image,
+                                UploadCallback callback) {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  batch_bytes_ += image->imageInfo().computeMinByteSize();
+  uploads_.push_back({std::move(image), std::move(callback)});
+  if (batch_bytes_ >= max_batch_bytes_) {
+    // Do not wait for the end of the window to upload a full batch.
+    Drain();
+  } else if (!drain_pending_) {
+    drain_pending_ = true;
+    task_runner_->PostDelayedTask(
+        [strong = fml::Ref(this)]() { strong->Drain(); }, window_);
+  }
+}
+
+void ImageUploadBatcher::Drain() {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  std::vector<PendingUpload> uploads;
+  uploads.swap(uploads_);
+  const size_t bytes = std::exchange(batch_bytes_, 0);
+  drain_pending_ = false;
+
+  if (uploads.empty()) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "ImageUploadBatcher::Drain");
+  FML_TRACE_COUNTER("flutter", "ImageUploadBatch",
+                    reinterpret_cast<int64_t>(this), "Count", uploads.size(),
+                    "KBytes", bytes / 1024);
+
+  std::vector<sk_sp<SkImage>> images;
+  images.reserve(uploads.size());
+  for (const PendingUpload& upload : uploads) {
+    images.push_back(upload.image);
+  }
+
+  if (!io_manager_) {
+    FML_LOG(ERROR) << "Could not acquire IO manager.";
+    for (const PendingUpload& upload : uploads) {
+      upload.callback(nullptr, false);
+    }
+    return;
+  }
+
+  // Without a resource context, the caller might not have set one or a
+  // software backend could be in use. Either way, the images are used as
+  // they are.
+  std::vector<sk_sp<SkImage>> results = images;
+  bool cross_context = false;
+  fml::WeakPtr<GrDirectContext> context = io_manager_->GetResourceContext();
+  if (context) {
+    io_manager_->GetIsGpuDisabledSyncSwitch()->Execute(
+        fml::SyncSwitch::Handlers().SetIfFalse([&] {
+          TRACE_EVENT0("flutter", "MakeCrossContextImagesFromPixmaps");
+          // Each upload flushes the context and fences its texture for use by
+          // other contexts. Skia has no public API to upload several images
+          // with a single flush.
+          for (size_t i = 0; i < images.size(); i++) {
+            SkPixmap pixmap;
+            results[i] =
+                images[i]->peekPixels(&pixmap)
+                    ? SkImage::MakeCrossContextFromPixmap(context.get(), pixmap,
+                                                          true, true)
+                    : nullptr;
+          }
+          cross_context = true;
+        }));
+  }
+
+  for (size_t i = 0; i < uploads.size(); i++) {
+    uploads[i].callback(std::move(results[i]), cross_context);
+  }
+}
+
+}  // namespace flutter
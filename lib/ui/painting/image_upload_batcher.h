@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_UPLOAD_BATCHER_H_
+#define FLUTTER_LIB_UI_PAINTING_IMAGE_UPLOAD_BATCHER_H_
+
+#include <functional>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/memory/ref_counted.h"
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+class IOManager;
+
+// Uploads decoded images to the resource context of the IO manager in
+// batches, so that the uploads of images decoded at about the same time run
+// back to back in one IO task instead of one task each. Every upload still
+// flushes the resource context, see |SkImage::MakeCrossContextFromPixmap|.
+//
+// A batch is uploaded once |window| has passed since its first image was
+// added, or as soon as the images in it add up to |max_batch_bytes|.
+class ImageUploadBatcher
+    : public fml::RefCountedThreadSafe<ImageUploadBatcher> {
+ public:
+  // Called with an image that can be drawn by other contexts than the
+  // resource context, or with the raster image itself if there is no resource
+  // context or the GPU is disabled. Called with null if the upload failed.
+  //
+  // |cross_context| is true if the image was made by uploading it with the
+  // resource context. Such images are lazily backed by their texture, so
+  // |SkImage::isTextureBacked| cannot tell them apart from raster images.
+  using UploadCallback =
+      std::function<void(sk_sp<SkImage> image, bool cross_context)>;
+
+  // Uploads the raster |image| with the rest of the current batch. Must be
+  // called on the task runner.
+  void Upload(sk_sp<SkImage> image, UploadCallback callback);
+
+  // Uploads the images added so far. Usually, the drain is called
+  // automatically. Must be called on the task runner.
+  void Drain();
+
+ private:
+  struct PendingUpload {
+    sk_sp<SkImage> image;
+    UploadCallback callback;
+  };
+
+  const fml::RefPtr<fml::TaskRunner> task_runner_;
+  const fml::WeakPtr<IOManager> io_manager_;
+  const fml::TimeDelta window_;
+  const size_t max_batch_bytes_;
+  std::vector<PendingUpload> uploads_;
+  size_t batch_bytes_;
+  bool drain_pending_;
+
+  ImageUploadBatcher(fml::RefPtr<fml::TaskRunner> task_runner,
+                     fml::WeakPtr<IOManager> io_manager,
+                     fml::TimeDelta window,
+                     size_t max_batch_bytes);
+
+  ~ImageUploadBatcher();
+
+  FML_FRIEND_REF_COUNTED_THREAD_SAFE(ImageUploadBatcher);
+  FML_FRIEND_MAKE_REF_COUNTED(ImageUploadBatcher);
+  FML_DISALLOW_COPY_AND_ASSIGN(ImageUploadBatcher);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_UPLOAD_BATCHER_H_
@@ -4,7 +4,11 @@
 
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
@@ -12,17 +16,37 @@
 
 namespace flutter {
 
+static std::atomic<size_t> gLookAheadFrameCount = 0;
+static std::atomic<size_t> gMaxResidentBytes = 0;
+
 MultiFrameCodec::MultiFrameCodec(
     std::shared_ptr<SkCodecImageGenerator> generator)
-    : state_(new State(std::move(generator))) {}
+    : state_(new State(std::move(generator),
+                       gLookAheadFrameCount.load(std::memory_order_relaxed),
+                       gMaxResidentBytes.load(std::memory_order_relaxed))) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::shared_ptr<SkCodecImageGenerator> generator)
+void MultiFrameCodec::SetLookAheadFrameCount(size_t count) {
+  gLookAheadFrameCount.store(count, std::memory_order_relaxed);
+}
+
+void MultiFrameCodec::SetMaxResidentBytes(size_t bytes) {
+  gMaxResidentBytes.store(bytes, std::memory_order_relaxed);
+}
+
+MultiFrameCodec::State::State(std::shared_ptr<SkCodecImageGenerator> generator,
+                              size_t lookAheadCount,
+                              size_t maxResidentBytes)
     : generator_(std::move(generator)),
       frameCount_(generator_->getFrameCount()),
       repetitionCount_(generator_->getRepetitionCount()),
-      nextFrameIndex_(0) {}
+      lookAheadCount_(
+          std::min(lookAheadCount, static_cast<size_t>(frameCount_))),
+      maxResidentBytes_(maxResidentBytes),
+      nextFrameIndex_(0),
+      decodeFrameIndex_(0),
+      recordingLoop_(maxResidentBytes > 0) {}
 
 static void InvokeNextFrameCallback(
     fml::RefPtr<CanvasImage> image,
@@ -73,8 +97,11 @@ static bool CopyToBitmap(SkBitmap* dst,
   return true;
 }
 
-sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
-    fml::WeakPtr<GrDirectContext> resourceContext) {
+MultiFrameCodec::State::Frame MultiFrameCodec::State::DecodeNextFrameLocked() {
+  TRACE_EVENT0("flutter", "MultiFrameCodec::State::DecodeNextFrame");
+  const int frameIndex = decodeFrameIndex_;
+  decodeFrameIndex_ = (decodeFrameIndex_ + 1) % frameCount_;
+
   SkBitmap bitmap = SkBitmap();
   SkImageInfo info = generator_->getInfo().makeColorType(kN32_SkColorType);
   if (info.alphaType() == kUnpremul_SkAlphaType) {
@@ -84,16 +111,17 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
   bitmap.allocPixels(info);
 
   SkCodec::Options options;
-  options.fFrameIndex = nextFrameIndex_;
+  options.fFrameIndex = frameIndex;
   SkCodec::FrameInfo frameInfo{0};
-  generator_->getFrameInfo(nextFrameIndex_, &frameInfo);
+  generator_->getFrameInfo(frameIndex, &frameInfo);
   const int requiredFrameIndex = frameInfo.fRequiredFrame;
   if (requiredFrameIndex != SkCodec::kNoFrame) {
     if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
+      FML_LOG(ERROR) << "Frame " << frameIndex << " depends on frame "
                      << requiredFrameIndex
                      << " and no required frames are cached.";
-      return nullptr;
+      StopRecordingLoopLocked();
+      return {};
     } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
                      << " is not cached. Using " << lastRequiredFrameIndex_
@@ -109,26 +137,86 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
 
   if (!generator_->getPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
                              &options)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frameIndex;
+    StopRecordingLoopLocked();
+    return {};
   }
 
+  // The pixels are shared by the frame image and, if it is required to decode
+  // future frames, lastRequiredFrame_, which only reads them.
+  bitmap.setImmutable();
+
   // Hold onto this if we need it to decode future frames.
   if (frameInfo.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
     lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
+    lastRequiredFrameIndex_ = frameIndex;
   }
 
-  if (resourceContext) {
-    SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
-                    bitmap.pixelRef()->rowBytes());
-    return SkImage::MakeCrossContextFromPixmap(resourceContext.get(), pixmap,
-                                               true);
+  Frame frame = {SkImage::MakeFromBitmap(bitmap), frameInfo.fDuration};
+
+  // Keep the frames of the first loop while they fit, so that later loops
+  // need no decoding.
+  const size_t frameBytes = bitmap.computeByteSize();
+  if (recordingLoop_ && frame.image &&
+      static_cast<int>(loopFrames_.size()) == frameIndex &&
+      loopBytes_ + frameBytes <= maxResidentBytes_) {
+    loopFrames_.push_back(frame);
+    loopBytes_ += frameBytes;
+    if (static_cast<int>(loopFrames_.size()) == frameCount_) {
+      resident_ = true;
+      lastRequiredFrame_.reset();
+    }
   } else {
-    // Defer decoding until time of draw later on the raster thread. Can happen
-    // when GL operations are currently forbidden such as in the background
-    // on iOS.
-    return SkImage::MakeFromBitmap(bitmap);
+    StopRecordingLoopLocked();
+  }
+
+  return frame;
+}
+
+void MultiFrameCodec::State::StopRecordingLoopLocked() {
+  recordingLoop_ = false;
+  loopFrames_.clear();
+  loopBytes_ = 0;
+}
+
+MultiFrameCodec::State::Frame MultiFrameCodec::State::TakeNextFrame() {
+  std::scoped_lock lock(mutex_);
+  Frame frame;
+  if (resident_) {
+    frame = loopFrames_[nextFrameIndex_];
+    aheadFrames_.clear();
+  } else if (!aheadFrames_.empty()) {
+    frame = std::move(aheadFrames_.front());
+    aheadFrames_.pop_front();
+  } else {
+    FML_DCHECK(decodeFrameIndex_ == nextFrameIndex_);
+    frame = DecodeNextFrameLocked();
+  }
+  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  return frame;
+}
+
+bool MultiFrameCodec::State::StartDecodeAhead() {
+  std::scoped_lock lock(mutex_);
+  if (resident_ || decodeAheadPending_ ||
+      aheadFrames_.size() >= lookAheadCount_) {
+    return false;
+  }
+  decodeAheadPending_ = true;
+  return true;
+}
+
+void MultiFrameCodec::State::DecodeAhead() {
+  TRACE_EVENT0("flutter", "MultiFrameCodec::State::DecodeAhead");
+  while (true) {
+    // Decode one frame at a time so that a frame requested meanwhile waits
+    // for at most one decode.
+    std::scoped_lock lock(mutex_);
+    if (resident_ || aheadFrames_.size() >= lookAheadCount_) {
+      decodeAheadPending_ = false;
+      return;
+    }
+    aheadFrames_.push_back(DecodeNextFrameLocked());
   }
 }
 
@@ -140,15 +228,23 @@ void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     size_t trace_id) {
   fml::RefPtr<CanvasImage> image = nullptr;
   int duration = 0;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
+  Frame frame = TakeNextFrame();
+  sk_sp<SkImage> skImage = std::move(frame.image);
+  if (skImage && resourceContext) {
+    SkPixmap pixmap;
+    skImage = skImage->peekPixels(&pixmap)
+                  ? SkImage::MakeCrossContextFromPixmap(
+                        resourceContext.get(), pixmap, true)
+                  : nullptr;
+  }
+  // Otherwise, defer uploading until time of draw later on the raster
+  // thread. Can happen when GL operations are currently forbidden such as in
+  // the background on iOS.
   if (skImage) {
     image = CanvasImage::Create();
     image->set_image({skImage, std::move(unref_queue)});
-    SkCodec::FrameInfo skFrameInfo{0};
-    generator_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
-    duration = skFrameInfo.fDuration;
+    duration = frame.duration;
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable([callback = std::move(callback),
                                               image = std::move(image),
@@ -175,6 +271,7 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
            tonic::DartState::Current(), callback_handle),
        weak_state = std::weak_ptr<MultiFrameCodec::State>(state_), trace_id,
        ui_task_runner = task_runners.GetUITaskRunner(),
+       concurrent_task_runner = dart_state->GetConcurrentTaskRunner(),
        io_manager = dart_state->GetIOManager()]() mutable {
         auto state = weak_state.lock();
         if (!state) {
@@ -186,6 +283,15 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
             std::move(callback), std::move(ui_task_runner),
             io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue(),
             trace_id);
+
+        // Decode the frames that follow while the animation shows this one.
+        if (concurrent_task_runner && state->StartDecodeAhead()) {
+          concurrent_task_runner->PostTask([weak_state]() {
+            if (auto state = weak_state.lock()) {
+              state->DecodeAhead();
+            }
+          });
+        }
       }));
 
   return Dart_Null();
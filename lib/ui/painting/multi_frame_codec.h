@@ -5,11 +5,18 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <deque>
+#include <mutex>
+#include <vector>
+
 #include "flutter/fml/macros.h"
 #include "flutter/lib/ui/painting/codec.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
 namespace flutter {
+namespace testing {
+class MultiFrameCodecTest;
+}  // namespace testing
 
 class MultiFrameCodec : public Codec {
  public:
@@ -26,35 +33,91 @@ class MultiFrameCodec : public Codec {
   // |Codec|
   Dart_Handle getNextFrame(Dart_Handle args) override;
 
+  // Sets the number of frames that codecs created afterwards decode ahead of
+  // time on the concurrent task runner, or 0 to decode each frame when it is
+  // requested.
+  static void SetLookAheadFrameCount(size_t count);
+
+  // Sets the size limit of all the frames of an animation for codecs created
+  // afterwards to keep them once the animation has played through, or 0 to
+  // decode frames again on every loop.
+  static void SetMaxResidentBytes(size_t bytes);
+
  private:
   // Captures the state shared between the IO and UI task runners.
   //
   // The state is initialized on the UI task runner when the Dart object is
-  // created. Decoding occurs on the IO task runner. Since it is possible for
-  // the UI object to be collected independently of the IO task runner work,
-  // it is not safe for this state to live directly on the MultiFrameCodec.
-  // Instead, the MultiFrameCodec creates this object when it is constructed,
-  // shares it with the IO task runner's decoding work, and sets the live_
-  // member to false when it is destructed.
+  // created. Decoding occurs on the IO task runner, and ahead of time on the
+  // concurrent task runner. Since it is possible for the UI object to be
+  // collected independently of the IO task runner work, it is not safe for
+  // this state to live directly on the MultiFrameCodec. Instead, the
+  // MultiFrameCodec creates this object when it is constructed, shares it
+  // with the IO task runner's decoding work, and sets the live_ member to
+  // false when it is destructed.
   struct State {
-    State(std::shared_ptr<SkCodecImageGenerator> generator);
+    struct Frame {
+      // A raster image, or nullptr if the frame could not be decoded.
+      sk_sp<SkImage> image;
+      int duration = 0;
+    };
+
+    State(std::shared_ptr<SkCodecImageGenerator> generator,
+          size_t lookAheadCount,
+          size_t maxResidentBytes);
 
     const std::shared_ptr<SkCodecImageGenerator> generator_;
     const int frameCount_;
     const int repetitionCount_;
+    const size_t lookAheadCount_;
+    const size_t maxResidentBytes_;
 
-    // The non-const members and functions below here are only read or written
-    // to on the IO thread. They are not safe to access or write on the UI
-    // thread.
+    // Guards the members below. Frames depend on the frames before them, so
+    // they are decoded one at a time with the mutex held, either on the IO
+    // thread when a frame is requested or on the concurrent task runner.
+    std::mutex mutex_;
+
+    // The index of the next frame returned to Dart.
     int nextFrameIndex_;
+
+    // The index of the next frame to decode.
+    int decodeFrameIndex_;
+
     // The last decoded frame that's required to decode any subsequent frames.
     std::unique_ptr<SkBitmap> lastRequiredFrame_;
 
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
 
-    sk_sp<SkImage> GetNextFrameImage(
-        fml::WeakPtr<GrDirectContext> resourceContext);
+    // The frames decoded ahead of being requested, from nextFrameIndex_ up to
+    // decodeFrameIndex_.
+    std::deque<Frame> aheadFrames_;
+
+    // Whether a task decoding frames ahead has been posted and not run.
+    bool decodeAheadPending_ = false;
+
+    // The frames of the first loop of the animation, as long as their total
+    // size is within maxResidentBytes_.
+    std::vector<Frame> loopFrames_;
+    size_t loopBytes_ = 0;
+    bool recordingLoop_;
+
+    // Set once loopFrames_ holds every frame. No frames are decoded after.
+    bool resident_ = false;
+
+    // Returns the frame at nextFrameIndex_, decoding it if it was not decoded
+    // ahead, and moves on to the next frame.
+    Frame TakeNextFrame();
+
+    // Returns true if frames should be decoded ahead by calling DecodeAhead on
+    // the concurrent task runner. Returns false while such a call is pending.
+    bool StartDecodeAhead();
+
+    // Decodes frames until lookAheadCount_ frames are ready.
+    void DecodeAhead();
+
+    Frame DecodeNextFrameLocked();
+
+    void StopRecordingLoopLocked();
 
     void GetNextFrameAndInvokeCallback(
         std::unique_ptr<DartPersistentValue> callback,
@@ -69,6 +132,7 @@ class MultiFrameCodec : public Codec {
 
   FML_FRIEND_MAKE_REF_COUNTED(MultiFrameCodec);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(MultiFrameCodec);
+  friend class testing::MultiFrameCodecTest;
 };
 
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PICTURE_H_
 #define FLUTTER_LIB_UI_PAINTING_PICTURE_H_
 
+#include "flutter/flow/display_list.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/lib/ui/dart_wrapper.h"
 #include "flutter/lib/ui/painting/image.h"
@@ -26,8 +27,18 @@ class Picture : public RefCountedDartWrappable<Picture> {
   ~Picture() override;
   static fml::RefPtr<Picture> Create(Dart_Handle dart_handle,
                                      flutter::SkiaGPUObject<SkPicture> picture);
+  static fml::RefPtr<Picture> Create(
+      Dart_Handle dart_handle,
+      flutter::SkiaGPUObject<DisplayList> display_list);
 
+  // Only one of |picture| and |display_list| is set, depending on how the
+  // picture was recorded.
   sk_sp<SkPicture> picture() const { return picture_.get(); }
+  sk_sp<DisplayList> display_list() const { return display_list_.get(); }
+
+  // The contents of the picture as an |SkPicture|, converting the display
+  // list if the picture was recorded into one.
+  sk_sp<SkPicture> AsSkPicture() const;
 
   Dart_Handle toImage(uint32_t width,
                       uint32_t height,
@@ -46,8 +57,10 @@ class Picture : public RefCountedDartWrappable<Picture> {
 
  private:
   Picture(flutter::SkiaGPUObject<SkPicture> picture);
+  Picture(flutter::SkiaGPUObject<DisplayList> display_list);
 
   flutter::SkiaGPUObject<SkPicture> picture_;
+  flutter::SkiaGPUObject<DisplayList> display_list_;
 };
 
 }  // namespace flutter
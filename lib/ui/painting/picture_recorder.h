@@ -5,6 +5,9 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PICTURE_RECORDER_H_
 #define FLUTTER_LIB_UI_PAINTING_PICTURE_RECORDER_H_
 
+#include <memory>
+
+#include "flutter/flow/display_list_canvas.h"
 #include "flutter/lib/ui/dart_wrapper.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
 
@@ -26,6 +29,14 @@ class PictureRecorder : public RefCountedDartWrappable<PictureRecorder> {
   ~PictureRecorder() override;
 
   SkCanvas* BeginRecording(SkRect bounds);
+
+  // The builder behind the canvas returned by |BeginRecording| when
+  // pictures are recorded into display lists, null otherwise.
+  DisplayListBuilder* display_list_builder() const {
+    return display_list_recorder_ ? display_list_recorder_->builder()
+                                  : nullptr;
+  }
+
   fml::RefPtr<Picture> endRecording(Dart_Handle dart_picture);
 
   void set_canvas(fml::RefPtr<Canvas> canvas) { canvas_ = std::move(canvas); }
@@ -37,6 +48,7 @@ class PictureRecorder : public RefCountedDartWrappable<PictureRecorder> {
 
   SkRTreeFactory rtree_factory_;
   SkPictureRecorder picture_recorder_;
+  std::unique_ptr<DisplayListCanvasRecorder> display_list_recorder_;
   fml::RefPtr<Canvas> canvas_;
 };
 
@@ -3140,6 +3140,24 @@ class Paragraph extends NativeFieldWrapperClass2 {
   void layout(ParagraphConstraints constraints) => _layout(constraints.width);
   void _layout(double width) native 'Paragraph_layout';
 
+  /// Lays out each of the given paragraphs with the constraints at the same
+  /// index, as if [layout] had been called on each of them in order.
+  ///
+  /// The paragraphs are laid out concurrently on the engine's worker threads,
+  /// and this returns once all of them are laid out. This is faster than
+  /// calling [layout] on each paragraph when there are many of them.
+  static void layoutAll(List<Paragraph> paragraphs, List<ParagraphConstraints> constraints) {
+    if (paragraphs.length != constraints.length) {
+      throw ArgumentError('The number of paragraphs (${paragraphs.length}) must match '
+                          'the number of constraints (${constraints.length}).');
+    }
+    final List<double> widths = <double>[
+      for (final ParagraphConstraints constraint in constraints) constraint.width,
+    ];
+    _layoutAll(paragraphs, widths);
+  }
+  static void _layoutAll(List<Paragraph> paragraphs, List<double> widths) native 'Paragraph_layoutAll';
+
   List<TextBox> _decodeTextBoxes(Float32List encoded) {
     final int count = encoded.length ~/ 5;
     final List<TextBox> boxes = <TextBox>[];
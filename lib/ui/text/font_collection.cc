@@ -4,8 +4,11 @@
 
 #include "flutter/lib/ui/text/font_collection.h"
 
+#include <map>
 #include <mutex>
 
+#include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/platform_configuration.h"
@@ -20,7 +23,11 @@
 #include "third_party/tonic/dart_library_natives.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 #include "third_party/tonic/typed_data/typed_list.h"
+#include "minikin/Layout.h"
+#include "minikin/LayoutCache.h"
 #include "txt/asset_font_manager.h"
+#include "txt/glyph_profile.h"
+#include "txt/hyphenation_patterns.h"
 #include "txt/test_font_manager.h"
 
 namespace flutter {
@@ -45,6 +52,33 @@ void _LoadFontFromList(Dart_NativeArguments args) {
   tonic::DartCallStatic(LoadFontFromList, args);
 }
 
+// Keeps text layout results in the text store of the persistent cache.
+class PersistentCacheTextStore : public minikin::LayoutCacheStore {
+ public:
+  PersistentCacheTextStore() = default;
+
+  // |minikin::LayoutCacheStore|
+  bool load(const std::string& key, std::string* value) override {
+    sk_sp<SkData> data = PersistentCache::GetCacheForProcess()->LoadText(
+        *SkData::MakeWithoutCopy(key.data(), key.size()));
+    if (!data) {
+      return false;
+    }
+    value->assign(static_cast<const char*>(data->data()), data->size());
+    return true;
+  }
+
+  // |minikin::LayoutCacheStore|
+  void store(const std::string& key, const std::string& value) override {
+    PersistentCache::GetCacheForProcess()->StoreText(
+        *SkData::MakeWithoutCopy(key.data(), key.size()),
+        *SkData::MakeWithoutCopy(value.data(), value.size()));
+  }
+
+ private:
+  FML_DISALLOW_COPY_AND_ASSIGN(PersistentCacheTextStore);
+};
+
 }  // namespace
 
 FontCollection::FontCollection()
@@ -133,6 +167,14 @@ void FontCollection::RegisterFonts(
       sk_make_sp<txt::AssetFontManager>(std::move(font_provider)));
 }
 
+void FontCollection::RegisterHyphenationPatterns(
+    std::shared_ptr<AssetManager> asset_manager) {
+  txt::SetHyphenationPatternProvider(
+      [asset_manager = std::move(asset_manager)](const std::string& file_name) {
+        return asset_manager->GetAsMapping("hyphenation/" + file_name);
+      });
+}
+
 void FontCollection::RegisterTestFonts() {
   std::vector<sk_sp<SkTypeface>> test_typefaces;
   std::vector<std::unique_ptr<SkStreamAsset>> font_data = GetTestFontData();
@@ -173,4 +215,75 @@ void FontCollection::LoadFontFromList(const uint8_t* font_data,
   collection_->ClearFontFamilyCache();
 }
 
+void FontCollection::EnablePersistentCache() {
+  auto store = std::make_shared<PersistentCacheTextStore>();
+  collection_->SetPersistentStore(store);
+  // The cache of shaped words is shared by all engines in the process.
+  minikin::Layout::setCacheStore(std::move(store));
+}
+
+void FontCollection::PrewarmGlyphsFromProfile(
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
+    fml::WeakPtr<IOManager> io_manager) {
+  if (glyph_profile_loaded_) {
+    return;
+  }
+  glyph_profile_loaded_ = true;
+
+  io_task_runner->PostTask([collection = collection_, io_manager]() {
+    TRACE_EVENT0("flutter", "FontCollection::PrewarmGlyphsFromProfile");
+    txt::GlyphProfile& profile = collection->glyph_profile();
+    // The stored glyphs of each device pixel ratio they were drawn at.
+    std::map<float, txt::GlyphProfile::Entries> entries;
+    for (const auto& [font_data, glyph_data] :
+         PersistentCache::GetCacheForProcess()->LoadGlyphProfile()) {
+      txt::GlyphProfile::Font font;
+      float device_scale;
+      txt::GlyphProfile::Glyphs glyphs;
+      if (txt::GlyphProfile::DecodeFont(font_data->data(), font_data->size(),
+                                        &font, &device_scale) &&
+          txt::GlyphProfile::DecodeGlyphs(glyph_data->data(),
+                                          glyph_data->size(), &glyphs)) {
+        profile.Add(font, glyphs);
+        entries[device_scale].emplace_back(std::move(font), std::move(glyphs));
+      }
+    }
+    // Recording starts once the stored glyphs are known, so that the profile
+    // of a font is only stored again when it gains glyphs.
+    profile.SetRecording(true);
+    if (entries.empty() || !io_manager) {
+      return;
+    }
+
+    auto prewarm = [&](GrDirectContext* context) {
+      for (const auto& [device_scale, scale_entries] : entries) {
+        txt::GlyphProfile::Prewarm(*collection, scale_entries, device_scale,
+                                   context);
+      }
+    };
+    // Glyphs drawn into GPU surfaces are cached as different masks than the
+    // ones drawn into raster surfaces.
+    io_manager->GetIsGpuDisabledSyncSwitch()->Execute(
+        fml::SyncSwitch::Handlers()
+            .SetIfTrue([&] { prewarm(nullptr); })
+            .SetIfFalse(
+                [&] { prewarm(io_manager->GetResourceContext().get()); }));
+  });
+}
+
+void FontCollection::StoreGlyphProfile(float device_pixel_ratio) {
+  txt::GlyphProfile& profile = collection_->glyph_profile();
+  if (!profile.IsRecording() || !(device_pixel_ratio > 0)) {
+    return;
+  }
+  for (const auto& [font, glyphs] : profile.TakeChanged()) {
+    std::string font_data =
+        txt::GlyphProfile::EncodeFont(font, device_pixel_ratio);
+    std::string glyph_data = txt::GlyphProfile::EncodeGlyphs(glyphs);
+    PersistentCache::GetCacheForProcess()->StoreGlyphProfile(
+        *SkData::MakeWithoutCopy(font_data.data(), font_data.size()),
+        *SkData::MakeWithoutCopy(glyph_data.data(), glyph_data.size()));
+  }
+}
+
 }  // namespace flutter
@@ -11,6 +11,9 @@
 #include "flutter/assets/asset_manager.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/lib/ui/io_manager.h"
 #include "txt/font_collection.h"
 
 namespace tonic {
@@ -35,13 +38,37 @@ class FontCollection {
 
   void RegisterTestFonts();
 
+  // Makes the hyphenation pattern files in the "hyphenation" directory of
+  // |asset_manager| available to the paragraphs of the whole process. A
+  // file is only read the first time a paragraph in its language is laid
+  // out.
+  static void RegisterHyphenationPatterns(
+      std::shared_ptr<AssetManager> asset_manager);
+
   void LoadFontFromList(const uint8_t* font_data,
                         int length,
                         std::string family_name);
 
+  // Keeps the results of text shaping and font fallback in the process's
+  // persistent cache, so that they are reused by later runs of the app.
+  void EnablePersistentCache();
+
+  // Reads the glyph profile in the process's persistent cache into the
+  // profile of this collection and rasterizes its glyphs on the IO task
+  // runner with the resource context of |io_manager|, so that the first
+  // frames do not have to. Then records the glyphs laid out by text into the
+  // profile. Only the first call has an effect.
+  void PrewarmGlyphsFromProfile(fml::RefPtr<fml::TaskRunner> io_task_runner,
+                                fml::WeakPtr<IOManager> io_manager);
+
+  // Stores the glyphs recorded since the last call in the glyph profile, as
+  // drawn at |device_pixel_ratio|.
+  void StoreGlyphProfile(float device_pixel_ratio);
+
  private:
   std::shared_ptr<txt::FontCollection> collection_;
   sk_sp<txt::DynamicFontManager> dynamic_font_manager_;
+  bool glyph_profile_loaded_ = false;
 
   FML_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
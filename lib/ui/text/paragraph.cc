@@ -4,10 +4,18 @@
 
 #include "flutter/lib/ui/text/paragraph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_args.h"
 #include "third_party/tonic/dart_binding_macros.h"
@@ -37,7 +45,13 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Paragraph);
   V(Paragraph, getPositionForOffset)    \
   V(Paragraph, computeLineMetrics)
 
-DART_BIND_ALL(Paragraph, FOR_EACH_BINDING)
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+DART_NATIVE_CALLBACK_STATIC(Paragraph, layoutAll)
+
+void Paragraph::RegisterNatives(tonic::DartLibraryNatives* natives) {
+  natives->Register({FOR_EACH_BINDING(DART_REGISTER_NATIVE)
+                         DART_REGISTER_NATIVE_STATIC(Paragraph, layoutAll)});
+}
 
 Paragraph::Paragraph(std::unique_ptr<txt::Paragraph> paragraph)
     : m_paragraph(std::move(paragraph)) {}
@@ -87,6 +101,79 @@ void Paragraph::layout(double width) {
   m_paragraph->Layout(width);
 }
 
+namespace {
+
+// The paragraphs of a Paragraph.layoutAll call. The UI thread and the workers
+// helping it claim paragraphs one at a time until none are left. Workers that
+// only start once all paragraphs are claimed return without touching them.
+struct LayoutAllJob {
+  std::vector<std::pair<txt::Paragraph*, double>> paragraphs;
+  std::atomic<size_t> next_paragraph = 0;
+  std::atomic<size_t> remaining_paragraphs = 0;
+  fml::ManualResetWaitableEvent done;
+
+  void Run() {
+    for (size_t i = next_paragraph++; i < paragraphs.size();
+         i = next_paragraph++) {
+      paragraphs[i].first->Layout(paragraphs[i].second);
+      if (--remaining_paragraphs == 0) {
+        done.Signal();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+void Paragraph::layoutAll(std::vector<Paragraph*> paragraphs,
+                          std::vector<double> widths) {
+  TRACE_EVENT1("flutter", "Paragraph::layoutAll", "count",
+               std::to_string(paragraphs.size()).c_str());
+  // Paragraph.layoutAll checks the lengths before calling this.
+  FML_DCHECK(paragraphs.size() == widths.size());
+  const size_t count = std::min(paragraphs.size(), widths.size());
+
+  auto job = std::make_shared<LayoutAllJob>();
+  // A paragraph listed more than once is laid out only at its last width,
+  // which leaves it as laying the paragraphs out in order would, and keeps
+  // two threads from laying out the same paragraph.
+  std::unordered_map<Paragraph*, size_t> indices;
+  for (size_t i = 0; i < count; i++) {
+    if (!paragraphs[i]) {
+      continue;
+    }
+    auto [found, inserted] =
+        indices.try_emplace(paragraphs[i], job->paragraphs.size());
+    if (inserted) {
+      job->paragraphs.emplace_back(paragraphs[i]->m_paragraph.get(),
+                                   widths[i]);
+    } else {
+      job->paragraphs[found->second].second = widths[i];
+    }
+  }
+
+  UIDartState* state = UIDartState::Current();
+  auto runner = state->GetConcurrentTaskRunner();
+  // SkParagraph's font collection is not safe to use from several threads.
+  if (!runner || state->enable_skparagraph() || job->paragraphs.size() < 2) {
+    for (const auto& [paragraph, width] : job->paragraphs) {
+      paragraph->Layout(width);
+    }
+    return;
+  }
+
+  job->remaining_paragraphs = job->paragraphs.size();
+  const size_t helper_count =
+      std::min<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1,
+                       job->paragraphs.size() - 1);
+  for (size_t i = 0; i < helper_count; i++) {
+    runner->PostTaskWithPriority([job]() { job->Run(); },
+                                 fml::ConcurrentTaskPriority::kHigh);
+  }
+  job->Run();
+  job->done.Wait();
+}
+
 void Paragraph::paint(Canvas* canvas, double x, double y) {
   SkCanvas* sk_canvas = canvas->canvas();
   if (!sk_canvas) {
@@ -41,6 +41,13 @@ class Paragraph : public RefCountedDartWrappable<Paragraph> {
   bool didExceedMaxLines();
 
   void layout(double width);
+
+  // Lays out each paragraph at the width with the same index, spreading the
+  // paragraphs over the concurrent worker threads, and returns once all of
+  // them are laid out.
+  static void layoutAll(std::vector<Paragraph*> paragraphs,
+                        std::vector<double> widths);
+
   void paint(Canvas* canvas, double x, double y);
 
   tonic::Float32List getRectsForRange(unsigned start,
@@ -494,24 +494,41 @@ void ParagraphBuilder::pop() {
   m_paragraphBuilder->Pop();
 }
 
-Dart_Handle ParagraphBuilder::addText(const std::u16string& text) {
-  if (text.empty()) {
+Dart_Handle ParagraphBuilder::addText(Dart_Handle text) {
+  intptr_t length = 0;
+  Dart_Handle result = Dart_StringLength(text, &length);
+  if (Dart_IsError(result)) {
+    return tonic::ToDart(Dart_GetError(result));
+  }
+  if (length == 0) {
     return Dart_Null();
   }
 
-  // Use ICU to validate the UTF-16 input.  Calling u_strToUTF8 with a null
-  // output buffer will return U_BUFFER_OVERFLOW_ERROR if the input is well
-  // formed.
-  const UChar* text_ptr = reinterpret_cast<const UChar*>(text.data());
-  UErrorCode error_code = U_ZERO_ERROR;
-  u_strToUTF8(nullptr, 0, nullptr, text_ptr, text.size(), &error_code);
-  if (error_code != U_BUFFER_OVERFLOW_ERROR) {
-    return tonic::ToDart("string is not well-formed UTF-16");
-  }
+  // The string is copied once, from the Dart heap into the buffer that the
+  // paragraph takes over, and only kept if it turns out to be valid.
+  const char* error = nullptr;
+  m_paragraphBuilder->AddText(length, [&](uint16_t* buffer) {
+    intptr_t copied = length;
+    Dart_Handle result = Dart_StringToUTF16(text, buffer, &copied);
+    if (Dart_IsError(result) || copied != length) {
+      error = "string could not be read";
+      return false;
+    }
 
-  m_paragraphBuilder->AddText(text);
+    // Use ICU to validate the UTF-16 input.  Calling u_strToUTF8 with a null
+    // output buffer will return U_BUFFER_OVERFLOW_ERROR if the input is well
+    // formed.
+    const UChar* text_ptr = reinterpret_cast<const UChar*>(buffer);
+    UErrorCode error_code = U_ZERO_ERROR;
+    u_strToUTF8(nullptr, 0, nullptr, text_ptr, length, &error_code);
+    if (error_code != U_BUFFER_OVERFLOW_ERROR) {
+      error = "string is not well-formed UTF-16";
+      return false;
+    }
+    return true;
+  });
 
-  return Dart_Null();
+  return error ? tonic::ToDart(error) : Dart_Null();
 }
 
 Dart_Handle ParagraphBuilder::addPlaceholder(double width,
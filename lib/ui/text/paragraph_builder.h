@@ -55,7 +55,9 @@ class ParagraphBuilder : public RefCountedDartWrappable<ParagraphBuilder> {
 
   void pop();
 
-  Dart_Handle addText(const std::u16string& text);
+  // Copies the Dart string |text| straight into the text of the paragraph
+  // being built. Returns an error message if it is not well-formed UTF-16.
+  Dart_Handle addText(Dart_Handle text);
 
   // Pushes the information required to leave an open space, where Flutter may
   // draw a custom placeholder into.
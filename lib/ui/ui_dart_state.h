@@ -13,6 +13,7 @@
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/hint_freed_delegate.h"
@@ -70,6 +71,8 @@ class UIDartState : public tonic::DartState {
 
   fml::WeakPtr<ImageDecoder> GetImageDecoder() const;
 
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentTaskRunner() const;
+
   std::shared_ptr<IsolateNameServer> GetIsolateNameServer() const;
 
   tonic::DartErrorHandleType GetLastError();
@@ -87,6 +90,8 @@ class UIDartState : public tonic::DartState {
 
   bool enable_skparagraph() const;
 
+  bool enable_display_list() const;
+
   template <class T>
   static flutter::SkiaGPUObject<T> CreateGPUObject(sk_sp<T> object) {
     if (!object) {
@@ -107,6 +112,7 @@ class UIDartState : public tonic::DartState {
               fml::WeakPtr<IOManager> io_manager,
               fml::RefPtr<SkiaUnrefQueue> skia_unref_queue,
               fml::WeakPtr<ImageDecoder> image_decoder,
+              std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
               std::string advisory_script_uri,
               std::string advisory_script_entrypoint,
               std::string logger_prefix,
@@ -115,7 +121,8 @@ class UIDartState : public tonic::DartState {
               std::shared_ptr<IsolateNameServer> isolate_name_server,
               bool is_root_isolate_,
               std::shared_ptr<VolatilePathTracker> volatile_path_tracker,
-              bool enable_skparagraph);
+              bool enable_skparagraph,
+              bool enable_display_list);
 
   ~UIDartState() override;
 
@@ -137,6 +144,7 @@ class UIDartState : public tonic::DartState {
   fml::WeakPtr<IOManager> io_manager_;
   fml::RefPtr<SkiaUnrefQueue> skia_unref_queue_;
   fml::WeakPtr<ImageDecoder> image_decoder_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   std::shared_ptr<VolatilePathTracker> volatile_path_tracker_;
   const std::string advisory_script_uri_;
   const std::string advisory_script_entrypoint_;
@@ -150,6 +158,7 @@ class UIDartState : public tonic::DartState {
   LogMessageCallback log_message_callback_;
   const std::shared_ptr<IsolateNameServer> isolate_name_server_;
   const bool enable_skparagraph_;
+  const bool enable_display_list_;
 
   void AddOrRemoveTaskObserver(bool add);
 };
@@ -767,4 +767,7 @@ class ImageDescriptor {
 
     return await _createBmp(_data!, width, height, _rowBytes ?? width, _format!);
   }
+
+  Future<Image> decodeRegion(Rect region, {int? targetWidth, int? targetHeight}) =>
+      throw UnsupportedError('ImageDescriptor.decodeRegion is not supported on web.');
 }
@@ -600,6 +600,15 @@ abstract class Paragraph {
   double get ideographicBaseline;
   bool get didExceedMaxLines;
   void layout(ParagraphConstraints constraints);
+  static void layoutAll(List<Paragraph> paragraphs, List<ParagraphConstraints> constraints) {
+    if (paragraphs.length != constraints.length) {
+      throw ArgumentError('The number of paragraphs (${paragraphs.length}) must match '
+          'the number of constraints (${constraints.length}).');
+    }
+    for (int i = 0; i < paragraphs.length; i++) {
+      paragraphs[i].layout(constraints[i]);
+    }
+  }
   List<TextBox> getBoxesForRange(int start, int end,
       {BoxHeightStyle boxHeightStyle = BoxHeightStyle.tight,
       BoxWidthStyle boxWidthStyle = BoxWidthStyle.tight});
@@ -327,6 +327,7 @@ DartIsolate::DartIsolate(
                   std::move(io_manager),
                   std::move(unref_queue),
                   std::move(image_decoder),
+                  DartVMRef::GetRunningVM()->GetConcurrentWorkerTaskRunner(),
                   advisory_script_uri,
                   advisory_script_entrypoint,
                   settings.log_tag,
@@ -335,7 +336,8 @@ DartIsolate::DartIsolate(
                   DartVMRef::GetIsolateNameServer(),
                   is_root_isolate,
                   std::move(volatile_path_tracker),
-                  settings.enable_skparagraph),
+                  settings.enable_skparagraph,
+                  settings.enable_display_list),
       may_insecurely_connect_to_all_domains_(
           settings.may_insecurely_connect_to_all_domains),
       domain_network_policy_(settings.domain_network_policy) {
@@ -137,6 +137,9 @@ fml::WeakPtr<Engine> Engine::GetWeakPtr() const {
 void Engine::SetupDefaultFontManager() {
   TRACE_EVENT0("flutter", "Engine::SetupDefaultFontManager");
   font_collection_->SetupDefaultFontManager();
+  if (settings_.persistent_text_cache) {
+    font_collection_->EnablePersistentCache();
+  }
 }
 
 std::shared_ptr<AssetManager> Engine::GetAssetManager() {
@@ -157,11 +160,17 @@ bool Engine::UpdateAssetManager(
 
   // Using libTXT as the text engine.
   font_collection_->RegisterFonts(asset_manager_);
+  FontCollection::RegisterHyphenationPatterns(asset_manager_);
 
   if (settings_.use_test_fonts) {
     font_collection_->RegisterTestFonts();
   }
 
+  if (settings_.glyph_cache_profile) {
+    font_collection_->PrewarmGlyphsFromProfile(
+        task_runners_.GetIOTaskRunner(), runtime_controller_->GetIOManager());
+  }
+
   return true;
 }
 
@@ -235,6 +244,9 @@ void Engine::NotifyIdle(int64_t deadline) {
                trace_event.c_str());
   runtime_controller_->NotifyIdle(deadline, hint_freed_bytes_since_last_idle_);
   hint_freed_bytes_since_last_idle_ = 0;
+  if (settings_.glyph_cache_profile) {
+    font_collection_->StoreGlyphProfile(viewport_metrics_.device_pixel_ratio);
+  }
 }
 
 std::optional<uint32_t> Engine::GetUIIsolateReturnCode() {
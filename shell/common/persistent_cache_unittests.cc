@@ -5,8 +5,12 @@
 #include "flutter/common/graphics/persistent_cache.h"
 
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/common/graphics/packed_cache_store.h"
 #include "flutter/flow/layers/container_layer.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/layers/physical_shape_layer.h"
@@ -14,6 +18,9 @@
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/log_settings.h"
+#include "flutter/fml/paths.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/switches.h"
@@ -307,5 +314,268 @@ TEST_F(ShellTest, PurgeAllowsFutureSkSLCache) {
   DestroyShell(std::move(shell));
 }
 
+TEST(PackedCacheStoreTest, EntriesArePersistedAcrossInstances) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(temp_dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  sk_sp<SkData> key_a = SkData::MakeWithCString("key_a");
+  sk_sp<SkData> key_b = SkData::MakeWithCString("key_b");
+  sk_sp<SkData> value_a = SkData::MakeWithCString("value_a");
+  sk_sp<SkData> value_b = SkData::MakeWithCString("value_b");
+
+  {
+    PackedCacheStore store(directory, /*read_only=*/false);
+    store.Store(*key_a, *value_a);
+    // Stored entries are visible before they are flushed.
+    sk_sp<SkData> loaded = store.Load(*key_a);
+    ASSERT_TRUE(loaded);
+    EXPECT_TRUE(loaded->equals(value_a.get()));
+    ASSERT_TRUE(store.Flush());
+    EXPECT_FALSE(store.HasPendingEntries());
+
+    store.Store(*key_b, *value_b);
+    store.Store(*key_a, *value_b);
+    ASSERT_TRUE(store.Flush());
+  }
+
+  PackedCacheStore store(directory, /*read_only=*/true);
+  EXPECT_EQ(store.GetEntryCount(), 2u);
+  sk_sp<SkData> loaded_a = store.Load(*key_a);
+  ASSERT_TRUE(loaded_a);
+  EXPECT_TRUE(loaded_a->equals(value_b.get()));
+  sk_sp<SkData> loaded_b = store.Load(*key_b);
+  ASSERT_TRUE(loaded_b);
+  EXPECT_TRUE(loaded_b->equals(value_b.get()));
+  EXPECT_FALSE(store.Load(*SkData::MakeWithCString("missing")));
+}
+
+TEST(PackedCacheStoreTest, CompactionDropsReplacedRecords) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(temp_dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  sk_sp<SkData> key = SkData::MakeWithCString("key");
+  std::vector<uint8_t> bytes(128 * 1024, 0xab);
+  sk_sp<SkData> old_value = SkData::MakeWithCopy(bytes.data(), bytes.size());
+  bytes.back() = 0xcd;
+  sk_sp<SkData> new_value = SkData::MakeWithCopy(bytes.data(), bytes.size());
+
+  PackedCacheStore store(directory, /*read_only=*/false);
+  store.Store(*key, *old_value);
+  ASSERT_TRUE(store.Flush());
+  EXPECT_FALSE(store.NeedsCompaction());
+  store.Store(*key, *new_value);
+  ASSERT_TRUE(store.Flush());
+  ASSERT_TRUE(store.NeedsCompaction());
+
+  auto data_size = [&directory]() {
+    return fml::FileMapping::CreateReadOnly(*directory,
+                                            PackedCacheStore::kDataFileName)
+        ->GetSize();
+  };
+  const size_t size_before_compaction = data_size();
+  ASSERT_TRUE(store.Compact());
+  EXPECT_FALSE(store.NeedsCompaction());
+  EXPECT_LT(data_size(), size_before_compaction);
+
+  sk_sp<SkData> loaded = store.Load(*key);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->equals(new_value.get()));
+}
+
+TEST(PackedCacheStoreTest, FlushTruncatesLeftoversOfAnInterruptedFlush) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(temp_dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  sk_sp<SkData> key_a = SkData::MakeWithCString("key_a");
+  sk_sp<SkData> key_b = SkData::MakeWithCString("key_b");
+  sk_sp<SkData> value = SkData::MakeWithCString("value");
+  auto data_size = [&directory]() {
+    return fml::FileMapping::CreateReadOnly(*directory,
+                                            PackedCacheStore::kDataFileName)
+        ->GetSize();
+  };
+
+  {
+    PackedCacheStore store(directory, /*read_only=*/false);
+    store.Store(*key_a, *value);
+    ASSERT_TRUE(store.Flush());
+  }
+  const size_t flushed_size = data_size();
+
+  // Records written by a flush whose index never made it to disk.
+  {
+    fml::UniqueFD data_file =
+        fml::OpenFile(*directory, PackedCacheStore::kDataFileName, false,
+                      fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::TruncateFile(data_file, flushed_size + 4096));
+  }
+
+  PackedCacheStore store(directory, /*read_only=*/false);
+  store.Store(*key_b, *value);
+  ASSERT_TRUE(store.Flush());
+  // The record header is two uint32_t sizes.
+  EXPECT_EQ(data_size(), flushed_size + 2 * sizeof(uint32_t) +
+                             key_b->size() + value->size());
+  EXPECT_EQ(store.GetEntryCount(), 2u);
+  EXPECT_TRUE(store.Load(*key_a));
+  EXPECT_TRUE(store.Load(*key_b));
+}
+
+TEST(PackedCacheStoreTest, StoresAfterAFlushStartsScheduleAnotherFlush) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(temp_dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  sk_sp<SkData> key_a = SkData::MakeWithCString("key_a");
+  sk_sp<SkData> key_b = SkData::MakeWithCString("key_b");
+  sk_sp<SkData> value = SkData::MakeWithCString("value");
+
+  PackedCacheStore store(directory, /*read_only=*/false);
+  store.Store(*key_a, *value);
+  EXPECT_TRUE(store.ScheduleFlush());
+  // The scheduled flush has not started, so it also writes this entry.
+  store.Store(*key_b, *value);
+  EXPECT_FALSE(store.ScheduleFlush());
+
+  ASSERT_TRUE(store.Flush());
+  EXPECT_FALSE(store.HasPendingEntries());
+  // Once a flush has taken the pending entries, new entries need a new flush
+  // even though nothing else was stored since.
+  store.Store(*key_a, *key_b);
+  EXPECT_TRUE(store.ScheduleFlush());
+  ASSERT_TRUE(store.Flush());
+  EXPECT_FALSE(store.HasPendingEntries());
+
+  PackedCacheStore read_only_store(directory, /*read_only=*/true);
+  EXPECT_FALSE(read_only_store.ScheduleFlush());
+}
+
+TEST(PackedCacheStoreTest, ConcurrentFlushesKeepAllEntries) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(
+      fml::OpenDirectory(temp_dir.path().c_str(), false,
+                         fml::FilePermission::kReadWrite));
+  constexpr int kThreadCount = 4;
+  constexpr int kEntriesPerThread = 32;
+
+  {
+    PackedCacheStore store(directory, /*read_only=*/false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreadCount; t++) {
+      threads.emplace_back([&store, t]() {
+        for (int i = 0; i < kEntriesPerThread; i++) {
+          std::string key = std::to_string(t) + "/" + std::to_string(i);
+          sk_sp<SkData> data = SkData::MakeWithCString(key.c_str());
+          store.Store(*data, *data);
+          EXPECT_TRUE(i % 4 == 0 ? store.Compact() : store.Flush());
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    EXPECT_FALSE(store.HasPendingEntries());
+  }
+
+  PackedCacheStore store(directory, /*read_only=*/true);
+  EXPECT_EQ(store.GetEntryCount(),
+            static_cast<size_t>(kThreadCount * kEntriesPerThread));
+}
+
+TEST(PersistentCacheTest, TextEntriesArePersistedInTheirOwnStore) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::gCacheText = true;
+  PersistentCache::ResetCacheForProcess();
+
+  sk_sp<SkData> key = SkData::MakeWithCString("text_key");
+  sk_sp<SkData> value = SkData::MakeWithCString("text_value");
+  // Without workers, the entry is written to disk right away.
+  PersistentCache::GetCacheForProcess()->StoreText(*key, *value);
+  // Text entries are not visible as shaders.
+  EXPECT_FALSE(PersistentCache::GetCacheForProcess()->load(*key));
+
+  PersistentCache::ResetCacheForProcess();
+  sk_sp<SkData> loaded = PersistentCache::GetCacheForProcess()->LoadText(*key);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->equals(value.get()));
+
+  fml::UniqueFD text_dir = fml::OpenDirectoryReadOnly(
+      base_dir.fd(),
+      fml::paths::JoinPaths({"flutter_engine", GetFlutterEngineVersion(),
+                             "skia", GetSkiaVersion(),
+                             PersistentCache::kTextSubdirName})
+          .c_str());
+  ASSERT_TRUE(text_dir.is_valid());
+  EXPECT_TRUE(fml::FileExists(text_dir, PackedCacheStore::kDataFileName));
+
+  // Stored entries can be loaded before the worker writes them to disk.
+  fml::Thread worker("io.worker.1");
+  fml::AutoResetWaitableEvent worker_blocked;
+  worker.GetTaskRunner()->PostTask([&worker_blocked]() {
+    worker_blocked.Wait();
+  });
+  PersistentCache::GetCacheForProcess()->AddWorkerTaskRunner(
+      worker.GetTaskRunner());
+  sk_sp<SkData> other_key = SkData::MakeWithCString("other_text_key");
+  PersistentCache::GetCacheForProcess()->StoreText(*other_key, *value);
+  loaded = PersistentCache::GetCacheForProcess()->LoadText(*other_key);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->equals(value.get()));
+  PersistentCache::GetCacheForProcess()->RemoveWorkerTaskRunner(
+      worker.GetTaskRunner());
+  worker_blocked.Signal();
+  worker.Join();
+
+  // Without the switch, the text store is not used.
+  PersistentCache::gCacheText = false;
+  PersistentCache::ResetCacheForProcess();
+  EXPECT_FALSE(PersistentCache::GetCacheForProcess()->LoadText(*key));
+
+  // Cleanup
+  PersistentCache::SetCacheDirectoryPath("");
+  PersistentCache::ResetCacheForProcess();
+}
+
+TEST(PersistentCacheTest, GlyphProfileIsPersistedInItsOwnStore) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::gCacheGlyphProfile = true;
+  PersistentCache::ResetCacheForProcess();
+  EXPECT_TRUE(
+      PersistentCache::GetCacheForProcess()->LoadGlyphProfile().empty());
+
+  sk_sp<SkData> font = SkData::MakeWithCString("font");
+  sk_sp<SkData> glyphs = SkData::MakeWithCString("glyphs");
+  sk_sp<SkData> more_glyphs = SkData::MakeWithCString("more_glyphs");
+  // Without workers, the entries are written to disk right away.
+  PersistentCache::GetCacheForProcess()->StoreGlyphProfile(*font, *glyphs);
+  PersistentCache::GetCacheForProcess()->StoreGlyphProfile(*font,
+                                                           *more_glyphs);
+  EXPECT_FALSE(PersistentCache::GetCacheForProcess()->load(*font));
+
+  PersistentCache::ResetCacheForProcess();
+  std::vector<PersistentCache::GlyphProfileEntry> profile =
+      PersistentCache::GetCacheForProcess()->LoadGlyphProfile();
+  ASSERT_EQ(profile.size(), 1u);
+  EXPECT_TRUE(profile[0].first->equals(font.get()));
+  EXPECT_TRUE(profile[0].second->equals(more_glyphs.get()));
+
+  // Without the switch, the glyph profile is not used.
+  PersistentCache::gCacheGlyphProfile = false;
+  PersistentCache::ResetCacheForProcess();
+  EXPECT_TRUE(
+      PersistentCache::GetCacheForProcess()->LoadGlyphProfile().empty());
+
+  // Cleanup
+  PersistentCache::SetCacheDirectoryPath("");
+  PersistentCache::ResetCacheForProcess();
+}
+
 }  // namespace testing
 }  // namespace flutter
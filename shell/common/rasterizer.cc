@@ -10,6 +10,7 @@
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/lib/ui/painting/image_decoder_cache.h"
 #include "flutter/shell/common/serialization_callbacks.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
 #include "third_party/skia/include/core/SkImageEncoder.h"
@@ -123,6 +124,9 @@ void Rasterizer::DisableThreadMergerIfNeeded() {
 }
 
 void Rasterizer::NotifyLowMemoryWarning() const {
+  // Decoded images are shared by all engines and can be decoded again.
+  ImageDecoderCache::GetInstance().Purge();
+
   if (!surface_) {
     FML_DLOG(INFO)
         << "Rasterizer::NotifyLowMemoryWarning called with no surface.";
@@ -374,6 +378,8 @@ RasterStatus Rasterizer::DoDraw(
   // for Fuchsia to capture SceneUpdateContext::ExecutePaintTasks.
   const auto raster_finish_time = fml::TimePoint::Now();
   timing.Set(FrameTiming::kRasterFinish, raster_finish_time);
+  RecordFrameTimingHistograms(timing,
+                              raster_status == RasterStatus::kSuccess);
   delegate_.OnFrameRasterized(timing);
 
 // SceneDisplayLag events are disabled on Fuchsia.
@@ -479,7 +485,24 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+    std::optional<Damage> damage = ComputeFrameDamage(layer_tree, *frame);
+    // Everything outside of the buffer damage is already up to date in the
+    // framebuffer, so painting is clipped to it.
+    const bool clip_to_damage = damage && root_surface_canvas;
+    if (clip_to_damage) {
+      root_surface_canvas->save();
+      root_surface_canvas->clipRect(SkRect::Make(damage->buffer_damage));
+    }
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
     RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+    if (clip_to_damage) {
+      root_surface_canvas->restore();
+    }
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
     if (raster_status == RasterStatus::kFailed ||
         raster_status == RasterStatus::kSkipAndRetry) {
       return raster_status;
@@ -502,6 +525,19 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
           surface_->GetContext(), std::move(frame),
           delegate_.GetIsGpuDisabledSyncSwitch());
     } else {
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+      if (damage) {
+        // The surface expects damage in its own coordinate space.
+        SkRect frame_damage = SkRect::Make(damage->frame_damage);
+        SkRect buffer_damage = SkRect::Make(damage->buffer_damage);
+        root_surface_transformation.mapRect(&frame_damage);
+        root_surface_transformation.mapRect(&buffer_damage);
+        SurfaceFrame::SubmitInfo submit_info;
+        submit_info.frame_damage = frame_damage.roundOut();
+        submit_info.buffer_damage = buffer_damage.roundOut();
+        frame->set_submit_info(submit_info);
+      }
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
       frame->Submit();
     }
 
@@ -686,6 +722,72 @@ void Rasterizer::SetExternalViewEmbedder(
   external_view_embedder_ = view_embedder;
 }
 
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+std::optional<Damage> Rasterizer::ComputeFrameDamage(
+    flutter::LayerTree& layer_tree,
+    const SurfaceFrame& frame) {
+  const SurfaceFrame::FramebufferInfo& framebuffer_info =
+      frame.framebuffer_info();
+  // Platform views are composited by the external view embedder, which has no
+  // notion of partial repaint.
+  if (!framebuffer_info.supports_partial_repaint || external_view_embedder_ ||
+      layer_tree.root_layer() == nullptr) {
+    return std::nullopt;
+  }
+
+  TRACE_EVENT0("flutter", "Rasterizer::ComputeFrameDamage");
+
+  const SkIRect frame_rect = SkIRect::MakeSize(layer_tree.frame_size());
+
+  // Redrawing the last layer tree only has to repair the parts of the
+  // framebuffer that are stale. Diffing the tree against itself would also
+  // clobber the paint regions it is diffed against.
+  if (&layer_tree == last_layer_tree_.get()) {
+    if (!framebuffer_info.existing_damage) {
+      return std::nullopt;
+    }
+    SkIRect existing_damage = *framebuffer_info.existing_damage;
+    if (!existing_damage.intersect(frame_rect)) {
+      existing_damage.setEmpty();
+    }
+    return Damage{existing_damage, existing_damage};
+  }
+
+  const flutter::LayerTree* last_layer_tree = last_layer_tree_.get();
+  if (last_layer_tree != nullptr &&
+      (last_layer_tree->frame_size() != layer_tree.frame_size() ||
+       last_layer_tree->root_layer() == nullptr ||
+       last_layer_tree->paint_region_map().empty())) {
+    last_layer_tree = nullptr;
+  }
+
+  const PaintRegionMap empty_paint_region_map;
+  DiffContext context(layer_tree.frame_size(), layer_tree.device_pixel_ratio(),
+                      layer_tree.paint_region_map(),
+                      last_layer_tree ? last_layer_tree->paint_region_map()
+                                      : empty_paint_region_map);
+  context.PushCullRect(SkRect::Make(frame_rect));
+
+  // The root of a layer tree always replaces the root of the last one. The
+  // SceneBuilder creates a new root container for every scene, so matching the
+  // roots by IsReplacing would dirty every frame.
+  const Layer* old_root =
+      last_layer_tree ? last_layer_tree->root_layer() : nullptr;
+  if (old_root == nullptr) {
+    context.MarkSubtreeDirty();
+  }
+  // Always diff, even when the frame is repainted in full, so that the paint
+  // regions of this tree are available to diff the next frame against.
+  layer_tree.root_layer()->Diff(&context, old_root);
+  context.statistics().LogStatistics();
+
+  if (last_layer_tree == nullptr || !framebuffer_info.existing_damage) {
+    return std::nullopt;
+  }
+  return context.ComputeDamage(*framebuffer_info.existing_damage);
+}
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
 void Rasterizer::FireNextFrameCallbackIfPresent() {
   if (!next_frame_callback_) {
     return;
@@ -718,6 +820,40 @@ void Rasterizer::SetResourceCacheMaxBytes(size_t max_bytes, bool from_user) {
   }
 }
 
+void Rasterizer::RecordFrameTimingHistograms(const FrameTiming& timing,
+                                             bool frame_was_drawn) {
+  auto& histograms = frame_timing_histograms_;
+  histograms.build_time.Record(
+      (timing.Get(FrameTiming::kBuildFinish) -
+       timing.Get(FrameTiming::kBuildStart))
+          .ToMicroseconds());
+  histograms.raster_time.Record(
+      (timing.Get(FrameTiming::kRasterFinish) -
+       timing.Get(FrameTiming::kRasterStart))
+          .ToMicroseconds());
+  histograms.vsync_lag.Record((timing.Get(FrameTiming::kBuildStart) -
+                               timing.Get(FrameTiming::kVsyncStart))
+                                  .ToMicroseconds());
+
+  if (!frame_was_drawn) {
+    return;
+  }
+  const auto& raster_cache = compositor_context_->raster_cache();
+  const size_t lookups = raster_cache.GetLastFrameHitCount() +
+                         raster_cache.GetLastFrameMissCount();
+  if (lookups > 0) {
+    histograms.raster_cache_hit_percentage.Record(
+        raster_cache.GetLastFrameHitCount() * 100 / lookups);
+  }
+}
+
+void Rasterizer::ResetFrameTimingHistograms() {
+  frame_timing_histograms_.build_time.Reset();
+  frame_timing_histograms_.raster_time.Reset();
+  frame_timing_histograms_.vsync_lag.Reset();
+  frame_timing_histograms_.raster_cache_hit_percentage.Reset();
+}
+
 std::optional<size_t> Rasterizer::GetResourceCacheMaxBytes() const {
   if (!surface_) {
     return std::nullopt;
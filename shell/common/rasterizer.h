@@ -12,6 +12,8 @@
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/instrumentation.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/surface.h"
 #include "flutter/fml/closure.h"
@@ -410,6 +412,40 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   std::optional<size_t> GetResourceCacheMaxBytes() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Histograms of per-frame metrics of all the frames rasterized
+  ///             since the rasterizer was created or the histograms were last
+  ///             reset. Unlike the `FrameTiming`s reported to the framework,
+  ///             these use a fixed amount of memory and can be queried for
+  ///             percentiles at any time.
+  ///
+  struct FrameTimingHistograms {
+    // Times are recorded in microseconds, up to 10 seconds.
+    static constexpr int64_t kMaxTimeMicros = 10 * 1000 * 1000;
+
+    /// The time the UI thread took to build the layer tree.
+    Histogram build_time{kMaxTimeMicros};
+    /// The time the rasterizer took to draw the layer tree.
+    Histogram raster_time{kMaxTimeMicros};
+    /// The time from the vsync to the UI thread starting the build.
+    Histogram vsync_lag{kMaxTimeMicros};
+    /// The percentage of raster cache lookups in the frame that drew a cached
+    /// image. Frames that did not look anything up are not recorded.
+    Histogram raster_cache_hit_percentage{100};
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      The histograms of the frames rasterized so far.
+  ///
+  const FrameTimingHistograms& GetFrameTimingHistograms() const {
+    return frame_timing_histograms_;
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Clears the histograms returned by `GetFrameTimingHistograms`.
+  ///
+  void ResetFrameTimingHistograms();
+
   //----------------------------------------------------------------------------
   /// @brief      Enables the thread merger if the external view embedder
   ///             supports dynamic thread merging.
@@ -460,6 +496,7 @@ class Rasterizer final : public SnapshotDelegate {
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
   std::shared_ptr<ExternalViewEmbedder> external_view_embedder_;
   bool shared_engine_block_thread_merging_ = false;
+  FrameTimingHistograms frame_timing_histograms_;
 
   // |SnapshotDelegate|
   sk_sp<SkImage> MakeRasterSnapshot(sk_sp<SkPicture> picture,
@@ -482,6 +519,20 @@ class Rasterizer final : public SnapshotDelegate {
 
   RasterStatus DrawToSurface(flutter::LayerTree& layer_tree);
 
+  // Adds the metrics of a rasterized frame to |frame_timing_histograms_|. The
+  // raster cache statistics are only valid if the frame was drawn.
+  void RecordFrameTimingHistograms(const FrameTiming& timing,
+                                   bool frame_was_drawn);
+
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+  // Diffs the layer tree against the last rasterized layer tree and returns
+  // the area of the frame that has to be repainted. Returns std::nullopt when
+  // the whole frame must be repainted, either because the surface does not
+  // support partial repaint or because there is nothing to diff against.
+  std::optional<Damage> ComputeFrameDamage(flutter::LayerTree& layer_tree,
+                                           const SurfaceFrame& frame);
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
   void FireNextFrameCallbackIfPresent();
 
   static bool NoDiscard(const flutter::LayerTree& layer_tree) { return false; }
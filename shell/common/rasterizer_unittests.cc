@@ -6,6 +6,8 @@
 
 #include "flutter/shell/common/rasterizer.h"
 
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/testing/mock_layer.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/testing.h"
 #include "gmock/gmock.h"
@@ -299,4 +301,88 @@ TEST(RasterizerTest, externalViewEmbedderDoesntEndFrameWhenNoSurfaceIsSet) {
   });
   latch.Wait();
 }
+#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+TEST(RasterizerTest, drawRepaintsOnlyDamageWhenSurfaceSupportsPartialRepaint) {
+  std::string test_name =
+      ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  ThreadHost thread_host("io.flutter.test." + test_name + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::RASTER |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  fml::MessageLoop::EnsureInitializedForCurrentThread();
+  TaskRunners task_runners("test",
+                           fml::MessageLoop::GetCurrent().GetTaskRunner(),
+                           fml::MessageLoop::GetCurrent().GetTaskRunner(),
+                           thread_host.ui_thread->GetTaskRunner(),
+                           thread_host.io_thread->GetTaskRunner());
+
+  MockDelegate delegate;
+  EXPECT_CALL(delegate, GetTaskRunners())
+      .WillRepeatedly(ReturnRef(task_runners));
+  EXPECT_CALL(delegate, OnFrameRasterized(_)).Times(2);
+
+  auto rasterizer = std::make_unique<Rasterizer>(delegate);
+  auto surface = std::make_unique<MockSurface>();
+
+  // The surface hands out the same backing store every frame, so it always
+  // holds the previously presented frame.
+  const SkISize frame_size = SkISize::Make(100, 100);
+  sk_sp<SkSurface> backing_store = SkSurface::MakeRasterN32Premul(
+      frame_size.width(), frame_size.height());
+  std::vector<SurfaceFrame::SubmitInfo> submitted;
+  EXPECT_CALL(*surface, GetRootTransformation())
+      .WillRepeatedly(Return(SkMatrix()));
+  EXPECT_CALL(*surface, AcquireFrame(frame_size))
+      .Times(2)
+      .WillRepeatedly([&](const SkISize& size) {
+        auto frame = std::make_unique<SurfaceFrame>(
+            backing_store, /*supports_readback=*/true,
+            /*submit_callback=*/
+            [&](const SurfaceFrame& surface_frame, SkCanvas* canvas) {
+              submitted.push_back(surface_frame.submit_info());
+              return true;
+            });
+        SurfaceFrame::FramebufferInfo framebuffer_info;
+        framebuffer_info.supports_partial_repaint = true;
+        framebuffer_info.existing_damage = SkIRect::MakeEmpty();
+        frame->set_framebuffer_info(framebuffer_info);
+        return frame;
+      });
+  rasterizer->Setup(std::move(surface));
+
+  auto retained_layer = std::make_shared<testing::MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(10, 10, 20, 20)));
+  auto old_root = std::make_shared<ContainerLayer>();
+  old_root->Add(retained_layer);
+  old_root->Add(std::make_shared<testing::MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(50, 50, 60, 60))));
+
+  auto new_root = std::make_shared<ContainerLayer>();
+  new_root->AssignOldLayer(old_root.get());
+  new_root->Add(retained_layer);
+  new_root->Add(std::make_shared<testing::MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(70, 70, 80, 80))));
+
+  auto pipeline = fml::AdoptRef(new Pipeline<LayerTree>(/*depth=*/10));
+  auto no_discard = [](LayerTree&) { return false; };
+  for (const auto& root : {old_root, new_root}) {
+    auto layer_tree = std::make_unique<LayerTree>(frame_size,
+                                                  /*device_pixel_ratio=*/1.0f);
+    layer_tree->set_root_layer(root);
+    ASSERT_TRUE(pipeline->Produce().Complete(std::move(layer_tree)));
+    rasterizer->Draw(pipeline, no_discard);
+  }
+
+  ASSERT_EQ(submitted.size(), 2u);
+  // There is nothing to diff the first frame against.
+  EXPECT_FALSE(submitted[0].frame_damage.has_value());
+  EXPECT_FALSE(submitted[0].buffer_damage.has_value());
+  // The second frame only repaints where the replaced layer used to be and
+  // where the new one is.
+  ASSERT_TRUE(submitted[1].frame_damage.has_value());
+  EXPECT_EQ(*submitted[1].frame_damage, SkIRect::MakeLTRB(50, 50, 80, 80));
+  ASSERT_TRUE(submitted[1].buffer_damage.has_value());
+  EXPECT_EQ(*submitted[1].buffer_damage, SkIRect::MakeLTRB(50, 50, 80, 80));
+}
+#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+
 }  // namespace flutter
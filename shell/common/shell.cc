@@ -5,11 +5,14 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/common/constants.h"
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/icu_util.h"
@@ -20,6 +23,7 @@
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/shell/common/engine.h"
 #include "flutter/shell/common/skia_event_tracer_impl.h"
@@ -129,7 +133,15 @@ void PerformInitializationTasks(Settings& settings) {
     }
   });
 
+  PersistentCache::gUsePackedStore = settings.packed_persistent_cache;
+  PersistentCache::gCacheText = settings.persistent_text_cache;
+  PersistentCache::gCacheGlyphProfile = settings.glyph_cache_profile;
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+
+  MultiFrameCodec::SetLookAheadFrameCount(
+      settings.animated_image_look_ahead_frames);
+  MultiFrameCodec::SetMaxResidentBytes(
+      settings.animated_image_max_resident_size_mb * 1024 * 1024);
 }
 
 }  // namespace
@@ -204,6 +216,23 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        RasterCache& raster_cache =
+            rasterizer->compositor_context()->raster_cache();
+        raster_cache.SetMaxCacheBytes(static_cast<size_t>(
+            shell->GetSettings().raster_cache_max_size_mb *
+            kMegaByteSizeInBytes));
+        raster_cache.SetEvictionGraceFrames(
+            shell->GetSettings().raster_cache_eviction_grace_frames);
+        if (shell->GetSettings().enable_async_raster_cache) {
+          raster_cache.SetAsyncRasterizationTaskRunner(
+              shell->GetDartVM()->GetConcurrentWorkerTaskRunner());
+        }
+        if (shell->GetSettings().enable_concurrent_layer_painting) {
+          // The raster thread records a share of the subtrees itself, so the
+          // pool leaves room for it and the UI thread.
+          rasterizer->compositor_context()->EnableConcurrentPaint(
+              std::max(1u, std::thread::hardware_concurrency() / 2));
+        }
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
@@ -427,6 +456,11 @@ Shell::Shell(DartVMRef vm,
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetFrameTimingHistogramsExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetFrameTimingHistograms, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -1680,6 +1714,45 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+static void AddHistogram(const char* name,
+                         const Histogram& histogram,
+                         rapidjson::Document* response) {
+  auto& allocator = response->GetAllocator();
+  rapidjson::Value value;
+  value.SetObject();
+  value.AddMember<int64_t>("count", histogram.count(), allocator);
+  value.AddMember<int64_t>("min", histogram.min(), allocator);
+  value.AddMember<int64_t>("max", histogram.max(), allocator);
+  value.AddMember<double>("mean", histogram.Mean(), allocator);
+  value.AddMember<int64_t>("p50", histogram.ValueAtPercentile(50), allocator);
+  value.AddMember<int64_t>("p90", histogram.ValueAtPercentile(90), allocator);
+  value.AddMember<int64_t>("p99", histogram.ValueAtPercentile(99), allocator);
+  value.AddMember<int64_t>("p99.9", histogram.ValueAtPercentile(99.9),
+                           allocator);
+  response->AddMember(rapidjson::StringRef(name), value, allocator);
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolGetFrameTimingHistograms(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+  const auto& histograms = rasterizer_->GetFrameTimingHistograms();
+  response->SetObject();
+  response->AddMember("type", "FrameTimingHistograms",
+                      response->GetAllocator());
+  AddHistogram("buildTimeMicros", histograms.build_time, response);
+  AddHistogram("rasterTimeMicros", histograms.raster_time, response);
+  AddHistogram("vsyncLagMicros", histograms.vsync_lag, response);
+  AddHistogram("rasterCacheHitPercentage",
+               histograms.raster_cache_hit_percentage, response);
+  auto reset = params.find("reset");
+  if (reset != params.end() && reset->second == "true") {
+    rasterizer_->ResetFrameTimingHistograms();
+  }
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -1753,6 +1826,25 @@ Rasterizer::Screenshot Shell::Screenshot(
   return screenshot;
 }
 
+std::optional<Rasterizer::FrameTimingHistograms>
+Shell::GetFrameTimingHistograms(bool reset) {
+  fml::AutoResetWaitableEvent latch;
+  std::optional<Rasterizer::FrameTimingHistograms> histograms;
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetRasterTaskRunner(),
+      [&latch, rasterizer = GetRasterizer(), &histograms, reset]() {
+        if (rasterizer) {
+          histograms.emplace(rasterizer->GetFrameTimingHistograms());
+          if (reset) {
+            rasterizer->ResetFrameTimingHistograms();
+          }
+        }
+        latch.Signal();
+      });
+  latch.Wait();
+  return histograms;
+}
+
 fml::Status Shell::WaitForFirstFrame(fml::TimeDelta timeout) {
   FML_DCHECK(is_setup_);
   if (task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread() ||
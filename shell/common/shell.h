@@ -285,6 +285,20 @@ class Shell final : public PlatformView::Delegate,
   Rasterizer::Screenshot Screenshot(Rasterizer::ScreenshotType type,
                                     bool base64_encode);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Used by embedders to read the histograms of per-frame metrics
+  ///             kept by the rasterizer.
+  ///
+  /// @see        `Rasterizer::GetFrameTimingHistograms`
+  ///
+  /// @param[in]  reset  Whether to clear the histograms after reading them.
+  ///
+  /// @return     A copy of the histograms, or std::nullopt if the rasterizer
+  ///             is gone.
+  ///
+  std::optional<Rasterizer::FrameTimingHistograms> GetFrameTimingHistograms(
+      bool reset);
+
   //----------------------------------------------------------------------------
   /// @brief   Pauses the calling thread until the first frame is presented.
   ///
@@ -619,6 +633,15 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  //
+  // Responds with the count, minimum, maximum, mean and p50/p90/p99/p99.9 of
+  // every histogram of |Rasterizer::FrameTimingHistograms|. Pass "reset" as
+  // "true" to clear the histograms after reading them.
+  bool OnServiceProtocolGetFrameTimingHistograms(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // Creates an asset bundle from the original settings asset path or
   // directory.
   std::unique_ptr<DirectoryAssetBundle> RestoreOriginalAssetResolver();
@@ -7,10 +7,17 @@
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/message_loop.h"
+#include "flutter/lib/ui/painting/image_decoder_cache.h"
 #include "third_party/skia/include/gpu/gl/GrGLInterface.h"
 
 namespace flutter {
 
+// How long the texture uploads of images decoded one after the other are
+// held back to be run together, and the size at which they are run anyway.
+static constexpr fml::TimeDelta kUploadBatchWindow =
+    fml::TimeDelta::FromMilliseconds(1);
+static constexpr size_t kMaxUploadBatchBytes = 16 * 1024 * 1024;
+
 sk_sp<GrDirectContext> ShellIOManager::CreateCompatibleResourceLoadingContext(
     GrBackend backend,
     sk_sp<const GrGLInterface> gl_interface) {
@@ -62,11 +69,14 @@ ShellIOManager::ShellIOManager(
                     resource_context_.get())
               : nullptr),
       unref_queue_(fml::MakeRefCounted<flutter::SkiaUnrefQueue>(
-          std::move(unref_queue_task_runner),
+          unref_queue_task_runner,
           fml::TimeDelta::FromMilliseconds(8),
           GetResourceContext())),
       is_gpu_disabled_sync_switch_(is_gpu_disabled_sync_switch),
       weak_factory_(this) {
+  upload_batcher_ = fml::MakeRefCounted<ImageUploadBatcher>(
+      unref_queue_task_runner, GetWeakIOManager(), kUploadBatchWindow,
+      kMaxUploadBatchBytes);
   if (!resource_context_) {
 #ifndef OS_FUCHSIA
     FML_DLOG(WARNING) << "The IO manager was initialized without a resource "
@@ -77,6 +87,10 @@ ShellIOManager::ShellIOManager(
 }
 
 ShellIOManager::~ShellIOManager() {
+  // Cached textures still hold references to the resource context and are
+  // released on the unref queue.
+  ImageDecoderCache::GetInstance().PurgeContext(resource_context_.get());
+
   // Last chance to drain the IO queue as the platform side reference to the
   // underlying OpenGL context may be going away.
   is_gpu_disabled_sync_switch_->Execute(
@@ -95,6 +109,9 @@ void ShellIOManager::NotifyResourceContextAvailable(
 
 void ShellIOManager::UpdateResourceContext(
     sk_sp<GrDirectContext> resource_context) {
+  if (resource_context_ != resource_context) {
+    ImageDecoderCache::GetInstance().PurgeContext(resource_context_.get());
+  }
   resource_context_ = std::move(resource_context);
   resource_context_weak_factory_ =
       resource_context_
@@ -129,4 +146,9 @@ std::shared_ptr<fml::SyncSwitch> ShellIOManager::GetIsGpuDisabledSyncSwitch() {
   return is_gpu_disabled_sync_switch_;
 }
 
+// |IOManager|
+fml::RefPtr<ImageUploadBatcher> ShellIOManager::GetImageUploadBatcher() const {
+  return upload_batcher_;
+}
+
 }  // namespace flutter
@@ -11,6 +11,7 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/image_upload_batcher.h"
 #include "third_party/skia/include/gpu/GrDirectContext.h"
 
 namespace flutter {
@@ -55,6 +56,9 @@ class ShellIOManager final : public IOManager {
   // |IOManager|
   std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch() override;
 
+  // |IOManager|
+  fml::RefPtr<ImageUploadBatcher> GetImageUploadBatcher() const override;
+
   sk_sp<GrDirectContext> GetSharedResourceContext() const {
     return resource_context_;
   };
@@ -70,6 +74,10 @@ class ShellIOManager final : public IOManager {
 
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
 
+  // Image upload batching. Created once the weak pointers to this manager
+  // can be handed out.
+  fml::RefPtr<ImageUploadBatcher> upload_batcher_;
+
   fml::WeakPtrFactory<ShellIOManager> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ShellIOManager);
@@ -381,6 +381,9 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.enable_skparagraph =
       command_line.HasOption(FlagForSwitch(Switch::EnableSkParagraph));
 
+  settings.enable_display_list =
+      command_line.HasOption(FlagForSwitch(Switch::EnableDisplayList));
+
   std::string all_dart_flags;
   if (command_line.GetOptionValue(FlagForSwitch(Switch::DartFlags),
                                   &all_dart_flags)) {
@@ -409,12 +412,61 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.purge_persistent_cache =
       command_line.HasOption(FlagForSwitch(Switch::PurgePersistentCache));
 
+  settings.packed_persistent_cache =
+      command_line.HasOption(FlagForSwitch(Switch::PackedPersistentCache));
+
+  settings.persistent_text_cache =
+      command_line.HasOption(FlagForSwitch(Switch::PersistentTextCache));
+
+  settings.glyph_cache_profile =
+      command_line.HasOption(FlagForSwitch(Switch::GlyphCacheProfile));
+
   if (command_line.HasOption(FlagForSwitch(Switch::OldGenHeapSize))) {
     std::string old_gen_heap_size;
     command_line.GetOptionValue(FlagForSwitch(Switch::OldGenHeapSize),
                                 &old_gen_heap_size);
     settings.old_gen_heap_size = std::stoi(old_gen_heap_size);
   }
+
+  settings.enable_concurrent_layer_painting = command_line.HasOption(
+      FlagForSwitch(Switch::EnableConcurrentLayerPainting));
+
+  settings.enable_async_raster_cache =
+      command_line.HasOption(FlagForSwitch(Switch::EnableAsyncRasterCache));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxSize))) {
+    std::string raster_cache_max_size;
+    command_line.GetOptionValue(FlagForSwitch(Switch::RasterCacheMaxSize),
+                                &raster_cache_max_size);
+    settings.raster_cache_max_size_mb = std::stoul(raster_cache_max_size);
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheEvictionGraceFrames))) {
+    std::string grace_frames;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::RasterCacheEvictionGraceFrames), &grace_frames);
+    settings.raster_cache_eviction_grace_frames = std::stoul(grace_frames);
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageLookAheadFrames))) {
+    std::string look_ahead_frames;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::AnimatedImageLookAheadFrames),
+        &look_ahead_frames);
+    settings.animated_image_look_ahead_frames = std::stoul(look_ahead_frames);
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageMaxResidentSize))) {
+    std::string max_resident_size;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::AnimatedImageMaxResidentSize),
+        &max_resident_size);
+    settings.animated_image_max_resident_size_mb =
+        std::stoul(max_resident_size);
+  }
   return settings;
 }
 
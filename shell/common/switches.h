@@ -155,6 +155,22 @@ DEF_SWITCH(PurgePersistentCache,
            "purge-persistent-cache",
            "Remove all existing persistent cache. This is mainly for debugging "
            "purposes such as reproducing the shader compilation jank.")
+DEF_SWITCH(PackedPersistentCache,
+           "packed-persistent-cache",
+           "Store the persistent cache in a single memory mapped data file "
+           "with a sorted index instead of one file per entry. This speeds "
+           "up loading caches with many entries.")
+DEF_SWITCH(PersistentTextCache,
+           "persistent-text-cache",
+           "Keep the results of text shaping and font fallback in the "
+           "persistent cache, so that text laid out by an earlier run of the "
+           "app does not have to be shaped again.")
+DEF_SWITCH(GlyphCacheProfile,
+           "glyph-cache-profile",
+           "Record the fonts, sizes and glyphs drawn by text into a profile in "
+           "the persistent cache, and rasterize the glyphs of the profile on "
+           "a background thread at startup, so that the first frames do not "
+           "have to.")
 DEF_SWITCH(
     TraceSystrace,
     "trace-systrace",
@@ -202,9 +218,45 @@ DEF_SWITCH(
 DEF_SWITCH(OldGenHeapSize,
            "old-gen-heap-size",
            "The size limit in megabytes for the Dart VM old gen heap space.")
+DEF_SWITCH(RasterCacheMaxSize,
+           "raster-cache-max-size",
+           "The size limit in megabytes for the images held by the raster "
+           "cache. When the limit is exceeded, the entries that save the least "
+           "raster time per byte are evicted first. By default, the raster "
+           "cache is not limited by size.")
+DEF_SWITCH(RasterCacheEvictionGraceFrames,
+           "raster-cache-eviction-grace-frames",
+           "The number of consecutive frames a raster cache entry may go "
+           "unused before it is evicted. Defaults to 0.")
+DEF_SWITCH(EnableConcurrentLayerPainting,
+           "enable-concurrent-layer-painting",
+           "Record independent layer subtrees into separate pictures on a "
+           "dedicated pool of worker threads during Paint and stitch them "
+           "together on the raster thread. Subtrees containing platform "
+           "views, textures or backdrop reads, and subtrees drawn over "
+           "textures, are always painted on the raster thread.")
+DEF_SWITCH(EnableAsyncRasterCache,
+           "enable-async-raster-cache",
+           "Rasterize pictures for the raster cache on the engine's worker "
+           "threads. Pictures are drawn uncached until their cache entry is "
+           "ready instead of populating the cache within a frame.")
+DEF_SWITCH(AnimatedImageLookAheadFrames,
+           "animated-image-look-ahead-frames",
+           "The number of frames of animated images that are decoded ahead of "
+           "time on the engine's worker threads. By default, each frame is "
+           "decoded when it is requested.")
+DEF_SWITCH(AnimatedImageMaxResidentSize,
+           "animated-image-max-resident-size",
+           "The size limit in megabytes of all the frames of an animated image "
+           "for them to be kept after the animation first plays through "
+           "instead of being decoded again on every loop. Defaults to 0.")
 DEF_SWITCH(EnableSkParagraph,
            "enable-skparagraph",
            "Selects the SkParagraph implementation of the text layout engine.")
+DEF_SWITCH(EnableDisplayList,
+           "enable-display-list",
+           "Records pictures into display lists owned by the engine instead "
+           "of SkPictures.")
 
 DEF_SWITCHES_END
 
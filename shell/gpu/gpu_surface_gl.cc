@@ -259,15 +259,35 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceGL::AcquireFrame(const SkISize& size) {
   SurfaceFrame::SubmitCallback submit_callback =
       [weak = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) {
-        return weak ? weak->PresentSurface(canvas) : false;
+        return weak ? weak->PresentSurface(surface_frame, canvas) : false;
       };
 
-  return std::make_unique<SurfaceFrame>(
+  auto frame = std::make_unique<SurfaceFrame>(
       surface, delegate_->SurfaceSupportsReadback(), submit_callback,
       std::move(context_switch));
+
+  if (delegate_->GLContextSupportsPartialRepaint()) {
+    SurfaceFrame::FramebufferInfo framebuffer_info;
+    framebuffer_info.supports_partial_repaint = true;
+    // The delegate reports damage in surface coordinates while the rasterizer
+    // works in frame coordinates.
+    auto existing_damage =
+        delegate_->GLContextFramebufferExistingDamage(fbo_id_);
+    SkMatrix inverse_transformation;
+    if (existing_damage &&
+        root_surface_transformation.invert(&inverse_transformation)) {
+      SkRect damage = SkRect::Make(*existing_damage);
+      inverse_transformation.mapRect(&damage);
+      framebuffer_info.existing_damage = damage.roundOut();
+    }
+    frame->set_framebuffer_info(framebuffer_info);
+  }
+
+  return frame;
 }
 
-bool GPUSurfaceGL::PresentSurface(SkCanvas* canvas) {
+bool GPUSurfaceGL::PresentSurface(const SurfaceFrame& surface_frame,
+                                  SkCanvas* canvas) {
   if (delegate_ == nullptr || canvas == nullptr || context_ == nullptr) {
     return false;
   }
@@ -277,7 +297,10 @@ bool GPUSurfaceGL::PresentSurface(SkCanvas* canvas) {
     onscreen_surface_->getCanvas()->flush();
   }
 
-  if (!delegate_->GLContextPresent(fbo_id_)) {
+  GLPresentInfo present_info = {fbo_id_,
+                                 surface_frame.submit_info().frame_damage,
+                                 surface_frame.submit_info().buffer_damage};
+  if (!delegate_->GLContextPresentWithInfo(present_info)) {
     return false;
   }
 
@@ -12,6 +12,20 @@ namespace flutter {
 
 GPUSurfaceGLDelegate::~GPUSurfaceGLDelegate() = default;
 
+bool GPUSurfaceGLDelegate::GLContextPresentWithInfo(
+    const GLPresentInfo& present_info) {
+  return GLContextPresent(present_info.fbo_id);
+}
+
+bool GPUSurfaceGLDelegate::GLContextSupportsPartialRepaint() const {
+  return false;
+}
+
+std::optional<SkIRect> GPUSurfaceGLDelegate::GLContextFramebufferExistingDamage(
+    intptr_t fbo_id) const {
+  return std::nullopt;
+}
+
 bool GPUSurfaceGLDelegate::GLContextFBOResetAfterPresent() const {
   return false;
 }
@@ -5,10 +5,13 @@
 #ifndef FLUTTER_SHELL_GPU_GPU_SURFACE_GL_DELEGATE_H_
 #define FLUTTER_SHELL_GPU_GPU_SURFACE_GL_DELEGATE_H_
 
+#include <optional>
+
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/gpu/gl/GrGLInterface.h"
 
 namespace flutter {
@@ -20,6 +23,17 @@ struct GLFrameInfo {
   uint32_t height;
 };
 
+// A structure to represent the information which is passed to the embedder
+// when presenting a frame buffer object. The damage rects are in surface
+// coordinates; std::nullopt means the entire frame buffer.
+struct GLPresentInfo {
+  uint32_t fbo_id;
+  // The area that changed since the previously presented frame.
+  std::optional<SkIRect> frame_damage;
+  // The area of the frame buffer that was painted to.
+  std::optional<SkIRect> buffer_damage;
+};
+
 class GPUSurfaceGLDelegate {
  public:
   ~GPUSurfaceGLDelegate();
@@ -35,6 +49,22 @@ class GPUSurfaceGLDelegate {
   // context and not any of the contexts dedicated for IO.
   virtual bool GLContextPresent(uint32_t fbo_id) = 0;
 
+  // Called to present the main GL surface along with the damage of the frame.
+  // Delegates that support partial repaint override this to present only the
+  // damaged area. The default implementation presents the whole surface.
+  virtual bool GLContextPresentWithInfo(const GLPresentInfo& present_info);
+
+  // Whether the delegate is able to report the existing damage of its frame
+  // buffers and to present partial updates. When this returns false, every
+  // frame is repainted in full.
+  virtual bool GLContextSupportsPartialRepaint() const;
+
+  // The area of the given frame buffer, in surface coordinates, that is stale
+  // relative to the most recently presented frame. Return std::nullopt if the
+  // contents of the frame buffer are unknown.
+  virtual std::optional<SkIRect> GLContextFramebufferExistingDamage(
+      intptr_t fbo_id) const;
+
   // The ID of the main window bound framebuffer. Typically FBO0.
   virtual intptr_t GLContextFBO(GLFrameInfo frame_info) const = 0;
 
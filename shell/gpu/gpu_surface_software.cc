@@ -66,10 +66,34 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    if (!self->delegate_->SupportsPartialRepaint()) {
+      return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    }
+
+    if (!self->delegate_->PresentBackingStoreWithDamage(
+            surface_frame.SkiaSurface(),
+            surface_frame.submit_info().frame_damage)) {
+      return false;
+    }
+    self->last_presented_backing_store_ = surface_frame.SkiaSurface();
+    return true;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+
+  if (delegate_->SupportsPartialRepaint()) {
+    SurfaceFrame::FramebufferInfo framebuffer_info;
+    framebuffer_info.supports_partial_repaint = true;
+    if (backing_store == last_presented_backing_store_) {
+      framebuffer_info.existing_damage = SkIRect::MakeEmpty();
+    }
+    frame->set_framebuffer_info(framebuffer_info);
+    // The backing store is about to be painted to. Until this frame is
+    // presented its contents match no presented frame.
+    last_presented_backing_store_ = nullptr;
+  }
+
+  return frame;
 }
 
 // |Surface|
@@ -8,4 +8,14 @@ namespace flutter {
 
 GPUSurfaceSoftwareDelegate::~GPUSurfaceSoftwareDelegate() = default;
 
+bool GPUSurfaceSoftwareDelegate::SupportsPartialRepaint() const {
+  return false;
+}
+
+bool GPUSurfaceSoftwareDelegate::PresentBackingStoreWithDamage(
+    sk_sp<SkSurface> backing_store,
+    const std::optional<SkIRect>& frame_damage) {
+  return PresentBackingStore(std::move(backing_store));
+}
+
 }  // namespace flutter
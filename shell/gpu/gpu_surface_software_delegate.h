@@ -5,6 +5,8 @@
 #ifndef FLUTTER_SHELL_GPU_GPU_SURFACE_SOFTWARE_DELEGATE_H_
 #define FLUTTER_SHELL_GPU_GPU_SURFACE_SOFTWARE_DELEGATE_H_
 
+#include <optional>
+
 #include "flutter/flow/embedded_views.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkSurface.h"
@@ -48,6 +50,34 @@ class GPUSurfaceSoftwareDelegate {
   ///             the screen.
   ///
   virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether the platform keeps the contents of the backing store
+  ///             between frames and can present partial updates. When true,
+  ///             the rasterizer only repaints the area of the backing store
+  ///             that changed since the last presented frame.
+  ///
+  /// @return     Returns if the platform supports partial repaint.
+  ///
+  virtual bool SupportsPartialRepaint() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Called instead of |PresentBackingStore| to present a frame
+  ///             along with the area that changed since the last presented
+  ///             frame. The default implementation ignores the damage and
+  ///             presents the whole backing store.
+  ///
+  /// @param[in]  backing_store  The software backing store to present.
+  /// @param[in]  frame_damage   The area of the backing store that changed,
+  ///                            or std::nullopt if the whole backing store
+  ///                            changed.
+  ///
+  /// @return     Returns if the platform could present the backing store onto
+  ///             the screen.
+  ///
+  virtual bool PresentBackingStoreWithDamage(
+      sk_sp<SkSurface> backing_store,
+      const std::optional<SkIRect>& frame_damage);
 };
 
 }  // namespace flutter
@@ -8,6 +8,7 @@
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -118,8 +119,8 @@ static bool IsSoftwareRendererConfigValid(const FlutterRendererConfig* config) {
 
   const FlutterSoftwareRendererConfig* software_config = &config->software;
 
-  if (SAFE_ACCESS(software_config, surface_present_callback, nullptr) ==
-      nullptr) {
+  if (!SAFE_EXISTS_ONE_OF(software_config, surface_present_callback,
+                          surface_present_with_info_callback)) {
     return false;
   }
 
@@ -176,6 +177,42 @@ static void* DefaultGLProcResolver(const char* name) {
 }
 #endif  // OS_LINUX || OS_WIN
 
+// Points |damage| at a single rect stored in |storage|. Unknown damage is
+// reported to the embedder as an empty damage region, which the embedder API
+// documents as the whole surface.
+static void PopulateFlutterDamage(const std::optional<SkIRect>& rect,
+                                  FlutterRect* storage,
+                                  FlutterDamage* damage) {
+  damage->struct_size = sizeof(FlutterDamage);
+  damage->num_rects = 0;
+  damage->damage = nullptr;
+  if (!rect.has_value()) {
+    return;
+  }
+  storage->left = rect->left();
+  storage->top = rect->top();
+  storage->right = rect->right();
+  storage->bottom = rect->bottom();
+  damage->num_rects = 1;
+  damage->damage = storage;
+}
+
+#ifdef SHELL_ENABLE_GL
+// The engine tracks damage as a single bounding rect. A null damage array
+// means the embedder does not know what the frame buffer contains.
+static std::optional<SkIRect> ToSkIRect(const FlutterDamage& damage) {
+  if (damage.damage == nullptr) {
+    return std::nullopt;
+  }
+  SkRect bounds = SkRect::MakeEmpty();
+  for (size_t i = 0; i < damage.num_rects; ++i) {
+    const FlutterRect& rect = damage.damage[i];
+    bounds.join(SkRect::MakeLTRB(rect.left, rect.top, rect.right, rect.bottom));
+  }
+  return bounds.roundOut();
+}
+#endif  // SHELL_ENABLE_GL
+
 static flutter::Shell::CreateCallback<flutter::PlatformView>
 InferOpenGLPlatformViewCreationCallback(
     const FlutterRendererConfig* config,
@@ -195,15 +232,22 @@ InferOpenGLPlatformViewCreationCallback(
   auto gl_clear_current = [ptr = config->open_gl.clear_current,
                            user_data]() -> bool { return ptr(user_data); };
 
-  auto gl_present = [present = config->open_gl.present,
-                     present_with_info = config->open_gl.present_with_info,
-                     user_data](uint32_t fbo_id) -> bool {
+  auto gl_present =
+      [present = config->open_gl.present,
+       present_with_info = config->open_gl.present_with_info,
+       user_data](const flutter::GLPresentInfo& gl_present_info) -> bool {
     if (present) {
       return present(user_data);
     } else {
+      FlutterRect frame_damage_rect = {};
+      FlutterRect buffer_damage_rect = {};
       FlutterPresentInfo present_info = {};
       present_info.struct_size = sizeof(FlutterPresentInfo);
-      present_info.fbo_id = fbo_id;
+      present_info.fbo_id = gl_present_info.fbo_id;
+      PopulateFlutterDamage(gl_present_info.frame_damage, &frame_damage_rect,
+                            &present_info.frame_damage);
+      PopulateFlutterDamage(gl_present_info.buffer_damage, &buffer_damage_rect,
+                            &present_info.buffer_damage);
       return present_with_info(user_data, &present_info);
     }
   };
@@ -269,6 +313,20 @@ InferOpenGLPlatformViewCreationCallback(
 #endif
   }
 
+  std::function<std::optional<SkIRect>(intptr_t)>
+      gl_populate_existing_damage = nullptr;
+  if (SAFE_ACCESS(open_gl_config, populate_existing_damage, nullptr) !=
+      nullptr) {
+    gl_populate_existing_damage =
+        [ptr = config->open_gl.populate_existing_damage,
+         user_data](intptr_t fbo_id) -> std::optional<SkIRect> {
+      FlutterDamage existing_damage = {};
+      existing_damage.struct_size = sizeof(FlutterDamage);
+      ptr(user_data, fbo_id, &existing_damage);
+      return ToSkIRect(existing_damage);
+    };
+  }
+
   bool fbo_reset_after_present =
       SAFE_ACCESS(open_gl_config, fbo_reset_after_present, false);
 
@@ -280,6 +338,7 @@ InferOpenGLPlatformViewCreationCallback(
       gl_make_resource_current_callback,   // gl_make_resource_current_callback
       gl_surface_transformation_callback,  // gl_surface_transformation_callback
       gl_proc_resolver,                    // gl_proc_resolver
+      gl_populate_existing_damage,         // gl_populate_existing_damage
   };
 
   return fml::MakeCopyable(
@@ -380,15 +439,44 @@ InferSoftwarePlatformViewCreationCallback(
     return nullptr;
   }
 
-  auto software_present_backing_store =
-      [ptr = config->software.surface_present_callback, user_data](
-          const void* allocation, size_t row_bytes, size_t height) -> bool {
-    return ptr(user_data, allocation, row_bytes, height);
-  };
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
+
+  std::function<bool(const void*, size_t, size_t)>
+      software_present_backing_store = nullptr;
+  if (SAFE_ACCESS(software_config, surface_present_callback, nullptr) !=
+      nullptr) {
+    software_present_backing_store =
+        [ptr = config->software.surface_present_callback, user_data](
+            const void* allocation, size_t row_bytes, size_t height) -> bool {
+      return ptr(user_data, allocation, row_bytes, height);
+    };
+  }
+
+  std::function<bool(const void*, size_t, size_t,
+                     const std::optional<SkIRect>&)>
+      software_present_backing_store_with_damage = nullptr;
+  if (SAFE_ACCESS(software_config, surface_present_with_info_callback,
+                  nullptr) != nullptr) {
+    software_present_backing_store_with_damage =
+        [ptr = config->software.surface_present_with_info_callback,
+         user_data](const void* allocation, size_t row_bytes, size_t height,
+                    const std::optional<SkIRect>& frame_damage) -> bool {
+      FlutterRect frame_damage_rect = {};
+      FlutterSoftwarePresentInfo present_info = {};
+      present_info.struct_size = sizeof(FlutterSoftwarePresentInfo);
+      present_info.allocation = allocation;
+      present_info.row_bytes = row_bytes;
+      present_info.height = height;
+      PopulateFlutterDamage(frame_damage, &frame_damage_rect,
+                            &present_info.frame_damage);
+      return ptr(user_data, &present_info);
+    };
+  }
 
   flutter::EmbedderSurfaceSoftware::SoftwareDispatchTable
       software_dispatch_table = {
-          software_present_backing_store,  // required
+          software_present_backing_store,              // optional
+          software_present_backing_store_with_damage,  // optional
       };
 
   return fml::MakeCopyable(
@@ -2207,6 +2295,53 @@ FlutterEngineResult FlutterEngineNotifyDisplayUpdate(
   }
 }
 
+static FlutterHistogramSummary SummarizeHistogram(
+    const flutter::Histogram& histogram) {
+  FlutterHistogramSummary summary = {};
+  summary.count = histogram.count();
+  summary.min = histogram.min();
+  summary.max = histogram.max();
+  summary.mean = histogram.Mean();
+  summary.p50 = histogram.ValueAtPercentile(50);
+  summary.p90 = histogram.ValueAtPercentile(90);
+  summary.p99 = histogram.ValueAtPercentile(99);
+  summary.p99_9 = histogram.ValueAtPercentile(99.9);
+  return summary;
+}
+
+FlutterEngineResult FlutterEngineGetFrameTimingHistograms(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    bool reset,
+    FlutterFrameTimingHistograms* histograms) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (histograms == nullptr ||
+      histograms->struct_size != sizeof(FlutterFrameTimingHistograms)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid FlutterFrameTimingHistograms.");
+  }
+
+  auto frame_timing_histograms =
+      engine->GetShell().GetFrameTimingHistograms(reset);
+  if (!frame_timing_histograms) {
+    return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                              "The rasterizer was unavailable.");
+  }
+
+  histograms->build_time_micros =
+      SummarizeHistogram(frame_timing_histograms->build_time);
+  histograms->raster_time_micros =
+      SummarizeHistogram(frame_timing_histograms->raster_time);
+  histograms->vsync_lag_micros =
+      SummarizeHistogram(frame_timing_histograms->vsync_lag);
+  histograms->raster_cache_hit_percentage =
+      SummarizeHistogram(frame_timing_histograms->raster_cache_hit_percentage);
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEngineGetProcAddresses(
     FlutterEngineProcTable* table) {
   if (!table) {
@@ -2257,6 +2392,7 @@ FlutterEngineResult FlutterEngineGetProcAddresses(
   SET_PROC(PostCallbackOnAllNativeThreads,
            FlutterEnginePostCallbackOnAllNativeThreads);
   SET_PROC(NotifyDisplayUpdate, FlutterEngineNotifyDisplayUpdate);
+  SET_PROC(GetFrameTimingHistograms, FlutterEngineGetFrameTimingHistograms);
 #undef SET_PROC
 
   return kSuccess;
@@ -338,6 +338,16 @@ typedef struct {
   double y;
 } FlutterPoint;
 
+/// A structure to represent a damage region made up of rectangles.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterDamage).
+  size_t struct_size;
+  /// The number of rectangles in the `damage` array.
+  size_t num_rects;
+  /// The rectangles making up the damage region, in physical pixels.
+  FlutterRect* damage;
+} FlutterDamage;
+
 /// A structure to represent a rounded rectangle.
 typedef struct {
   FlutterRect rect;
@@ -371,6 +381,17 @@ typedef struct {
   size_t struct_size;
   /// Id of the fbo backing the surface that was presented.
   uint32_t fbo_id;
+  /// The area of the surface that changed since the previously presented
+  /// frame. Corresponds to the surface damage of EGL_KHR_partial_update and
+  /// may be passed to eglSwapBuffersWithDamageKHR. Only populated when
+  /// `FlutterOpenGLRendererConfig.populate_existing_damage` is specified;
+  /// otherwise `num_rects` is zero and the whole surface changed.
+  FlutterDamage frame_damage;
+  /// The area of the fbo that was painted to. Corresponds to the buffer damage
+  /// of EGL_KHR_partial_update and may be passed to eglSetDamageRegionKHR.
+  /// Only populated when `FlutterOpenGLRendererConfig.populate_existing_damage`
+  /// is specified; otherwise `num_rects` is zero and the whole fbo was painted.
+  FlutterDamage buffer_damage;
 } FlutterPresentInfo;
 
 /// Callback for when a surface is presented.
@@ -378,6 +399,15 @@ typedef bool (*BoolPresentInfoCallback)(
     void* /* user data */,
     const FlutterPresentInfo* /* present info */);
 
+/// Callback for when the engine needs to know which part of a frame buffer
+/// object is stale relative to the most recently presented frame.
+///
+/// See: \ref FlutterOpenGLRendererConfig.populate_existing_damage.
+typedef void (*FlutterFrameBufferWithDamageCallback)(
+    void* /* user data */,
+    const intptr_t /* fbo id */,
+    FlutterDamage* /* existing damage */);
+
 typedef struct {
   /// The size of this struct. Must be sizeof(FlutterOpenGLRendererConfig).
   size_t struct_size;
@@ -436,6 +466,23 @@ typedef struct {
   /// `FlutterPresentInfo` struct that the embedder can use to release any
   /// resources. The return value indicates success of the present call.
   BoolPresentInfoCallback present_with_info;
+  /// Specifying this callback opts the embedder into partial repaint. Before
+  /// rendering to an fbo, the engine asks for the area of the fbo that is
+  /// stale relative to the most recently presented frame (for example, the
+  /// damage accumulated since the fbo was last presented when the swapchain
+  /// has more than one buffer). The engine passes in a `FlutterDamage` with
+  /// `num_rects` set to zero and `damage` set to null. The embedder either
+  /// leaves `damage` null, which means the contents of the fbo are unknown and
+  /// the whole frame is repainted, or points `damage` at `num_rects` rects
+  /// that stay valid until the callback returns. A non-null `damage` with
+  /// `num_rects` of zero means the fbo holds the last presented frame. The
+  /// engine then repaints only what changed and reports the damage in the
+  /// `FlutterPresentInfo` passed to `present_with_info`, so embedders using
+  /// this callback should specify `present_with_info`.
+  ///
+  /// Partial repaint is not performed when a `FlutterCompositor` is used.
+  /// This callback is optional.
+  FlutterFrameBufferWithDamageCallback populate_existing_damage;
 } FlutterOpenGLRendererConfig;
 
 /// Alias for id<MTLDevice>.
@@ -529,6 +576,29 @@ typedef struct {
   FlutterMetalTextureFrameCallback external_texture_frame_callback;
 } FlutterMetalRendererConfig;
 
+/// This information is passed to the embedder when a software surface is
+/// presented.
+///
+/// See: \ref FlutterSoftwareRendererConfig.surface_present_with_info_callback.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterSoftwarePresentInfo).
+  size_t struct_size;
+  /// The fully populated buffer. The pixel format of the buffer is the native
+  /// 32-bit RGBA format.
+  const void* allocation;
+  /// The number of bytes in a row of the buffer.
+  size_t row_bytes;
+  /// The number of rows in the buffer.
+  size_t height;
+  /// The area of the buffer that changed since the previously presented frame.
+  /// If `num_rects` is zero, the whole buffer changed.
+  FlutterDamage frame_damage;
+} FlutterSoftwarePresentInfo;
+
+typedef bool (*SoftwareSurfacePresentWithInfoCallback)(
+    void* /* user data */,
+    const FlutterSoftwarePresentInfo* /* present info */);
+
 typedef struct {
   /// The size of this struct. Must be sizeof(FlutterSoftwareRendererConfig).
   size_t struct_size;
@@ -537,6 +607,15 @@ typedef struct {
   /// format. The buffer is owned by the Flutter engine and must be copied in
   /// this callback if needed.
   SoftwareSurfacePresentCallback surface_present_callback;
+  /// Specifying one (and only one) of `surface_present_callback` or
+  /// `surface_present_with_info_callback` is required. Specifying both is an
+  /// error and engine initialization will be terminated. When using this
+  /// variant, the engine retains the contents of the buffer between frames,
+  /// only repaints the area that changed and reports that area in the
+  /// `FlutterSoftwarePresentInfo`. The embedder then only needs to copy the
+  /// damaged area out of the buffer. Partial repaint is not performed when a
+  /// `FlutterCompositor` is used.
+  SoftwareSurfacePresentWithInfoCallback surface_present_with_info_callback;
 } FlutterSoftwareRendererConfig;
 
 typedef struct {
@@ -1522,6 +1601,40 @@ typedef struct {
   const char* log_tag;
 } FlutterProjectArgs;
 
+/// A summary of one of the histograms in `FlutterFrameTimingHistograms`. All
+/// values are zero if nothing was recorded.
+typedef struct {
+  /// The number of frames recorded.
+  uint64_t count;
+  int64_t min;
+  int64_t max;
+  double mean;
+  /// The values that 50%, 90%, 99% and 99.9% of the recorded values are less
+  /// than or equal to. Each is at most 1/32 (about 3%) larger than the
+  /// exact value.
+  int64_t p50;
+  int64_t p90;
+  int64_t p99;
+  int64_t p99_9;
+} FlutterHistogramSummary;
+
+/// Histograms of per-frame metrics kept by the engine. See
+/// `FlutterEngineGetFrameTimingHistograms`.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterFrameTimingHistograms).
+  size_t struct_size;
+  /// The time the UI thread took to build each frame, in microseconds.
+  FlutterHistogramSummary build_time_micros;
+  /// The time the raster thread took to draw each frame, in microseconds.
+  FlutterHistogramSummary raster_time_micros;
+  /// The time from the vsync to the start of the build of each frame, in
+  /// microseconds.
+  FlutterHistogramSummary vsync_lag_micros;
+  /// The percentage of raster cache lookups in each frame that drew a cached
+  /// image. Frames that did not look anything up are not recorded.
+  FlutterHistogramSummary raster_cache_hit_percentage;
+} FlutterFrameTimingHistograms;
+
 #ifndef FLUTTER_ENGINE_NO_PROTOTYPES
 
 //------------------------------------------------------------------------------
@@ -2182,6 +2295,29 @@ FlutterEngineResult FlutterEngineNotifyDisplayUpdate(
     const FlutterEngineDisplay* displays,
     size_t display_count);
 
+//------------------------------------------------------------------------------
+/// @brief      Reads the histograms of per-frame metrics the engine has
+///             recorded since it was started or since they were last reset.
+///             The histograms use a fixed amount of memory, so this is a
+///             cheap way to monitor percentiles of frame times without
+///             collecting the timing of every frame.
+///
+/// @attention  This call blocks until the raster thread has copied the
+///             histograms.
+///
+/// @param[in]  engine      A running engine instance.
+/// @param[in]  reset       Whether to clear the histograms after reading them.
+/// @param[out] histograms  The summaries of the histograms. The struct_size
+///                         must be set by the caller.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetFrameTimingHistograms(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    bool reset,
+    FlutterFrameTimingHistograms* histograms);
+
 #endif  // !FLUTTER_ENGINE_NO_PROTOTYPES
 
 // Typedefs for the function pointers in FlutterEngineProcTable.
@@ -2298,6 +2434,10 @@ typedef FlutterEngineResult (*FlutterEngineNotifyDisplayUpdateFnPtr)(
     FlutterEngineDisplaysUpdateType update_type,
     const FlutterEngineDisplay* displays,
     size_t display_count);
+typedef FlutterEngineResult (*FlutterEngineGetFrameTimingHistogramsFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    bool reset,
+    FlutterFrameTimingHistograms* histograms);
 
 /// Function-pointer-based versions of the APIs above.
 typedef struct {
@@ -2342,6 +2482,7 @@ typedef struct {
   FlutterEnginePostCallbackOnAllNativeThreadsFnPtr
       PostCallbackOnAllNativeThreads;
   FlutterEngineNotifyDisplayUpdateFnPtr NotifyDisplayUpdate;
+  FlutterEngineGetFrameTimingHistogramsFnPtr GetFrameTimingHistograms;
 } FlutterEngineProcTable;
 
 //------------------------------------------------------------------------------
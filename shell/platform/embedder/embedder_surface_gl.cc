@@ -46,7 +46,29 @@ bool EmbedderSurfaceGL::GLContextClearCurrent() {
 
 // |GPUSurfaceGLDelegate|
 bool EmbedderSurfaceGL::GLContextPresent(uint32_t fbo_id) {
-  return gl_dispatch_table_.gl_present_callback(fbo_id);
+  return gl_dispatch_table_.gl_present_callback(
+      {fbo_id, std::nullopt, std::nullopt});
+}
+
+// |GPUSurfaceGLDelegate|
+bool EmbedderSurfaceGL::GLContextPresentWithInfo(
+    const GLPresentInfo& present_info) {
+  return gl_dispatch_table_.gl_present_callback(present_info);
+}
+
+// |GPUSurfaceGLDelegate|
+bool EmbedderSurfaceGL::GLContextSupportsPartialRepaint() const {
+  return !!gl_dispatch_table_.gl_populate_existing_damage;
+}
+
+// |GPUSurfaceGLDelegate|
+std::optional<SkIRect> EmbedderSurfaceGL::GLContextFramebufferExistingDamage(
+    intptr_t fbo_id) const {
+  auto callback = gl_dispatch_table_.gl_populate_existing_damage;
+  if (!callback) {
+    return std::nullopt;
+  }
+  return callback(fbo_id);
 }
 
 // |GPUSurfaceGLDelegate|
@@ -18,12 +18,14 @@ class EmbedderSurfaceGL final : public EmbedderSurface,
   struct GLDispatchTable {
     std::function<bool(void)> gl_make_current_callback;           // required
     std::function<bool(void)> gl_clear_current_callback;          // required
-    std::function<bool(uint32_t)> gl_present_callback;            // required
+    std::function<bool(GLPresentInfo)> gl_present_callback;       // required
     std::function<intptr_t(GLFrameInfo)> gl_fbo_callback;         // required
     std::function<bool(void)> gl_make_resource_current_callback;  // optional
     std::function<SkMatrix(void)>
         gl_surface_transformation_callback;              // optional
     std::function<void*(const char*)> gl_proc_resolver;  // optional
+    std::function<std::optional<SkIRect>(intptr_t)>
+        gl_populate_existing_damage;  // optional
   };
 
   EmbedderSurfaceGL(
@@ -58,6 +60,16 @@ class EmbedderSurfaceGL final : public EmbedderSurface,
   // |GPUSurfaceGLDelegate|
   bool GLContextPresent(uint32_t fbo_id) override;
 
+  // |GPUSurfaceGLDelegate|
+  bool GLContextPresentWithInfo(const GLPresentInfo& present_info) override;
+
+  // |GPUSurfaceGLDelegate|
+  bool GLContextSupportsPartialRepaint() const override;
+
+  // |GPUSurfaceGLDelegate|
+  std::optional<SkIRect> GLContextFramebufferExistingDamage(
+      intptr_t fbo_id) const override;
+
   // |GPUSurfaceGLDelegate|
   intptr_t GLContextFBO(GLFrameInfo frame_info) const override;
 
@@ -14,7 +14,8 @@ EmbedderSurfaceSoftware::EmbedderSurfaceSoftware(
     std::shared_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
     : software_dispatch_table_(software_dispatch_table),
       external_view_embedder_(external_view_embedder) {
-  if (!software_dispatch_table_.software_present_backing_store) {
+  if (!software_dispatch_table_.software_present_backing_store &&
+      !software_dispatch_table_.software_present_backing_store_with_damage) {
     return;
   }
   valid_ = true;
@@ -78,32 +79,63 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
 // |GPUSurfaceSoftwareDelegate|
 bool EmbedderSurfaceSoftware::PresentBackingStore(
     sk_sp<SkSurface> backing_store) {
+  return PresentBackingStoreWithDamage(std::move(backing_store), std::nullopt);
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::SupportsPartialRepaint() const {
+  return !!software_dispatch_table_.software_present_backing_store_with_damage;
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PresentBackingStoreWithDamage(
+    sk_sp<SkSurface> backing_store,
+    const std::optional<SkIRect>& frame_damage) {
   if (!IsValid()) {
     FML_LOG(ERROR) << "Tried to present an invalid software surface.";
     return false;
   }
 
   SkPixmap pixmap;
-  if (!backing_store->peekPixels(&pixmap)) {
+  if (!PeekBackingStorePixels(backing_store, &pixmap)) {
+    return false;
+  }
+
+  if (software_dispatch_table_.software_present_backing_store_with_damage) {
+    return software_dispatch_table_.software_present_backing_store_with_damage(
+        pixmap.addr(),      //
+        pixmap.rowBytes(),  //
+        pixmap.height(),    //
+        frame_damage        //
+    );
+  }
+
+  return software_dispatch_table_.software_present_backing_store(
+      pixmap.addr(),      //
+      pixmap.rowBytes(),  //
+      pixmap.height()     //
+  );
+}
+
+bool EmbedderSurfaceSoftware::PeekBackingStorePixels(
+    const sk_sp<SkSurface>& backing_store,
+    SkPixmap* pixmap) const {
+  if (!backing_store->peekPixels(pixmap)) {
     FML_LOG(ERROR) << "Could not peek the pixels of the backing store.";
     return false;
   }
 
   // Some basic sanity checking.
-  uint64_t expected_pixmap_data_size = pixmap.width() * pixmap.height() * 4;
+  uint64_t expected_pixmap_data_size = pixmap->width() * pixmap->height() * 4;
 
-  const size_t pixmap_size = pixmap.computeByteSize();
+  const size_t pixmap_size = pixmap->computeByteSize();
 
   if (expected_pixmap_data_size != pixmap_size) {
     FML_LOG(ERROR) << "Software backing store had unexpected size.";
     return false;
   }
 
-  return software_dispatch_table_.software_present_backing_store(
-      pixmap.addr(),      //
-      pixmap.rowBytes(),  //
-      pixmap.height()     //
-  );
+  return true;
 }
 
 }  // namespace flutter
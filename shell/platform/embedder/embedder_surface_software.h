@@ -16,8 +16,15 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
                                       public GPUSurfaceSoftwareDelegate {
  public:
   struct SoftwareDispatchTable {
+    // One of the present callbacks is required. Providing the variant that
+    // takes the frame damage enables partial repaint.
     std::function<bool(const void* allocation, size_t row_bytes, size_t height)>
-        software_present_backing_store;  // required
+        software_present_backing_store;  // optional
+    std::function<bool(const void* allocation,
+                       size_t row_bytes,
+                       size_t height,
+                       const std::optional<SkIRect>& frame_damage)>
+        software_present_backing_store_with_damage;  // optional
   };
 
   EmbedderSurfaceSoftware(
@@ -47,6 +54,17 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   // |GPUSurfaceSoftwareDelegate|
   bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
 
+  // |GPUSurfaceSoftwareDelegate|
+  bool SupportsPartialRepaint() const override;
+
+  // |GPUSurfaceSoftwareDelegate|
+  bool PresentBackingStoreWithDamage(
+      sk_sp<SkSurface> backing_store,
+      const std::optional<SkIRect>& frame_damage) override;
+
+  bool PeekBackingStorePixels(const sk_sp<SkSurface>& backing_store,
+                              SkPixmap* pixmap) const;
+
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderSurfaceSoftware);
 };
 
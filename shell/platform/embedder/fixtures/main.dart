@@ -746,6 +746,24 @@ void platform_view_mutators_with_pixel_ratio() {
   PlatformDispatcher.instance.scheduleFrame();
 }
 
+@pragma('vm:entry-point')
+void render_unchanged_then_changed_scene() {
+  // Frame 0 and 1 are identical. Frame 2 changes the color of the second box.
+  int frame = 0;
+  PlatformDispatcher.instance.onBeginFrame = (Duration duration) {
+    Color color = frame < 2 ? Color.fromARGB(255, 255, 0, 0) : Color.fromARGB(255, 0, 0, 255);
+    SceneBuilder builder = SceneBuilder();
+    builder.addPicture(Offset(0.0, 0.0), CreateColoredBox(Color.fromARGB(255, 0, 255, 0), Size(100.0, 100.0)));
+    builder.addPicture(Offset(200.0, 200.0), CreateColoredBox(color, Size(100.0, 100.0)));
+    PlatformDispatcher.instance.views.first.render(builder.build());
+    frame++;
+    if (frame < 3) {
+      PlatformDispatcher.instance.scheduleFrame();
+    }
+  };
+  PlatformDispatcher.instance.scheduleFrame();
+}
+
 @pragma('vm:entry-point')
 void empty_scene() {
   PlatformDispatcher.instance.onBeginFrame = (Duration duration) {
@@ -20,6 +20,22 @@
 namespace flutter {
 namespace testing {
 
+static sk_sp<SkImage> MakeImageFromSoftwareBuffer(const void* allocation,
+                                                  size_t row_bytes,
+                                                  size_t height) {
+  auto image_info =
+      SkImageInfo::MakeN32Premul(SkISize::Make(row_bytes / 4, height));
+  SkBitmap bitmap;
+  if (!bitmap.installPixels(image_info, const_cast<void*>(allocation),
+                            row_bytes)) {
+    FML_LOG(ERROR) << "Could not copy pixels for the software "
+                      "composition from the engine.";
+    return nullptr;
+  }
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
 EmbedderConfigBuilder::EmbedderConfigBuilder(
     EmbedderTestContext& context,
     InitializationPreference preference)
@@ -77,18 +93,12 @@ EmbedderConfigBuilder::EmbedderConfigBuilder(
   software_renderer_config_.surface_present_callback =
       [](void* context, const void* allocation, size_t row_bytes,
          size_t height) {
-        auto image_info =
-            SkImageInfo::MakeN32Premul(SkISize::Make(row_bytes / 4, height));
-        SkBitmap bitmap;
-        if (!bitmap.installPixels(image_info, const_cast<void*>(allocation),
-                                  row_bytes)) {
-          FML_LOG(ERROR) << "Could not copy pixels for the software "
-                            "composition from the engine.";
+        auto image = MakeImageFromSoftwareBuffer(allocation, row_bytes, height);
+        if (!image) {
           return false;
         }
-        bitmap.setImmutable();
         return reinterpret_cast<EmbedderTestContextSoftware*>(context)->Present(
-            SkImage::MakeFromBitmap(bitmap));
+            std::move(image));
       };
 
   // The first argument is treated as the executable name. Don't make tests have
@@ -126,6 +136,24 @@ void EmbedderConfigBuilder::SetSoftwareRendererConfig(SkISize surface_size) {
   context_.SetupSurface(surface_size);
 }
 
+void EmbedderConfigBuilder::SetSoftwarePresentWithInfoCallBack() {
+  // SetSoftwareRendererConfig must be called before this.
+  FML_CHECK(renderer_config_.type == FlutterRendererType::kSoftware);
+  // Only one of the two present callbacks may be specified.
+  renderer_config_.software.surface_present_callback = nullptr;
+  renderer_config_.software.surface_present_with_info_callback =
+      [](void* context, const FlutterSoftwarePresentInfo* present_info) {
+        auto image = MakeImageFromSoftwareBuffer(present_info->allocation,
+                                                 present_info->row_bytes,
+                                                 present_info->height);
+        if (!image) {
+          return false;
+        }
+        return reinterpret_cast<EmbedderTestContextSoftware*>(context)
+            ->PresentWithInfo(std::move(image), *present_info);
+      };
+}
+
 void EmbedderConfigBuilder::SetOpenGLFBOCallBack() {
 #ifdef SHELL_ENABLE_GL
   // SetOpenGLRendererConfig must be called before this.
@@ -50,6 +50,12 @@ class EmbedderConfigBuilder {
 
   void SetMetalRendererConfig(SkISize surface_size);
 
+  // Used to replace the `software.surface_present_callback` set by the ctor
+  // with a `software.surface_present_with_info_callback`, which opts the
+  // engine into partial repaint. SetSoftwareRendererConfig must be called
+  // before this.
+  void SetSoftwarePresentWithInfoCallBack();
+
   // Used to explicitly set an `open_gl.fbo_callback`. Using this method will
   // cause your test to fail since the ctor for this class sets
   // `open_gl.fbo_callback_with_frame_info`. This method exists as a utility to
@@ -30,6 +30,28 @@ bool EmbedderTestContextSoftware::Present(sk_sp<SkImage> image) {
   return true;
 }
 
+bool EmbedderTestContextSoftware::PresentWithInfo(
+    sk_sp<SkImage> image,
+    const FlutterSoftwarePresentInfo& present_info) {
+  SoftwarePresentCallback callback;
+  {
+    std::scoped_lock lock(software_present_callback_mutex_);
+    callback = software_present_callback_;
+  }
+
+  if (callback) {
+    callback(present_info);
+  }
+
+  return Present(std::move(image));
+}
+
+void EmbedderTestContextSoftware::SetSoftwarePresentCallback(
+    SoftwarePresentCallback callback) {
+  std::scoped_lock lock(software_present_callback_mutex_);
+  software_present_callback_ = callback;
+}
+
 size_t EmbedderTestContextSoftware::GetSurfacePresentCount() const {
   return software_surface_present_count_;
 }
@@ -12,6 +12,9 @@ namespace testing {
 
 class EmbedderTestContextSoftware : public EmbedderTestContext {
  public:
+  using SoftwarePresentCallback =
+      std::function<void(const FlutterSoftwarePresentInfo& present_info)>;
+
   EmbedderTestContextSoftware(std::string assets_path = "");
 
   ~EmbedderTestContextSoftware() override;
@@ -23,6 +26,23 @@ class EmbedderTestContextSoftware : public EmbedderTestContext {
 
   bool Present(sk_sp<SkImage> image);
 
+  bool PresentWithInfo(sk_sp<SkImage> image,
+                       const FlutterSoftwarePresentInfo& present_info);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets a callback that will be invoked (on the raster task
+  ///             runner) when the engine presents the software surface through
+  ///             `surface_present_with_info_callback`.
+  ///
+  /// @attention  The callback will be invoked on the raster task runner. The
+  ///             callback can be set on the tests host thread. The damage rects
+  ///             in the present info are only valid during the callback.
+  ///
+  /// @param[in]  callback  The callback to set. The previous callback will be
+  ///                       un-registered.
+  ///
+  void SetSoftwarePresentCallback(SoftwarePresentCallback callback);
+
  protected:
   virtual void SetupCompositor() override;
 
@@ -30,6 +50,8 @@ class EmbedderTestContextSoftware : public EmbedderTestContext {
   sk_sp<SkSurface> surface_;
   SkISize surface_size_;
   size_t software_surface_present_count_ = 0;
+  std::mutex software_present_callback_mutex_;
+  SoftwarePresentCallback software_present_callback_;
   void SetupSurface(SkISize surface_size) override;
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderTestContextSoftware);
@@ -4,6 +4,7 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -1001,6 +1002,86 @@ TEST_F(EmbedderTest, VerifyB143464703WithSoftwareBackend) {
       ImageMatchesFixture("verifyb143464703_soft_noxform.png", rendered_scene));
 }
 
+// Runs the "render_unchanged_then_changed_scene" entrypoint on the software
+// backend with `surface_present_with_info_callback` and returns the frame
+// damage reported for each of its three frames. Damage that covers the whole
+// surface is returned as std::nullopt.
+static std::vector<std::optional<SkIRect>> GetSoftwareFrameDamageOfScenes(
+    EmbedderTestContext& context) {
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig(SkISize::Make(800, 600));
+  builder.SetSoftwarePresentWithInfoCallBack();
+  builder.SetDartEntrypoint("render_unchanged_then_changed_scene");
+
+  std::mutex frame_damage_mutex;
+  std::vector<std::optional<SkIRect>> frame_damage;
+  fml::CountDownLatch latch(3);
+  static_cast<EmbedderTestContextSoftware&>(context).SetSoftwarePresentCallback(
+      [&](const FlutterSoftwarePresentInfo& present_info) {
+        std::optional<SkIRect> damage;
+        const FlutterDamage& reported = present_info.frame_damage;
+        EXPECT_EQ(reported.struct_size, sizeof(FlutterDamage));
+        if (reported.num_rects > 0) {
+          EXPECT_EQ(reported.num_rects, 1u);
+          const FlutterRect& rect = reported.damage[0];
+          damage = SkIRect::MakeLTRB(rect.left, rect.top, rect.right,
+                                     rect.bottom);
+        }
+        {
+          std::scoped_lock lock(frame_damage_mutex);
+          if (frame_damage.size() == 3u) {
+            return;
+          }
+          frame_damage.push_back(damage);
+        }
+        latch.CountDown();
+      });
+
+  auto engine = builder.LaunchEngine();
+  EXPECT_TRUE(engine.is_valid());
+
+  // Send a window metrics events so frames may be scheduled.
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  EXPECT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+
+  latch.Wait();
+  engine.reset();
+  static_cast<EmbedderTestContextSoftware&>(context).SetSoftwarePresentCallback(
+      nullptr);
+
+  std::scoped_lock lock(frame_damage_mutex);
+  return frame_damage;
+}
+
+TEST_F(EmbedderTest, SoftwarePresentInfoReportsNoDamageForUnchangedFrame) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  auto frame_damage = GetSoftwareFrameDamageOfScenes(context);
+
+  ASSERT_EQ(frame_damage.size(), 3u);
+  // There is no previous frame to diff the first one against.
+  ASSERT_FALSE(frame_damage[0].has_value());
+  // The second frame draws the same boxes as the first.
+  ASSERT_TRUE(frame_damage[1].has_value());
+  ASSERT_TRUE(frame_damage[1]->isEmpty());
+}
+
+TEST_F(EmbedderTest, SoftwarePresentInfoReportsDamageOfChangedFrame) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  auto frame_damage = GetSoftwareFrameDamageOfScenes(context);
+
+  ASSERT_EQ(frame_damage.size(), 3u);
+  // The third frame only changes the color of the box at (200, 200).
+  ASSERT_TRUE(frame_damage[2].has_value());
+  ASSERT_EQ(*frame_damage[2], SkIRect::MakeLTRB(200, 200, 300, 300));
+}
+
 TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
 
@@ -1019,6 +1100,30 @@ TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   ASSERT_EQ(FlutterEngineNotifyLowMemoryWarning(engine.get()), kSuccess);
 }
 
+TEST_F(EmbedderTest, CanGetFrameTimingHistograms) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterFrameTimingHistograms histograms = {};
+  ASSERT_EQ(FlutterEngineGetFrameTimingHistograms(engine.get(), false,
+                                                  &histograms),
+            kInvalidArguments);
+
+  histograms.struct_size = sizeof(FlutterFrameTimingHistograms);
+  ASSERT_EQ(FlutterEngineGetFrameTimingHistograms(engine.get(), true,
+                                                  &histograms),
+            kSuccess);
+  // No frames were scheduled.
+  ASSERT_EQ(histograms.build_time_micros.count, 0u);
+  ASSERT_EQ(histograms.raster_cache_hit_percentage.p99, 0);
+}
+
 TEST_F(EmbedderTest, CanPostTaskToAllNativeThreads) {
   UniqueEngine engine;
   size_t worker_count = 0;
@@ -71,6 +71,22 @@ void main() {
     expect(codec.frameCount, 1);
   });
 
+  test('image descriptor decodes regions', () async {
+    final Uint8List bytes = await _getSkiaResource('test640x479.gif').readAsBytes();
+    final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
+    final ImageDescriptor descriptor = await ImageDescriptor.encoded(buffer);
+
+    Image image = await descriptor.decodeRegion(const Rect.fromLTWH(100, 50, 200, 100));
+    expect(image.width, 200);
+    expect(image.height, 100);
+
+    image = await descriptor.decodeRegion(const Rect.fromLTWH(100, 50, 200, 100), targetWidth: 50);
+    expect(image.width, 50);
+    expect(image.height, 25);
+
+    expect(() => descriptor.decodeRegion(const Rect.fromLTWH(600, 0, 100, 100)), throwsException);
+  });
+
   test('HEIC image', () async {
     final Uint8List bytes = await readFile('grill_chicken.heic');
     final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
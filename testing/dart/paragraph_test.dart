@@ -60,4 +60,52 @@ void main() {
       );
     }
   });
+  test('layoutAll lays out paragraphs like layout does', () {
+    Paragraph buildParagraph(double fontSize) {
+      final ParagraphBuilder builder = ParagraphBuilder(ParagraphStyle(
+        fontFamily: 'Ahem',
+        fontStyle: FontStyle.normal,
+        fontWeight: FontWeight.normal,
+        fontSize: fontSize,
+      ));
+      builder.addText('Test Ahem');
+      return builder.build();
+    }
+
+    final List<double> fontSizes = <double>[
+      for (int i = 0; i < 64; i++) 10.0 + i % 4 * 10.0,
+    ];
+    final List<Paragraph> paragraphs = <Paragraph>[
+      for (final double fontSize in fontSizes) buildParagraph(fontSize),
+    ];
+    final List<ParagraphConstraints> constraints = <ParagraphConstraints>[
+      for (final double fontSize in fontSizes) ParagraphConstraints(width: fontSize * 5.0),
+    ];
+    Paragraph.layoutAll(paragraphs, constraints);
+
+    for (int i = 0; i < paragraphs.length; i++) {
+      final Paragraph expected = buildParagraph(fontSizes[i]);
+      expected.layout(constraints[i]);
+      expect(paragraphs[i].width, closeTo(expected.width, 0.001));
+      expect(paragraphs[i].height, closeTo(expected.height, 0.001));
+      expect(paragraphs[i].height, closeTo(fontSizes[i] * 2.0, 0.001));
+    }
+
+    // A paragraph listed twice ends up laid out at its last width.
+    final Paragraph paragraph = buildParagraph(10.0);
+    Paragraph.layoutAll(
+      <Paragraph>[paragraph, paragraph],
+      const <ParagraphConstraints>[
+        ParagraphConstraints(width: 50.0),
+        ParagraphConstraints(width: 400.0),
+      ],
+    );
+    expect(paragraph.width, closeTo(400.0, 0.001));
+    expect(paragraph.height, closeTo(10.0, 0.001));
+
+    expect(
+      () => Paragraph.layoutAll(<Paragraph>[paragraph], const <ParagraphConstraints>[]),
+      throwsArgumentError,
+    );
+  });
 }
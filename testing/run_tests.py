@@ -171,6 +171,8 @@ def RunCCTests(build_dir, filter):
 def RunEngineBenchmarks(build_dir, filter):
   print("Running Engine Benchmarks.")
 
+  RunEngineExecutable(build_dir, 'flow_benchmarks', filter)
+
   RunEngineExecutable(build_dir, 'shell_benchmarks', filter)
 
   RunEngineExecutable(build_dir, 'fml_benchmarks', filter)
@@ -16,6 +16,7 @@
 
 #include "flutter/fml/logging.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/Layout.h"
 #include "third_party/benchmark/include/benchmark/benchmark_api.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -197,4 +198,42 @@ static void BM_ParagraphBuilderLongParagraphConstruct(benchmark::State& state) {
 }
 BENCHMARK(BM_ParagraphBuilderLongParagraphConstruct);
 
+// Builds and lays out a paragraph of Latin text in a single style, with the
+// advance tables of minikin off (0) or on (1). Ahem is used because it needs
+// no shaping; text in fonts with kerning or ligatures is always shaped.
+static void BM_ParagraphBuilderLatinParagraphLayout(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Ahem");
+  text_style.color = SK_ColorBLACK;
+  auto font_collection = GetTestFontCollection();
+  minikin::Layout::setAdvanceTablesEnabled(state.range(0) != 0);
+  while (state.KeepRunning()) {
+    txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    auto paragraph = builder.Build();
+    paragraph->Layout(300);
+  }
+  minikin::Layout::setAdvanceTablesEnabled(true);
+}
+BENCHMARK(BM_ParagraphBuilderLatinParagraphLayout)->Arg(0)->Arg(1);
+
 }  // namespace txt
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2017 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks of paragraphs built from the text in benchmarks/corpus, which
+// mixes scripts the way app content does: Latin with other European scripts,
+// CJK, Arabic and Hebrew with embedded Latin and numbers, emoji sequences,
+// and Thai and Khmer, which need dictionary based line breaking. Each corpus
+// file opens with Article 1 of the Universal Declaration of Human Rights in
+// its languages. The test fonts have no Hebrew or Thai glyphs, so those are
+// shaped with the missing glyph but still itemized and broken into lines.
+//
+// Every benchmark runs once per corpus file, plus once for a single very
+// long paragraph made of all of them, and once per paragraph implementation.
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/testing/testing.h"
+#include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/Layout.h"
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "txt/font_collection.h"
+#include "txt/paragraph.h"
+#include "txt/paragraph_builder.h"
+
+#if FLUTTER_ENABLE_SKSHAPER
+#include "third_party/skia/modules/skparagraph/include/FontCollection.h"
+#include "third_party/skia/modules/skparagraph/include/ParagraphCache.h"
+#endif
+
+namespace txt {
+
+namespace {
+
+constexpr double kLayoutWidth = 300;
+
+const char* const kCorpusFiles[] = {
+    "latin.txt", "cjk.txt", "bidi.txt", "emoji.txt", "southeast_asian.txt",
+};
+constexpr size_t kCorpusFileCount = std::size(kCorpusFiles);
+
+// The index of the paragraph made of the whole corpus.
+constexpr size_t kLongParagraph = kCorpusFileCount;
+
+// How many times the whole corpus is repeated in the long paragraph.
+constexpr size_t kLongParagraphRepeats = 8;
+
+enum ParagraphKind {
+  kTxtParagraph,
+  kSkiaParagraph,
+};
+
+std::u16string ReadCorpusFile(const char* name) {
+  std::unique_ptr<fml::Mapping> mapping =
+      flutter::testing::OpenFixtureAsMapping(name);
+  FML_CHECK(mapping) << "Missing corpus file " << name;
+  auto text = icu::UnicodeString::fromUTF8(icu::StringPiece(
+      reinterpret_cast<const char*>(mapping->GetMapping()),
+      static_cast<int32_t>(mapping->GetSize())));
+  return std::u16string(text.getBuffer(), text.getBuffer() + text.length());
+}
+
+const std::u16string& GetCorpusText(size_t index) {
+  static const std::vector<std::u16string>* texts = [] {
+    auto corpus = new std::vector<std::u16string>();
+    std::u16string all;
+    for (const char* name : kCorpusFiles) {
+      corpus->push_back(ReadCorpusFile(name));
+      all += corpus->back();
+    }
+    // The long paragraph has no hard line breaks.
+    for (char16_t& c : all) {
+      if (c == u'\n') {
+        c = u' ';
+      }
+    }
+    std::u16string long_paragraph;
+    for (size_t i = 0; i < kLongParagraphRepeats; i++) {
+      long_paragraph += all;
+    }
+    corpus->push_back(std::move(long_paragraph));
+    return corpus;
+  }();
+  return (*texts)[index];
+}
+
+std::string GetCorpusName(size_t index) {
+  if (index == kLongParagraph) {
+    return "long_paragraph";
+  }
+  std::string name = kCorpusFiles[index];
+  return name.substr(0, name.find('.'));
+}
+
+// Runs a benchmark for each corpus entry with each paragraph implementation.
+void CorpusArguments(benchmark::internal::Benchmark* benchmark) {
+  for (size_t corpus = 0; corpus <= kLongParagraph; corpus++) {
+    benchmark->ArgPair(corpus, kTxtParagraph);
+#if FLUTTER_ENABLE_SKSHAPER
+    benchmark->ArgPair(corpus, kSkiaParagraph);
+#endif
+  }
+}
+
+}  // namespace
+
+class ParagraphCorpusFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State& state) {
+    font_collection_ = GetTestFontCollection();
+
+    bitmap_ = std::make_unique<SkBitmap>();
+    bitmap_->allocN32Pixels(1000, 1000);
+    canvas_ = std::make_unique<SkCanvas>(*bitmap_);
+    canvas_->clear(SK_ColorWHITE);
+  }
+
+  void TearDown(const benchmark::State& state) { font_collection_.reset(); }
+
+ protected:
+  const std::u16string& GetText(const benchmark::State& state) {
+    return GetCorpusText(state.range(0));
+  }
+
+  std::unique_ptr<Paragraph> BuildParagraph(benchmark::State& state) {
+    txt::ParagraphStyle paragraph_style;
+
+    txt::TextStyle text_style;
+    text_style.font_families = {"Roboto", "Noto Sans CJK JP",
+                                "Noto Naskh Arabic", "Noto Sans Khmer",
+                                "Noto Color Emoji"};
+    text_style.color = SK_ColorBLACK;
+
+    std::unique_ptr<ParagraphBuilder> builder;
+    switch (state.range(1)) {
+      case kTxtParagraph:
+        builder = ParagraphBuilder::CreateTxtBuilder(paragraph_style,
+                                                     font_collection_);
+        break;
+#if FLUTTER_ENABLE_SKSHAPER
+      case kSkiaParagraph:
+        builder = ParagraphBuilder::CreateSkiaBuilder(paragraph_style,
+                                                      font_collection_);
+        break;
+#endif
+      default:
+        FML_UNREACHABLE();
+    }
+    builder->PushStyle(text_style);
+    builder->AddText(GetText(state));
+    builder->Pop();
+    return builder->Build();
+  }
+
+  std::unique_ptr<Paragraph> BuildLaidOutParagraph(benchmark::State& state) {
+    std::unique_ptr<Paragraph> paragraph = BuildParagraph(state);
+    paragraph->Layout(kLayoutWidth);
+    return paragraph;
+  }
+
+  // Clears the caches of shaped words, so the next layout shapes the text.
+  void PurgeShapingCaches(benchmark::State& state) {
+    if (state.range(1) == kTxtParagraph) {
+      minikin::Layout::purgeCaches();
+    }
+#if FLUTTER_ENABLE_SKSHAPER
+    if (state.range(1) == kSkiaParagraph) {
+      font_collection_->CreateSktFontCollection()->getParagraphCache()->reset();
+    }
+#endif
+  }
+
+  void SetLabel(benchmark::State& state) {
+    state.SetLabel(GetCorpusName(state.range(0)) +
+                   (state.range(1) == kTxtParagraph ? "/txt" : "/skia"));
+  }
+
+  std::shared_ptr<FontCollection> font_collection_;
+  std::unique_ptr<SkCanvas> canvas_;
+  std::unique_ptr<SkBitmap> bitmap_;
+};
+
+// Builds and lays out the paragraph with no shaped words cached, so this
+// covers itemization, shaping and line breaking.
+BENCHMARK_DEFINE_F(ParagraphCorpusFixture, Layout)(benchmark::State& state) {
+  SetLabel(state);
+  while (state.KeepRunning()) {
+    PurgeShapingCaches(state);
+    std::unique_ptr<Paragraph> paragraph = BuildParagraph(state);
+    paragraph->Layout(kLayoutWidth);
+  }
+  state.SetItemsProcessed(state.iterations() * GetText(state).size());
+}
+BENCHMARK_REGISTER_F(ParagraphCorpusFixture, Layout)->Apply(CorpusArguments);
+
+// Lays out an already laid out paragraph at alternating widths, which mostly
+// covers line breaking.
+BENCHMARK_DEFINE_F(ParagraphCorpusFixture, Relayout)(benchmark::State& state) {
+  SetLabel(state);
+  std::unique_ptr<Paragraph> paragraph = BuildLaidOutParagraph(state);
+  bool wide = false;
+  while (state.KeepRunning()) {
+    wide = !wide;
+    paragraph->Layout(wide ? kLayoutWidth + 20 : kLayoutWidth);
+  }
+  state.SetItemsProcessed(state.iterations() * GetText(state).size());
+}
+BENCHMARK_REGISTER_F(ParagraphCorpusFixture, Relayout)->Apply(CorpusArguments);
+
+// Queries the boxes of a selection of the whole text, of its middle third,
+// and of a caret sized range in its middle.
+BENCHMARK_DEFINE_F(ParagraphCorpusFixture, GetRectsForRange)
+(benchmark::State& state) {
+  SetLabel(state);
+  std::unique_ptr<Paragraph> paragraph = BuildLaidOutParagraph(state);
+  const size_t size = GetText(state).size();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(paragraph->GetRectsForRange(
+        0, size, Paragraph::RectHeightStyle::kMax,
+        Paragraph::RectWidthStyle::kTight));
+    benchmark::DoNotOptimize(paragraph->GetRectsForRange(
+        size / 3, size * 2 / 3, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kMax));
+    benchmark::DoNotOptimize(paragraph->GetRectsForRange(
+        size / 2, size / 2 + 1, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight));
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphCorpusFixture, GetRectsForRange)
+    ->Apply(CorpusArguments);
+
+// Hit tests a grid of points covering the paragraph.
+BENCHMARK_DEFINE_F(ParagraphCorpusFixture, GetGlyphPositionAtCoordinate)
+(benchmark::State& state) {
+  SetLabel(state);
+  std::unique_ptr<Paragraph> paragraph = BuildLaidOutParagraph(state);
+  constexpr int kGridSize = 16;
+  const double height = paragraph->GetHeight();
+  while (state.KeepRunning()) {
+    for (int y = 0; y < kGridSize; y++) {
+      for (int x = 0; x < kGridSize; x++) {
+        benchmark::DoNotOptimize(paragraph->GetGlyphPositionAtCoordinate(
+            kLayoutWidth * x / kGridSize, height * y / kGridSize));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kGridSize * kGridSize);
+}
+BENCHMARK_REGISTER_F(ParagraphCorpusFixture, GetGlyphPositionAtCoordinate)
+    ->Apply(CorpusArguments);
+
+BENCHMARK_DEFINE_F(ParagraphCorpusFixture, Paint)(benchmark::State& state) {
+  SetLabel(state);
+  std::unique_ptr<Paragraph> paragraph = BuildLaidOutParagraph(state);
+  while (state.KeepRunning()) {
+    paragraph->Paint(canvas_.get(), 0, 0);
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphCorpusFixture, Paint)->Apply(CorpusArguments);
+
+}  // namespace txt
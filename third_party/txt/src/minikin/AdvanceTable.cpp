@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AdvanceTable.h"
+
+#include <math.h>
+#include <map>
+#include <tuple>
+
+#include <hb-ot.h>
+#include <hb.h>
+
+#include "HbFontCache.h"
+#include "MinikinInternal.h"
+
+namespace minikin {
+
+namespace {
+
+struct TableKey {
+  int32_t fontId;
+  float size;
+  float scaleX;
+  float skewX;
+  uint32_t paintFlags;
+  bool fakeBold;
+  bool fakeItalic;
+
+  bool operator<(const TableKey& other) const {
+    return std::tie(fontId, size, scaleX, skewX, paintFlags, fakeBold,
+                    fakeItalic) < std::tie(other.fontId, other.size,
+                                           other.scaleX, other.skewX,
+                                           other.paintFlags, other.fakeBold,
+                                           other.fakeItalic);
+  }
+};
+
+// Tables are cheap to fill in again, so all of them are dropped when there
+// are too many rather than keeping track of which were used last.
+const size_t kMaxTables = 64;
+const size_t kMaxFonts = 256;
+
+// Guarded by gMinikinLock.
+std::map<TableKey, std::shared_ptr<AdvanceTable>>& getTablesLocked() {
+  static auto* tables = new std::map<TableKey, std::shared_ptr<AdvanceTable>>();
+  return *tables;
+}
+
+// Whether fonts, by unique ID, are shaped one character at a time. Guarded
+// by gMinikinLock.
+std::map<int32_t, bool>& getSimpleFontsLocked() {
+  static auto* fonts = new std::map<int32_t, bool>();
+  return *fonts;
+}
+
+bool hasTable(hb_face_t* face, hb_tag_t tag) {
+  HbBlob table(hb_face_reference_table(face, tag));
+  return table.size() != 0;
+}
+
+// Returns true if HarfBuzz maps each character to its nominal glyph and
+// advance, whatever the script, language or neighboring characters.
+bool isSimpleFontLocked(const MinikinFont* font) {
+  if (!font->GetAxes().empty()) {
+    return false;
+  }
+  hb_font_t* hbFont = getHbFontLocked(font);
+  hb_face_t* face = hb_font_get_face(hbFont);
+  bool simple = !hb_ot_layout_has_substitution(face) &&
+                !hb_ot_layout_has_positioning(face) &&
+                !hb_ot_color_has_png(face) &&
+                !hasTable(face, HB_TAG('k', 'e', 'r', 'n')) &&
+                !hasTable(face, HB_TAG('k', 'e', 'r', 'x')) &&
+                !hasTable(face, HB_TAG('m', 'o', 'r', 't')) &&
+                !hasTable(face, HB_TAG('m', 'o', 'r', 'x')) &&
+                !hasTable(face, HB_TAG('t', 'r', 'a', 'k'));
+  hb_font_destroy(hbFont);
+  return simple;
+}
+
+}  // namespace
+
+bool AdvanceTable::isSimpleText(const uint16_t* chars, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!isSimpleChar(chars[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<AdvanceTable> AdvanceTable::getLocked(
+    const FakedFont& font,
+    const MinikinPaint& paint) {
+  assertMinikinLocked();
+  const int32_t fontId = font.font->GetUniqueId();
+  FontFakery fakery = font.fakery;
+  TableKey key = {fontId,
+                  paint.size,
+                  paint.scaleX,
+                  paint.skewX,
+                  paint.paintFlags,
+                  fakery.isFakeBold(),
+                  fakery.isFakeItalic()};
+  auto& tables = getTablesLocked();
+  auto found = tables.find(key);
+  if (found != tables.end()) {
+    return found->second;
+  }
+
+  auto& fonts = getSimpleFontsLocked();
+  auto simple = fonts.find(fontId);
+  if (simple == fonts.end()) {
+    if (fonts.size() >= kMaxFonts) {
+      fonts.clear();
+    }
+    simple = fonts.emplace(fontId, isSimpleFontLocked(font.font)).first;
+  }
+  if (!simple->second) {
+    return nullptr;
+  }
+
+  if (tables.size() >= kMaxTables) {
+    tables.clear();
+  }
+  auto table = std::make_shared<AdvanceTable>(font, paint);
+  tables.emplace(key, table);
+  return table;
+}
+
+void AdvanceTable::purgeLocked() {
+  assertMinikinLocked();
+  getTablesLocked().clear();
+  getSimpleFontsLocked().clear();
+}
+
+AdvanceTable::AdvanceTable(const FakedFont& font, const MinikinPaint& paint)
+    : mPaint(paint) {
+  // Only the parameters that affect the metrics of a glyph are kept.
+  mPaint.font = font.font;
+  mPaint.fakery = font.fakery;
+  mPaint.letterSpacing = 0;
+  mPaint.wordSpacing = 0;
+  mPaint.hyphenEdit = HyphenEdit();
+  mPaint.fontFeatureSettings.clear();
+}
+
+bool AdvanceTable::fillLocked(const uint16_t* chars, size_t count) {
+  assertMinikinLocked();
+  hb_font_t* hbFont = nullptr;
+  bool found = true;
+  for (size_t i = 0; i < count && found; i++) {
+    const size_t index = indexOf(chars[i]);
+    if (mFilled[index]) {
+      found = !mMissing[index];
+      continue;
+    }
+    if (hbFont == nullptr) {
+      hbFont = getHbFontLocked(mPaint.font);
+    }
+    mFilled[index] = true;
+    hb_codepoint_t glyph = 0;
+    if (!hb_font_get_nominal_glyph(hbFont, chars[i], &glyph) || glyph == 0 ||
+        glyph > UINT16_MAX) {
+      mMissing[index] = true;
+      found = false;
+      continue;
+    }
+
+    // The same conversions as the HarfBuzz advance callback and
+    // Layout::doLayoutRun.
+    Entry& entry = mEntries[index];
+    entry.glyph = glyph;
+    const hb_position_t position =
+        256 * mPaint.font->GetHorizontalAdvance(glyph, mPaint) + 0.5;
+    entry.advance = scalbnf(position, -8);
+    if ((mPaint.paintFlags & LinearTextFlag) == 0) {
+      entry.advance = roundf(entry.advance);
+    }
+    mPaint.font->GetBounds(&entry.bounds, glyph, mPaint);
+  }
+  if (hbFont != nullptr) {
+    hb_font_destroy(hbFont);
+  }
+  return found;
+}
+
+}  // namespace minikin
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINIKIN_ADVANCE_TABLE_H
+#define MINIKIN_ADVANCE_TABLE_H
+
+#include <bitset>
+#include <cstdint>
+#include <memory>
+
+#include <minikin/FontFamily.h>
+#include <minikin/MinikinFont.h>
+
+namespace minikin {
+
+// libtxt extension: the glyphs, advances and bounds of the Latin characters
+// of one font at one size, for laying out text without shaping it.
+//
+// Tables are only made for fonts that HarfBuzz shapes one character at a
+// time: fonts without OpenType or AAT layout tables, kerning or color
+// bitmaps. Text in those fonts is laid out the same from a table as it is by
+// shaping it.
+class AdvanceTable {
+ public:
+  struct Entry {
+    uint16_t glyph;
+    // The advance as Layout::doLayoutRun computes it from HarfBuzz's
+    // fixed point position.
+    float advance;
+    MinikinRect bounds;
+  };
+
+  // Returns true if |ch| is one of the characters a table holds, that is
+  // a printable character of Basic Latin, Latin-1 Supplement or Latin
+  // Extended-A other than the soft hyphen.
+  static bool isSimpleChar(uint16_t ch) {
+    return (ch >= 0x20 && ch < 0x7F) ||
+           (ch >= 0xA0 && ch < 0x180 && ch != 0xAD);
+  }
+
+  static bool isSimpleText(const uint16_t* chars, size_t count);
+
+  // Returns the table for |font| laid out with |paint|, or nullptr if the
+  // font may need shaping. gMinikinLock must be held.
+  static std::shared_ptr<AdvanceTable> getLocked(const FakedFont& font,
+                                                 const MinikinPaint& paint);
+
+  // Forgets all tables. gMinikinLock must be held.
+  static void purgeLocked();
+
+  // Makes sure the entries of |chars|, which must be simple text, are
+  // filled in. Returns false if the font has no glyph for one of them.
+  // gMinikinLock must be held.
+  bool fillLocked(const uint16_t* chars, size_t count);
+
+  // Returns the entry of a character filled in by |fillLocked|. Entries are
+  // never changed once filled in, so they can be read without holding
+  // gMinikinLock.
+  const Entry& get(uint16_t ch) const { return mEntries[indexOf(ch)]; }
+
+  AdvanceTable(const FakedFont& font, const MinikinPaint& paint);
+
+ private:
+  static constexpr size_t kSize = (0x7F - 0x20) + (0x180 - 0xA0);
+
+  static size_t indexOf(uint16_t ch) {
+    return ch < 0x80 ? ch - 0x20 : ch - 0xA0 + (0x7F - 0x20);
+  }
+
+  MinikinPaint mPaint;
+  Entry mEntries[kSize];
+  // Guarded by gMinikinLock.
+  std::bitset<kSize> mFilled;
+  std::bitset<kSize> mMissing;
+
+  AdvanceTable(const AdvanceTable&) = delete;
+  void operator=(const AdvanceTable&) = delete;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_ADVANCE_TABLE_H
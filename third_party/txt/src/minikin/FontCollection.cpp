@@ -543,6 +543,17 @@ FakedFont FontCollection::baseFontFaked(FontStyle style) {
   return mFamilies[0]->getClosestMatch(style);
 }
 
+bool FontCollection::isCoveredByFirstFamily(const uint16_t* string,
+                                            size_t size) const {
+  const SparseBitSet& coverage = mFamilies[0]->getCoverage();
+  for (size_t i = 0; i < size; i++) {
+    if (!coverage.get(string[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::shared_ptr<FontCollection> FontCollection::createCollectionWithVariation(
     const std::vector<FontVariation>& variations) {
   if (variations.empty() || mSupportedAxes.empty()) {
@@ -579,4 +590,54 @@ uint32_t FontCollection::getId() const {
   return mId;
 }
 
+uint64_t FontCollection::getContentHash() const {
+  assertMinikinLocked();
+  if (mHasContentHash) {
+    return mContentHash;
+  }
+  uint64_t hash = mFamilies.size();
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    for (size_t i = 0; i < family->getNumFonts(); i++) {
+      const uint64_t fontHash = family->getFont(i)->GetContentHash();
+      if (fontHash == 0) {
+        hash = 0;
+        break;
+      }
+      hash ^= fontHash + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    if (hash == 0) {
+      break;
+    }
+  }
+  mContentHash = hash;
+  mHasContentHash = true;
+  return mContentHash;
+}
+
+MinikinFont* FontCollection::findFontByContentHash(uint64_t hash) const {
+  assertMinikinLocked();
+  auto findInFamily = [hash](const FontFamily& family) -> MinikinFont* {
+    for (size_t i = 0; i < family.getNumFonts(); i++) {
+      MinikinFont* font = family.getFont(i).get();
+      if (font->GetContentHash() == hash) {
+        return font;
+      }
+    }
+    return nullptr;
+  };
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    if (MinikinFont* font = findInFamily(*family)) {
+      return font;
+    }
+  }
+  for (const auto& [locale, families] : mCachedFallbackFamilies) {
+    for (const std::shared_ptr<FontFamily>& family : families) {
+      if (MinikinFont* font = findInFamily(*family)) {
+        return font;
+      }
+    }
+  }
+  return nullptr;
+}
+
 }  // namespace minikin
@@ -65,6 +65,11 @@ class FontCollection {
   // Get base font with fakery information (fake bold could affect metrics)
   FakedFont baseFontFaked(FontStyle style);
 
+  // libtxt extension: returns true if the first font family supports every
+  // character of |string|, which itemize then puts in a single run of that
+  // family. The string must not contain surrogates.
+  bool isCoveredByFirstFamily(const uint16_t* string, size_t size) const;
+
   // Creates new FontCollection based on this collection while applying font
   // variations. Returns nullptr if none of variations apply to this collection.
   std::shared_ptr<FontCollection> createCollectionWithVariation(
@@ -76,6 +81,17 @@ class FontCollection {
 
   uint32_t getId() const;
 
+  // libtxt extension: a hash of the files of all fonts in this collection that
+  // stays the same across runs of the process, or 0 if some font can't be
+  // identified that way. Fallback fonts found after construction are not
+  // included. gMinikinLock must be held.
+  uint64_t getContentHash() const;
+
+  // libtxt extension: returns the font of this collection, including the
+  // fallback fonts found after construction, whose content hash is |hash|, or
+  // nullptr. gMinikinLock must be held.
+  MinikinFont* findFontByContentHash(uint64_t hash) const;
+
   void set_fallback_font_provider(std::unique_ptr<FallbackFontProvider> ffp) {
     mFallbackFontProvider = std::move(ffp);
   }
@@ -159,6 +175,10 @@ class FontCollection {
   // was constructed.
   mutable std::map<std::string, std::vector<std::shared_ptr<FontFamily>>>
       mCachedFallbackFamilies;
+
+  // libtxt extension: computed by the first call to getContentHash.
+  mutable bool mHasContentHash = false;
+  mutable uint64_t mContentHash = 0;
 };
 
 }  // namespace minikin
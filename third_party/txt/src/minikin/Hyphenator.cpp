@@ -17,6 +17,7 @@
 #include <unicode/uchar.h>
 #include <unicode/uscript.h>
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -77,9 +78,10 @@ struct Pattern {
   // accessors
   static uint32_t len(uint32_t entry) { return entry >> 26; }
   static uint32_t shift(uint32_t entry) { return (entry >> 20) & 0x3f; }
+  static uint32_t offset(uint32_t entry) { return entry & 0xfffff; }
   const uint8_t* buf(uint32_t entry) const {
     return reinterpret_cast<const uint8_t*>(this) + pattern_offset +
-           (entry & 0xfffff);
+           offset(entry);
   }
 };
 
@@ -122,6 +124,133 @@ Hyphenator* Hyphenator::loadBinary(const uint8_t* patternData,
   return result;
 }
 
+// libtxt: the magic number and the supported version of the hyb format.
+static const uint32_t HYB_MAGIC = 0x62ad7968;
+static const uint32_t HYB_VERSION = 0;
+
+// Whether |size| bytes at |offset| lie within a file of |fileSize| bytes.
+static bool isInFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+  return offset <= fileSize && size <= fileSize - offset;
+}
+
+static bool isValidPatternData(const uint8_t* data, size_t size) {
+  if (data == nullptr || size < sizeof(Header) ||
+      reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0) {
+    return false;
+  }
+  const Header* header = reinterpret_cast<const Header*>(data);
+  if (header->magic != HYB_MAGIC || header->version != HYB_VERSION ||
+      header->file_size > size) {
+    return false;
+  }
+  const uint64_t fileSize = header->file_size;
+  for (uint32_t offset : {header->alphabet_offset, header->trie_offset,
+                          header->pattern_offset}) {
+    if (offset % alignof(uint32_t) != 0) {
+      return false;
+    }
+  }
+
+  if (!isInFile(header->alphabet_offset, sizeof(uint32_t), fileSize)) {
+    return false;
+  }
+  const uint64_t alphabetOffset = header->alphabet_offset;
+  // The largest code a word can be converted to, start and stop codes
+  // included.
+  uint32_t maxCode = 0;
+  switch (header->alphabetVersion()) {
+    case 0: {
+      const AlphabetTable0* alphabet = header->alphabetTable0();
+      if (!isInFile(alphabetOffset, offsetof(AlphabetTable0, data),
+                    fileSize) ||
+          alphabet->max_codepoint < alphabet->min_codepoint ||
+          !isInFile(alphabetOffset + offsetof(AlphabetTable0, data),
+                    alphabet->max_codepoint - alphabet->min_codepoint,
+                    fileSize)) {
+        return false;
+      }
+      for (uint32_t i = 0;
+           i < alphabet->max_codepoint - alphabet->min_codepoint; i++) {
+        maxCode = std::max<uint32_t>(maxCode, alphabet->data[i]);
+      }
+      break;
+    }
+    case 1: {
+      const AlphabetTable1* alphabet = header->alphabetTable1();
+      if (!isInFile(alphabetOffset, offsetof(AlphabetTable1, data),
+                    fileSize) ||
+          !isInFile(alphabetOffset + offsetof(AlphabetTable1, data),
+                    uint64_t(alphabet->n_entries) * sizeof(uint32_t),
+                    fileSize)) {
+        return false;
+      }
+      for (uint32_t i = 0; i < alphabet->n_entries; i++) {
+        maxCode =
+            std::max(maxCode, AlphabetTable1::value(alphabet->data[i]));
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+
+  const uint64_t trieOffset = header->trie_offset;
+  if (!isInFile(trieOffset, offsetof(Trie, data), fileSize) ||
+      !isInFile(trieOffset + offsetof(Trie, data),
+                uint64_t(header->trieTable()->n_entries) * sizeof(uint32_t),
+                fileSize)) {
+    return false;
+  }
+
+  const uint64_t patternOffset = header->pattern_offset;
+  if (!isInFile(patternOffset, offsetof(Pattern, data), fileSize)) {
+    return false;
+  }
+  const Pattern* pattern = header->patternTable();
+  if (!isInFile(patternOffset + offsetof(Pattern, data),
+                uint64_t(pattern->n_entries) * sizeof(uint32_t), fileSize) ||
+      !isInFile(patternOffset + pattern->pattern_offset, pattern->pattern_size,
+                fileSize)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < pattern->n_entries; i++) {
+    const uint32_t entry = pattern->data[i];
+    if (!isInFile(Pattern::offset(entry), Pattern::len(entry),
+                  pattern->pattern_size)) {
+      return false;
+    }
+  }
+
+  // hyphenateFromCodes looks up every code of a word in the trie from the
+  // root and from any node an entry links to, and reads the pattern of each
+  // node it reaches, so all of them must lie within the tables.
+  const Trie* trie = header->trieTable();
+  if (trie->link_shift >= 32 || trie->pattern_shift >= 32 ||
+      trie->n_entries <= maxCode) {
+    return false;
+  }
+  for (uint32_t i = 0; i < trie->n_entries; i++) {
+    const uint32_t entry = trie->data[i];
+    const uint32_t link = (entry & trie->link_mask) >> trie->link_shift;
+    const uint32_t patternIndex = entry >> trie->pattern_shift;
+    if (uint64_t(link) + maxCode >= trie->n_entries ||
+        (patternIndex != 0 && patternIndex >= pattern->n_entries)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Hyphenator* Hyphenator::loadBinary(const uint8_t* patternData,
+                                   size_t size,
+                                   size_t minPrefix,
+                                   size_t minSuffix) {
+  if (!isValidPatternData(patternData, size)) {
+    return nullptr;
+  }
+  return loadBinary(patternData, minPrefix, minSuffix);
+}
+
 void Hyphenator::hyphenate(vector<HyphenationType>* result,
                            const uint16_t* word,
                            size_t len,
@@ -156,6 +156,15 @@ class Hyphenator {
                                 size_t minPrefix,
                                 size_t minSuffix);
 
+  // libtxt extension: like loadBinary above, but first checks that the |size|
+  // bytes of pattern data hold a hyb file of a supported version whose tables
+  // all lie within it, and returns nullptr if they don't. This is meant for
+  // pattern data that is mapped from a file rather than built into the binary.
+  static Hyphenator* loadBinary(const uint8_t* patternData,
+                                size_t size,
+                                size_t minPrefix,
+                                size_t minSuffix);
+
  private:
   // apply various hyphenation rules including hard and soft hyphens, ignoring
   // patterns
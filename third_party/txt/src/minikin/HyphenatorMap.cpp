@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minikin/HyphenatorMap.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace minikin {
+
+HyphenatorMap& HyphenatorMap::getInstance() {
+  static HyphenatorMap* instance = new HyphenatorMap();
+  return *instance;
+}
+
+void HyphenatorMap::setLoader(Loader loader) {
+  HyphenatorMap& map = getInstance();
+  std::scoped_lock lock(map.mMutex);
+  map.mLoader = std::move(loader);
+  // Loaded hyphenators are kept, as line breakers may still be using them.
+  for (auto it = map.mEntries.begin(); it != map.mEntries.end();) {
+    if (it->second.hyphenator == nullptr) {
+      it = map.mEntries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+Hyphenator* HyphenatorMap::get(const std::string& languageTag) {
+  std::string tag = languageTag;
+  std::replace(tag.begin(), tag.end(), '_', '-');
+  std::transform(tag.begin(), tag.end(), tag.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  HyphenatorMap& map = getInstance();
+  std::scoped_lock lock(map.mMutex);
+  Hyphenator* hyphenator = map.getLocked(tag);
+  size_t subtagEnd = tag.find('-');
+  if (hyphenator == nullptr && subtagEnd != std::string::npos) {
+    hyphenator = map.getLocked(tag.substr(0, subtagEnd));
+  }
+  return hyphenator;
+}
+
+Hyphenator* HyphenatorMap::getLocked(const std::string& tag) {
+  auto found = mEntries.find(tag);
+  if (found != mEntries.end()) {
+    return found->second.hyphenator.get();
+  }
+  if (!mLoader) {
+    return nullptr;
+  }
+
+  Entry entry;
+  entry.data = mLoader(tag);
+  if (entry.data != nullptr) {
+    entry.hyphenator.reset(Hyphenator::loadBinary(
+        entry.data->data(), entry.data->size(), kMinPrefix, kMinSuffix));
+  }
+  if (entry.hyphenator == nullptr) {
+    entry.data.reset();
+  }
+  Hyphenator* hyphenator = entry.hyphenator.get();
+  mEntries.emplace(tag, std::move(entry));
+  return hyphenator;
+}
+
+}  // namespace minikin
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINIKIN_HYPHENATOR_MAP_H
+#define MINIKIN_HYPHENATOR_MAP_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <minikin/Hyphenator.h>
+
+namespace minikin {
+
+// libtxt extension: the hyphenators of all languages, shared by every user of
+// minikin in the process.
+//
+// Pattern data is only requested from the loader the first time a language
+// is looked up, so making patterns available for many languages costs nothing
+// for the languages that are never hyphenated. Loaded hyphenators, and the
+// pattern data they read, are kept until the process exits.
+class HyphenatorMap {
+ public:
+  // Pattern data in the hyb format described in doc/hyb_file_format.md, such
+  // as a file mapped into memory. The data must not change while the object
+  // is alive.
+  class PatternData {
+   public:
+    virtual ~PatternData() = default;
+    virtual const uint8_t* data() const = 0;
+    virtual size_t size() const = 0;
+  };
+
+  // Returns the pattern data for a lowercase BCP 47 language tag, such as
+  // "en-us" or "de", or null if there is none.
+  using Loader =
+      std::function<std::unique_ptr<PatternData>(const std::string& tag)>;
+
+  // The minimum number of code units before and after a hyphen.
+  static constexpr size_t kMinPrefix = 2;
+  static constexpr size_t kMinSuffix = 2;
+
+  // Sets the source of pattern data, or clears it if |loader| is empty.
+  // Languages that had no pattern data are looked up again by the new loader.
+  static void setLoader(Loader loader);
+
+  // Returns the hyphenator for a BCP 47 language tag, or null if there is no
+  // valid pattern data for it. The full tag is tried first and then its
+  // language subtag alone, so "en-US" can be served by "en-us" or by "en".
+  static Hyphenator* get(const std::string& languageTag);
+
+ private:
+  struct Entry {
+    std::unique_ptr<PatternData> data;
+    std::unique_ptr<Hyphenator> hyphenator;
+  };
+
+  static HyphenatorMap& getInstance();
+
+  // Returns the hyphenator for a lowercase tag, loading it if it was not
+  // looked up before. mMutex must be held.
+  Hyphenator* getLocked(const std::string& tag);
+
+  std::mutex mMutex;
+  Loader mLoader;
+  // Keyed by lowercase tag. Tags without pattern data map to empty entries.
+  std::unordered_map<std::string, Entry> mEntries;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_HYPHENATOR_MAP_H
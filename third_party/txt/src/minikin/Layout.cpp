@@ -20,14 +20,14 @@
 #include <unicode/ubidi.h>
 #include <unicode/utf16.h>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <iostream>  // for debugging
 #include <string>
 #include <vector>
 
 #include <log/log.h>
-#include <utils/JenkinsHash.h>
-#include <utils/LruCache.h>
 #include <utils/WindowsUtils.h>
 
 #include <hb-icu.h>
@@ -35,9 +35,11 @@
 
 #include <minikin/Emoji.h>
 #include <minikin/Layout.h>
+#include "AdvanceTable.h"
 #include "FontLanguage.h"
 #include "FontLanguageListCache.h"
 #include "HbFontCache.h"
+#include "LayoutCache.h"
 #include "LayoutUtils.h"
 #include "MinikinInternal.h"
 
@@ -59,113 +61,15 @@ struct LayoutContext {
   }
 };
 
-// Layout cache datatypes
-
-class LayoutCacheKey {
- public:
-  LayoutCacheKey(const std::shared_ptr<FontCollection>& collection,
-                 const MinikinPaint& paint,
-                 FontStyle style,
-                 const uint16_t* chars,
-                 size_t start,
-                 size_t count,
-                 size_t nchars,
-                 bool dir)
-      : mChars(chars),
-        mNchars(nchars),
-        mStart(start),
-        mCount(count),
-        mId(collection->getId()),
-        mStyle(style),
-        mSize(paint.size),
-        mScaleX(paint.scaleX),
-        mSkewX(paint.skewX),
-        mLetterSpacing(paint.letterSpacing),
-        mPaintFlags(paint.paintFlags),
-        mHyphenEdit(paint.hyphenEdit),
-        mIsRtl(dir),
-        mHash(computeHash()) {}
-  bool operator==(const LayoutCacheKey& other) const;
-
-  android::hash_t hash() const { return mHash; }
-
-  void copyText() {
-    uint16_t* charsCopy = new uint16_t[mNchars];
-    memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
-    mChars = charsCopy;
-  }
-  void freeText() {
-    delete[] mChars;
-    mChars = NULL;
-  }
-
-  void doLayout(Layout* layout,
-                LayoutContext* ctx,
-                const std::shared_ptr<FontCollection>& collection) const {
-    layout->mAdvances.resize(mCount, 0);
-    ctx->clearHbFonts();
-    layout->doLayoutRun(mChars, mStart, mCount, mNchars, mIsRtl, ctx,
-                        collection);
-  }
-
- private:
-  const uint16_t* mChars;
-  size_t mNchars;
-  size_t mStart;
-  size_t mCount;
-  uint32_t mId;  // for the font collection
-  FontStyle mStyle;
-  float mSize;
-  float mScaleX;
-  float mSkewX;
-  float mLetterSpacing;
-  int32_t mPaintFlags;
-  HyphenEdit mHyphenEdit;
-  bool mIsRtl;
-  // Note: any fields added to MinikinPaint must also be reflected here.
-  // TODO: language matching (possibly integrate into style)
-  android::hash_t mHash;
-
-  android::hash_t computeHash() const;
-};
-
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
- public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
-  }
-
-  void clear() { mCache.clear(); }
-
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
-    }
-    return layout;
-  }
-
- private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
-  }
-
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
-
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
-
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
-};
+void LayoutCacheKey::doLayout(
+    Layout* layout,
+    LayoutContext* ctx,
+    const std::shared_ptr<FontCollection>& collection) const {
+  layout->mAdvances.resize(mCount, 0);
+  ctx->clearHbFonts();
+  layout->doLayoutRun(mChars, mStart, mCount, mNchars, mIsRtl, ctx,
+                      collection);
+}
 
 class LayoutEngine {
  public:
@@ -178,6 +82,9 @@ class LayoutEngine {
   hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
+  // Guarded by gMinikinLock.
+  std::shared_ptr<LayoutCacheStore> cacheStore;
+  std::atomic<bool> advanceTablesEnabled = true;
 
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
@@ -185,36 +92,6 @@ class LayoutEngine {
   }
 };
 
-bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
-  return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
-         mStyle == other.mStyle && mSize == other.mSize &&
-         mScaleX == other.mScaleX && mSkewX == other.mSkewX &&
-         mLetterSpacing == other.mLetterSpacing &&
-         mPaintFlags == other.mPaintFlags && mHyphenEdit == other.mHyphenEdit &&
-         mIsRtl == other.mIsRtl && mNchars == other.mNchars &&
-         !memcmp(mChars, other.mChars, mNchars * sizeof(uint16_t));
-}
-
-android::hash_t LayoutCacheKey::computeHash() const {
-  uint32_t hash = android::JenkinsHashMix(0, mId);
-  hash = android::JenkinsHashMix(hash, mStart);
-  hash = android::JenkinsHashMix(hash, mCount);
-  hash = android::JenkinsHashMix(hash, hash_type(mStyle));
-  hash = android::JenkinsHashMix(hash, hash_type(mSize));
-  hash = android::JenkinsHashMix(hash, hash_type(mScaleX));
-  hash = android::JenkinsHashMix(hash, hash_type(mSkewX));
-  hash = android::JenkinsHashMix(hash, hash_type(mLetterSpacing));
-  hash = android::JenkinsHashMix(hash, hash_type(mPaintFlags));
-  hash = android::JenkinsHashMix(hash, hash_type(mHyphenEdit.getHyphen()));
-  hash = android::JenkinsHashMix(hash, hash_type(mIsRtl));
-  hash = android::JenkinsHashMixShorts(hash, mChars, mNchars);
-  return android::JenkinsHashWhiten(hash);
-}
-
-android::hash_t hash_type(const LayoutCacheKey& key) {
-  return key.hash();
-}
-
 void MinikinRect::join(const MinikinRect& r) {
   if (isEmpty()) {
     set(r);
@@ -588,8 +465,8 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
+  // gMinikinLock is only taken to shape the words that miss the layout cache,
+  // see doLayoutWord.
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -599,8 +476,6 @@ void Layout::doLayout(const uint16_t* buf,
 
   doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, start, collection,
                     this, NULL);
-
-  ctx.clearHbFonts();
 }
 
 float Layout::measureText(const uint16_t* buf,
@@ -612,17 +487,12 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
 
-  float advance = doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0,
-                                    collection, NULL, advances);
-
-  ctx.clearHbFonts();
-  return advance;
+  return doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0,
+                           collection, NULL, advances);
 }
 
 float Layout::doLayoutRunCached(
@@ -638,6 +508,10 @@ float Layout::doLayoutRunCached(
     float* advances) {
   const uint32_t originalHyphen = ctx->paint.hyphenEdit.getHyphen();
   float advance = 0;
+  if (!isRtl && doLayoutRunSimple(buf, start, count, bufSize, ctx, dstStart,
+                                  collection, layout, advances, &advance)) {
+    return advance;
+  }
   if (!isRtl) {
     // left to right
     size_t wordstart = start == bufSize
@@ -691,6 +565,86 @@ float Layout::doLayoutRunCached(
   return advance;
 }
 
+bool Layout::doLayoutRunSimple(
+    const uint16_t* buf,
+    size_t start,
+    size_t count,
+    size_t bufSize,
+    LayoutContext* ctx,
+    size_t dstStart,
+    const std::shared_ptr<FontCollection>& collection,
+    Layout* layout,
+    float* advances,
+    float* advance) {
+  const MinikinPaint& paint = ctx->paint;
+  if (!LayoutEngine::getInstance().advanceTablesEnabled.load(
+          std::memory_order_relaxed) ||
+      count == 0 || paint.letterSpacing != 0 ||
+      paint.hyphenEdit.getHyphen() != 0 || paint.skipCache() ||
+      !AdvanceTable::isSimpleText(buf + start, count) ||
+      !collection->isCoveredByFirstFamily(buf + start, count)) {
+    return false;
+  }
+
+  FakedFont font;
+  std::shared_ptr<AdvanceTable> table;
+  {
+    std::scoped_lock _l(gMinikinLock);
+    font = collection->baseFontFaked(ctx->style);
+    table = AdvanceTable::getLocked(font, paint);
+    if (!table || !table->fillLocked(buf + start, count)) {
+      return false;
+    }
+  }
+  const int font_ix = layout ? layout->findFace(font, NULL) : 0;
+
+  // Words are laid out and appended one at a time, as doLayoutWord and
+  // appendLayout do, so that glyph positions round the same way.
+  float total = 0;
+  size_t wordend;
+  for (size_t iter = start; iter < start + count; iter = wordend) {
+    wordend = getNextWordBreakForCache(buf, iter, bufSize);
+    const size_t wordcount = std::min(start + count, wordend) - iter;
+    const float wordSpacing =
+        wordcount == 1 && isWordSpace(buf[iter]) ? paint.wordSpacing : 0;
+    const float x0 = layout ? layout->mAdvance : 0;
+    float x = 0;
+    MinikinRect wordBounds;
+    wordBounds.setEmpty();
+    for (size_t i = 0; i < wordcount; i++) {
+      const AdvanceTable::Entry& entry = table->get(buf[iter + i]);
+      if (layout) {
+        const uint32_t cluster = iter - dstStart + i;
+        layout->mGlyphs.push_back({font_ix, entry.glyph, x0 + x, 0, cluster});
+        layout->mAdvances[cluster] = entry.advance;
+        MinikinRect glyphBounds(entry.bounds);
+        glyphBounds.offset(x, 0);
+        wordBounds.join(glyphBounds);
+      }
+      if (advances) {
+        advances[iter - start + i] = entry.advance;
+      }
+      x += entry.advance;
+    }
+    if (layout) {
+      layout->mAdvances[iter - dstStart] += wordSpacing;
+      wordBounds.offset(x0, 0);
+      layout->mBounds.join(wordBounds);
+      layout->mAdvance += x + wordSpacing;
+    }
+    float wordAdvance = x;
+    if (wordSpacing != 0) {
+      wordAdvance += wordSpacing;
+      if (advances) {
+        advances[iter - start] += wordSpacing;
+      }
+    }
+    total += wordAdvance;
+  }
+  *advance = total;
+  return true;
+}
+
 float Layout::doLayoutWord(const uint16_t* buf,
                            size_t start,
                            size_t count,
@@ -702,8 +656,8 @@ float Layout::doLayoutWord(const uint16_t* buf,
                            Layout* layout,
                            float* advances) {
   LayoutCache& cache = LayoutEngine::getInstance().layoutCache;
-  LayoutCacheKey key(collection, ctx->paint, ctx->style, buf, start, count,
-                     bufSize, isRtl);
+  LayoutCacheKey key(collection->getId(), ctx->paint, ctx->style, buf, start,
+                     count, bufSize, isRtl);
 
   float wordSpacing =
       count == 1 && isWordSpace(buf[start]) ? ctx->paint.wordSpacing : 0;
@@ -711,7 +665,11 @@ float Layout::doLayoutWord(const uint16_t* buf,
   float advance;
   if (ctx->paint.skipCache()) {
     Layout layoutForWord;
-    key.doLayout(&layoutForWord, ctx, collection);
+    {
+      std::scoped_lock _l(gMinikinLock);
+      key.doLayout(&layoutForWord, ctx, collection);
+      ctx->clearHbFonts();
+    }
     if (layout) {
       layout->appendLayout(&layoutForWord, bufStart, wordSpacing);
     }
@@ -720,9 +678,26 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<const Layout> layoutForWord = cache.get(key);
+    if (!layoutForWord) {
+      // Shaping goes through the HarfBuzz fonts and buffer shared by the
+      // process, which are guarded by gMinikinLock.
+      auto shaped = std::make_unique<Layout>();
+      {
+        std::scoped_lock _l(gMinikinLock);
+        LayoutCacheStore* store = LayoutEngine::getInstance().cacheStore.get();
+        if (!store || !loadFromStore(store, key, *collection, shaped.get())) {
+          key.doLayout(shaped.get(), ctx, collection);
+          ctx->clearHbFonts();
+          if (store) {
+            saveToStore(store, key, *collection, *shaped);
+          }
+        }
+      }
+      layoutForWord = cache.put(key, std::move(shaped));
+    }
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -1105,7 +1080,9 @@ void Layout::doLayoutRun(const uint16_t* buf,
   mAdvance = x;
 }
 
-void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
+void Layout::appendLayout(const Layout* src,
+                          size_t start,
+                          float extraAdvance) {
   int fontMapStack[16];
   int* fontMap;
   if (src->mFaces.size() < sizeof(fontMapStack) / sizeof(fontMapStack[0])) {
@@ -1121,7 +1098,7 @@ void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
   // jitter.
   float x0 = mAdvance;
   for (size_t i = 0; i < src->mGlyphs.size(); i++) {
-    LayoutGlyph& srcGlyph = src->mGlyphs[i];
+    const LayoutGlyph& srcGlyph = src->mGlyphs[i];
     int font_ix = fontMap[srcGlyph.font_ix];
     unsigned int glyph_id = srcGlyph.glyph_id;
     float x = x0 + srcGlyph.x;
@@ -1184,7 +1161,7 @@ float Layout::getAdvance() const {
   return mAdvance;
 }
 
-void Layout::getAdvances(float* advances) {
+void Layout::getAdvances(float* advances) const {
   memcpy(advances, &mAdvances[0], mAdvances.size() * sizeof(float));
 }
 
@@ -1192,11 +1169,197 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
 void Layout::purgeCaches() {
+  LayoutEngine::getInstance().layoutCache.clear();
   std::scoped_lock _l(gMinikinLock);
-  LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
-  layoutCache.clear();
+  AdvanceTable::purgeLocked();
   purgeHbFontCacheLocked();
 }
 
+void Layout::setAdvanceTablesEnabled(bool enabled) {
+  LayoutEngine::getInstance().advanceTablesEnabled.store(
+      enabled, std::memory_order_relaxed);
+}
+
+void Layout::setCacheMaxBytes(size_t maxBytes) {
+  LayoutEngine::getInstance().layoutCache.setMaxBytes(maxBytes);
+}
+
+LayoutCacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
+}
+
+void Layout::setCacheStore(std::shared_ptr<LayoutCacheStore> store) {
+  std::scoped_lock _l(gMinikinLock);
+  LayoutEngine::getInstance().cacheStore = std::move(store);
+}
+
+namespace {
+
+// The layout of a stored value, which is only ever read back by the same
+// build of the engine on the same device:
+//
+//   float advance, MinikinRect bounds,
+//   uint32_t face count, then for each face
+//       uint64_t content hash, uint8_t fakery (bit 0 bold, bit 1 italic),
+//   uint32_t glyph count, then for each glyph
+//       int32_t font_ix, uint32_t glyph_id, float x, float y, uint32_t cluster,
+//   uint32_t advance count, then the advances as floats.
+
+template <typename T>
+void appendValue(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class StoredValueReader {
+ public:
+  explicit StoredValueReader(const std::string& data) : mData(data) {}
+
+  template <typename T>
+  bool read(T* value) {
+    if (mData.size() - mOffset < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, mData.data() + mOffset, sizeof(T));
+    mOffset += sizeof(T);
+    return true;
+  }
+
+  // Whether there are enough bytes left for |count| elements of |size| bytes,
+  // which guards allocations sized by a count read from the value.
+  bool hasRoomFor(uint32_t count, size_t size) const {
+    return count <= (mData.size() - mOffset) / size;
+  }
+
+  bool atEnd() const { return mOffset == mData.size(); }
+
+ private:
+  const std::string& mData;
+  size_t mOffset = 0;
+};
+
+}  // namespace
+
+bool Layout::loadFromStore(LayoutCacheStore* store,
+                           const LayoutCacheKey& key,
+                           const FontCollection& collection,
+                           Layout* layout) {
+  const uint64_t collectionHash = collection.getContentHash();
+  if (collectionHash == 0) {
+    return false;
+  }
+  std::string value;
+  if (!store->load(key.getStoreKey(collectionHash), &value)) {
+    return false;
+  }
+
+  // A value that can't be read leaves |layout| empty, ready to be shaped.
+  auto read = [&]() {
+    StoredValueReader reader(value);
+    uint32_t faceCount;
+    if (!reader.read(&layout->mAdvance) || !reader.read(&layout->mBounds) ||
+        !reader.read(&faceCount) ||
+        !reader.hasRoomFor(faceCount, sizeof(uint64_t) + sizeof(uint8_t))) {
+      return false;
+    }
+    layout->mFaces.reserve(faceCount);
+    for (uint32_t i = 0; i < faceCount; i++) {
+      uint64_t hash;
+      uint8_t fakery;
+      if (!reader.read(&hash) || !reader.read(&fakery)) {
+        return false;
+      }
+      MinikinFont* font = collection.findFontByContentHash(hash);
+      if (!font) {
+        return false;
+      }
+      layout->mFaces.push_back(
+          {font, FontFakery((fakery & 1) != 0, (fakery & 2) != 0)});
+    }
+    uint32_t glyphCount;
+    if (!reader.read(&glyphCount) ||
+        !reader.hasRoomFor(glyphCount, 5 * sizeof(uint32_t))) {
+      return false;
+    }
+    layout->mGlyphs.resize(glyphCount);
+    for (LayoutGlyph& glyph : layout->mGlyphs) {
+      int32_t fontIx;
+      if (!reader.read(&fontIx) || !reader.read(&glyph.glyph_id) ||
+          !reader.read(&glyph.x) || !reader.read(&glyph.y) ||
+          !reader.read(&glyph.cluster) || fontIx < 0 ||
+          static_cast<uint32_t>(fontIx) >= faceCount) {
+        return false;
+      }
+      glyph.font_ix = fontIx;
+    }
+    uint32_t advanceCount;
+    if (!reader.read(&advanceCount) ||
+        !reader.hasRoomFor(advanceCount, sizeof(float))) {
+      return false;
+    }
+    layout->mAdvances.resize(advanceCount);
+    for (float& advance : layout->mAdvances) {
+      if (!reader.read(&advance)) {
+        return false;
+      }
+    }
+    return reader.atEnd();
+  };
+  if (!read()) {
+    layout->reset();
+    return false;
+  }
+  return true;
+}
+
+void Layout::saveToStore(LayoutCacheStore* store,
+                         const LayoutCacheKey& key,
+                         const FontCollection& collection,
+                         const Layout& layout) {
+  const uint64_t collectionHash = collection.getContentHash();
+  if (collectionHash == 0) {
+    return;
+  }
+  // A word that came out with missing glyphs may shape differently once a
+  // fallback font for it is found, so it is left to be shaped again.
+  for (const LayoutGlyph& glyph : layout.mGlyphs) {
+    if (glyph.glyph_id == 0) {
+      return;
+    }
+  }
+
+  std::string value;
+  appendValue(&value, layout.mAdvance);
+  appendValue(&value, layout.mBounds);
+  appendValue(&value, static_cast<uint32_t>(layout.mFaces.size()));
+  for (FakedFont face : layout.mFaces) {
+    const uint64_t hash = face.font->GetContentHash();
+    if (hash == 0) {
+      return;
+    }
+    appendValue(&value, hash);
+    appendValue(&value, static_cast<uint8_t>(face.fakery.isFakeBold() |
+                                             face.fakery.isFakeItalic() << 1));
+  }
+  appendValue(&value, static_cast<uint32_t>(layout.mGlyphs.size()));
+  for (const LayoutGlyph& glyph : layout.mGlyphs) {
+    appendValue(&value, static_cast<int32_t>(glyph.font_ix));
+    appendValue(&value, glyph.glyph_id);
+    appendValue(&value, glyph.x);
+    appendValue(&value, glyph.y);
+    appendValue(&value, glyph.cluster);
+  }
+  appendValue(&value, static_cast<uint32_t>(layout.mAdvances.size()));
+  for (float advance : layout.mAdvances) {
+    appendValue(&value, advance);
+  }
+  store->store(key.getStoreKey(collectionHash), value);
+}
+
 }  // namespace minikin
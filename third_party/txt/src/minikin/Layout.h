@@ -46,6 +46,9 @@ struct LayoutGlyph {
 // Internal state used during layout operation
 struct LayoutContext;
 
+class LayoutCacheKey;
+class LayoutCacheStore;
+
 enum {
   kBidi_LTR = 0,
   kBidi_RTL = 1,
@@ -57,6 +60,16 @@ enum {
   kBidi_Mask = 0x7
 };
 
+// libtxt extension: counters of the process-wide cache of shaped words.
+struct LayoutCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t maxBytes = 0;
+};
+
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
 // may not mutate it at the same time.
@@ -106,7 +119,7 @@ class Layout {
 
   // Get advances, copying into caller-provided buffer. The size of this
   // buffer must match the length of the string (count arg to doLayout).
-  void getAdvances(float* advances);
+  void getAdvances(float* advances) const;
 
   // The i parameter is an offset within the buf relative to start, it is <
   // count, where start and count are the parameters to doLayout
@@ -114,9 +127,28 @@ class Layout {
 
   void getBounds(MinikinRect* rect) const;
 
+  // libtxt extension: an estimate of the heap memory held by this layout.
+  size_t getMemoryUsage() const;
+
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // libtxt extension: sets the number of bytes the cache of shaped words may
+  // use. The cache is shared by all threads of the process.
+  static void setCacheMaxBytes(size_t maxBytes);
+
+  static LayoutCacheStats getCacheStats();
+
+  // libtxt extension: sets a store that keeps shaped words across runs of the
+  // process, or clears it if |store| is null. Only words shaped with fonts
+  // that have a content hash are stored.
+  static void setCacheStore(std::shared_ptr<LayoutCacheStore> store);
+
+  // libtxt extension: sets whether left to right runs of Latin text in a font
+  // that needs no shaping are laid out from a table of the font's advances
+  // instead of word by word. On by default.
+  static void setAdvanceTablesEnabled(bool enabled);
+
  private:
   friend class LayoutCacheKey;
 
@@ -141,6 +173,21 @@ class Layout {
       Layout* layout,
       float* advances);
 
+  // libtxt extension: lays out a left to right run the way doLayoutRunCached
+  // does, from the advance table of its font. Returns false without laying
+  // anything out if the run needs shaping.
+  static bool doLayoutRunSimple(
+      const uint16_t* buf,
+      size_t runStart,
+      size_t runLength,
+      size_t bufSize,
+      LayoutContext* ctx,
+      size_t dstStart,
+      const std::shared_ptr<FontCollection>& collection,
+      Layout* layout,
+      float* advances,
+      float* advance);
+
   // Lay out a single word
   static float doLayoutWord(const uint16_t* buf,
                             size_t start,
@@ -163,7 +210,22 @@ class Layout {
                    const std::shared_ptr<FontCollection>& collection);
 
   // Append another layout (for example, cached value) into this one
-  void appendLayout(Layout* src, size_t start, float extraAdvance);
+  void appendLayout(const Layout* src, size_t start, float extraAdvance);
+
+  // libtxt extension: reads the layout for the key from the cache store into
+  // |layout|. Returns false if the store has no layout for the key or a font
+  // it refers to is not in the collection. gMinikinLock must be held.
+  static bool loadFromStore(LayoutCacheStore* store,
+                            const LayoutCacheKey& key,
+                            const FontCollection& collection,
+                            Layout* layout);
+
+  // libtxt extension: writes the layout for the key to the cache store, unless
+  // some of its fonts have no content hash. gMinikinLock must be held.
+  static void saveToStore(LayoutCacheStore* store,
+                          const LayoutCacheKey& key,
+                          const FontCollection& collection,
+                          const Layout& layout);
 
   std::vector<LayoutGlyph> mGlyphs;
   std::vector<float> mAdvances;
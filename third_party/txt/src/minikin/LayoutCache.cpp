@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LayoutCache.h"
+
+#include <cstring>
+#include <mutex>
+
+#include <utils/JenkinsHash.h>
+
+#include "FontLanguage.h"
+#include "FontLanguageListCache.h"
+#include "MinikinInternal.h"
+
+namespace minikin {
+
+bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
+  return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
+         mStyle == other.mStyle && mSize == other.mSize &&
+         mScaleX == other.mScaleX && mSkewX == other.mSkewX &&
+         mLetterSpacing == other.mLetterSpacing &&
+         mPaintFlags == other.mPaintFlags && mHyphenEdit == other.mHyphenEdit &&
+         mIsRtl == other.mIsRtl && mNchars == other.mNchars &&
+         !memcmp(mChars, other.mChars, mNchars * sizeof(uint16_t));
+}
+
+android::hash_t LayoutCacheKey::computeHash() const {
+  uint32_t hash = android::JenkinsHashMix(0, mId);
+  hash = android::JenkinsHashMix(hash, mStart);
+  hash = android::JenkinsHashMix(hash, mCount);
+  hash = android::JenkinsHashMix(hash, hash_type(mStyle));
+  // The scalars are hashed with the android:: specializations; an unqualified
+  // call would convert them to a FontStyle.
+  hash = android::JenkinsHashMix(hash, android::hash_type(mSize));
+  hash = android::JenkinsHashMix(hash, android::hash_type(mScaleX));
+  hash = android::JenkinsHashMix(hash, android::hash_type(mSkewX));
+  hash = android::JenkinsHashMix(hash, android::hash_type(mLetterSpacing));
+  hash = android::JenkinsHashMix(hash, android::hash_type(mPaintFlags));
+  hash = android::JenkinsHashMix(
+      hash, android::hash_type(mHyphenEdit.getHyphen()));
+  hash = android::JenkinsHashMix(hash, android::hash_type(mIsRtl));
+  hash = android::JenkinsHashMixShorts(hash, mChars, mNchars);
+  return android::JenkinsHashWhiten(hash);
+}
+
+namespace {
+
+// Bumped whenever the layout of store keys or values changes.
+constexpr uint32_t kStoreFormatVersion = 1;
+
+template <typename T>
+void appendBytes(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+std::string LayoutCacheKey::getStoreKey(uint64_t collectionHash) const {
+  // The language list id is only meaningful within the process, so the key
+  // spells out the languages instead.
+  std::string languages;
+  const FontLanguages& langs =
+      FontLanguageListCache::getById(mStyle.getLanguageListId());
+  for (size_t i = 0; i < langs.size(); i++) {
+    languages += langs[i].getString();
+    languages += ',';
+  }
+
+  std::string key = "minikin.layout";
+  appendBytes(&key, kStoreFormatVersion);
+  appendBytes(&key, collectionHash);
+  appendBytes(&key, static_cast<int32_t>(mStyle.getWeight()));
+  appendBytes(&key, static_cast<int32_t>(mStyle.getVariant()));
+  appendBytes(&key, mStyle.getItalic());
+  appendBytes(&key, static_cast<uint32_t>(languages.size()));
+  key += languages;
+  appendBytes(&key, mSize);
+  appendBytes(&key, mScaleX);
+  appendBytes(&key, mSkewX);
+  appendBytes(&key, mLetterSpacing);
+  appendBytes(&key, mPaintFlags);
+  appendBytes(&key, mHyphenEdit.getHyphen());
+  appendBytes(&key, mIsRtl);
+  appendBytes(&key, static_cast<uint32_t>(mStart));
+  appendBytes(&key, static_cast<uint32_t>(mCount));
+  appendBytes(&key, static_cast<uint32_t>(mNchars));
+  key.append(reinterpret_cast<const char*>(mChars), textBytes());
+  return key;
+}
+
+std::unique_ptr<uint16_t[]> LayoutCacheKey::copyText() {
+  std::unique_ptr<uint16_t[]> charsCopy(new uint16_t[mNchars]);
+  memcpy(charsCopy.get(), mChars, mNchars * sizeof(uint16_t));
+  mChars = charsCopy.get();
+  return charsCopy;
+}
+
+LayoutCache::LayoutCache(size_t maxBytes) : mMaxBytes(maxBytes) {}
+
+LayoutCache::~LayoutCache() = default;
+
+LayoutCache::Shard& LayoutCache::shardFor(const LayoutCacheKey& key) {
+  static_assert((kShardCount & (kShardCount - 1)) == 0,
+                "The shard count must be a power of two.");
+  // The unordered maps bucket by the low bits of the hash, so the shard is
+  // picked from the high bits.
+  return mShards[(key.hash() >> 24) & (kShardCount - 1)];
+}
+
+size_t LayoutCache::shardMaxBytes() const {
+  return mMaxBytes.load(std::memory_order_relaxed) / kShardCount;
+}
+
+std::shared_ptr<const Layout> LayoutCache::get(const LayoutCacheKey& key) {
+  Shard& shard = shardFor(key);
+  std::shared_lock lock(shard.mutex);
+  auto found = shard.index.find(key);
+  if (found == shard.index.end()) {
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  shard.hits.fetch_add(1, std::memory_order_relaxed);
+  Entry& entry = *found->second;
+  entry.referenced.store(true, std::memory_order_relaxed);
+  return entry.layout;
+}
+
+std::shared_ptr<const Layout> LayoutCache::put(const LayoutCacheKey& key,
+                                               std::unique_ptr<Layout> layout) {
+  Shard& shard = shardFor(key);
+  std::unique_lock lock(shard.mutex);
+  auto found = shard.index.find(key);
+  if (found != shard.index.end()) {
+    return found->second->layout;
+  }
+
+  LayoutCacheKey ownedKey = key;
+  std::unique_ptr<uint16_t[]> text = ownedKey.copyText();
+  const size_t bytes = sizeof(Entry) + ownedKey.textBytes() +
+                       layout->getMemoryUsage() +
+                       sizeof(decltype(shard.index)::value_type);
+  // New entries go just behind the clock hand, so they are the last ones it
+  // reaches.
+  auto entry = shard.entries.emplace(shard.hand, ownedKey, std::move(text),
+                                     std::move(layout), bytes);
+  shard.index.emplace(ownedKey, entry);
+  shard.bytes += bytes;
+  shard.evictLocked(shardMaxBytes());
+
+  // The new entry itself is evicted if it alone exceeds the shard's budget,
+  // which the caller is given a reference to regardless.
+  return entry->layout;
+}
+
+void LayoutCache::Shard::evictLocked(size_t maxBytes) {
+  while (bytes > maxBytes && !entries.empty()) {
+    if (hand == entries.end()) {
+      hand = entries.begin();
+    }
+    if (hand->referenced.exchange(false, std::memory_order_relaxed)) {
+      ++hand;
+      continue;
+    }
+    index.erase(hand->key);
+    bytes -= hand->bytes;
+    hand = entries.erase(hand);
+    evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LayoutCache::clear() {
+  for (Shard& shard : mShards) {
+    std::unique_lock lock(shard.mutex);
+    shard.index.clear();
+    shard.entries.clear();
+    shard.hand = shard.entries.end();
+    shard.bytes = 0;
+  }
+}
+
+void LayoutCache::setMaxBytes(size_t maxBytes) {
+  mMaxBytes.store(maxBytes, std::memory_order_relaxed);
+  const size_t shardBytes = shardMaxBytes();
+  for (Shard& shard : mShards) {
+    std::unique_lock lock(shard.mutex);
+    shard.evictLocked(shardBytes);
+  }
+}
+
+size_t LayoutCache::getMaxBytes() const {
+  return mMaxBytes.load(std::memory_order_relaxed);
+}
+
+LayoutCacheStats LayoutCache::getStats() const {
+  LayoutCacheStats stats;
+  for (const Shard& shard : mShards) {
+    stats.hits += shard.hits.load(std::memory_order_relaxed);
+    stats.misses += shard.misses.load(std::memory_order_relaxed);
+    stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+    std::shared_lock lock(shard.mutex);
+    stats.entries += shard.entries.size();
+    stats.bytes += shard.bytes;
+  }
+  stats.maxBytes = getMaxBytes();
+  return stats;
+}
+
+}  // namespace minikin
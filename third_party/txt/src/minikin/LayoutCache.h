@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINIKIN_LAYOUT_CACHE_H
+#define MINIKIN_LAYOUT_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <minikin/Layout.h>
+#include <utils/TypeHelpers.h>
+
+namespace minikin {
+
+class LayoutCacheKey {
+ public:
+  LayoutCacheKey(uint32_t collectionId,
+                 const MinikinPaint& paint,
+                 FontStyle style,
+                 const uint16_t* chars,
+                 size_t start,
+                 size_t count,
+                 size_t nchars,
+                 bool dir)
+      : mChars(chars),
+        mNchars(nchars),
+        mStart(start),
+        mCount(count),
+        mId(collectionId),
+        mStyle(style),
+        mSize(paint.size),
+        mScaleX(paint.scaleX),
+        mSkewX(paint.skewX),
+        mLetterSpacing(paint.letterSpacing),
+        mPaintFlags(paint.paintFlags),
+        mHyphenEdit(paint.hyphenEdit),
+        mIsRtl(dir),
+        mHash(computeHash()) {}
+  bool operator==(const LayoutCacheKey& other) const;
+
+  android::hash_t hash() const { return mHash; }
+
+  // Copies the text the key refers to and points the key at the copy, so the
+  // key can outlive the caller's buffer. The key must not outlive the
+  // returned copy.
+  std::unique_ptr<uint16_t[]> copyText();
+
+  size_t textBytes() const { return mNchars * sizeof(uint16_t); }
+
+  // Returns a key for the layout in a LayoutCacheStore, which unlike this key
+  // stays the same across runs of the process. |collectionHash| is the
+  // content hash of the font collection. gMinikinLock must be held.
+  std::string getStoreKey(uint64_t collectionHash) const;
+
+  // Defined in Layout.cpp, which owns LayoutContext.
+  void doLayout(Layout* layout,
+                LayoutContext* ctx,
+                const std::shared_ptr<FontCollection>& collection) const;
+
+ private:
+  const uint16_t* mChars;
+  size_t mNchars;
+  size_t mStart;
+  size_t mCount;
+  uint32_t mId;  // for the font collection
+  FontStyle mStyle;
+  float mSize;
+  float mScaleX;
+  float mSkewX;
+  float mLetterSpacing;
+  int32_t mPaintFlags;
+  HyphenEdit mHyphenEdit;
+  bool mIsRtl;
+  // Note: any fields added to MinikinPaint must also be reflected here.
+  // TODO: language matching (possibly integrate into style)
+  android::hash_t mHash;
+
+  android::hash_t computeHash() const;
+};
+
+// libtxt extension: a store that keeps shaped words across runs of the
+// process, consulted when a word misses the LayoutCache. Keys and values are
+// opaque byte strings. The store is only used with gMinikinLock held.
+class LayoutCacheStore {
+ public:
+  virtual ~LayoutCacheStore() = default;
+
+  // Copies the value stored for the key into |value| and returns true, or
+  // returns false if there is none.
+  virtual bool load(const std::string& key, std::string* value) = 0;
+
+  virtual void store(const std::string& key, const std::string& value) = 0;
+};
+
+// A cache of shaped words that can be shared by all threads of a process.
+//
+// The cache is split into shards by key hash. Lookups only take the reader
+// side of their shard's lock, so concurrent lookups never wait on each other,
+// and insertions only block lookups that land on the same shard. Each shard
+// keeps to its share of a byte budget by evicting entries with a CLOCK
+// (second chance) policy, which lets a lookup mark an entry as recently used
+// without having to reorder anything.
+//
+// Entries are handed out as shared pointers, so a layout stays valid for the
+// caller even if it is evicted or the cache is cleared concurrently.
+class LayoutCache {
+ public:
+  static constexpr size_t kShardCount = 16;
+  static constexpr size_t kDefaultMaxBytes = 8 * 1024 * 1024;
+
+  explicit LayoutCache(size_t maxBytes = kDefaultMaxBytes);
+  ~LayoutCache();
+
+  // Returns the cached layout for the key, or null if there is none.
+  std::shared_ptr<const Layout> get(const LayoutCacheKey& key);
+
+  // Caches the layout under the key, copying the text the key refers to. If
+  // another thread cached the same key first, that layout is returned
+  // instead and |layout| is discarded.
+  std::shared_ptr<const Layout> put(const LayoutCacheKey& key,
+                                    std::unique_ptr<Layout> layout);
+
+  void clear();
+
+  // Changes the byte budget, evicting entries if the cache is over it.
+  void setMaxBytes(size_t maxBytes);
+  size_t getMaxBytes() const;
+
+  LayoutCacheStats getStats() const;
+
+ private:
+  struct KeyHasher {
+    size_t operator()(const LayoutCacheKey& key) const { return key.hash(); }
+  };
+
+  struct Entry {
+    Entry(const LayoutCacheKey& key,
+          std::unique_ptr<uint16_t[]> text,
+          std::shared_ptr<const Layout> layout,
+          size_t bytes)
+        : key(key),
+          text(std::move(text)),
+          layout(std::move(layout)),
+          bytes(bytes) {}
+
+    // Refers to |text|.
+    LayoutCacheKey key;
+    std::unique_ptr<uint16_t[]> text;
+    std::shared_ptr<const Layout> layout;
+    size_t bytes;
+    // Set by lookups and cleared as the clock hand passes over the entry.
+    std::atomic<bool> referenced{false};
+  };
+
+  // Shards are aligned to a cache line so the counters of neighbouring shards
+  // don't share one.
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<LayoutCacheKey, std::list<Entry>::iterator, KeyHasher>
+        index;
+    std::list<Entry>::iterator hand = entries.end();
+    size_t bytes = 0;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+
+    // Evicts entries until the shard holds at most |maxBytes|. The writer
+    // lock must be held.
+    void evictLocked(size_t maxBytes);
+  };
+
+  Shard& shardFor(const LayoutCacheKey& key);
+
+  size_t shardMaxBytes() const;
+
+  std::atomic<size_t> mMaxBytes;
+  Shard mShards[kShardCount];
+
+  // Forbid copying and assignment.
+  LayoutCache(const LayoutCache&) = delete;
+  void operator=(const LayoutCache&) = delete;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_LAYOUT_CACHE_H
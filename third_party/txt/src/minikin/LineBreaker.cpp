@@ -74,6 +74,12 @@ void LineBreaker::setLocale() {
   mHyphenator = nullptr;
 }
 
+void LineBreaker::setHyphenator(Hyphenator* hyphenator,
+                                const icu::Locale& locale) {
+  mHyphenator = hyphenator;
+  mLocale = hyphenator != nullptr ? locale : icu::Locale();
+}
+
 void LineBreaker::setText() {
   mWordBreaker.setText(mTextBuf.data(), mTextBuf.size());
 
@@ -127,13 +133,36 @@ float LineBreaker::addStyleRun(MinikinPaint* paint,
                                size_t start,
                                size_t end,
                                bool isRtl) {
+  return addStyleRunInternal(paint, typeface, style, start, end, isRtl, true);
+}
+
+void LineBreaker::addMeasuredStyleRun(
+    MinikinPaint* paint,
+    const std::shared_ptr<FontCollection>& typeface,
+    FontStyle style,
+    size_t start,
+    size_t end,
+    bool isRtl) {
+  addStyleRunInternal(paint, typeface, style, start, end, isRtl, false);
+}
+
+float LineBreaker::addStyleRunInternal(
+    MinikinPaint* paint,
+    const std::shared_ptr<FontCollection>& typeface,
+    FontStyle style,
+    size_t start,
+    size_t end,
+    bool isRtl,
+    bool measure) {
   float width = 0.0f;
 
   float hyphenPenalty = 0.0;
   if (paint != nullptr) {
-    width = Layout::measureText(mTextBuf.data(), start, end - start,
-                                mTextBuf.size(), isRtl, style, *paint, typeface,
-                                mCharWidths.data() + start);
+    if (measure) {
+      width = Layout::measureText(mTextBuf.data(), start, end - start,
+                                  mTextBuf.size(), isRtl, style, *paint,
+                                  typeface, mCharWidths.data() + start);
+    }
 
     // a heuristic that seems to perform well
     hyphenPenalty =
@@ -102,6 +102,12 @@ class LineBreaker {
   // of the ICU break iterator can be reused.
   void setLocale();
 
+  // libtxt extension: hyphenates words with |hyphenator| following the rules
+  // of |locale|, or stops hyphenating if |hyphenator| is null. Word breaking
+  // keeps using the default locale. See HyphenatorMap for a source of
+  // hyphenators.
+  void setHyphenator(Hyphenator* hyphenator, const icu::Locale& locale);
+
   void resize(size_t size) {
     mTextBuf.resize(size);
     mCharWidths.resize(size);
@@ -148,6 +154,17 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt: Like addStyleRun, but uses the widths already stored in
+  // charWidths() instead of measuring the run. This lets callers that kept
+  // the widths from an earlier break of the same text rebreak it at another
+  // width without shaping it again. The paint is still used for hyphenation.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -193,6 +210,14 @@ class LineBreaker {
 
   float currentLineWidth() const;
 
+  float addStyleRunInternal(MinikinPaint* paint,
+                            const std::shared_ptr<FontCollection>& typeface,
+                            FontStyle style,
+                            size_t start,
+                            size_t end,
+                            bool isRtl,
+                            bool measure);
+
   void addWordBreak(size_t offset,
                     ParaWidth preBreak,
                     ParaWidth postBreak,
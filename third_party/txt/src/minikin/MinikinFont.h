@@ -117,6 +117,11 @@ class MinikinFont {
 
   int32_t GetUniqueId() const { return mUniqueId; }
 
+  // libtxt extension: a hash of the font file that stays the same across runs
+  // of the process, so that results computed with the font can be persisted.
+  // Returns 0 if the font can't be identified that way.
+  virtual uint64_t GetContentHash() const { return 0; }
+
  private:
   const int32_t mUniqueId;
 };
@@ -29,7 +29,8 @@ namespace minikin {
 
 // All external Minikin interfaces are designed to be thread-safe.
 // Presently, that's implemented by through a global lock, and having
-// all external interfaces take that lock.
+// all external interfaces take that lock. The layout cache has its own
+// locking, so only layouts that miss it take the global lock.
 
 extern std::recursive_mutex gMinikinLock;
 
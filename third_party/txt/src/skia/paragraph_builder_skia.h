@@ -34,6 +34,7 @@ class ParagraphBuilderSkia : public ParagraphBuilder {
   virtual void PushStyle(const TextStyle& style) override;
   virtual void Pop() override;
   virtual const TextStyle& PeekStyle() override;
+  using ParagraphBuilder::AddText;
   virtual void AddText(const std::u16string& text) override;
   virtual void AddPlaceholder(PlaceholderRun& span) override;
   virtual std::unique_ptr<Paragraph> Build() override;
@@ -28,6 +28,7 @@
 #include "flutter/fml/trace_event.h"
 #include "font_skia.h"
 #include "minikin/Layout.h"
+#include "minikin/MinikinInternal.h"
 #include "txt/platform.h"
 #include "txt/text_style.h"
 
@@ -37,6 +38,10 @@ namespace {
 
 const std::shared_ptr<minikin::FontFamily> g_null_family;
 
+std::string FallbackStoreKey(uint32_t ch, const std::string& locale) {
+  return "txt.fallback." + locale + "." + std::to_string(ch);
+}
+
 }  // anonymous namespace
 
 FontCollection::FamilyKey::FamilyKey(const std::vector<std::string>& families,
@@ -163,11 +168,40 @@ FontCollection::GetMinikinFontCollectionForFamilies(
     const std::string& locale) {
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
-  auto cached = font_collections_cache_.find(family_key);
-  if (cached != font_collections_cache_.end()) {
-    return cached->second;
+  {
+    std::shared_lock lock(font_collections_mutex_);
+    auto cached = font_collections_cache_.find(family_key);
+    if (cached != font_collections_cache_.end()) {
+      return cached->second;
+    }
+  }
+
+  // Building a collection reads the fallback fonts, which are guarded by the
+  // minikin lock. Holding it for the whole build also means that a collection
+  // missed by several threads at once is only built by one of them.
+  std::scoped_lock minikin_lock(minikin::gMinikinLock);
+  {
+    std::shared_lock lock(font_collections_mutex_);
+    auto cached = font_collections_cache_.find(family_key);
+    if (cached != font_collections_cache_.end()) {
+      return cached->second;
+    }
   }
 
+  std::shared_ptr<minikin::FontCollection> font_collection =
+      CreateMinikinFontCollection(font_families, locale);
+
+  // Cache the font collection for future queries.
+  std::unique_lock lock(font_collections_mutex_);
+  font_collections_cache_[family_key] = font_collection;
+
+  return font_collection;
+}
+
+std::shared_ptr<minikin::FontCollection>
+FontCollection::CreateMinikinFontCollection(
+    const std::vector<std::string>& font_families,
+    const std::string& locale) {
   std::vector<std::shared_ptr<minikin::FontFamily>> minikin_families;
 
   // Search for all user provided font families.
@@ -193,7 +227,6 @@ FontCollection::GetMinikinFontCollectionForFamilies(
   }
   // Default font family also not found. We fail to get a FontCollection.
   if (minikin_families.empty()) {
-    font_collections_cache_[family_key] = nullptr;
     return nullptr;
   }
   if (enable_font_fallback_) {
@@ -209,17 +242,12 @@ FontCollection::GetMinikinFontCollectionForFamilies(
   auto font_collection =
       minikin::FontCollection::Create(std::move(minikin_families));
   if (!font_collection) {
-    font_collections_cache_[family_key] = nullptr;
     return nullptr;
   }
   if (enable_font_fallback_) {
     font_collection->set_fallback_font_provider(
         std::make_unique<TxtFallbackFontProvider>(shared_from_this()));
   }
-
-  // Cache the font collection for future queries.
-  font_collections_cache_[family_key] = font_collection;
-
   return font_collection;
 }
 
@@ -306,7 +334,7 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
     // Create the minikin font from the skia typeface.
     // Divide by 100 because the weights are given as "100", "200", etc.
     minikin_fonts.emplace_back(
-        std::make_shared<FontSkia>(skia_typeface),
+        std::make_shared<FontSkia>(skia_typeface, family_name),
         minikin::FontStyle{skia_typeface->fontStyle().weight() / 100,
                            skia_typeface->isItalic()});
   }
@@ -317,6 +345,7 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  std::scoped_lock minikin_lock(minikin::gMinikinLock);
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
@@ -333,6 +362,12 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
 const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  if (persistent_store_) {
+    if (const auto* stored = LoadStoredFallbackFont(ch, locale)) {
+      return *stored;
+    }
+  }
+
   for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
     std::vector<const char*> bcp47;
     if (!locale.empty())
@@ -351,11 +386,48 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
                   family_name) == fallback_fonts_for_locale_[locale].end())
       fallback_fonts_for_locale_[locale].push_back(family_name);
 
-    return GetFallbackFontFamily(manager, family_name);
+    const std::shared_ptr<minikin::FontFamily>& family =
+        GetFallbackFontFamily(manager, family_name);
+    if (family && persistent_store_) {
+      persistent_store_->store(FallbackStoreKey(ch, locale), family_name);
+    }
+    return family;
   }
   return g_null_family;
 }
 
+const std::shared_ptr<minikin::FontFamily>*
+FontCollection::LoadStoredFallbackFont(uint32_t ch, const std::string& locale) {
+  std::string family_name;
+  if (!persistent_store_->load(FallbackStoreKey(ch, locale), &family_name)) {
+    return nullptr;
+  }
+  for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
+    const std::shared_ptr<minikin::FontFamily>& family =
+        GetFallbackFontFamily(manager, family_name);
+    if (!family) {
+      continue;
+    }
+    if (!family->hasGlyph(ch, 0)) {
+      return nullptr;
+    }
+    std::vector<std::string>& locale_families =
+        fallback_fonts_for_locale_[locale];
+    if (std::find(locale_families.begin(), locale_families.end(),
+                  family_name) == locale_families.end()) {
+      locale_families.push_back(family_name);
+    }
+    return &family;
+  }
+  return nullptr;
+}
+
+void FontCollection::SetPersistentStore(
+    std::shared_ptr<minikin::LayoutCacheStore> store) {
+  std::scoped_lock minikin_lock(minikin::gMinikinLock);
+  persistent_store_ = std::move(store);
+}
+
 const std::shared_ptr<minikin::FontFamily>&
 FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
                                       const std::string& family_name) {
@@ -375,13 +447,19 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 
   // Clear the cache to force creation of new font collections that will
   // include this fallback font.
-  font_collections_cache_.clear();
+  {
+    std::unique_lock lock(font_collections_mutex_);
+    font_collections_cache_.clear();
+  }
 
   return insert_it.first->second;
 }
 
 void FontCollection::ClearFontFamilyCache() {
-  font_collections_cache_.clear();
+  {
+    std::unique_lock lock(font_collections_mutex_);
+    font_collections_cache_.clear();
+  }
 
 #if FLUTTER_ENABLE_SKSHAPER
   if (skt_collection_) {
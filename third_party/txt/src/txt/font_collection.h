@@ -19,16 +19,19 @@
 
 #include <memory>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 
 #include "flutter/fml/macros.h"
 #include "minikin/FontCollection.h"
 #include "minikin/FontFamily.h"
+#include "minikin/LayoutCache.h"
 #include "third_party/googletest/googletest/include/gtest/gtest_prod.h"  // nogncheck
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "txt/asset_font_manager.h"
+#include "txt/glyph_profile.h"
 #include "txt/text_style.h"
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -37,6 +40,8 @@
 
 namespace txt {
 
+// Paragraphs that share a FontCollection may be laid out concurrently. The
+// font managers must only be changed while no layout is in progress.
 class FontCollection : public std::enable_shared_from_this<FontCollection> {
  public:
   FontCollection();
@@ -57,6 +62,9 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
 
   // Provides a FontFamily that contains glyphs for ch. This caches previously
   // matched fonts. Also see FontCollection::DoMatchFallbackFont.
+  //
+  // The fallback caches are guarded by minikin's global lock, which minikin
+  // already holds when it asks for a fallback font during itemization.
   const std::shared_ptr<minikin::FontFamily>& MatchFallbackFont(
       uint32_t ch,
       std::string locale);
@@ -68,6 +76,14 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   // Remove all entries in the font family cache.
   void ClearFontFamilyCache();
 
+  // Sets a store that keeps the results of MatchFallbackFont across runs of
+  // the process, or clears it if |store| is null. The stored results are
+  // checked against the fonts available when they are read back.
+  void SetPersistentStore(std::shared_ptr<minikin::LayoutCacheStore> store);
+
+  // The glyphs paragraphs laid out with this collection use.
+  GlyphProfile& glyph_profile() { return glyph_profile_; }
+
 #if FLUTTER_ENABLE_SKSHAPER
 
   // Construct a Skia text layout FontCollection based on this collection.
@@ -94,6 +110,10 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> dynamic_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
+  // Guards font_collections_cache_. Nothing may call into minikin while
+  // holding it, as minikin calls back into this class with its own global
+  // lock held.
+  mutable std::shared_mutex font_collections_mutex_;
   std::unordered_map<FamilyKey,
                      std::shared_ptr<minikin::FontCollection>,
                      FamilyKey::Hasher>
@@ -107,6 +127,9 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   std::unordered_map<std::string, std::vector<std::string>>
       fallback_fonts_for_locale_;
   bool enable_font_fallback_;
+  // Guarded by the minikin lock, like the fallback caches.
+  std::shared_ptr<minikin::LayoutCacheStore> persistent_store_;
+  GlyphProfile glyph_profile_;
 
 #if FLUTTER_ENABLE_SKSHAPER
   // An equivalent font collection usable by the Skia text shaper library.
@@ -119,8 +142,21 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       uint32_t ch,
       std::string locale);
 
+  // Returns the fallback font family the persistent store holds for the
+  // character, or nullptr if there is none or it no longer has a glyph for
+  // the character.
+  const std::shared_ptr<minikin::FontFamily>* LoadStoredFallbackFont(
+      uint32_t ch,
+      const std::string& locale);
+
   std::vector<sk_sp<SkFontMgr>> GetFontManagerOrder() const;
 
+  // Builds the collection that GetMinikinFontCollectionForFamilies caches.
+  // The minikin lock must be held.
+  std::shared_ptr<minikin::FontCollection> CreateMinikinFontCollection(
+      const std::vector<std::string>& font_families,
+      const std::string& locale);
+
   std::shared_ptr<minikin::FontFamily> FindFontFamilyInManagers(
       const std::string& family_name);
 
@@ -18,7 +18,11 @@
 
 #include <minikin/MinikinFont.h>
 
+#include <vector>
+
 #include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkFontArguments.h"
+#include "third_party/skia/include/core/SkString.h"
 
 namespace txt {
 namespace {
@@ -44,8 +48,10 @@ hb_blob_t* GetTable(hb_face_t* face, hb_tag_t tag, void* context) {
 
 }  // namespace
 
-FontSkia::FontSkia(sk_sp<SkTypeface> typeface)
-    : MinikinFont(typeface->uniqueID()), typeface_(std::move(typeface)) {}
+FontSkia::FontSkia(sk_sp<SkTypeface> typeface, std::string family_name)
+    : MinikinFont(typeface->uniqueID()),
+      typeface_(std::move(typeface)),
+      family_name_(std::move(family_name)) {}
 
 FontSkia::~FontSkia() = default;
 
@@ -90,8 +96,60 @@ const std::vector<minikin::FontVariation>& FontSkia::GetAxes() const {
   return variations_;
 }
 
+uint64_t FontSkia::GetContentHash() const {
+  std::call_once(content_hash_once_, [this]() {
+    const SkFontTableTag head_tag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    const size_t head_size = typeface_->getTableSize(head_tag);
+    if (head_size == 0) {
+      return;
+    }
+    std::vector<uint8_t> data(head_size);
+    if (typeface_->getTableData(head_tag, 0, head_size, data.data()) !=
+        head_size) {
+      return;
+    }
+
+    // Faces of a font collection file may share their 'head' table.
+    SkString family_name;
+    typeface_->getFamilyName(&family_name);
+    data.insert(data.end(), family_name.c_str(),
+                family_name.c_str() + family_name.size());
+    const SkFontStyle style = typeface_->fontStyle();
+    for (int value : {style.weight(), style.width(),
+                      static_cast<int>(style.slant())}) {
+      data.push_back(static_cast<uint8_t>(value));
+      data.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    const int axis_count = typeface_->getVariationDesignPosition(nullptr, 0);
+    if (axis_count > 0) {
+      std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates(
+          axis_count);
+      if (typeface_->getVariationDesignPosition(coordinates.data(),
+                                                axis_count) == axis_count) {
+        const uint8_t* bytes =
+            reinterpret_cast<const uint8_t*>(coordinates.data());
+        data.insert(data.end(), bytes,
+                    bytes + coordinates.size() * sizeof(coordinates[0]));
+      }
+    }
+
+    // 64-bit FNV-1a.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint8_t byte : data) {
+      hash = (hash ^ byte) * 0x100000001b3ull;
+    }
+    content_hash_ = hash == 0 ? 1 : hash;
+  });
+  return content_hash_;
+}
+
 const sk_sp<SkTypeface>& FontSkia::GetSkTypeface() const {
   return typeface_;
 }
 
+const std::string& FontSkia::GetFamilyName() const {
+  return family_name_;
+}
+
 }  // namespace txt
@@ -16,6 +16,9 @@
 
 #include <minikin/MinikinFont.h>
 
+#include <mutex>
+#include <string>
+
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkTypeface.h"
@@ -24,7 +27,10 @@ namespace txt {
 
 class FontSkia : public minikin::MinikinFont {
  public:
-  explicit FontSkia(sk_sp<SkTypeface> typeface);
+  // |family_name| is the name the typeface was found under, which may differ
+  // from the family name stored in the font.
+  explicit FontSkia(sk_sp<SkTypeface> typeface,
+                    std::string family_name = std::string());
 
   ~FontSkia();
 
@@ -39,11 +45,20 @@ class FontSkia : public minikin::MinikinFont {
 
   const std::vector<minikin::FontVariation>& GetAxes() const override;
 
+  // Hashes the font's 'head' table, whose checksum covers the whole font file,
+  // along with its family name, style and variation position.
+  uint64_t GetContentHash() const override;
+
   const sk_sp<SkTypeface>& GetSkTypeface() const;
 
+  const std::string& GetFamilyName() const;
+
  private:
   sk_sp<SkTypeface> typeface_;
+  std::string family_name_;
   std::vector<minikin::FontVariation> variations_;
+  mutable std::once_flag content_hash_once_;
+  mutable uint64_t content_hash_ = 0;
 
   FML_DISALLOW_COPY_AND_ASSIGN(FontSkia);
 };
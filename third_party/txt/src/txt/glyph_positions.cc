@@ -0,0 +1,211 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glyph_positions.h"
+
+#include <algorithm>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/logging.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include <emmintrin.h>
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace txt {
+namespace {
+
+void AddToAll(double* values, size_t count, double delta) {
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_64)
+  const __m128d deltas = _mm_set1_pd(delta);
+  for (; i + 2 <= count; i += 2) {
+    _mm_storeu_pd(values + i, _mm_add_pd(_mm_loadu_pd(values + i), deltas));
+  }
+#elif defined(ARCH_CPU_ARM64)
+  const float64x2_t deltas = vdupq_n_f64(delta);
+  for (; i + 2 <= count; i += 2) {
+    vst1q_f64(values + i, vaddq_f64(vld1q_f64(values + i), deltas));
+  }
+#endif
+  for (; i < count; i++) {
+    values[i] += delta;
+  }
+}
+
+// Returns the index of the first value greater than |x|, or |count| if there
+// is none.
+size_t FindFirstGreater(const double* values, size_t count, double x) {
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_64)
+  const __m128d xs = _mm_set1_pd(x);
+  for (; i + 2 <= count; i += 2) {
+    int mask = _mm_movemask_pd(_mm_cmplt_pd(xs, _mm_loadu_pd(values + i)));
+    if (mask != 0) {
+      return i + ((mask & 1) ? 0 : 1);
+    }
+  }
+#elif defined(ARCH_CPU_ARM64)
+  const float64x2_t xs = vdupq_n_f64(x);
+  for (; i + 2 <= count; i += 2) {
+    uint64x2_t greater = vcltq_f64(xs, vld1q_f64(values + i));
+    if (vgetq_lane_u64(greater, 0)) {
+      return i;
+    }
+    if (vgetq_lane_u64(greater, 1)) {
+      return i + 1;
+    }
+  }
+#endif
+  for (; i < count; i++) {
+    if (x < values[i]) {
+      return i;
+    }
+  }
+  return count;
+}
+
+double Min(const double* values, size_t count) {
+  FML_DCHECK(count > 0);
+  double result = values[0];
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_64)
+  if (count >= 2) {
+    __m128d mins = _mm_loadu_pd(values);
+    for (i = 2; i + 2 <= count; i += 2) {
+      mins = _mm_min_pd(mins, _mm_loadu_pd(values + i));
+    }
+    result = std::min(_mm_cvtsd_f64(mins),
+                      _mm_cvtsd_f64(_mm_unpackhi_pd(mins, mins)));
+  }
+#elif defined(ARCH_CPU_ARM64)
+  if (count >= 2) {
+    float64x2_t mins = vld1q_f64(values);
+    for (i = 2; i + 2 <= count; i += 2) {
+      mins = vminq_f64(mins, vld1q_f64(values + i));
+    }
+    result = vminvq_f64(mins);
+  }
+#endif
+  for (; i < count; i++) {
+    result = std::min(result, values[i]);
+  }
+  return result;
+}
+
+double Max(const double* values, size_t count) {
+  FML_DCHECK(count > 0);
+  double result = values[0];
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_64)
+  if (count >= 2) {
+    __m128d maxes = _mm_loadu_pd(values);
+    for (i = 2; i + 2 <= count; i += 2) {
+      maxes = _mm_max_pd(maxes, _mm_loadu_pd(values + i));
+    }
+    result = std::max(_mm_cvtsd_f64(maxes),
+                      _mm_cvtsd_f64(_mm_unpackhi_pd(maxes, maxes)));
+  }
+#elif defined(ARCH_CPU_ARM64)
+  if (count >= 2) {
+    float64x2_t maxes = vld1q_f64(values);
+    for (i = 2; i + 2 <= count; i += 2) {
+      maxes = vmaxq_f64(maxes, vld1q_f64(values + i));
+    }
+    result = vmaxvq_f64(maxes);
+  }
+#endif
+  for (; i < count; i++) {
+    result = std::max(result, values[i]);
+  }
+  return result;
+}
+
+}  // namespace
+
+GlyphPosition::GlyphPosition(double x_start,
+                             double x_advance,
+                             size_t code_unit_index,
+                             size_t code_unit_width)
+    : code_units(code_unit_index, code_unit_index + code_unit_width),
+      x_pos(x_start, x_start + x_advance) {}
+
+void GlyphPosition::Shift(double delta) {
+  x_pos.Shift(delta);
+}
+
+GlyphPositions::GlyphPositions() = default;
+
+GlyphPositions::GlyphPositions(const std::vector<GlyphPosition>& positions) {
+  code_unit_starts_.reserve(positions.size());
+  code_unit_ends_.reserve(positions.size());
+  x_starts_.reserve(positions.size());
+  x_ends_.reserve(positions.size());
+  for (const GlyphPosition& position : positions) {
+    code_unit_starts_.push_back(position.code_units.start);
+    code_unit_ends_.push_back(position.code_units.end);
+    x_starts_.push_back(position.x_pos.start);
+    x_ends_.push_back(position.x_pos.end);
+  }
+}
+
+GlyphPosition GlyphPositions::operator[](size_t index) const {
+  FML_DCHECK(index < size());
+  GlyphPosition position(x_starts_[index], 0, code_unit_starts_[index], 0);
+  position.code_units.end = code_unit_ends_[index];
+  position.x_pos.end = x_ends_[index];
+  return position;
+}
+
+void GlyphPositions::Shift(double delta) {
+  AddToAll(x_starts_.data(), x_starts_.size(), delta);
+  AddToAll(x_ends_.data(), x_ends_.size(), delta);
+}
+
+size_t GlyphPositions::FindByX(double x) const {
+  FML_DCHECK(!empty());
+  // Position i extends to the start of position i + 1, so x falls in the
+  // position before the first one that starts after it.
+  return FindFirstGreater(x_starts_.data() + 1, size() - 1, x);
+}
+
+Paragraph::Range<size_t> GlyphPositions::FindCodeUnits(size_t start,
+                                                       size_t end) const {
+  size_t first =
+      std::lower_bound(code_unit_starts_.begin(), code_unit_starts_.end(),
+                       start) -
+      code_unit_starts_.begin();
+  size_t last = std::upper_bound(code_unit_starts_.begin() + first,
+                                 code_unit_starts_.end(), end) -
+                code_unit_starts_.begin();
+  // The last positions may start within the range but end past it.
+  while (last > first && code_unit_ends_[last - 1] > end) {
+    last--;
+  }
+  return Paragraph::Range<size_t>(first, last);
+}
+
+Paragraph::Range<double> GlyphPositions::GetXExtent(
+    Paragraph::Range<size_t> indices) const {
+  FML_DCHECK(indices.start < indices.end && indices.end <= size());
+  return Paragraph::Range<double>(
+      Min(x_starts_.data() + indices.start, indices.width()),
+      Max(x_ends_.data() + indices.start, indices.width()));
+}
+
+}  // namespace txt
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_GLYPH_POSITIONS_H_
+#define LIB_TXT_SRC_GLYPH_POSITIONS_H_
+
+#include <vector>
+
+#include "paragraph.h"
+
+namespace txt {
+
+// The code units and horizontal extent of a glyph, or of one grapheme of a
+// ligature glyph.
+struct GlyphPosition {
+  Paragraph::Range<size_t> code_units;
+  Paragraph::Range<double> x_pos;
+
+  GlyphPosition(double x_start,
+                double x_advance,
+                size_t code_unit_index,
+                size_t code_unit_width);
+
+  void Shift(double delta);
+};
+
+// A sequence of glyph positions, stored as one array per field rather than
+// as an array of GlyphPosition.
+//
+// Shifting a line and searching it by coordinate then run over contiguous
+// doubles, which is done two at a time with SSE2 on x86-64 and NEON on
+// arm64, and one at a time elsewhere.
+class GlyphPositions {
+ public:
+  GlyphPositions();
+
+  explicit GlyphPositions(const std::vector<GlyphPosition>& positions);
+
+  size_t size() const { return x_starts_.size(); }
+  bool empty() const { return x_starts_.empty(); }
+
+  GlyphPosition operator[](size_t index) const;
+  GlyphPosition front() const { return (*this)[0]; }
+  GlyphPosition back() const { return (*this)[size() - 1]; }
+
+  // Moves every position horizontally by |delta|.
+  void Shift(double delta);
+
+  // Returns the index of the position that the x coordinate |x| falls in,
+  // where each position is taken to extend to the start of the next one. A
+  // coordinate past the end falls in the last position. The positions must be
+  // sorted by x coordinate and not be empty.
+  size_t FindByX(double x) const;
+
+  // Returns the range of indices of the positions whose code units all lie
+  // within [start, end). The positions must be sorted by code unit index and
+  // not overlap.
+  Paragraph::Range<size_t> FindCodeUnits(size_t start, size_t end) const;
+
+  // Returns the union of the horizontal extents of the positions in the
+  // range of indices, which must not be empty.
+  Paragraph::Range<double> GetXExtent(Paragraph::Range<size_t> indices) const;
+
+ private:
+  std::vector<size_t> code_unit_starts_;
+  std::vector<size_t> code_unit_ends_;
+  std::vector<double> x_starts_;
+  std::vector<double> x_ends_;
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_GLYPH_POSITIONS_H_
@@ -0,0 +1,317 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glyph_profile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#include "flutter/fml/trace_event.h"
+#include "font_collection.h"
+#include "font_skia.h"
+#include "minikin/FontCollection.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/core/SkSurfaceProps.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
+
+namespace txt {
+namespace {
+
+// The layout of a stored font, which is only ever read back by the same
+// build of the engine on the same device:
+//
+//   float size, float device scale, int32_t weight, int32_t width,
+//   int32_t slant, uint8_t fakery (bit 0 bold, bit 1 italic),
+//   uint8_t luminance, then the family name.
+//
+// Glyphs are stored as an array of uint16_t.
+
+template <typename T>
+void AppendValue(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(const uint8_t** data, const uint8_t* end, T* value) {
+  if (static_cast<size_t>(end - *data) < sizeof(T)) {
+    return false;
+  }
+  memcpy(value, *data, sizeof(T));
+  *data += sizeof(T);
+  return true;
+}
+
+// Glyphs are drawn with their baseline on the bottom edge of the surface so
+// that they are not clipped out before they are rasterized.
+constexpr int kPrewarmSurfaceSize = 64;
+
+// Skia positions glyphs of horizontal text to a quarter of a device pixel and
+// caches a mask for each of these offsets.
+constexpr int kSubpixelOffsets = 4;
+
+}  // namespace
+
+bool GlyphProfile::Font::operator<(const Font& other) const {
+  return std::make_tuple(family_name, size, style.weight(), style.width(),
+                         style.slant(), fake_bold, fake_italic, luminance) <
+         std::make_tuple(other.family_name, other.size, other.style.weight(),
+                         other.style.width(), other.style.slant(),
+                         other.fake_bold, other.fake_italic, other.luminance);
+}
+
+void GlyphProfile::Batch::Add(const std::string& family_name,
+                              const SkFont& font,
+                              const SkPaint& paint,
+                              const uint16_t* glyphs,
+                              size_t count) {
+  Font key;
+  key.family_name = family_name;
+  if (font.getTypeface()) {
+    key.style = font.getTypeface()->fontStyle();
+  }
+  key.size = font.getSize();
+  key.fake_bold = font.isEmbolden();
+  key.fake_italic = font.getSkewX() != 0;
+  key.luminance = LuminanceOf(paint);
+  std::vector<uint16_t>& font_glyphs = fonts_[key];
+  font_glyphs.insert(font_glyphs.end(), glyphs, glyphs + count);
+}
+
+GlyphProfile::GlyphProfile() = default;
+
+GlyphProfile::~GlyphProfile() = default;
+
+void GlyphProfile::SetRecording(bool recording) {
+  recording_.store(recording, std::memory_order_relaxed);
+}
+
+void GlyphProfile::Record(const Batch& batch) {
+  if (batch.empty()) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  for (const auto& [font, glyphs] : batch.fonts_) {
+    AddLocked(font, glyphs.data(), glyphs.size(), true);
+  }
+}
+
+void GlyphProfile::Add(const Font& font, const Glyphs& glyphs) {
+  std::scoped_lock lock(mutex_);
+  AddLocked(font, glyphs.data(), glyphs.size(), false);
+}
+
+void GlyphProfile::AddLocked(const Font& font,
+                             const uint16_t* glyphs,
+                             size_t count,
+                             bool changed) {
+  auto found = fonts_.find(font);
+  if (found == fonts_.end()) {
+    if (fonts_.size() >= kMaxFonts) {
+      return;
+    }
+    found = fonts_.emplace(font, Usage()).first;
+  }
+  Usage& usage = found->second;
+  for (size_t i = 0; i < count; i++) {
+    uint16_t glyph = glyphs[i];
+    if (glyph >= usage.glyphs.size()) {
+      usage.glyphs.resize(glyph + 1);
+    }
+    if (!usage.glyphs[glyph]) {
+      usage.glyphs[glyph] = true;
+      usage.changed |= changed;
+    }
+  }
+}
+
+GlyphProfile::Entries GlyphProfile::TakeChanged() {
+  std::scoped_lock lock(mutex_);
+  Entries entries;
+  for (auto& [font, usage] : fonts_) {
+    if (!usage.changed) {
+      continue;
+    }
+    usage.changed = false;
+    Glyphs glyphs;
+    for (size_t glyph = 0; glyph < usage.glyphs.size(); glyph++) {
+      if (usage.glyphs[glyph]) {
+        glyphs.push_back(glyph);
+      }
+    }
+    entries.emplace_back(font, std::move(glyphs));
+  }
+  return entries;
+}
+
+uint8_t GlyphProfile::LuminanceOf(const SkPaint& paint) {
+  // Skia uses a mid gray for paints whose color is not known up front, see
+  // SkPaintPriv::ComputeLuminanceColor.
+  if (paint.getShader() || paint.getColorFilter()) {
+    return 0x80;
+  }
+  // The weights of SkComputeLuminance.
+  const SkColor color = paint.getColor();
+  return (SkColorGetR(color) * 54 + SkColorGetG(color) * 183 +
+          SkColorGetB(color) * 19) >>
+         8;
+}
+
+std::string GlyphProfile::EncodeFont(const Font& font, float device_scale) {
+  std::string key;
+  AppendValue(&key, font.size);
+  AppendValue(&key, device_scale);
+  AppendValue(&key, static_cast<int32_t>(font.style.weight()));
+  AppendValue(&key, static_cast<int32_t>(font.style.width()));
+  AppendValue(&key, static_cast<int32_t>(font.style.slant()));
+  AppendValue(&key, static_cast<uint8_t>((font.fake_bold ? 1 : 0) |
+                                         (font.fake_italic ? 2 : 0)));
+  AppendValue(&key, font.luminance);
+  key.append(font.family_name);
+  return key;
+}
+
+bool GlyphProfile::DecodeFont(const void* data,
+                              size_t size,
+                              Font* font,
+                              float* device_scale) {
+  const uint8_t* current = static_cast<const uint8_t*>(data);
+  const uint8_t* end = current + size;
+  int32_t weight, width, slant;
+  uint8_t fakery;
+  if (!ReadValue(&current, end, &font->size) ||
+      !ReadValue(&current, end, device_scale) ||
+      !ReadValue(&current, end, &weight) ||
+      !ReadValue(&current, end, &width) || !ReadValue(&current, end, &slant) ||
+      !ReadValue(&current, end, &fakery) ||
+      !ReadValue(&current, end, &font->luminance)) {
+    return false;
+  }
+  if (!(font->size > 0) || !(*device_scale > 0) ||
+      slant < SkFontStyle::kUpright_Slant ||
+      slant > SkFontStyle::kOblique_Slant) {
+    return false;
+  }
+  font->style = SkFontStyle(weight, width,
+                            static_cast<SkFontStyle::Slant>(slant));
+  font->fake_bold = (fakery & 1) != 0;
+  font->fake_italic = (fakery & 2) != 0;
+  font->family_name.assign(reinterpret_cast<const char*>(current),
+                           end - current);
+  return true;
+}
+
+std::string GlyphProfile::EncodeGlyphs(const Glyphs& glyphs) {
+  return std::string(reinterpret_cast<const char*>(glyphs.data()),
+                     glyphs.size() * sizeof(uint16_t));
+}
+
+bool GlyphProfile::DecodeGlyphs(const void* data,
+                                size_t size,
+                                Glyphs* glyphs) {
+  if (size % sizeof(uint16_t) != 0) {
+    return false;
+  }
+  glyphs->resize(size / sizeof(uint16_t));
+  memcpy(glyphs->data(), data, size);
+  return true;
+}
+
+size_t GlyphProfile::Prewarm(FontCollection& font_collection,
+                             const Entries& entries,
+                             float device_scale,
+                             GrDirectContext* context) {
+  TRACE_EVENT0("flutter", "GlyphProfile::Prewarm");
+  if (!(device_scale > 0)) {
+    return 0;
+  }
+  // The pixel geometry and flags of the surfaces the engine draws to, which
+  // decide the gamma and contrast of cached glyph masks.
+  SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+  const SkImageInfo info =
+      SkImageInfo::MakeN32Premul(kPrewarmSurfaceSize, kPrewarmSurfaceSize);
+  sk_sp<SkSurface> surface =
+      context ? SkSurface::MakeRenderTarget(context, SkBudgeted::kNo, info, 0,
+                                            &props)
+              : SkSurface::MakeRaster(info, &props);
+  if (!surface) {
+    return 0;
+  }
+  SkCanvas* canvas = surface->getCanvas();
+  // Paragraphs are laid out in logical pixels and drawn under a transform
+  // that scales them by the device pixel ratio.
+  canvas->scale(device_scale, device_scale);
+  const float baseline = kPrewarmSurfaceSize / device_scale;
+  const float subpixel = 1.0f / (kSubpixelOffsets * device_scale);
+
+  size_t count = 0;
+  for (const auto& [font, glyphs] : entries) {
+    if (glyphs.empty()) {
+      continue;
+    }
+    // Find the typeface the way paragraphs do, so that the glyphs are cached
+    // for the same typeface object.
+    std::shared_ptr<minikin::FontCollection> minikin_collection =
+        font_collection.GetMinikinFontCollectionForFamilies(
+            {font.family_name}, "");
+    if (!minikin_collection) {
+      continue;
+    }
+    minikin::FakedFont faked_font = minikin_collection->baseFontFaked(
+        minikin::FontStyle(font.style.weight() / 100,
+                           font.style.slant() != SkFontStyle::kUpright_Slant));
+    const FontSkia* font_skia = static_cast<const FontSkia*>(faked_font.font);
+    if (!font_skia || font_skia->GetFamilyName() != font.family_name) {
+      // The family is missing and the collection fell back to another one.
+      continue;
+    }
+
+    // The same font parameters as ParagraphTxt::Layout.
+    SkFont sk_font(font_skia->GetSkTypeface(), font.size);
+    sk_font.setEdging(SkFont::Edging::kAntiAlias);
+    sk_font.setSubpixel(true);
+    sk_font.setHinting(SkFontHinting::kSlight);
+    sk_font.setEmbolden(font.fake_bold);
+    sk_font.setSkewX(font.fake_italic ? -SK_Scalar1 / 4 : 0);
+
+    // The same paint as ParagraphTxt::Paint, down to the luminance of the
+    // color.
+    SkPaint paint;
+    paint.setColor(
+        SkColorSetRGB(font.luminance, font.luminance, font.luminance));
+
+    SkTextBlobBuilder builder;
+    const SkTextBlobBuilder::RunBuffer& buffer =
+        builder.allocRunPos(sk_font, glyphs.size() * kSubpixelOffsets);
+    for (int offset = 0; offset < kSubpixelOffsets; offset++) {
+      for (size_t i = 0; i < glyphs.size(); i++) {
+        const size_t index = offset * glyphs.size() + i;
+        buffer.glyphs[index] = glyphs[i];
+        buffer.pos[index * 2] = offset * subpixel;
+        buffer.pos[index * 2 + 1] = baseline;
+      }
+    }
+    canvas->drawTextBlob(builder.make(), 0, 0, paint);
+    count += glyphs.size();
+  }
+  surface->flushAndSubmit();
+  return count;
+}
+
+}  // namespace txt
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_GLYPH_PROFILE_H_
+#define LIB_TXT_SRC_GLYPH_PROFILE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkFontStyle.h"
+#include "third_party/skia/include/core/SkPaint.h"
+
+class GrDirectContext;
+
+namespace txt {
+
+class FontCollection;
+
+// Records which glyphs paragraphs lay out in which fonts, sizes and colors,
+// so that a later run of the process can rasterize them into Skia's glyph
+// cache on a background thread before they are first drawn.
+//
+// Each FontCollection has a profile of the paragraphs laid out with it.
+// Recording is off until |SetRecording| turns it on.
+class GlyphProfile {
+ public:
+  // A font at a size in logical pixels, identified so that a later run of the
+  // process can find it again through a FontCollection.
+  struct Font {
+    std::string family_name;
+    SkFontStyle style;
+    float size = 0;
+    bool fake_bold = false;
+    bool fake_italic = false;
+    // The luminance of the text color. Skia keys the glyph masks it caches
+    // on it, see |LuminanceOf|.
+    uint8_t luminance = 0;
+
+    bool operator<(const Font& other) const;
+  };
+
+  // Sorted glyph IDs of a font.
+  using Glyphs = std::vector<uint16_t>;
+  using Entries = std::vector<std::pair<Font, Glyphs>>;
+
+  // The glyphs of one paragraph layout. Batches are filled without any lock
+  // held and then recorded at once.
+  class Batch {
+   public:
+    // Adds glyphs laid out with |font|, whose typeface was found under
+    // |family_name|, and drawn with |paint|.
+    void Add(const std::string& family_name,
+             const SkFont& font,
+             const SkPaint& paint,
+             const uint16_t* glyphs,
+             size_t count);
+
+    bool empty() const { return fonts_.empty(); }
+
+   private:
+    friend class GlyphProfile;
+
+    std::map<Font, std::vector<uint16_t>> fonts_;
+  };
+
+  GlyphProfile();
+
+  ~GlyphProfile();
+
+  void SetRecording(bool recording);
+
+  bool IsRecording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  // Records the glyphs of |batch|.
+  void Record(const Batch& batch);
+
+  // Adds glyphs from a profile stored by an earlier run, so that they are not
+  // reported by |TakeChanged| again.
+  void Add(const Font& font, const Glyphs& glyphs);
+
+  // Returns all the glyphs of the fonts that were given new glyphs since the
+  // last call.
+  Entries TakeChanged();
+
+  // The luminance Skia computes for the color of |paint| when it looks up
+  // glyph masks.
+  static uint8_t LuminanceOf(const SkPaint& paint);
+
+  // Converts a font drawn at |device_scale| device pixels per logical pixel
+  // to and from the key it is stored under.
+  static std::string EncodeFont(const Font& font, float device_scale);
+  static bool DecodeFont(const void* data,
+                         size_t size,
+                         Font* font,
+                         float* device_scale);
+
+  static std::string EncodeGlyphs(const Glyphs& glyphs);
+  static bool DecodeGlyphs(const void* data, size_t size, Glyphs* glyphs);
+
+  // Rasterizes the glyphs of |entries| into Skia's process-wide glyph cache
+  // the way ParagraphTxt::Paint draws them under a transform that scales by
+  // |device_scale|, at every subpixel offset. Glyphs are drawn into a render
+  // target of |context| if there is one, so that they get the glyph masks of
+  // GPU surfaces, or into a raster surface otherwise. Fonts that
+  // |font_collection| cannot find are skipped. Returns the number of glyphs
+  // that were rasterized.
+  static size_t Prewarm(FontCollection& font_collection,
+                        const Entries& entries,
+                        float device_scale,
+                        GrDirectContext* context);
+
+  // The most fonts that are recorded, to keep the stored profile small.
+  static constexpr size_t kMaxFonts = 256;
+
+ private:
+  struct Usage {
+    // One bit per glyph ID.
+    std::vector<bool> glyphs;
+    bool changed = false;
+  };
+
+  std::atomic<bool> recording_ = false;
+  std::mutex mutex_;
+  std::map<Font, Usage> fonts_;
+
+  // Marks the glyphs as used. |mutex_| must be held.
+  void AddLocked(const Font& font,
+                 const uint16_t* glyphs,
+                 size_t count,
+                 bool changed);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(GlyphProfile);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_GLYPH_PROFILE_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hyphenation_patterns.h"
+
+#include "flutter/fml/file.h"
+#include "minikin/HyphenatorMap.h"
+
+namespace txt {
+namespace {
+
+class MappedPatternData : public minikin::HyphenatorMap::PatternData {
+ public:
+  explicit MappedPatternData(std::unique_ptr<fml::Mapping> mapping)
+      : mapping_(std::move(mapping)) {}
+
+  // |minikin::HyphenatorMap::PatternData|
+  const uint8_t* data() const override { return mapping_->GetMapping(); }
+
+  // |minikin::HyphenatorMap::PatternData|
+  size_t size() const override { return mapping_->GetSize(); }
+
+ private:
+  std::unique_ptr<fml::Mapping> mapping_;
+};
+
+}  // namespace
+
+void SetHyphenationPatternProvider(HyphenationPatternProvider provider) {
+  if (!provider) {
+    minikin::HyphenatorMap::setLoader(nullptr);
+    return;
+  }
+  minikin::HyphenatorMap::setLoader(
+      [provider = std::move(provider)](const std::string& tag)
+          -> std::unique_ptr<minikin::HyphenatorMap::PatternData> {
+        std::unique_ptr<fml::Mapping> mapping =
+            provider("hyph-" + tag + ".hyb");
+        if (mapping == nullptr || mapping->GetMapping() == nullptr) {
+          return nullptr;
+        }
+        return std::make_unique<MappedPatternData>(std::move(mapping));
+      });
+}
+
+HyphenationPatternProvider GetHyphenationPatternDirectory(
+    const std::string& directory) {
+  return [directory](
+             const std::string& file_name) -> std::unique_ptr<fml::Mapping> {
+    fml::UniqueFD directory_fd = fml::OpenDirectory(
+        directory.c_str(), false, fml::FilePermission::kRead);
+    if (!directory_fd.is_valid() ||
+        !fml::FileExists(directory_fd, file_name.c_str())) {
+      return nullptr;
+    }
+    return fml::FileMapping::CreateReadOnly(directory_fd, file_name);
+  };
+}
+
+}  // namespace txt
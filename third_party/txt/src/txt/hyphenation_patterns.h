@@ -0,0 +1,48 @@
+/*
+ * Copyright 2017 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+#define LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "flutter/fml/mapping.h"
+
+namespace txt {
+
+// Returns the contents of the named hyphenation pattern file, or null if
+// there is no such file.
+using HyphenationPatternProvider =
+    std::function<std::unique_ptr<fml::Mapping>(const std::string& file_name)>;
+
+// Makes the hyphenation patterns from |provider| available to the whole
+// process through minikin::HyphenatorMap, or stops providing patterns if
+// |provider| is empty.
+//
+// Pattern files are in minikin's hyb format and are named after the lowercase
+// BCP 47 tag of their language, as in "hyph-en-us.hyb" or "hyph-de.hyb". A
+// file is only requested the first time its language is hyphenated.
+void SetHyphenationPatternProvider(HyphenationPatternProvider provider);
+
+// Returns a provider that maps the pattern files in |directory| into memory.
+HyphenationPatternProvider GetHyphenationPatternDirectory(
+    const std::string& directory);
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
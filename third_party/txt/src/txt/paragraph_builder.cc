@@ -42,4 +42,12 @@ std::unique_ptr<ParagraphBuilder> ParagraphBuilder::CreateSkiaBuilder(
 
 #endif  // FLUTTER_ENABLE_SKSHAPER
 
+void ParagraphBuilder::AddText(size_t length,
+                               const std::function<bool(uint16_t*)>& write) {
+  std::u16string text(length, 0);
+  if (write(reinterpret_cast<uint16_t*>(text.data()))) {
+    AddText(text);
+  }
+}
+
 }  // namespace txt
@@ -17,6 +17,7 @@
 #ifndef LIB_TXT_SRC_PARAGRAPH_BUILDER_H_
 #define LIB_TXT_SRC_PARAGRAPH_BUILDER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -67,6 +68,12 @@ class ParagraphBuilder {
   // on the style_stack_;
   virtual void AddText(const std::u16string& text) = 0;
 
+  // Adds |length| UTF-16 code units that |write| copies into the buffer it is
+  // given, so that text that is not already in a std::u16string does not have
+  // to be copied into one first. Nothing is added if |write| returns false.
+  virtual void AddText(size_t length,
+                       const std::function<bool(uint16_t*)>& write);
+
   // Pushes the information required to leave an open space, where Flutter may
   // draw a custom placeholder into.
   //
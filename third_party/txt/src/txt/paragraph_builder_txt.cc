@@ -61,6 +61,18 @@ void ParagraphBuilderTxt::AddText(const std::u16string& text) {
   text_.insert(text_.end(), text.begin(), text.end());
 }
 
+void ParagraphBuilderTxt::AddText(
+    size_t length,
+    const std::function<bool(uint16_t*)>& write) {
+  // The text is written straight into the buffer that Build hands over to
+  // the paragraph.
+  size_t start = text_.size();
+  text_.resize(start + length);
+  if (!write(text_.data() + start)) {
+    text_.resize(start);
+  }
+}
+
 void ParagraphBuilderTxt::AddPlaceholder(PlaceholderRun& span) {
   obj_replacement_char_indexes_.insert(text_.size());
   runs_.StartRun(PeekStyleIndex(), text_.size());
@@ -36,6 +36,9 @@ class ParagraphBuilderTxt : public ParagraphBuilder {
   virtual void Pop() override;
   virtual const TextStyle& PeekStyle() override;
   virtual void AddText(const std::u16string& text) override;
+  virtual void AddText(
+      size_t length,
+      const std::function<bool(uint16_t*)>& write) override;
   virtual void AddPlaceholder(PlaceholderRun& span) override;
   virtual std::unique_ptr<Paragraph> Build() override;
 
@@ -23,6 +23,7 @@
 #include <cstring>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -30,12 +31,15 @@
 #include "flutter/fml/logging.h"
 #include "font_collection.h"
 #include "font_skia.h"
+#include "glyph_profile.h"
 #include "minikin/FontLanguageListCache.h"
 #include "minikin/GraphemeBreak.h"
 #include "minikin/HbFontCache.h"
+#include "minikin/HyphenatorMap.h"
 #include "minikin/LayoutUtils.h"
 #include "minikin/LineBreaker.h"
 #include "minikin/MinikinFont.h"
+#include "minikin/MinikinInternal.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkFont.h"
 #include "third_party/skia/include/core/SkFontMetrics.h"
@@ -51,6 +55,26 @@
 namespace txt {
 namespace {
 
+// The start of the Hebrew block. No code unit below it is a right to left or
+// bidi control character.
+constexpr uint16_t kFirstRtlCodeUnit = 0x0590;
+
+// Returns the hyphens to draw for a line given the flags the line breaker
+// broke it with. Breaks that do not add or replace any text are left out, so
+// that lines broken without hyphenation are laid out as before.
+uint32_t GetDrawnHyphenEdit(int flags) {
+  const minikin::HyphenEdit edit(flags);
+  uint32_t drawn = minikin::HyphenEdit::NO_EDIT;
+  if (minikin::HyphenEdit::isInsertion(edit.getStart())) {
+    drawn |= edit.getStart();
+  }
+  if (minikin::HyphenEdit::isInsertion(edit.getEnd()) ||
+      minikin::HyphenEdit::isReplacement(edit.getEnd())) {
+    drawn |= edit.getEnd();
+  }
+  return drawn;
+}
+
 class GlyphTypeface {
  public:
   GlyphTypeface(sk_sp<SkTypeface> typeface, minikin::FontFakery fakery)
@@ -191,21 +215,10 @@ void FindWords(const std::vector<uint16_t>& text,
 
 static const float kDoubleDecorationSpacing = 3.0f;
 
-ParagraphTxt::GlyphPosition::GlyphPosition(double x_start,
-                                           double x_advance,
-                                           size_t code_unit_index,
-                                           size_t code_unit_width)
-    : code_units(code_unit_index, code_unit_index + code_unit_width),
-      x_pos(x_start, x_start + x_advance) {}
-
-void ParagraphTxt::GlyphPosition::Shift(double delta) {
-  x_pos.Shift(delta);
-}
-
-ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu)
+ParagraphTxt::GlyphLine::GlyphLine(GlyphPositions&& p, size_t tcu)
     : positions(std::move(p)), total_code_units(tcu) {}
 
-ParagraphTxt::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
+ParagraphTxt::CodeUnitRun::CodeUnitRun(GlyphPositions&& p,
                                        Range<size_t> cu,
                                        Range<double> x,
                                        size_t line,
@@ -224,8 +237,7 @@ ParagraphTxt::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
 
 void ParagraphTxt::CodeUnitRun::Shift(double delta) {
   x_pos.Shift(delta);
-  for (GlyphPosition& position : positions)
-    position.Shift(delta);
+  positions.Shift(delta);
 }
 
 ParagraphTxt::ParagraphTxt() {
@@ -253,8 +265,23 @@ void ParagraphTxt::SetInlinePlaceholders(
 bool ParagraphTxt::ComputeLineBreaks() {
   line_metrics_.clear();
   line_widths_.clear();
+  line_hyphen_edits_.clear();
   max_intrinsic_width_ = 0;
 
+  // Words are hyphenated if patterns for the language of the paragraph were
+  // provided through SetHyphenationPatternProvider.
+  minikin::Hyphenator* hyphenator =
+      paragraph_style_.locale.empty()
+          ? nullptr
+          : minikin::HyphenatorMap::get(paragraph_style_.locale);
+  breaker_.setHyphenator(hyphenator,
+                         icu::Locale(paragraph_style_.locale.c_str()));
+
+  if (!measurements_valid_) {
+    measured_blocks_.clear();
+  }
+  size_t measured_block_index = 0;
+
   std::vector<size_t> newline_positions;
   // Discover and add all hard breaks.
   for (size_t i = 0; i < text_.size(); ++i) {
@@ -280,6 +307,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
       line_metrics_.emplace_back(block_start, block_end, block_end,
                                  block_end + 1, true);
       line_widths_.push_back(0);
+      line_hyphen_edits_.push_back(minikin::HyphenEdit::NO_EDIT);
       continue;
     }
 
@@ -294,6 +322,15 @@ bool ParagraphTxt::ComputeLineBreaks() {
            block_size * sizeof(text_[0]));
     breaker_.setText();
 
+    const MeasuredBlock* measured_block =
+        measurements_valid_ ? &measured_blocks_[measured_block_index++]
+                            : nullptr;
+    if (measured_block) {
+      FML_DCHECK(measured_block->char_widths.size() == block_size);
+      memcpy(breaker_.charWidths(), measured_block->char_widths.data(),
+             block_size * sizeof(float));
+    }
+
     // Add the runs that include this line to the LineBreaker.
     double block_total_width = 0;
     while (run_index < runs_.size()) {
@@ -316,6 +353,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
                               ? ""
                               : run.style.font_families[0])
                       << "\".";
+        measured_blocks_.clear();
         return false;
       }
       size_t run_start = std::max(run.start, block_start) - block_start;
@@ -342,6 +380,10 @@ bool ParagraphTxt::ComputeLineBreaks() {
         breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
                              isRtl);
         inline_placeholder_index++;
+      } else if (measured_block) {
+        // Is a regular text run that was measured by an earlier layout.
+        breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                     run_end, isRtl);
       } else {
         // Is a regular text run.
         double run_width = breaker_.addStyleRun(&paint, collection, font,
@@ -353,10 +395,19 @@ bool ParagraphTxt::ComputeLineBreaks() {
         break;
       run_index++;
     }
+    if (measured_block) {
+      block_total_width = measured_block->total_width;
+    } else {
+      measured_blocks_.push_back(
+          {std::vector<float>(breaker_.charWidths(),
+                              breaker_.charWidths() + block_size),
+           block_total_width});
+    }
     max_intrinsic_width_ = std::max(max_intrinsic_width_, block_total_width);
 
     size_t breaks_count = breaker_.computeBreaks();
     const int* breaks = breaker_.getBreaks();
+    const int* flags = breaker_.getFlags();
     for (size_t i = 0; i < breaks_count; ++i) {
       size_t break_start = (i > 0) ? breaks[i - 1] : 0;
       size_t line_start = break_start + block_start;
@@ -374,6 +425,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
                                  line_end_excluding_whitespace,
                                  line_end_including_newline, hard_break);
       line_widths_.push_back(breaker_.getWidths()[i]);
+      line_hyphen_edits_.push_back(GetDrawnHyphenEdit(flags[i]));
     }
 
     breaker_.finish();
@@ -386,6 +438,45 @@ bool ParagraphTxt::ComputeBidiRuns(std::vector<BidiRun>* result) {
   if (text_.empty())
     return true;
 
+  // Build a map of styled runs indexed by start position.
+  std::map<size_t, StyledRuns::Run> styled_run_map;
+  for (size_t i = 0; i < runs_.size(); ++i) {
+    StyledRuns::Run run = runs_.GetRun(i);
+    styled_run_map.emplace(std::make_pair(run.start, run));
+  }
+
+  // Breaks a bidi run into chunks based on text style.
+  auto add_bidi_run = [&](size_t bidi_run_start, size_t bidi_run_end,
+                          TextDirection text_direction) {
+    std::vector<BidiRun> chunks;
+    size_t chunk_start = bidi_run_start;
+    while (chunk_start < bidi_run_end) {
+      auto styled_run_iter = styled_run_map.upper_bound(chunk_start);
+      styled_run_iter--;
+      const StyledRuns::Run& styled_run = styled_run_iter->second;
+      size_t chunk_end = std::min(bidi_run_end, styled_run.end);
+      chunks.emplace_back(chunk_start, chunk_end, text_direction,
+                          styled_run.style);
+      chunk_start = chunk_end;
+    }
+
+    if (text_direction == TextDirection::ltr) {
+      result->insert(result->end(), chunks.begin(), chunks.end());
+    } else {
+      result->insert(result->end(), chunks.rbegin(), chunks.rend());
+    }
+  };
+
+  // Text without right to left or bidi control characters is a single left
+  // to right run in a left to right paragraph, which is what ubidi would find
+  // after going through all of it.
+  if (paragraph_style_.text_direction == TextDirection::ltr &&
+      std::all_of(text_.begin(), text_.end(),
+                  [](uint16_t c) { return c < kFirstRtlCodeUnit; })) {
+    add_bidi_run(0, text_.size(), TextDirection::ltr);
+    return true;
+  }
+
   auto ubidi_closer = [](UBiDi* b) { ubidi_close(b); };
   std::unique_ptr<UBiDi, decltype(ubidi_closer)> bidi(ubidi_open(),
                                                       ubidi_closer);
@@ -444,13 +535,6 @@ bool ParagraphTxt::ComputeBidiRuns(std::vector<BidiRun>* result) {
     }
   }
 
-  // Build a map of styled runs indexed by start position.
-  std::map<size_t, StyledRuns::Run> styled_run_map;
-  for (size_t i = 0; i < runs_.size(); ++i) {
-    StyledRuns::Run run = runs_.GetRun(i);
-    styled_run_map.emplace(std::make_pair(run.start, run));
-  }
-
   for (int32_t bidi_run_index = 0; bidi_run_index < bidi_run_count;
        ++bidi_run_index) {
     UBiDiDirection direction = ubidi_getVisualRun(
@@ -484,28 +568,9 @@ bool ParagraphTxt::ComputeBidiRuns(std::vector<BidiRun>* result) {
       bidi_run_length++;
     }
 
-    size_t bidi_run_end = bidi_run_start + bidi_run_length;
-    TextDirection text_direction =
-        direction == UBIDI_RTL ? TextDirection::rtl : TextDirection::ltr;
-
-    // Break this bidi run into chunks based on text style.
-    std::vector<BidiRun> chunks;
-    size_t chunk_start = bidi_run_start;
-    while (chunk_start < bidi_run_end) {
-      auto styled_run_iter = styled_run_map.upper_bound(chunk_start);
-      styled_run_iter--;
-      const StyledRuns::Run& styled_run = styled_run_iter->second;
-      size_t chunk_end = std::min(bidi_run_end, styled_run.end);
-      chunks.emplace_back(chunk_start, chunk_end, text_direction,
-                          styled_run.style);
-      chunk_start = chunk_end;
-    }
-
-    if (text_direction == TextDirection::ltr) {
-      result->insert(result->end(), chunks.begin(), chunks.end());
-    } else {
-      result->insert(result->end(), chunks.rbegin(), chunks.rend());
-    }
+    add_bidi_run(bidi_run_start, bidi_run_start + bidi_run_length,
+                 direction == UBIDI_RTL ? TextDirection::rtl
+                                        : TextDirection::ltr);
   }
 
   return true;
@@ -679,6 +744,11 @@ void ParagraphTxt::Layout(double width) {
 
   width_ = rounded_width;
 
+  // Changes to the text, styles or placeholders dirty the paragraph, and
+  // invalidate everything measured by the previous layout.
+  if (needs_layout_) {
+    measurements_valid_ = false;
+  }
   needs_layout_ = false;
 
   records_.clear();
@@ -692,9 +762,13 @@ void ParagraphTxt::Layout(double width) {
   if (!ComputeLineBreaks())
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
-    return;
+  if (!measurements_valid_) {
+    bidi_runs_.clear();
+    if (!ComputeBidiRuns(&bidi_runs_))
+      return;
+    measurements_valid_ = true;
+  }
+  const std::vector<BidiRun>& bidi_runs = bidi_runs_;
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -703,6 +777,11 @@ void ParagraphTxt::Layout(double width) {
 
   minikin::Layout layout;
   SkTextBlobBuilder builder;
+  // The glyphs of this layout are collected without holding the lock of the
+  // glyph profile and recorded once the layout is done.
+  GlyphProfile& glyph_profile = font_collection_->glyph_profile();
+  const bool record_glyphs = glyph_profile.IsRecording();
+  GlyphProfile::Batch glyph_batch;
   double y_offset = 0;
   double prev_max_descent = 0;
   double max_word_width = 0;
@@ -878,6 +957,19 @@ void ParagraphTxt::Layout(double width) {
         }
       }
 
+      // Draw the hyphens the line breaker chose to break the line with.
+      if (ellipsized_text.empty() && !run.is_ghost() &&
+          !run.is_placeholder_run()) {
+        uint32_t hyphen_edit = line_hyphen_edits_[line_number];
+        if (run.start() != line_metrics.start_index) {
+          hyphen_edit &= ~minikin::HyphenEdit::MASK_START_OF_LINE;
+        }
+        if (run.end() != line_end_index) {
+          hyphen_edit &= ~minikin::HyphenEdit::MASK_END_OF_LINE;
+        }
+        minikin_paint.hyphenEdit = hyphen_edit;
+      }
+
       layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
                       minikin_font, minikin_paint, minikin_font_collection);
 
@@ -1027,6 +1119,20 @@ void ParagraphTxt::Layout(double width) {
           }
         }  // for each in glyph_blob
 
+        if (record_glyphs && !run.is_placeholder_run()) {
+          const FontSkia* font_skia =
+              static_cast<const FontSkia*>(layout.getFont(glyph_blob.start));
+          SkPaint paint;
+          if (run.style().has_foreground) {
+            paint = run.style().foreground;
+          } else {
+            paint.setColor(run.style().color);
+          }
+          glyph_batch.Add(font_skia->GetFamilyName(), font, paint,
+                          blob_buffer.glyphs,
+                          glyph_blob.end - glyph_blob.start);
+        }
+
         if (glyph_positions.empty())
           continue;
 
@@ -1064,7 +1170,7 @@ void ParagraphTxt::Layout(double width) {
         double blob_x_pos_start = glyph_positions.front().x_pos.start;
         double blob_x_pos_end = glyph_positions.back().x_pos.end;
         line_code_unit_runs.emplace_back(
-            std::move(code_unit_positions),
+            GlyphPositions(code_unit_positions),
             Range<size_t>(run.start(), run.end()),
             Range<double>(blob_x_pos_start, blob_x_pos_end), line_number,
             *metrics, run.style(), run.direction(), run.placeholder_run());
@@ -1095,6 +1201,7 @@ void ParagraphTxt::Layout(double width) {
     }  // for each in line_runs
 
     // Adjust the glyph positions based on the alignment of the line.
+    GlyphPositions line_positions(line_glyph_positions);
     double line_x_offset = GetLineXOffset(run_x_offset, justify_line);
     if (line_x_offset) {
       for (CodeUnitRun& code_unit_run : line_code_unit_runs) {
@@ -1104,15 +1211,13 @@ void ParagraphTxt::Layout(double width) {
            line_inline_placeholder_code_unit_runs) {
         code_unit_run.Shift(line_x_offset);
       }
-      for (GlyphPosition& position : line_glyph_positions) {
-        position.Shift(line_x_offset);
-      }
+      line_positions.Shift(line_x_offset);
     }
 
     size_t next_line_start = (line_number < line_metrics_.size() - 1)
                                  ? line_metrics_[line_number + 1].start_index
                                  : text_.size();
-    glyph_lines_.emplace_back(std::move(line_glyph_positions),
+    glyph_lines_.emplace_back(std::move(line_positions),
                               next_line_start - line_metrics.start_index);
     code_unit_runs_.insert(code_unit_runs_.end(), line_code_unit_runs.begin(),
                            line_code_unit_runs.end());
@@ -1180,6 +1285,8 @@ void ParagraphTxt::Layout(double width) {
     }
   }  // for each line_number
 
+  glyph_profile.Record(glyph_batch);
+
   if (paragraph_style_.max_lines == 1 ||
       (paragraph_style_.unlimited_lines() && paragraph_style_.ellipsized())) {
     min_intrinsic_width_ = max_intrinsic_width_;
@@ -1392,6 +1499,8 @@ std::shared_ptr<minikin::FontCollection>
 ParagraphTxt::GetMinikinFontCollectionForStyle(const TextStyle& style) {
   std::string locale;
   if (!style.locale.empty()) {
+    // The language list cache is shared by every thread laying out text.
+    std::scoped_lock lock(minikin::gMinikinLock);
     uint32_t language_list_id =
         minikin::FontStyle::registerLanguageList(style.locale);
     const minikin::FontLanguages& langs =
@@ -1732,11 +1841,19 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
     } else {
       left = SK_ScalarMax;
       right = SK_ScalarMin;
-      for (const GlyphPosition& gp : run.positions) {
-        if (gp.code_units.start >= start && gp.code_units.end <= end) {
-          left = std::min(left, static_cast<SkScalar>(gp.x_pos.start));
-          right = std::max(right, static_cast<SkScalar>(gp.x_pos.end));
-        } else if (gp.code_units.end == end) {
+      // The positions are sorted by code unit index, so the ones within the
+      // range are found by binary search rather than by visiting each one.
+      Range<size_t> contained = run.positions.FindCodeUnits(start, end);
+      if (contained.width() > 0) {
+        Range<double> x_extent = run.positions.GetXExtent(contained);
+        left = x_extent.start;
+        right = x_extent.end;
+      }
+      if (contained.start > 0) {
+        // Only the position just before the contained ones can overlap the
+        // start of the range.
+        GlyphPosition gp = run.positions[contained.start - 1];
+        if (gp.code_units.end == end) {
           // Calculate left and right when we are at
           // the last position of a combining character.
           glyph_length = (gp.code_units.end - gp.code_units.start) - 1;
@@ -1903,8 +2020,7 @@ Paragraph::PositionWithAffinity ParagraphTxt::GetGlyphPositionAtCoordinate(
       break;
   }
 
-  const std::vector<GlyphPosition>& line_glyph_position =
-      glyph_lines_[y_index].positions;
+  const GlyphPositions& line_glyph_position = glyph_lines_[y_index].positions;
   if (line_glyph_position.empty()) {
     int line_start_index =
         std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
@@ -1914,38 +2030,25 @@ Paragraph::PositionWithAffinity ParagraphTxt::GetGlyphPositionAtCoordinate(
     return PositionWithAffinity(line_start_index, DOWNSTREAM);
   }
 
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (dx < glyph_end) {
-      gp = &line_glyph_position[x_index];
-      break;
-    }
-  }
-
-  if (gp == nullptr) {
-    gp = &line_glyph_position.back();
-  }
+  const GlyphPosition gp =
+      line_glyph_position[line_glyph_position.FindByX(dx)];
 
   // Find the direction of the run that contains this glyph.
   TextDirection direction = TextDirection::ltr;
   for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
+    if (gp.code_units.start >= run.code_units.start &&
+        gp.code_units.end <= run.code_units.end) {
       direction = run.direction;
       break;
     }
   }
 
-  double glyph_center = (gp->x_pos.start + gp->x_pos.end) / 2;
+  double glyph_center = (gp.x_pos.start + gp.x_pos.end) / 2;
   if ((direction == TextDirection::ltr && dx < glyph_center) ||
       (direction == TextDirection::rtl && dx >= glyph_center)) {
-    return PositionWithAffinity(gp->code_units.start, DOWNSTREAM);
+    return PositionWithAffinity(gp.code_units.start, DOWNSTREAM);
   } else {
-    return PositionWithAffinity(gp->code_units.end, UPSTREAM);
+    return PositionWithAffinity(gp.code_units.end, UPSTREAM);
   }
 }
 
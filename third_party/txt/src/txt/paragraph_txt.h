@@ -24,6 +24,7 @@
 #include "flutter/fml/compiler_specific.h"
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
+#include "glyph_positions.h"
 #include "line_metrics.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
@@ -71,6 +72,10 @@ class ParagraphTxt : public Paragraph {
   // number of characters. However, this is not significant for reasonably sized
   // paragraphs. It is currently recommended to break up very long paragraphs
   // (10k+ characters) to ensure speedy layout.
+  //
+  // When only the width changed since the previous call, the measured widths
+  // of the text and its bidi runs are reused and only the line breaks and
+  // positions are recomputed.
   virtual void Layout(double width) override;
 
   virtual void Paint(SkCanvas* canvas, double x, double y) override;
@@ -153,6 +158,7 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST_LINUX_ONLY(ParagraphTest, EmojiMultiLineRectsParagraph);
   FRIEND_TEST(ParagraphTest, HyphenBreakParagraph);
   FRIEND_TEST(ParagraphTest, RepeatLayoutParagraph);
+  FRIEND_TEST(ParagraphTest, WidthOnlyRelayoutReusesMeasurements);
   FRIEND_TEST(ParagraphTest, Ellipsize);
   FRIEND_TEST(ParagraphTest, UnderlineShiftParagraph);
   FRIEND_TEST(ParagraphTest, WavyDecorationParagraph);
@@ -164,6 +170,7 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, AddTextInPlace);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -189,6 +196,8 @@ class ParagraphTxt : public Paragraph {
   std::vector<LineMetrics> line_metrics_;
   size_t final_line_count_;
   std::vector<double> line_widths_;
+  // The minikin::HyphenEdit the line breaker chose for each line.
+  std::vector<uint32_t> line_hyphen_edits_;
 
   // Stores the result of Layout().
   std::vector<PaintRecord> records_;
@@ -257,29 +266,17 @@ class ParagraphTxt : public Paragraph {
     PlaceholderRun* placeholder_run_ = nullptr;
   };
 
-  struct GlyphPosition {
-    Range<size_t> code_units;
-    Range<double> x_pos;
-
-    GlyphPosition(double x_start,
-                  double x_advance,
-                  size_t code_unit_index,
-                  size_t code_unit_width);
-
-    void Shift(double delta);
-  };
-
   struct GlyphLine {
     // Glyph positions sorted by x coordinate.
-    const std::vector<GlyphPosition> positions;
+    const GlyphPositions positions;
     const size_t total_code_units;
 
-    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu);
+    GlyphLine(GlyphPositions&& p, size_t tcu);
   };
 
   struct CodeUnitRun {
     // Glyph positions sorted by code unit index.
-    std::vector<GlyphPosition> positions;
+    GlyphPositions positions;
     Range<size_t> code_units;
     Range<double> x_pos;
     size_t line_number;
@@ -288,7 +285,7 @@ class ParagraphTxt : public Paragraph {
     TextDirection direction;
     const PlaceholderRun* placeholder_run;
 
-    CodeUnitRun(std::vector<GlyphPosition>&& p,
+    CodeUnitRun(GlyphPositions&& p,
                 Range<size_t> cu,
                 Range<double> x,
                 size_t line,
@@ -320,6 +317,18 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  // The width independent results of the most recent Layout(), which are
+  // kept until the paragraph is changed so a relayout at another width
+  // doesn't need to measure the text again.
+  struct MeasuredBlock {
+    // The advance of each code unit between two hard breaks.
+    std::vector<float> char_widths;
+    double total_width;
+  };
+  std::vector<MeasuredBlock> measured_blocks_;
+  std::vector<BidiRun> bidi_runs_;
+  bool measurements_valid_ = false;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "minikin/AdvanceTable.h"
+#include "minikin/FontCollection.h"
+#include "minikin/Layout.h"
+#include "txt_test_utils.h"
+
+namespace minikin {
+
+class AdvanceTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mPaint.size = 14;
+    mPaint.scaleX = 1;
+  }
+
+  void TearDown() override { Layout::setAdvanceTablesEnabled(true); }
+
+  static std::shared_ptr<FontCollection> GetCollection(
+      const std::string& family) {
+    return txt::GetTestFontCollection()->GetMinikinFontCollectionForFamilies(
+        {family}, "en-US");
+  }
+
+  // Lays out and measures |count| characters of |text| from |start|, with
+  // the advance tables on and off, and expects the same results.
+  void ExpectSameLayout(const std::u16string& text,
+                        size_t start,
+                        size_t count,
+                        const std::shared_ptr<FontCollection>& collection) {
+    const uint16_t* buf = reinterpret_cast<const uint16_t*>(text.data());
+    Layout layouts[2];
+    std::vector<float> advances[2];
+    float widths[2];
+    for (int enabled = 0; enabled < 2; enabled++) {
+      Layout::setAdvanceTablesEnabled(enabled);
+      layouts[enabled].doLayout(buf, start, count, text.size(), false,
+                                FontStyle(), mPaint, collection);
+      advances[enabled].resize(count);
+      widths[enabled] =
+          Layout::measureText(buf, start, count, text.size(), false,
+                              FontStyle(), mPaint, collection,
+                              advances[enabled].data());
+    }
+
+    const Layout& shaped = layouts[0];
+    const Layout& table = layouts[1];
+    ASSERT_EQ(shaped.nGlyphs(), table.nGlyphs());
+    for (size_t i = 0; i < shaped.nGlyphs(); i++) {
+      EXPECT_EQ(shaped.getFont(i), table.getFont(i));
+      EXPECT_EQ(shaped.getGlyphId(i), table.getGlyphId(i));
+      EXPECT_EQ(shaped.getGlyphCluster(i), table.getGlyphCluster(i));
+      EXPECT_EQ(shaped.getX(i), table.getX(i));
+      EXPECT_EQ(shaped.getY(i), table.getY(i));
+    }
+    EXPECT_EQ(shaped.getAdvance(), table.getAdvance());
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(shaped.getCharAdvance(i), table.getCharAdvance(i));
+    }
+    MinikinRect shapedBounds, tableBounds;
+    shaped.getBounds(&shapedBounds);
+    table.getBounds(&tableBounds);
+    EXPECT_EQ(shapedBounds.mLeft, tableBounds.mLeft);
+    EXPECT_EQ(shapedBounds.mTop, tableBounds.mTop);
+    EXPECT_EQ(shapedBounds.mRight, tableBounds.mRight);
+    EXPECT_EQ(shapedBounds.mBottom, tableBounds.mBottom);
+
+    EXPECT_EQ(widths[0], widths[1]);
+    EXPECT_EQ(advances[0], advances[1]);
+  }
+
+  MinikinPaint mPaint;
+};
+
+TEST_F(AdvanceTableTest, SimpleText) {
+  EXPECT_TRUE(AdvanceTable::isSimpleChar(u' '));
+  EXPECT_TRUE(AdvanceTable::isSimpleChar(u'~'));
+  EXPECT_TRUE(AdvanceTable::isSimpleChar(u'\u00e9'));
+  EXPECT_TRUE(AdvanceTable::isSimpleChar(u'\u017f'));
+  EXPECT_FALSE(AdvanceTable::isSimpleChar(u'\t'));
+  EXPECT_FALSE(AdvanceTable::isSimpleChar(u'\u007f'));
+  EXPECT_FALSE(AdvanceTable::isSimpleChar(u'\u00ad'));
+  EXPECT_FALSE(AdvanceTable::isSimpleChar(u'\u0301'));
+  EXPECT_FALSE(AdvanceTable::isSimpleChar(u'\u05d0'));
+}
+
+TEST_F(AdvanceTableTest, LaysOutTextLikeShaping) {
+  std::shared_ptr<FontCollection> collection = GetCollection("Ahem");
+  const std::u16string text = u"Hello, world. Ça va? Very naïve text.";
+  ExpectSameLayout(text, 0, text.size(), collection);
+  // Runs that start and end inside words.
+  ExpectSameLayout(text, 3, 12, collection);
+
+  mPaint.size = 17.5;
+  mPaint.wordSpacing = 3;
+  ExpectSameLayout(text, 0, text.size(), collection);
+
+  mPaint.paintFlags = LinearTextFlag;
+  ExpectSameLayout(text, 2, text.size() - 2, collection);
+}
+
+TEST_F(AdvanceTableTest, OnlyFontsWithoutLayoutTablesSkipShaping) {
+  const std::u16string text = u"Uncached words in Latin text";
+  const uint16_t* buf = reinterpret_cast<const uint16_t*>(text.data());
+  Layout::purgeCaches();
+
+  // Ahem has no OpenType layout tables, so the layout cache is not used.
+  Layout layout;
+  LayoutCacheStats before = Layout::getCacheStats();
+  layout.doLayout(buf, 0, text.size(), text.size(), false, FontStyle(), mPaint,
+                  GetCollection("Ahem"));
+  LayoutCacheStats after = Layout::getCacheStats();
+  EXPECT_EQ(after.hits + after.misses, before.hits + before.misses);
+  EXPECT_EQ(layout.nGlyphs(), text.size());
+
+  // Roboto kerns with GPOS, so its words are shaped.
+  layout.doLayout(buf, 0, text.size(), text.size(), false, FontStyle(), mPaint,
+                  GetCollection("Roboto"));
+  after = Layout::getCacheStats();
+  EXPECT_GT(after.misses, before.misses);
+  ExpectSameLayout(text, 0, text.size(), GetCollection("Roboto"));
+
+  // Letter spacing is applied by shaping.
+  before = after;
+  mPaint.letterSpacing = 0.1;
+  layout.doLayout(buf, 0, text.size(), text.size(), false, FontStyle(), mPaint,
+                  GetCollection("Ahem"));
+  after = Layout::getCacheStats();
+  EXPECT_GT(after.misses, before.misses);
+}
+
+}  // namespace minikin
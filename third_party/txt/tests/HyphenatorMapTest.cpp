@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "minikin/HyphenatorMap.h"
+#include "txt_test_utils.h"
+
+namespace minikin {
+
+class TestPatternData : public HyphenatorMap::PatternData {
+ public:
+  explicit TestPatternData(std::vector<uint32_t> words)
+      : mWords(std::move(words)) {}
+
+  const uint8_t* data() const override {
+    return reinterpret_cast<const uint8_t*>(mWords.data());
+  }
+  size_t size() const override { return mWords.size() * sizeof(uint32_t); }
+
+ private:
+  std::vector<uint32_t> mWords;
+};
+
+static Hyphenator* LoadWords(const std::vector<uint32_t>& words,
+                             size_t size) {
+  return Hyphenator::loadBinary(
+      reinterpret_cast<const uint8_t*>(words.data()), size, 2, 2);
+}
+
+TEST(HyphenatorMapTest, LoadBinaryChecksTheFormat) {
+  std::vector<uint32_t> words = txt::GetTestHyphenationPatterns();
+  const size_t size = words.size() * sizeof(uint32_t);
+  std::unique_ptr<Hyphenator> hyphenator(LoadWords(words, size));
+  ASSERT_NE(hyphenator, nullptr);
+  const uint16_t word[] = {'a', 'b', 'c', 'd', 'e'};
+  std::vector<HyphenationType> result;
+  hyphenator->hyphenate(&result, word, 5, icu::Locale::getUS());
+  std::vector<HyphenationType> expected(5);
+  expected[2] = HyphenationType::BREAK_AND_INSERT_HYPHEN;
+  EXPECT_EQ(result, expected);
+
+  EXPECT_EQ(LoadWords(words, size - 4), nullptr);
+
+  std::vector<uint32_t> bad = words;
+  bad[0] = 0;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  bad = words;
+  bad[1] = 1;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  bad = words;
+  bad[3] = size;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // A trie that claims more entries than the file holds.
+  bad = words;
+  bad[64 / 4 + 5] = 1000;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+}
+
+TEST(HyphenatorMapTest, LoadBinaryChecksTheTrieAndPatternIndices) {
+  const std::vector<uint32_t> words = txt::GetTestHyphenationPatterns();
+  const size_t size = words.size() * sizeof(uint32_t);
+  // The indices of the entries of the trie and pattern tables.
+  const size_t trie = words[3] / 4 + 6;
+  const uint32_t trieEntries = words[words[3] / 4 + 5];
+  const size_t pattern = words[4] / 4 + 4;
+  const uint32_t c = 3;
+  ASSERT_EQ(words[trie + c], c | (32 << 5));
+  ASSERT_EQ(words[trie + 32], 1u << 16);
+  std::unique_ptr<Hyphenator> hyphenator(LoadWords(words, size));
+  ASSERT_NE(hyphenator, nullptr);
+
+  // A link to a node whose children lie past the end of the trie.
+  std::vector<uint32_t> bad = words;
+  bad[trie + c] = c | ((trieEntries - 26) << 5);
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // A link in an entry that no word reaches is checked too.
+  bad = words;
+  bad[trie + trieEntries - 1] = 0xffe0;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // A node with a pattern index past the end of the pattern table.
+  bad = words;
+  bad[trie + 32] = 2 << 16;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // A pattern that runs past the end of the pattern buffer.
+  bad = words;
+  bad[pattern + 1] = (2 << 26) | (1 << 20);
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // A pattern offset past the end of the pattern buffer.
+  bad = words;
+  bad[pattern + 1] = (1 << 26) | (1 << 20) | 1;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+
+  // Shifts that do not fit an entry.
+  bad = words;
+  bad[words[3] / 4 + 2] = 32;
+  EXPECT_EQ(LoadWords(bad, size), nullptr);
+}
+
+TEST(HyphenatorMapTest, LoadsPatternsWhenFirstNeeded) {
+  std::vector<std::string> requested;
+  HyphenatorMap::setLoader([&requested](const std::string& tag)
+                               -> std::unique_ptr<HyphenatorMap::PatternData> {
+    requested.push_back(tag);
+    if (tag == "en" || tag == "de") {
+      return std::make_unique<TestPatternData>(
+          txt::GetTestHyphenationPatterns());
+    }
+    return nullptr;
+  });
+  EXPECT_TRUE(requested.empty());
+
+  Hyphenator* english = HyphenatorMap::get("en_US");
+  EXPECT_NE(english, nullptr);
+  EXPECT_EQ(requested, (std::vector<std::string>{"en-us", "en"}));
+
+  // Hyphenators and missing languages are both remembered.
+  EXPECT_EQ(HyphenatorMap::get("en-US"), english);
+  EXPECT_EQ(HyphenatorMap::get("fr"), nullptr);
+  EXPECT_EQ(HyphenatorMap::get("fr"), nullptr);
+  EXPECT_EQ(requested, (std::vector<std::string>{"en-us", "en", "fr"}));
+
+  EXPECT_NE(HyphenatorMap::get("DE"), nullptr);
+  EXPECT_NE(HyphenatorMap::get("de"), english);
+
+  // A new loader is only asked for the tags that had no patterns.
+  requested.clear();
+  HyphenatorMap::setLoader([&requested](const std::string& tag) {
+    requested.push_back(tag);
+    return std::unique_ptr<HyphenatorMap::PatternData>();
+  });
+  EXPECT_EQ(HyphenatorMap::get("en-US"), english);
+  EXPECT_EQ(HyphenatorMap::get("fr"), nullptr);
+  EXPECT_EQ(requested, (std::vector<std::string>{"en-us", "fr"}));
+
+  HyphenatorMap::setLoader(nullptr);
+}
+
+}  // namespace minikin
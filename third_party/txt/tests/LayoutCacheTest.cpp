@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "minikin/LayoutCache.h"
+
+namespace minikin {
+
+static LayoutCacheKey MakeKey(const std::u16string& text,
+                              uint32_t collectionId = 1) {
+  return LayoutCacheKey(collectionId, MinikinPaint(), FontStyle(),
+                        reinterpret_cast<const uint16_t*>(text.data()), 0,
+                        text.size(), text.size(), false);
+}
+
+TEST(LayoutCacheTest, MissThenHit) {
+  LayoutCache cache;
+  const std::u16string text = u"hello";
+
+  EXPECT_EQ(cache.get(MakeKey(text)), nullptr);
+  auto layout = cache.put(MakeKey(text), std::make_unique<Layout>());
+  ASSERT_NE(layout, nullptr);
+  EXPECT_EQ(cache.get(MakeKey(text)), layout);
+  EXPECT_EQ(cache.get(MakeKey(text, 2)), nullptr);
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_GT(stats.bytes, 0u);
+}
+
+TEST(LayoutCacheTest, KeysOwnTheirText) {
+  LayoutCache cache;
+  std::u16string text = u"hello";
+  auto layout = cache.put(MakeKey(text), std::make_unique<Layout>());
+
+  // The cached key must not refer to the caller's buffer.
+  text[0] = u'j';
+  EXPECT_EQ(cache.get(MakeKey(text)), nullptr);
+  EXPECT_EQ(cache.get(MakeKey(u"hello")), layout);
+}
+
+TEST(LayoutCacheTest, PutKeepsTheFirstLayout) {
+  LayoutCache cache;
+  auto first = cache.put(MakeKey(u"word"), std::make_unique<Layout>());
+  auto second = cache.put(MakeKey(u"word"), std::make_unique<Layout>());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(cache.getStats().entries, 1u);
+}
+
+TEST(LayoutCacheTest, StaysWithinByteBudget) {
+  const size_t maxBytes = 64 * 1024;
+  LayoutCache cache(maxBytes);
+  for (int i = 0; i < 10000; i++) {
+    cache.put(MakeKey(u"word" + std::u16string(1, u'a' + i % 26), i),
+              std::make_unique<Layout>());
+  }
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_LE(stats.bytes, maxBytes);
+  EXPECT_GT(stats.entries, 0u);
+  EXPECT_EQ(stats.entries + stats.evictions, 10000u);
+
+  cache.setMaxBytes(0);
+  stats = cache.getStats();
+  EXPECT_EQ(stats.entries, 0u);
+  EXPECT_EQ(stats.bytes, 0u);
+  EXPECT_EQ(stats.maxBytes, 0u);
+}
+
+TEST(LayoutCacheTest, LayoutsOutliveClear) {
+  LayoutCache cache;
+  auto layout = cache.put(MakeKey(u"word"), std::make_unique<Layout>());
+  cache.clear();
+
+  EXPECT_EQ(cache.getStats().entries, 0u);
+  EXPECT_EQ(cache.get(MakeKey(u"word")), nullptr);
+  EXPECT_EQ(layout->nGlyphs(), 0u);
+}
+
+TEST(LayoutCacheTest, ConcurrentLookups) {
+  LayoutCache cache;
+  const int kThreads = 4;
+  const int kLookups = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&cache]() {
+      const std::u16string text = u"word";
+      for (int i = 0; i < kLookups; i++) {
+        LayoutCacheKey key = MakeKey(text, i % 100);
+        if (!cache.get(key)) {
+          cache.put(key, std::make_unique<Layout>());
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_EQ(stats.hits + stats.misses,
+            static_cast<uint64_t>(kThreads * kLookups));
+  EXPECT_EQ(stats.entries, 100u);
+  EXPECT_GE(stats.misses, 100u);
+}
+
+}  // namespace minikin
@@ -14,8 +14,13 @@
  * limitations under the License.
  */
 
+#include <map>
+#include <string>
+
 #include "flutter/fml/logging.h"
 #include "gtest/gtest.h"
+#include "minikin/Layout.h"
+#include "minikin/LayoutCache.h"
 #include "third_party/skia/include/utils/SkCustomTypeface.h"
 #include "txt/font_collection.h"
 #include "txt_test_utils.h"
@@ -138,6 +143,74 @@ TEST(FontCollectionTest, CheckSkTypefacesSorting) {
             SkFontStyle::kExpanded_Width);
 }
 
+namespace {
+// A cache store that keeps its entries in memory.
+class FakeLayoutCacheStore : public minikin::LayoutCacheStore {
+ public:
+  bool load(const std::string& key, std::string* value) override {
+    auto found = entries.find(key);
+    if (found == entries.end()) {
+      return false;
+    }
+    load_hits++;
+    *value = found->second;
+    return true;
+  }
+
+  void store(const std::string& key, const std::string& value) override {
+    entries[key] = value;
+  }
+
+  std::map<std::string, std::string> entries;
+  size_t load_hits = 0;
+};
+}  // namespace
+
+TEST(FontCollectionTest, ShapedWordsAreReadBackFromTheCacheStore) {
+  std::shared_ptr<minikin::FontCollection> collection =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamilies({"Roboto"},
+                                                                   "en-US");
+  ASSERT_TRUE(collection);
+  auto store = std::make_shared<FakeLayoutCacheStore>();
+  minikin::Layout::setCacheStore(store);
+  minikin::Layout::purgeCaches();
+
+  const std::u16string text = u"Settings and more";
+  minikin::MinikinPaint paint;
+  paint.size = 20;
+  auto layout_text = [&](minikin::Layout* layout) {
+    layout->doLayout(reinterpret_cast<const uint16_t*>(text.data()), 0,
+                     text.size(), text.size(), false, minikin::FontStyle(),
+                     paint, collection);
+  };
+
+  minikin::Layout shaped;
+  layout_text(&shaped);
+  EXPECT_FALSE(store->entries.empty());
+  EXPECT_EQ(store->load_hits, 0u);
+
+  // With the in-memory cache gone, the words come from the store.
+  minikin::Layout::purgeCaches();
+  minikin::Layout loaded;
+  layout_text(&loaded);
+  EXPECT_EQ(store->load_hits, store->entries.size());
+
+  ASSERT_EQ(loaded.nGlyphs(), shaped.nGlyphs());
+  EXPECT_EQ(loaded.getAdvance(), shaped.getAdvance());
+  for (size_t i = 0; i < shaped.nGlyphs(); i++) {
+    EXPECT_EQ(loaded.getFont(i), shaped.getFont(i));
+    EXPECT_EQ(loaded.getGlyphId(i), shaped.getGlyphId(i));
+    EXPECT_EQ(loaded.getX(i), shaped.getX(i));
+    EXPECT_EQ(loaded.getGlyphCluster(i), shaped.getGlyphCluster(i));
+  }
+  for (size_t i = 0; i < text.size(); i++) {
+    EXPECT_EQ(loaded.getCharAdvance(i), shaped.getCharAdvance(i));
+  }
+
+  minikin::Layout::setCacheStore(nullptr);
+  minikin::Layout::purgeCaches();
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
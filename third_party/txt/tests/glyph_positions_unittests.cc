@@ -0,0 +1,101 @@
+/*
+ * Copyright 2017 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "txt/glyph_positions.h"
+
+namespace txt {
+
+namespace {
+// Returns |count| positions of the given advance, one code unit each, laid
+// out from x = 0.
+GlyphPositions MakeLine(size_t count, double advance) {
+  std::vector<GlyphPosition> positions;
+  for (size_t i = 0; i < count; i++) {
+    positions.emplace_back(i * advance, advance, i, 1);
+  }
+  return GlyphPositions(positions);
+}
+}  // namespace
+
+TEST(GlyphPositionsTest, StoresPositions) {
+  std::vector<GlyphPosition> positions;
+  positions.emplace_back(1.5, 2.0, 3, 2);
+  positions.emplace_back(3.5, 4.0, 5, 1);
+  GlyphPositions stored(positions);
+
+  ASSERT_EQ(stored.size(), 2u);
+  EXPECT_EQ(stored[0].code_units.start, 3u);
+  EXPECT_EQ(stored[0].code_units.end, 5u);
+  EXPECT_EQ(stored[0].x_pos.start, 1.5);
+  EXPECT_EQ(stored[0].x_pos.end, 3.5);
+  EXPECT_EQ(stored.back().code_units.start, 5u);
+  EXPECT_EQ(stored.back().x_pos.end, 7.5);
+  EXPECT_TRUE(GlyphPositions().empty());
+}
+
+TEST(GlyphPositionsTest, ShiftMovesEveryPosition) {
+  // An odd count also covers the elements left over by the vector loop.
+  for (size_t count : {1u, 2u, 7u}) {
+    GlyphPositions line = MakeLine(count, 10);
+    line.Shift(2.5);
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(line[i].x_pos.start, i * 10 + 2.5);
+      EXPECT_EQ(line[i].x_pos.end, i * 10 + 12.5);
+      EXPECT_EQ(line[i].code_units.start, i);
+    }
+  }
+}
+
+TEST(GlyphPositionsTest, FindByX) {
+  GlyphPositions line = MakeLine(7, 10);
+  EXPECT_EQ(line.FindByX(-5), 0u);
+  EXPECT_EQ(line.FindByX(0), 0u);
+  EXPECT_EQ(line.FindByX(9.9), 0u);
+  EXPECT_EQ(line.FindByX(10), 1u);
+  EXPECT_EQ(line.FindByX(35), 3u);
+  EXPECT_EQ(line.FindByX(59.9), 5u);
+  EXPECT_EQ(line.FindByX(60), 6u);
+  EXPECT_EQ(line.FindByX(1000), 6u);
+
+  EXPECT_EQ(MakeLine(1, 10).FindByX(50), 0u);
+}
+
+TEST(GlyphPositionsTest, FindCodeUnitsAndExtent) {
+  std::vector<GlyphPosition> positions;
+  positions.emplace_back(0, 10, 0, 1);
+  positions.emplace_back(10, 10, 1, 2);
+  positions.emplace_back(20, 10, 3, 1);
+  positions.emplace_back(30, 10, 4, 1);
+  positions.emplace_back(40, 10, 5, 1);
+  GlyphPositions run(positions);
+
+  Paragraph::Range<size_t> found = run.FindCodeUnits(1, 4);
+  EXPECT_EQ(found, Paragraph::Range<size_t>(1, 3));
+  EXPECT_EQ(run.GetXExtent(found), Paragraph::Range<double>(10, 30));
+
+  // The position covering code units 1 and 2 is only partly in the range.
+  EXPECT_EQ(run.FindCodeUnits(2, 6), Paragraph::Range<size_t>(2, 5));
+  EXPECT_EQ(run.FindCodeUnits(0, 2).width(), 1u);
+  EXPECT_EQ(run.FindCodeUnits(2, 3).width(), 0u);
+  EXPECT_EQ(run.FindCodeUnits(0, 6), Paragraph::Range<size_t>(0, 5));
+  EXPECT_EQ(run.GetXExtent(Paragraph::Range<size_t>(0, 5)),
+            Paragraph::Range<double>(0, 50));
+}
+
+}  // namespace txt
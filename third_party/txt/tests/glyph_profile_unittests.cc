@@ -0,0 +1,195 @@
+/*
+ * Copyright 2017 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkGraphics.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "txt/font_collection.h"
+#include "txt/glyph_profile.h"
+#include "txt_test_utils.h"
+
+namespace txt {
+
+namespace {
+
+std::unique_ptr<ParagraphTxt> BuildRobotoParagraph(
+    const std::shared_ptr<FontCollection>& font_collection) {
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 14;
+  builder.PushStyle(text_style);
+  builder.AddText(u"abc");
+  builder.Pop();
+  return BuildParagraph(builder);
+}
+
+// Paints |paragraph| the way the engine draws text at a device pixel ratio
+// of |device_scale|.
+void PaintScaled(ParagraphTxt& paragraph, float device_scale) {
+  SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+  sk_sp<SkSurface> surface = SkSurface::MakeRaster(
+      SkImageInfo::MakeN32Premul(200, 100), &props);
+  surface->getCanvas()->scale(device_scale, device_scale);
+  paragraph.Paint(surface->getCanvas(), 0, 0);
+}
+
+}  // namespace
+
+TEST(GlyphProfileTest, EncodesFonts) {
+  GlyphProfile::Font font;
+  font.family_name = "Roboto";
+  font.style = SkFontStyle::Bold();
+  font.size = 28;
+  font.fake_italic = true;
+  font.luminance = 0x80;
+
+  std::string key = GlyphProfile::EncodeFont(font, 2.5f);
+  GlyphProfile::Font decoded;
+  float device_scale = 0;
+  ASSERT_TRUE(GlyphProfile::DecodeFont(key.data(), key.size(), &decoded,
+                                       &device_scale));
+  EXPECT_EQ(decoded.family_name, "Roboto");
+  EXPECT_EQ(decoded.style, SkFontStyle::Bold());
+  EXPECT_EQ(decoded.size, 28);
+  EXPECT_FALSE(decoded.fake_bold);
+  EXPECT_TRUE(decoded.fake_italic);
+  EXPECT_EQ(decoded.luminance, 0x80);
+  EXPECT_EQ(device_scale, 2.5f);
+
+  EXPECT_FALSE(
+      GlyphProfile::DecodeFont(key.data(), 3, &decoded, &device_scale));
+
+  GlyphProfile::Glyphs glyphs = {1, 5, 300};
+  std::string value = GlyphProfile::EncodeGlyphs(glyphs);
+  GlyphProfile::Glyphs decoded_glyphs;
+  ASSERT_TRUE(
+      GlyphProfile::DecodeGlyphs(value.data(), value.size(), &decoded_glyphs));
+  EXPECT_EQ(decoded_glyphs, glyphs);
+  EXPECT_FALSE(GlyphProfile::DecodeGlyphs(value.data(), 3, &decoded_glyphs));
+}
+
+TEST(GlyphProfileTest, ReportsEachNewGlyphOnce) {
+  GlyphProfile profile;
+  SkFont font(nullptr, 10);
+  SkPaint paint;
+  paint.setColor(SK_ColorWHITE);
+  const uint16_t glyphs[] = {3, 1, 3};
+
+  GlyphProfile::Batch batch;
+  batch.Add("Roboto", font, paint, glyphs, 3);
+  profile.Record(batch);
+  GlyphProfile::Entries changed = profile.TakeChanged();
+  ASSERT_EQ(changed.size(), 1u);
+  GlyphProfile::Font recorded = changed[0].first;
+  EXPECT_EQ(recorded.family_name, "Roboto");
+  EXPECT_EQ(recorded.size, 10);
+  EXPECT_EQ(recorded.luminance, 0xFF);
+  EXPECT_EQ(changed[0].second, (GlyphProfile::Glyphs{1, 3}));
+  EXPECT_TRUE(profile.TakeChanged().empty());
+
+  // The same glyphs in another color are cached separately by Skia.
+  GlyphProfile::Batch black_batch;
+  black_batch.Add("Roboto", font, SkPaint(), glyphs, 1);
+  profile.Record(black_batch);
+  changed = profile.TakeChanged();
+  ASSERT_EQ(changed.size(), 1u);
+  EXPECT_EQ(changed[0].first.luminance, 0);
+
+  // Glyphs from a stored profile are known but not reported.
+  profile.Add(recorded, {5});
+  const uint16_t stored_glyph = 5;
+  GlyphProfile::Batch stored_batch;
+  stored_batch.Add("Roboto", font, paint, glyphs, 3);
+  stored_batch.Add("Roboto", font, paint, &stored_glyph, 1);
+  profile.Record(stored_batch);
+  EXPECT_TRUE(profile.TakeChanged().empty());
+
+  // A new glyph reports all the glyphs of its font.
+  const uint16_t new_glyph = 7;
+  GlyphProfile::Batch new_batch;
+  new_batch.Add("Roboto", font, paint, &new_glyph, 1);
+  profile.Record(new_batch);
+  changed = profile.TakeChanged();
+  ASSERT_EQ(changed.size(), 1u);
+  EXPECT_EQ(changed[0].second, (GlyphProfile::Glyphs{1, 3, 5, 7}));
+}
+
+TEST(GlyphProfileTest, RecordsParagraphLayout) {
+  std::shared_ptr<FontCollection> font_collection = GetTestFontCollection();
+  GlyphProfile& profile = font_collection->glyph_profile();
+
+  // Nothing is recorded until recording is turned on.
+  auto paragraph = BuildRobotoParagraph(font_collection);
+  paragraph->Layout(500);
+  EXPECT_TRUE(profile.TakeChanged().empty());
+
+  profile.SetRecording(true);
+  paragraph = BuildRobotoParagraph(font_collection);
+  paragraph->Layout(500);
+
+  GlyphProfile::Entries changed = profile.TakeChanged();
+  ASSERT_EQ(changed.size(), 1u);
+  EXPECT_EQ(changed[0].first.family_name, "Roboto");
+  EXPECT_EQ(changed[0].first.size, 14);
+  EXPECT_EQ(changed[0].second.size(), 3u);
+
+  // Laying the paragraph out again finds no new glyphs.
+  paragraph->Layout(400);
+  EXPECT_TRUE(profile.TakeChanged().empty());
+
+  // Other collections have profiles of their own.
+  EXPECT_FALSE(GetTestFontCollection()->glyph_profile().IsRecording());
+}
+
+TEST(GlyphProfileTest, PrewarmFillsTheStrikesParagraphsDrawWith) {
+  std::shared_ptr<FontCollection> font_collection = GetTestFontCollection();
+  GlyphProfile& profile = font_collection->glyph_profile();
+  profile.SetRecording(true);
+  auto paragraph = BuildRobotoParagraph(font_collection);
+  paragraph->Layout(500);
+  GlyphProfile::Entries entries = profile.TakeChanged();
+  ASSERT_EQ(entries.size(), 1u);
+
+  // Without prewarming, painting the paragraph fills Skia's glyph cache.
+  SkGraphics::PurgeFontCache();
+  ASSERT_EQ(SkGraphics::GetFontCacheCountUsed(), 0);
+  PaintScaled(*paragraph, 2);
+  EXPECT_GT(SkGraphics::GetFontCacheCountUsed(), 0);
+
+  // Fonts that cannot be found are skipped.
+  GlyphProfile::Font missing = entries[0].first;
+  missing.family_name = "NoSuchFamily";
+  entries.emplace_back(missing, entries[0].second);
+
+  SkGraphics::PurgeFontCache();
+  EXPECT_EQ(GlyphProfile::Prewarm(*font_collection, entries, 2, nullptr), 3u);
+  const int strikes = SkGraphics::GetFontCacheCountUsed();
+  const size_t bytes = SkGraphics::GetFontCacheUsed();
+  EXPECT_GT(strikes, 0);
+
+  // After prewarming, painting finds all its glyphs in the cache.
+  PaintScaled(*paragraph, 2);
+  EXPECT_EQ(SkGraphics::GetFontCacheCountUsed(), strikes);
+  EXPECT_EQ(SkGraphics::GetFontCacheUsed(), bytes);
+}
+
+}  // namespace txt
@@ -14,16 +14,22 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
 #include "txt/font_style.h"
 #include "txt/font_weight.h"
+#include "txt/hyphenation_patterns.h"
 #include "txt/paragraph_builder_txt.h"
 #include "txt/paragraph_txt.h"
 #include "txt/placeholder_run.h"
@@ -207,6 +213,36 @@ TEST_F(ParagraphTest, GetGlyphPositionAtCoordinateMultiRun) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, AddTextInPlace) {
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  builder.PushStyle(text_style);
+  builder.AddText(u"Hello ");
+  builder.AddText(5, [](uint16_t* buffer) {
+    std::u16string text = u"World";
+    std::copy(text.begin(), text.end(), buffer);
+    return true;
+  });
+  // Text that is rejected while it is written is not added.
+  builder.AddText(3, [](uint16_t* buffer) {
+    buffer[0] = 'x';
+    return false;
+  });
+  builder.AddText(u"!");
+  builder.Pop();
+
+  auto paragraph = BuildParagraph(builder);
+  std::u16string expected = u"Hello World!";
+  ASSERT_EQ(paragraph->text_.size(), expected.size());
+  EXPECT_TRUE(
+      std::equal(expected.begin(), expected.end(), paragraph->text_.begin()));
+  ASSERT_EQ(paragraph->runs_.size(), 1u);
+  EXPECT_EQ(paragraph->runs_.GetRun(0).end, expected.size());
+}
+
 TEST_F(ParagraphTest, LineMetricsParagraph1) {
   const char* text = "Hello! What is going on?\nSecond line \nthirdline";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -6003,6 +6039,55 @@ TEST_F(ParagraphTest, RepeatLayoutParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, WidthOnlyRelayoutReusesMeasurements) {
+  const char* text =
+      "Sentence to layout at diff widths to get diff line counts.\nshort "
+      "words short words short words short words short words short words "
+      "short words short words short words short words short words end";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.break_strategy = minikin::kBreakStrategy_HighQuality;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 31;
+  text_style.color = SK_ColorBLACK;
+
+  auto build = [&]() {
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  auto paragraph = build();
+  paragraph->Layout(300);
+  ASSERT_TRUE(paragraph->measurements_valid_);
+  ASSERT_EQ(paragraph->measured_blocks_.size(), 2ull);
+  const float* char_widths = paragraph->measured_blocks_[0].char_widths.data();
+  const double max_intrinsic_width = paragraph->GetMaxIntrinsicWidth();
+
+  // A new width rebreaks the measured text without measuring it again.
+  paragraph->Layout(600);
+  ASSERT_EQ(paragraph->measured_blocks_[0].char_widths.data(), char_widths);
+  ASSERT_EQ(paragraph->GetMaxIntrinsicWidth(), max_intrinsic_width);
+
+  auto fresh_paragraph = build();
+  fresh_paragraph->Layout(600);
+  ASSERT_EQ(paragraph->GetLineCount(), fresh_paragraph->GetLineCount());
+  ASSERT_EQ(paragraph->GetHeight(), fresh_paragraph->GetHeight());
+  ASSERT_EQ(paragraph->GetLongestLine(), fresh_paragraph->GetLongestLine());
+  ASSERT_EQ(paragraph->GetMinIntrinsicWidth(),
+            fresh_paragraph->GetMinIntrinsicWidth());
+  for (size_t i = 0; i < paragraph->line_widths_.size(); i++) {
+    ASSERT_EQ(paragraph->line_widths_[i], fresh_paragraph->line_widths_[i]);
+  }
+}
+
 TEST_F(ParagraphTest, Ellipsize) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
@@ -7202,4 +7287,61 @@ TEST_F(ParagraphTest, MixedTextHeightBehaviorRectsParagraph) {
 
   ASSERT_TRUE(Snapshot());
 }
+
+TEST_F(ParagraphTest, HyphenatesWithProvidedPatterns) {
+  const std::vector<uint32_t> patterns = GetTestHyphenationPatterns();
+  SetHyphenationPatternProvider(
+      [&patterns](
+          const std::string& file_name) -> std::unique_ptr<fml::Mapping> {
+        if (file_name != "hyph-qaa.hyb") {
+          return nullptr;
+        }
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(patterns.data());
+        return std::make_unique<fml::DataMapping>(std::vector<uint8_t>(
+            data, data + patterns.size() * sizeof(uint32_t)));
+      });
+
+  const std::u16string text = u"abcabcabcabcabcabc";
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.locale = "qaa";
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 50;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  SetHyphenationPatternProvider(nullptr);
+
+  paragraph->Paint(GetCanvas(), 0, 0);
+
+  // The word is broken before one of its 'c's, as the patterns allow, rather
+  // than wherever the line is full.
+  ASSERT_GT(paragraph->GetLineMetrics().size(), 1ull);
+  const LineMetrics& first_line = paragraph->GetLineMetrics()[0];
+  ASSERT_GT(first_line.end_index, first_line.start_index);
+  ASSERT_LT(first_line.end_index, text.size());
+  EXPECT_EQ(text[first_line.end_index], u'c');
+
+  // The first line is drawn with a hyphen after its letters.
+  size_t glyph_count = 0;
+  for (const PaintRecord& record : paragraph->records_) {
+    if (record.line() != 0) {
+      continue;
+    }
+    SkTextBlob::Iter iter(*record.text());
+    SkTextBlob::Iter::Run run;
+    while (iter.next(&run)) {
+      glyph_count += run.fGlyphCount;
+    }
+  }
+  EXPECT_EQ(glyph_count, first_line.end_index - first_line.start_index + 1);
+  ASSERT_TRUE(Snapshot());
+}
+
 }  // namespace txt
@@ -127,4 +127,54 @@ std::unique_ptr<ParagraphTxt> BuildParagraph(
       static_cast<txt::ParagraphTxt*>(builder.Build().release()));
 }
 
+std::vector<uint32_t> GetTestHyphenationPatterns() {
+  const uint32_t alphabet_offset = 24;
+  const uint32_t trie_offset = 64;
+  const uint32_t trie_entries = 64;
+  const uint32_t pattern_offset = trie_offset + 24 + trie_entries * 4;
+  const uint32_t pattern_entries = 2;
+  const uint32_t pattern_buf_offset = 16 + pattern_entries * 4;
+  const uint32_t file_size = pattern_offset + pattern_buf_offset + 4;
+
+  std::vector<uint32_t> words(file_size / 4);
+  words[0] = 0x62ad7968;  // magic
+  words[1] = 0;           // version
+  words[2] = alphabet_offset;
+  words[3] = trie_offset;
+  words[4] = pattern_offset;
+  words[5] = file_size;
+
+  uint32_t* alphabet = &words[alphabet_offset / 4];
+  alphabet[0] = 0;  // version
+  alphabet[1] = 'a';
+  alphabet[2] = 'z' + 1;
+  uint8_t* codes = reinterpret_cast<uint8_t*>(&alphabet[3]);
+  for (int i = 0; i < 26; i++) {
+    codes[i] = i + 1;
+  }
+
+  uint32_t* trie = &words[trie_offset / 4];
+  trie[0] = 0;     // version
+  trie[1] = 0x1f;  // char_mask
+  trie[2] = 5;     // link_shift
+  trie[3] = 0xffe0;
+  trie[4] = 16;  // pattern_shift
+  trie[5] = trie_entries;
+  // The root links 'c' to node 32, which holds pattern 1.
+  const uint32_t c_code = codes['c' - 'a'];
+  trie[6 + c_code] = c_code | (32 << 5);
+  trie[6 + 32] = 1 << 16;
+
+  uint32_t* pattern = &words[pattern_offset / 4];
+  pattern[0] = 0;  // version
+  pattern[1] = pattern_entries;
+  pattern[2] = pattern_buf_offset;
+  pattern[3] = 1;  // pattern_size
+  // Pattern 1 is one value, followed by the one trailing zero that is
+  // omitted, at offset 0 of the pattern buffer.
+  pattern[5] = (1 << 26) | (1 << 20) | 0;
+  reinterpret_cast<uint8_t*>(pattern)[pattern_buf_offset] = 1;
+  return words;
+}
+
 }  // namespace txt
@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "flutter/fml/command_line.h"
 #include "txt/font_collection.h"
@@ -35,4 +37,8 @@ std::shared_ptr<FontCollection> GetTestFontCollection();
 
 std::unique_ptr<ParagraphTxt> BuildParagraph(ParagraphBuilderTxt& builder);
 
+// Returns the words of a hyb hyphenation pattern file for the letters 'a' to
+// 'z' with a single pattern, "1c", that allows a hyphen before every 'c'.
+std::vector<uint32_t> GetTestHyphenationPatterns();
+
 }  // namespace txt